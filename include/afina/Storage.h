@@ -1,6 +1,7 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <functional>
 #include <string>
 
 namespace Afina {
@@ -84,6 +85,19 @@ public:
      * @param value output parameter to copy value to
      */
     virtual bool Get(const std::string &key, std::string &value) = 0;
+
+    /**
+     * Calls visit for every key/value pair stored, from the least recently used to the most recent one, so
+     * putting them in that order into another storage rebuilds the same recency. Storage must not be changed
+     * from visit.
+     *
+     * Method returns false if storage can't enumerate its content
+     *
+     * @param visit callback to pass every pair to
+     */
+    virtual bool Scan(const std::function<void(const std::string &key, const std::string &value)> & /* visit */) {
+        return false;
+    }
 };
 
 } // namespace Afina
@@ -0,0 +1,132 @@
+#ifndef AFINA_CLIENT_ASYNC_CLIENT_H
+#define AFINA_CLIENT_ASYNC_CLIENT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Client {
+
+/**
+ * Item of retrieval response: value of get or statistic of stats
+ */
+struct Value {
+    std::string key;
+    uint32_t flags = 0;
+    std::string data;
+};
+
+/**
+ * Response to a single request
+ */
+struct Response {
+    // Command succeeded: value stored or retrieval completed, missing keys are not a failure
+    bool ok = false;
+
+    // Last response line: STORED, NOT_STORED, END or error sent by server. Request that never got a response
+    // because of connection failure has "CONNECTION_ERROR <reason>" here
+    std::string status;
+
+    // Found values, for multi-get in no particular order
+    std::vector<Value> values;
+};
+
+using Callback = std::function<void(Response &)>;
+
+/**
+ * # Asynchronous client
+ * Nonblocking client for memcached text protocol over TCP or unix sockets, driven by a single epoll owned by the
+ * client. Requests are only queued by calls like Get or Set, they are written and responses are read by Poll,
+ * which invokes callbacks of completed requests. Everything happens on the thread calling methods, client is
+ * not thread safe: every thread should have its own one.
+ *
+ * - Pipelining: requests go into a connection without waiting for responses to previous ones. Requests queued
+ *   between two Polls are written with a single syscall.
+ * - Pooling: each server has a number of connections, request goes to the one with the least requests in
+ *   flight. Requests above pipeline depth of all connections wait in client.
+ * - Consistent hashing: key belongs to a server chosen by ketama ring (see HashRing.h), so clients agree on
+ *   placement and adding a server moves only a part of keys.
+ * - Multi-get: keys are grouped by server, every server gets a single get with all its keys and callback
+ *   gets all found values together. It is ok when at least one server answered, keys of failed servers are
+ *   just missing from values and status keeps the error.
+ *
+ * Connection that fails completes its requests with CONNECTION_ERROR. Server is reconnected on the next
+ * request, requests within reconnect delay after failure fail right away.
+ */
+class AsyncClient {
+public:
+    struct Options {
+        // Connections to each server
+        std::size_t connections = 1;
+
+        // Requests in flight on a single connection
+        std::size_t pipeline = 128;
+
+        // Failed server isn't contacted again for that long
+        std::chrono::milliseconds reconnect_delay = std::chrono::milliseconds(100);
+    };
+
+    /**
+     * Servers are given as "host:port", "[v6]:port" with numeric addresses or "unix:/path", "unix:@name".
+     * Nothing is connected until the first request
+     */
+    explicit AsyncClient(const std::vector<std::string> &servers);
+    AsyncClient(const std::vector<std::string> &servers, Options options);
+    ~AsyncClient();
+
+    void Get(const std::vector<std::string> &keys, Callback callback);
+    void Set(const std::string &key, const std::string &value, Callback callback, uint32_t flags = 0);
+    void Add(const std::string &key, const std::string &value, Callback callback, uint32_t flags = 0);
+    void Append(const std::string &key, const std::string &value, Callback callback, uint32_t flags = 0);
+
+    /**
+     * Statistics of the given server, see Servers
+     */
+    void Stats(std::size_t server, Callback callback);
+
+    /**
+     * Writes queued requests, waits for events no longer than timeout, negative waits forever, and handles
+     * them. Returns number of requests completed
+     */
+    std::size_t Poll(int timeout_ms);
+
+    /**
+     * Polls until all requests are completed
+     */
+    void Wait();
+
+    /**
+     * Requests without response yet
+     */
+    std::size_t InFlight() const;
+
+    /**
+     * Descriptor to wait for readiness on in somebody else's event loop, Poll(0) should be called then
+     */
+    int fd() const;
+
+    std::size_t Servers() const;
+
+    /**
+     * Server owning the key
+     */
+    std::size_t ServerOf(const std::string &key) const;
+
+private:
+    AsyncClient(const AsyncClient &) = delete;
+    AsyncClient &operator=(const AsyncClient &) = delete;
+
+    // Implementation details, see AsyncClient.cpp
+    struct State;
+    std::unique_ptr<State> _state;
+};
+
+} // namespace Client
+} // namespace Afina
+
+#endif // AFINA_CLIENT_ASYNC_CLIENT_H
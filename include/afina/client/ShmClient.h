@@ -0,0 +1,89 @@
+#ifndef AFINA_CLIENT_SHM_CLIENT_H
+#define AFINA_CLIENT_SHM_CLIENT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Afina {
+namespace Client {
+
+/**
+ * # Shared memory client
+ * Talks to afina running on the same host through a pair of rings in memory shared with the server,
+ * so a round trip takes no syscall while both sides are busy. Request is one or more complete memcached
+ * text commands, response is their responses together. Requests could be pipelined: every Send gets
+ * exactly one response, in order.
+ *
+ * Client is not thread safe, each thread should have its own one.
+ */
+class ShmClient {
+public:
+    // Default bytes of each ring, limits a single request or response to half of that
+    static constexpr uint32_t kDefaultCapacity = 1 << 20;
+
+    ShmClient();
+    ~ShmClient();
+
+    /**
+     * Attaches to server listening on unix socket given as "unix:/path" or "unix:@name" with rings of given
+     * capacity, power of two. Throws std::runtime_error on failure
+     */
+    void Connect(const std::string &address, uint32_t capacity = kDefaultCapacity);
+
+    /**
+     * Detaches from server, requests without responses are lost
+     */
+    void Close();
+
+    /**
+     * Time to keep polling for a response before going to sleep, zero sleeps right away. Default is 50us,
+     * no spin on a single core host
+     */
+    void SetSpin(std::chrono::microseconds spin) { _spin = spin; }
+
+    /**
+     * Longest request or response
+     */
+    std::size_t MaxRequest() const;
+
+    /**
+     * Queues request, returns false if ring has no room: responses must be taken first. Throws
+     * std::runtime_error if request is longer than MaxRequest
+     */
+    bool Send(const char *data, std::size_t size);
+    bool Send(const std::string &request) { return Send(request.data(), request.size()); }
+
+    /**
+     * Waits for response to the oldest request no longer than timeout, negative waits forever. Returns false
+     * on timeout, throws std::runtime_error if server is gone
+     */
+    bool Receive(std::string &response, std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+    /**
+     * Round trip: sends request and waits for its response
+     */
+    std::string Execute(const std::string &request);
+
+private:
+    ShmClient(const ShmClient &) = delete;
+    ShmClient &operator=(const ShmClient &) = delete;
+
+    /**
+     * Sleeps until server signals responses, goes away or timeout expires
+     */
+    void Wait(int timeout_ms);
+
+    // Implementation details, see ShmClient.cpp
+    struct State;
+    std::unique_ptr<State> _state;
+
+    std::chrono::microseconds _spin;
+};
+
+} // namespace Client
+} // namespace Afina
+
+#endif // AFINA_CLIENT_SHM_CLIENT_H
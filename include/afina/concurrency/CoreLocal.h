@@ -1,10 +1,193 @@
 #ifndef AFINA_CONCURRENCY_CORE_LOCAL_H
 #define AFINA_CONCURRENCY_CORE_LOCAL_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#include <sched.h>
+#include <unistd.h>
+
+#if defined(__has_include)
+#if __has_include(<sys/rseq.h>)
+#include <sys/rseq.h>
+#define AFINA_HAVE_RSEQ 1
+#endif
+#endif
+
 namespace Afina {
 namespace Concurrency {
 
-template <typename T> class CoreLocal {};
+/**
+ * # Per-CPU storage
+ * Keeps one instance of T for each CPU configured in the system. Each instance lives in its own
+ * cache line(s), so threads running on different cores never touch the same line. Comparing to
+ * per-thread storage memory is bounded by number of cores rather than number of threads.
+ *
+ * Current CPU is taken from the rseq area registered by glibc (single load from TLS) and falls
+ * back to sched_getcpu if kernel/libc doesn't provide one.
+ *
+ * Thread could be migrated to other CPU at any moment, even right after it got the slot, so two
+ * threads could end up on the same slot at once. There are two ways to deal with it:
+ * - local(): raw access, T must be ready for concurrent use, for example made of relaxed atomics;
+ * - try_lock_local()/with_local(): each slot has a tiny spinlock that is almost always free.
+ */
+template <typename T> class CoreLocal {
+public:
+    static constexpr std::size_t kCacheLine = 64;
+
+    /**
+     * Exclusive access to a slot, releases it on destruction. Evaluates to false if slot wasn't
+     * acquired
+     */
+    class Guard {
+    public:
+        Guard() : _slot(nullptr) {}
+        explicit Guard(std::atomic<bool> *lock, T *value) : _slot(value), _lock(lock) {}
+        Guard(Guard &&other) : _slot(other._slot), _lock(other._lock) { other._slot = nullptr; }
+        ~Guard() {
+            if (_slot != nullptr) {
+                _lock->store(false, std::memory_order_release);
+            }
+        }
+
+        explicit operator bool() const { return _slot != nullptr; }
+        T &operator*() const { return *_slot; }
+        T *operator->() const { return _slot; }
+
+    private:
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        T *_slot;
+        std::atomic<bool> *_lock;
+    };
+
+    template <typename... Args> explicit CoreLocal(Args &&... args) : _size(cpu_count()) {
+        void *mem = nullptr;
+        if (posix_memalign(&mem, kCacheLine, sizeof(Slot) * _size) != 0) {
+            throw std::bad_alloc();
+        }
+
+        _slots = static_cast<Slot *>(mem);
+        for (std::size_t i = 0; i < _size; i++) {
+            new (&_slots[i]) Slot(args...);
+        }
+    }
+
+    ~CoreLocal() {
+        for (std::size_t i = 0; i < _size; i++) {
+            _slots[i].~Slot();
+        }
+        free(_slots);
+    }
+
+    /**
+     * Returns instance that belongs to the CPU calling thread is running on
+     */
+    T &local() { return _slots[current_cpu() % _size].value; }
+
+    /**
+     * Tries to get exclusive access to the current CPU slot. Fails only if some other thread is
+     * holding it right now, i.e it was preempted or migrated away in the middle of the operation
+     */
+    Guard try_lock_local() { return try_lock(current_cpu() % _size); }
+
+    /**
+     * Runs f on exclusively owned slot. Prefers slot of the current CPU, but if it is busy takes
+     * the next free one instead of waiting, so that migrated thread never spins on other's slot
+     */
+    template <typename F> void with_local(F &&f) {
+        std::size_t cpu = current_cpu();
+        for (std::size_t i = 0;; i++) {
+            Guard guard = try_lock((cpu + i) % _size);
+            if (guard) {
+                f(*guard);
+                return;
+            }
+        }
+    }
+
+    /**
+     * Access instance of the given CPU
+     */
+    T &operator[](std::size_t cpu) { return _slots[cpu].value; }
+    const T &operator[](std::size_t cpu) const { return _slots[cpu].value; }
+
+    /**
+     * Number of slots, i.e number of CPUs configured in the system
+     */
+    std::size_t size() const { return _size; }
+
+    /**
+     * Calls f for each slot, no locking performed. Useful to read counters
+     */
+    template <typename F> void for_each(F &&f) const {
+        for (std::size_t i = 0; i < _size; i++) {
+            f(static_cast<const T &>(_slots[i].value));
+        }
+    }
+
+    /**
+     * Folds all slots into a single value, for example:
+     * total = counters.reduce(uint64_t(0), [](uint64_t acc, const Counter &c) { return acc + c.load(); });
+     */
+    template <typename R, typename F> R reduce(R init, F &&f) const {
+        for (std::size_t i = 0; i < _size; i++) {
+            init = f(std::move(init), static_cast<const T &>(_slots[i].value));
+        }
+        return init;
+    }
+
+    /**
+     * Index of the CPU calling thread is running on. Result is a hint only, thread could be
+     * migrated right after
+     */
+    static inline std::size_t current_cpu() {
+#ifdef AFINA_HAVE_RSEQ
+        if (__rseq_size > 0) {
+            const struct rseq *area = reinterpret_cast<const struct rseq *>(
+                static_cast<const char *>(__builtin_thread_pointer()) + __rseq_offset);
+            uint32_t cpu = *static_cast<const volatile uint32_t *>(&area->cpu_id);
+            if (cpu < static_cast<uint32_t>(INT32_MAX)) {
+                return cpu;
+            }
+        }
+#endif
+        int cpu = sched_getcpu();
+        return cpu >= 0 ? static_cast<std::size_t>(cpu) : 0;
+    }
+
+private:
+    CoreLocal(const CoreLocal &) = delete;
+    CoreLocal &operator=(const CoreLocal &) = delete;
+
+    struct alignas(kCacheLine) Slot {
+        template <typename... Args> explicit Slot(Args &&... args) : busy(false), value(std::forward<Args>(args)...) {}
+
+        std::atomic<bool> busy;
+        T value;
+    };
+
+    Guard try_lock(std::size_t idx) {
+        Slot &slot = _slots[idx];
+        if (slot.busy.load(std::memory_order_relaxed) || slot.busy.exchange(true, std::memory_order_acquire)) {
+            return Guard();
+        }
+        return Guard(&slot.busy, &slot.value);
+    }
+
+    static std::size_t cpu_count() {
+        long n = sysconf(_SC_NPROCESSORS_CONF);
+        return n > 0 ? static_cast<std::size_t>(n) : 1;
+    }
+
+    std::size_t _size;
+    Slot *_slots;
+};
 
 } // namespace Concurrency
 } // namespace Afina
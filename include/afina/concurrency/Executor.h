@@ -1,13 +1,16 @@
 #ifndef AFINA_CONCURRENCY_EXECUTOR_H
 #define AFINA_CONCURRENCY_EXECUTOR_H
 
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <queue>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace spdlog {
 class logger;
@@ -53,7 +56,8 @@ public:
      * Signal thread pool to stop, it will stop accepting new jobs and close threads just after each become
      * free. All enqueued jobs will be complete.
      *
-     * In case if await flag is true, call won't return until all background jobs are done and all threads are stopped
+     * In case if await flag is true, call won't return until all background jobs are done and all threads are stopped.
+     * Destructor stops pool that way
      */
     void Stop(bool await = false);
 
@@ -1,10 +1,149 @@
 #ifndef AFINA_CONCURRENCY_THREAD_LOCAL_H
 #define AFINA_CONCURRENCY_THREAD_LOCAL_H
 
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <vector>
+
 namespace Afina {
 namespace Concurrency {
 
-template <typename T> class ThreadLocal {};
+/**
+ * # Type independent part of ThreadLocal
+ * Owns global registry of all threads that have at least one slot and all alive ThreadLocal
+ * instances. Each thread keeps a vector of slots indexed by instance id, so access to own slot
+ * is a couple of loads without any locks. Registry lock is taken only when a slot is created,
+ * enumerated, released on thread exit or instance destroyed
+ */
+class ThreadLocalBase {
+public:
+    // Slots of a single thread, index is an id of ThreadLocal instance
+    struct ThreadEntry {
+        std::vector<void *> slots;
+    };
+
+protected:
+    ThreadLocalBase();
+    virtual ~ThreadLocalBase();
+
+    /**
+     * Returns slot of calling thread, creates new one if needed
+     */
+    inline void *slot() {
+        ThreadEntry *entry = _current;
+        if (entry != nullptr && _id < entry->slots.size() && entry->slots[_id] != nullptr) {
+            return entry->slots[_id];
+        }
+        return create_slot();
+    }
+
+    /**
+     * Calls fn for each existing slot under registry lock
+     */
+    void visit(void (*fn)(void *slot, void *ctx), void *ctx) const;
+
+    /**
+     * Destroys all slots that belongs to the instance. Must be called from the derived class
+     * destructor since it calls virtual methods
+     */
+    void release();
+
+    // Allocate and construct new value
+    virtual void *allocate() = 0;
+
+    // Destroys value, thread_exit tells whether owner thread is gone
+    virtual void destroy(void *slot, bool thread_exit) = 0;
+
+private:
+    friend void thread_local_exit(void *entry);
+
+    ThreadLocalBase(const ThreadLocalBase &) = delete;
+    ThreadLocalBase &operator=(const ThreadLocalBase &) = delete;
+
+    void *create_slot();
+
+    // Slots of the current thread
+    static thread_local ThreadEntry *_current;
+
+    // Index of instance slot in ThreadEntry::slots
+    std::size_t _id;
+};
+
+/**
+ * # Per-instance thread local object
+ * Unlike C++ thread_local each instance of ThreadLocal has its own value for each thread. Every
+ * value lives in its own cache lines, so threads never share them. Owner of the instance could
+ * enumerate values of all threads, for example to sum per-thread counters, without making owner
+ * threads to synchronize on each update.
+ *
+ * Once thread exits its values get destroyed, before that optional exit callback is invoked so that
+ * value could be merged somewhere else (i.e counters of the retired threads).
+ */
+template <typename T> class ThreadLocal : private ThreadLocalBase {
+public:
+    static constexpr std::size_t kCacheLine = 64;
+
+    ThreadLocal() {}
+
+    /**
+     * @param on_thread_exit called with the value once thread owning it exits, under registry lock
+     */
+    explicit ThreadLocal(std::function<void(T &)> on_thread_exit) : _on_thread_exit(std::move(on_thread_exit)) {}
+
+    ~ThreadLocal() { release(); }
+
+    /**
+     * Value of the calling thread
+     */
+    inline T &get() { return *static_cast<T *>(slot()); }
+    inline T &operator*() { return get(); }
+    inline T *operator->() { return &get(); }
+
+    /**
+     * Calls f for each thread value, including current one. Note that owners might change values
+     * concurrently, so T must be ready for that (atomics usually). Callback runs under registry lock
+     * and must not access any ThreadLocal
+     */
+    template <typename F> void for_each(F &&f) const {
+        typedef typename std::remove_reference<F>::type Fn;
+        auto fn = [](void *slot, void *ctx) { (*static_cast<Fn *>(ctx))(*static_cast<const T *>(slot)); };
+        visit(fn, const_cast<void *>(static_cast<const void *>(&f)));
+    }
+
+protected:
+    // See ThreadLocalBase
+    void *allocate() override {
+        void *mem = nullptr;
+        std::size_t size = (sizeof(T) + kCacheLine - 1) / kCacheLine * kCacheLine;
+        if (posix_memalign(&mem, kCacheLine, size) != 0) {
+            throw std::bad_alloc();
+        }
+
+        try {
+            return new (mem) T();
+        } catch (...) {
+            free(mem);
+            throw;
+        }
+    }
+
+    // See ThreadLocalBase
+    void destroy(void *slot, bool thread_exit) override {
+        T *value = static_cast<T *>(slot);
+        if (thread_exit && _on_thread_exit) {
+            _on_thread_exit(*value);
+        }
+
+        value->~T();
+        free(slot);
+    }
+
+private:
+    std::function<void(T &)> _on_thread_exit;
+};
 
 } // namespace Concurrency
 } // namespace Afina
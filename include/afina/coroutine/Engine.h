@@ -2,6 +2,7 @@
 #define AFINA_COROUTINE_ENGINE_H
 
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <setjmp.h>
@@ -13,6 +14,10 @@ namespace Coroutine {
 /**
  * # Entry point of coroutine library
  * Allows to run coroutine and schedule its execution. Not threadsafe
+ *
+ * Coroutine waiting for something external (i.e socket to get readable) blocks itself and is not
+ * scheduled until somebody unblocks it. Once all coroutines are blocked engine calls unblocker, which
+ * is expected to wait for events and unblock coroutines interested in them.
  */
 class Engine final {
 private:
@@ -37,6 +42,9 @@ private:
         // To include coroutine in the different lists, such as "alive", "blocked", e.t.c
         struct context *prev = nullptr;
         struct context *next = nullptr;
+
+        // Coroutine is in the blocked list
+        bool is_blocked = false;
     } context;
 
     /**
@@ -55,11 +63,21 @@ private:
      */
     context *alive;
 
+    /**
+     * List of routines waiting to be unblocked
+     */
+    context *blocked;
+
     /**
      * Context to be returned finally
      */
     context *idle_ctx;
 
+    /**
+     * Called once there are no routines to run but some are blocked
+     */
+    std::function<void(Engine &)> _unblocker;
+
 protected:
     /**
      * Save stack of the current coroutine in the given context
@@ -74,10 +92,27 @@ protected:
     /**
      * Suspend current coroutine execution and execute given context
      */
-     void Enter(context& ctx);
+    void Enter(context &ctx);
+
+    /**
+     * Runs on idle context each time current routine is done or blocked: passes control to some alive
+     * routine or waits for blocked ones. Returns once there is nothing to run anymore
+     */
+    void Idle();
+
+    /**
+     * Doubly linked list operations
+     */
+    static void Unlink(context *&list, context *routine);
+    static void Push(context *&list, context *routine);
 
 public:
-    Engine() : StackBottom(0), cur_routine(nullptr), alive(nullptr) {}
+    /**
+     * @param unblocker called when all coroutines are blocked, without it engine stops in such case
+     */
+    explicit Engine(std::function<void(Engine &)> unblocker = nullptr)
+        : StackBottom(0), cur_routine(nullptr), alive(nullptr), blocked(nullptr), idle_ctx(nullptr),
+          _unblocker(std::move(unblocker)) {}
     Engine(Engine &&) = delete;
     Engine(const Engine &) = delete;
 
@@ -100,6 +135,18 @@ public:
      */
     void sched(void *routine);
 
+    /**
+     * Moves routine to the blocked list, so it isn't scheduled until unblocked. Without argument blocks
+     * current routine and passes execution to some other one
+     */
+    void block(void *routine = nullptr);
+
+    /**
+     * Makes blocked routine ready to run again, does nothing for routine that isn't blocked. Doesn't
+     * pass execution to it
+     */
+    void unblock(void *routine);
+
     /**
      * Entry point into the engine. Prepare all internal mechanics and starts given function which is
      * considered as main.
@@ -120,8 +167,8 @@ public:
         idle_ctx = new context();
 
         if (setjmp(idle_ctx->Environment) > 0) {
-            // Here: correct finish of the coroutine section
-            yield();
+            // Here: some coroutine is finished or blocked
+            Idle();
         } else if (pc != nullptr) {
             Store(*idle_ctx);
             sched(pc);
@@ -158,22 +205,11 @@ public:
             // to pass control after that. We never want to go backward by stack as that would mean to go backward in
             // time. Function run() has already return once (when setjmp returns 0), so return second return from run
             // would looks a bit awkward
-            if (pc->prev != nullptr) {
-                pc->prev->next = pc->next;
-            }
-
-            if (pc->next != nullptr) {
-                pc->next->prev = pc->prev;
-            }
-
-            if (alive == cur_routine) {
-                alive = alive->next;
-            }
+            Unlink(alive, pc);
 
             // current coroutine finished, and the pointer is not relevant now
             cur_routine = nullptr;
-            pc->prev = pc->next = nullptr;
-            delete std::get<0>(pc->Stack);
+            delete[] std::get<0>(pc->Stack);
             delete pc;
 
             // We cannot return here, as this function "returned" once already, so here we must select some other
@@ -188,12 +224,7 @@ public:
         Store(*pc);
 
         // Add routine as alive double-linked list
-        pc->next = alive;
-        alive = pc;
-        if (pc->next != nullptr) {
-            pc->next->prev = pc;
-        }
-
+        Push(alive, pc);
         return pc;
     }
 };
@@ -1,6 +1,7 @@
 #ifndef AFINA_EXECUTE_COMMAND_H
 #define AFINA_EXECUTE_COMMAND_H
 
+#include <cstddef>
 #include <string>
 
 namespace Afina {
@@ -19,6 +20,12 @@ public:
     virtual ~Command() {}
 
     virtual void Execute(Storage &storage, const std::string &args, std::string &out) = 0;
+
+    /**
+     * Rough estimate of work needed to execute command with the given argument, in bytes to be copied.
+     * Network layer may move expensive commands out of its IO threads
+     */
+    virtual std::size_t Cost(const std::string &args) const { return args.size(); }
 };
 
 } // namespace Execute
@@ -41,6 +41,9 @@ public:
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
 
+    // Every key costs lookup and copy of a value of unknown size
+    std::size_t Cost(const std::string &args) const override;
+
 private:
     std::vector<std::string> _keys;
 };
@@ -2,17 +2,43 @@
 #define AFINA_EXECUTE_STATS_H
 
 #include <string>
+#include <vector>
 
 #include "Command.h"
 
+#include <sstream>
+
 namespace Afina {
 namespace Execute {
 
+/**
+ * # Server statistics
+ * Without arguments reports general purpose counters, "stats latency" reports server side latency
+ * percentiles for each command type.
+ *
+ * Each statistic is sent as:
+ * STAT <name> <value>\r\n
+ * ...
+ * END
+ */
 class Stats : public Command {
 public:
     Stats() {}
+    Stats(const std::vector<std::string> &args) : _args(args) {}
     ~Stats() {}
+
+    inline const std::vector<std::string> &args() const { return _args; }
+
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    // Reports counters
+    void General(std::stringstream &out);
+
+    // Reports latency percentiles
+    void Latency(std::stringstream &out);
+
+    std::vector<std::string> _args;
 };
 
 } // namespace Execute
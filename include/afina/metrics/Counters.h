@@ -0,0 +1,107 @@
+#ifndef AFINA_METRICS_COUNTERS_H
+#define AFINA_METRICS_COUNTERS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <afina/concurrency/ThreadLocal.h>
+
+namespace Afina {
+namespace Metrics {
+
+/**
+ * Counters reported by "stats" command
+ */
+enum Counter : std::size_t {
+    // Number of keys requested by retrieval commands
+    kGets = 0,
+    // Number of requested keys found / not found
+    kHits,
+    kMisses,
+    // Number of storage commands: set, add, append, replace
+    kSets,
+    // Number of items evicted to free memory for the new ones
+    kEvictions,
+    // Number of items that were found expired on access
+    kExpirations,
+    // Bytes received from / sent to network
+    kBytesRead,
+    kBytesWritten,
+    // Number of connections open right now
+    kCurrConnections,
+    // Number of connections accepted since start
+    kTotalConnections,
+    // Number of times rate limited client ran out of tokens and its connection paused reading
+    kRateLimited,
+
+    kCountersCount
+};
+
+/**
+ * Names of the counters in memcached "stats" output, indexed by Counter
+ */
+extern const char *const kCounterNames[kCountersCount];
+
+/**
+ * # Process wide statistic counters
+ * Each thread increments its own cache line isolated block of counters, so update is a plain load/add/store
+ * without lock prefix or contention. Blocks are summed up on demand only, counters of exited threads are
+ * merged into a separate block.
+ *
+ * Note that snapshot is not atomic: counters updated concurrently with Collect may or may not be included
+ */
+class Counters {
+public:
+    /**
+     * Counters used by all services of the process
+     */
+    static Counters &Instance();
+
+    /**
+     * Adds delta to the calling thread counter
+     */
+    inline void Add(Counter counter, int64_t delta = 1) {
+        // Only owner thread writes, so no need for read-modify-write atomic
+        std::atomic<int64_t> &value = _local.get().values[counter];
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    /**
+     * Sums counters of all threads
+     */
+    void Collect(int64_t (&out)[kCountersCount]) const;
+
+    /**
+     * Time counters were created at, i.e process start
+     */
+    std::chrono::steady_clock::time_point Started() const { return _started; }
+
+private:
+    Counters();
+    Counters(const Counters &) = delete;
+    Counters &operator=(const Counters &) = delete;
+
+    struct Block {
+        Block() {
+            for (auto &v : values) {
+                v.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<int64_t> values[kCountersCount];
+    };
+
+    const std::chrono::steady_clock::time_point _started;
+
+    // Counters of threads that already gone
+    Block _retired;
+
+    mutable Concurrency::ThreadLocal<Block> _local;
+};
+
+} // namespace Metrics
+} // namespace Afina
+
+#endif // AFINA_METRICS_COUNTERS_H
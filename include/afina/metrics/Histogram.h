@@ -0,0 +1,107 @@
+#ifndef AFINA_METRICS_HISTOGRAM_H
+#define AFINA_METRICS_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Metrics {
+
+/**
+ * # Log-linear histogram
+ * HdrHistogram like layout: values below 2^kSubBucketBits are counted exactly, each following power of two
+ * range is split into 2^kSubBucketBits linear sub-buckets. So relative error is bounded by 1/2^kSubBucketBits
+ * (~3%) for any value, while whole histogram is just a flat array of counters.
+ *
+ * Values above 2^kMaxBits are counted in the last bucket.
+ *
+ * Histogram is meant to have a single writer (Record) and any number of concurrent readers.
+ */
+class Histogram {
+public:
+    static constexpr unsigned kSubBucketBits = 5;
+    static constexpr unsigned kMaxBits = 32;
+    static constexpr uint64_t kSubBuckets = uint64_t(1) << kSubBucketBits;
+    static constexpr std::size_t kBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    Histogram() { Reset(); }
+
+    /**
+     * Counts given value, must be called by the owner thread only
+     */
+    inline void Record(uint64_t value) {
+        std::atomic<uint64_t> &bucket = _counts[BucketOf(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (value > _max.load(std::memory_order_relaxed)) {
+            _max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Adds all counts of other histogram into this one
+     */
+    void Merge(const Histogram &other);
+
+    /**
+     * Drops all values
+     */
+    void Reset();
+
+    /**
+     * Number of recorded values
+     */
+    uint64_t Count() const;
+
+    /**
+     * Value at the given percentile, i.e Percentile(99.9). Result is the middle of the bucket
+     * percentile falls in, so it is within histogram precision of the real one
+     */
+    uint64_t Percentile(double percentile) const;
+
+    /**
+     * Number of values counted by the given bucket
+     */
+    uint64_t CountAt(std::size_t bucket) const { return _counts[bucket].load(std::memory_order_relaxed); }
+
+    /**
+     * Largest value recorded
+     */
+    uint64_t Max() const { return _max.load(std::memory_order_relaxed); }
+
+    /**
+     * Index of the bucket that counts given value
+     */
+    static inline std::size_t BucketOf(uint64_t value) {
+        if (value < kSubBuckets) {
+            return value;
+        }
+
+        unsigned exponent = 63 - __builtin_clzll(value);
+        if (exponent >= kMaxBits) {
+            return kBuckets - 1;
+        }
+
+        unsigned shift = exponent - kSubBucketBits;
+        return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+    }
+
+    /**
+     * Smallest value counted by the given bucket
+     */
+    static uint64_t LowestOf(std::size_t bucket);
+
+    /**
+     * Number of values counted by the given bucket
+     */
+    static uint64_t WidthOf(std::size_t bucket);
+
+private:
+    std::atomic<uint64_t> _counts[kBuckets];
+    std::atomic<uint64_t> _max;
+};
+
+} // namespace Metrics
+} // namespace Afina
+
+#endif // AFINA_METRICS_HISTOGRAM_H
@@ -0,0 +1,123 @@
+#ifndef AFINA_METRICS_LATENCY_H
+#define AFINA_METRICS_LATENCY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <afina/concurrency/ThreadLocal.h>
+#include <afina/metrics/Histogram.h>
+
+namespace Afina {
+namespace Metrics {
+
+/**
+ * Command types latency is tracked for
+ */
+enum CommandType : std::size_t {
+    kCommandGet = 0,
+    kCommandSet,
+    kCommandAdd,
+    kCommandAppend,
+    kCommandReplace,
+    kCommandStats,
+    kCommandOther,
+
+    kCommandTypesCount
+};
+
+/**
+ * Names of the command types in "stats latency" output, indexed by CommandType
+ */
+extern const char *const kCommandTypeNames[kCommandTypesCount];
+
+/**
+ * Maps protocol command name onto its type
+ */
+CommandType CommandTypeOf(const std::string &name);
+
+/**
+ * # Server side command latency
+ * Each worker thread records into its own set of histograms (one per command type), histograms are merged on
+ * read only. Only each N-th command is measured, so that clock isn't read on every command:
+ *
+ * uint64_t started = latency.Start();
+ * ... execute command, enqueue response ...
+ * latency.Finish(parser.Name(), started);
+ */
+class Latency {
+public:
+    /**
+     * Latency tracker used by all network services of the process
+     */
+    static Latency &Instance();
+
+    /**
+     * Measure one command of each rate, 0 disables measurement at all
+     */
+    void SetSampleRate(uint32_t rate) { _sample_rate.store(rate, std::memory_order_relaxed); }
+    uint32_t SampleRate() const { return _sample_rate.load(std::memory_order_relaxed); }
+
+    /**
+     * Marks command start, returns 0 if the command is not sampled
+     */
+    inline uint64_t Start() {
+        uint32_t rate = _sample_rate.load(std::memory_order_relaxed);
+        if (rate == 0) {
+            return 0;
+        }
+
+        Block &block = _local.get();
+        if (++block.ticks < rate) {
+            return 0;
+        }
+        block.ticks = 0;
+        return Now();
+    }
+
+    /**
+     * Records time passed since Start for the given command
+     */
+    inline void Finish(const std::string &command, uint64_t started) {
+        if (started != 0) {
+            _local.get().histograms[CommandTypeOf(command)].Record(Now() - started);
+        }
+    }
+
+    /**
+     * Merges histograms of all threads for the given command type into out
+     */
+    void Collect(CommandType type, Histogram &out) const;
+
+private:
+    Latency();
+    Latency(const Latency &) = delete;
+    Latency &operator=(const Latency &) = delete;
+
+    // Nanoseconds of the monotonic clock, never 0
+    static inline uint64_t Now() {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() | 1;
+    }
+
+    struct Block {
+        // Commands seen since the last sampled one, touched by owner only
+        uint32_t ticks = 0;
+
+        Histogram histograms[kCommandTypesCount];
+    };
+
+    std::atomic<uint32_t> _sample_rate;
+
+    // Histograms of threads that already gone
+    Histogram _retired[kCommandTypesCount];
+
+    mutable Concurrency::ThreadLocal<Block> _local;
+};
+
+} // namespace Metrics
+} // namespace Afina
+
+#endif // AFINA_METRICS_LATENCY_H
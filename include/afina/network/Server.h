@@ -1,7 +1,9 @@
 #ifndef AFINA_NETWORK_SERVER_H
 #define AFINA_NETWORK_SERVER_H
 
+#include <chrono>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace Afina {
@@ -18,9 +20,37 @@ namespace Network {
 class Server {
 public:
     Server(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
-        : pStorage(ps), pLogging(pl) {}
+        : pStorage(ps), pLogging(pl), idleTimeout(300000), readTimeout(5000) {}
     virtual ~Server() {}
 
+    /**
+     * Connection that has nothing in progress and sends nothing for idle timeout is closed. Command
+     * started must be received completely within read timeout. Zero disables timeout. Must be
+     * called before Start
+     */
+    void SetTimeouts(std::chrono::milliseconds idle, std::chrono::milliseconds read) {
+        idleTimeout = idle;
+        readTimeout = read;
+    }
+
+    /**
+     * Addresses to accept connections on: TCP over IPv4 or IPv6 and unix sockets, see network/common/Listener.h.
+     * Without them server listens on the port passed to Start on all IPv4 interfaces. Must be called before Start
+     */
+    void SetAddresses(std::vector<std::string> addresses) { listenAddresses = std::move(addresses); }
+
+    /**
+     * Listening sockets taken over from the previous process, see Handoff. Server accepts on them instead
+     * of binding its own and takes ownership. Must be called before Start
+     */
+    void SetListeners(std::vector<int> sockets) { inheritedListeners = std::move(sockets); }
+
+    /**
+     * Listening sockets to hand over to the next process, valid between Start and Join. Server that can't
+     * stop accepting without shutting listening socket down returns nothing
+     */
+    virtual std::vector<int> Listeners() const { return {}; }
+
     /**
      * Starts network service. After method returns process should
      * listen on the given interface/port pair to process  incomming
@@ -55,6 +85,22 @@ protected:
      * Logging service to be used in order to report application progress
      */
     std::shared_ptr<Afina::Logging::Service> pLogging;
+
+    /**
+     * Connection deadlines, see SetTimeouts
+     */
+    std::chrono::milliseconds idleTimeout;
+    std::chrono::milliseconds readTimeout;
+
+    /**
+     * Addresses to listen on, see SetAddresses
+     */
+    std::vector<std::string> listenAddresses;
+
+    /**
+     * Sockets to accept on instead of binding new ones, see SetListeners
+     */
+    std::vector<int> inheritedListeners;
 };
 
 } // namespace Network
@@ -0,0 +1,137 @@
+#include "Distribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Afina {
+namespace Bench {
+
+namespace {
+
+double zeta(uint64_t n, double theta) {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; i++) {
+        sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    return sum;
+}
+
+std::size_t parse_size(const std::string &text) {
+    std::size_t pos = 0;
+    unsigned long long value;
+    try {
+        value = std::stoull(text, &pos);
+    } catch (std::exception &) {
+        pos = 0;
+    }
+    if (pos == 0 || pos != text.size()) {
+        throw std::runtime_error("Bad value size: " + text);
+    }
+    return static_cast<std::size_t>(value);
+}
+
+} // namespace
+
+// See Distribution.h
+uint64_t UniformKeys::Next(Random &random) const {
+    return std::uniform_int_distribution<uint64_t>(0, _keys - 1)(random);
+}
+
+// See Distribution.h
+ZipfianKeys::ZipfianKeys(uint64_t keys, double theta) : KeyDistribution(keys), _theta(theta) {
+    if (keys < 2 || !(theta > 0 && theta < 1)) {
+        throw std::runtime_error("Zipfian distribution needs at least 2 keys and theta in (0, 1)");
+    }
+    _alpha = 1.0 / (1.0 - theta);
+    _zetan = zeta(keys, theta);
+    double zeta2 = zeta(2, theta);
+    _eta = (1.0 - std::pow(2.0 / keys, 1.0 - theta)) / (1.0 - zeta2 / _zetan);
+}
+
+// See Distribution.h
+uint64_t ZipfianKeys::Next(Random &random) const {
+    double u = std::uniform_real_distribution<double>(0, 1)(random);
+    double uz = u * _zetan;
+    if (uz < 1.0) {
+        return 0;
+    } else if (uz < 1.0 + std::pow(0.5, _theta)) {
+        return 1;
+    }
+    uint64_t rank = static_cast<uint64_t>(_keys * std::pow(_eta * u - _eta + 1, _alpha));
+    return std::min(rank, _keys - 1);
+}
+
+// See Distribution.h
+HotspotKeys::HotspotKeys(uint64_t keys, double hot_keys, double hot_share) : KeyDistribution(keys), _share(hot_share) {
+    if (!(hot_keys > 0 && hot_keys < 1) || !(hot_share >= 0 && hot_share <= 1)) {
+        throw std::runtime_error("Hotspot needs hot keys fraction in (0, 1) and requests share in [0, 1]");
+    }
+    _hot = std::max<uint64_t>(1, std::min<uint64_t>(keys - 1, static_cast<uint64_t>(keys * hot_keys)));
+}
+
+// See Distribution.h
+uint64_t HotspotKeys::Next(Random &random) const {
+    if (std::uniform_real_distribution<double>(0, 1)(random) < _share) {
+        return std::uniform_int_distribution<uint64_t>(0, _hot - 1)(random);
+    }
+    return std::uniform_int_distribution<uint64_t>(_hot, _keys - 1)(random);
+}
+
+// See Distribution.h
+ValueSize::ValueSize(Type type, std::size_t min, std::size_t max) : _type(type), _min(min), _max(max) {
+    if (min > max) {
+        throw std::runtime_error("Smallest value size is above the largest one");
+    }
+    if (min == max) {
+        _type = Type::kFixed;
+    }
+}
+
+// See Distribution.h
+ValueSize ValueSize::Parse(const std::string &sizes, const std::string &type) {
+    std::size_t dash = sizes.find('-');
+    if (dash == std::string::npos) {
+        std::size_t size = parse_size(sizes);
+        return ValueSize(Type::kFixed, size, size);
+    }
+
+    std::size_t min = parse_size(sizes.substr(0, dash));
+    std::size_t max = parse_size(sizes.substr(dash + 1));
+    if (type == "uniform") {
+        return ValueSize(Type::kUniform, min, max);
+    } else if (type == "normal") {
+        return ValueSize(Type::kNormal, min, max);
+    } else if (type == "exponential") {
+        return ValueSize(Type::kExponential, min, max);
+    }
+    throw std::runtime_error("Unknown value size distribution: " + type);
+}
+
+// See Distribution.h
+std::size_t ValueSize::Next(Random &random) const {
+    double range = static_cast<double>(_max - _min);
+    double size;
+    switch (_type) {
+    case Type::kFixed:
+        return _min;
+    case Type::kUniform:
+        return std::uniform_int_distribution<std::size_t>(_min, _max)(random);
+    case Type::kNormal:
+        size = std::normal_distribution<double>(_min + range / 2, range / 6)(random);
+        break;
+    case Type::kExponential:
+        size = _min + std::exponential_distribution<double>(10.0 / range)(random);
+        break;
+    }
+    size = std::round(size);
+    if (size < _min) {
+        return _min;
+    } else if (size > _max) {
+        return _max;
+    }
+    return static_cast<std::size_t>(size);
+}
+
+} // namespace Bench
+} // namespace Afina
@@ -0,0 +1,108 @@
+#ifndef AFINA_BENCH_DISTRIBUTION_H
+#define AFINA_BENCH_DISTRIBUTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace Afina {
+namespace Bench {
+
+using Random = std::mt19937_64;
+
+/**
+ * # Key popularity
+ * Chooses index of the next key among [0, keys). Distribution itself is immutable once built, so every
+ * thread shares it and passes its own random generator.
+ */
+class KeyDistribution {
+public:
+    explicit KeyDistribution(uint64_t keys) : _keys(keys) {}
+    virtual ~KeyDistribution() {}
+
+    virtual uint64_t Next(Random &random) const = 0;
+
+    uint64_t keys() const { return _keys; }
+
+protected:
+    const uint64_t _keys;
+};
+
+/**
+ * Every key is equally likely
+ */
+class UniformKeys : public KeyDistribution {
+public:
+    explicit UniformKeys(uint64_t keys) : KeyDistribution(keys) {}
+
+    uint64_t Next(Random &random) const override;
+};
+
+/**
+ * Key of rank i is chosen with probability proportional to 1/i^theta, key 0 is the most popular. Generator of
+ * Gray et al. "Quickly generating billion-record synthetic databases" as used by YCSB: zeta(n) is summed once in
+ * constructor, after that every key costs a single uniform draw and pow. Theta must be in (0, 1).
+ */
+class ZipfianKeys : public KeyDistribution {
+public:
+    ZipfianKeys(uint64_t keys, double theta);
+
+    uint64_t Next(Random &random) const override;
+
+private:
+    double _theta;
+    double _alpha;
+    double _zetan;
+    double _eta;
+};
+
+/**
+ * Hot fraction of keys, the first ones, gets the given share of requests, both parts are uniform inside
+ */
+class HotspotKeys : public KeyDistribution {
+public:
+    HotspotKeys(uint64_t keys, double hot_keys, double hot_share);
+
+    uint64_t Next(Random &random) const override;
+
+private:
+    uint64_t _hot;
+    double _share;
+};
+
+/**
+ * # Value sizes
+ * Size of the next stored value within [min, max]:
+ * - fixed: always min;
+ * - uniform: any size is equally likely;
+ * - normal: centered in the middle of the range with a sixth of it as standard deviation;
+ * - exponential: small values are frequent, mean is at a tenth of the range above min.
+ * Sizes outside of the range are clamped.
+ */
+class ValueSize {
+public:
+    enum class Type { kFixed, kUniform, kNormal, kExponential };
+
+    ValueSize(Type type, std::size_t min, std::size_t max);
+
+    /**
+     * Parses "<N>" as fixed size or "<MIN>-<MAX>" as range of the given distribution name
+     */
+    static ValueSize Parse(const std::string &sizes, const std::string &type);
+
+    std::size_t Next(Random &random) const;
+
+    std::size_t min() const { return _min; }
+    std::size_t max() const { return _max; }
+
+private:
+    Type _type;
+    std::size_t _min;
+    std::size_t _max;
+};
+
+} // namespace Bench
+} // namespace Afina
+
+#endif // AFINA_BENCH_DISTRIBUTION_H
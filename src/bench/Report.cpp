@@ -0,0 +1,80 @@
+#include "Report.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace Afina {
+namespace Bench {
+
+namespace {
+
+void write_line(std::ostream &out, const char *format, double a, double b, unsigned long long c, double d = 0) {
+    char line[128];
+    std::snprintf(line, sizeof(line), format, a, b, c, d);
+    out << line;
+}
+
+// Largest value counted by the bucket, HdrHistogram reports "highest equivalent value" too
+uint64_t highest_of(std::size_t bucket) {
+    return Metrics::Histogram::LowestOf(bucket) + Metrics::Histogram::WidthOf(bucket) - 1;
+}
+
+} // namespace
+
+// See Report.h
+void WritePercentiles(std::ostream &out, const Metrics::Histogram &histogram, double scale, int ticks_per_half) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount",
+                  "1/(1-Percentile)");
+    out << line;
+
+    uint64_t total = histogram.Count();
+    const uint64_t max = histogram.Max();
+
+    // Mean and deviation are taken over bucket middles, same precision as the percentiles
+    double sum = 0, squares = 0;
+    for (std::size_t i = 0; i < Metrics::Histogram::kBuckets; i++) {
+        uint64_t count = histogram.CountAt(i);
+        double middle = Metrics::Histogram::LowestOf(i) + (Metrics::Histogram::WidthOf(i) - 1) / 2.0;
+        sum += count * middle;
+        squares += count * middle * middle;
+    }
+    double mean = total > 0 ? sum / total : 0;
+    double deviation = total > 0 ? std::sqrt(std::max(0.0, squares / total - mean * mean)) : 0;
+
+    std::size_t bucket = 0;
+    uint64_t seen = 0;
+    double level = 0;
+    while (seen < total) {
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(level / 100.0 * total)));
+        while (seen < rank) {
+            seen += histogram.CountAt(bucket++);
+        }
+        double value = std::min(highest_of(bucket - 1), max) / scale;
+
+        if (seen == total) {
+            write_line(out, "%12.3f %2.12f %10llu\n", value, 1.0, seen);
+            break;
+        }
+        write_line(out, "%12.3f %2.12f %10llu %14.2f\n", value, level / 100.0, seen, 100.0 / (100.0 - level));
+
+        // Step halves every time the distance to 100% halves
+        double halvings = std::floor(std::log2(100.0 / (100.0 - level))) + 1;
+        level += 100.0 / (ticks_per_half * std::pow(2.0, halvings));
+    }
+
+    std::snprintf(line, sizeof(line), "#[Mean    = %12.3f, StdDeviation   = %12.3f]\n", mean / scale,
+                  deviation / scale);
+    out << line;
+    std::snprintf(line, sizeof(line), "#[Max     = %12.3f, Total count    = %12llu]\n", max / scale,
+                  static_cast<unsigned long long>(total));
+    out << line;
+    std::snprintf(line, sizeof(line), "#[Buckets = %12llu, SubBuckets     = %12llu]\n",
+                  static_cast<unsigned long long>(Metrics::Histogram::kBuckets / Metrics::Histogram::kSubBuckets),
+                  static_cast<unsigned long long>(Metrics::Histogram::kSubBuckets));
+    out << line;
+}
+
+} // namespace Bench
+} // namespace Afina
@@ -0,0 +1,21 @@
+#ifndef AFINA_BENCH_REPORT_H
+#define AFINA_BENCH_REPORT_H
+
+#include <ostream>
+
+#include <afina/metrics/Histogram.h>
+
+namespace Afina {
+namespace Bench {
+
+/**
+ * Writes histogram as HdrHistogram percentile distribution, the text layout of outputPercentileDistribution
+ * and .hgrm files that HdrHistogram plotters read. Values are divided by scale, so microseconds recorded with
+ * scale 1000 come out as milliseconds. Every halving of distance to 100% gets ticks_per_half lines.
+ */
+void WritePercentiles(std::ostream &out, const Metrics::Histogram &histogram, double scale, int ticks_per_half = 5);
+
+} // namespace Bench
+} // namespace Afina
+
+#endif // AFINA_BENCH_REPORT_H
@@ -0,0 +1,120 @@
+#include "Worker.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <time.h>
+
+namespace Afina {
+namespace Bench {
+
+namespace {
+
+// Closed loop checks whether it is time to stop at least that often
+constexpr int kStopCheckMs = 100;
+
+} // namespace
+
+// See Worker.h
+Worker::Worker(const Workload &workload, uint64_t seed)
+    : _workload(workload), _random(seed), _client(workload.servers, workload.client),
+      _value(workload.values.max(), 'x') {}
+
+// See Worker.h
+uint64_t Worker::Prefill(uint64_t first, uint64_t last) {
+    const std::size_t depth = _client.Servers() * _workload.client.connections * _workload.client.pipeline;
+    uint64_t not_stored = 0;
+    for (uint64_t i = first; i < last; i++) {
+        while (_client.InFlight() >= depth) {
+            _client.Poll(-1);
+        }
+        _client.Set(Key(i), _value.substr(0, _workload.values.Next(_random)),
+                    [&not_stored](Client::Response &response) { not_stored += response.ok ? 0 : 1; });
+    }
+    _client.Wait();
+    return not_stored;
+}
+
+// See Worker.h
+void Worker::Run(const std::atomic<bool> &running) {
+    if (_workload.rate > 0) {
+        RunOpen(running);
+    } else {
+        RunClosed(running);
+    }
+    _client.Wait();
+}
+
+// See Worker.h
+void Worker::RunClosed(const std::atomic<bool> &running) {
+    const std::size_t depth = _client.Servers() * _workload.client.connections * _workload.client.pipeline;
+    while (running.load(std::memory_order_relaxed)) {
+        while (_client.InFlight() < depth) {
+            Issue(std::chrono::steady_clock::now());
+        }
+        _client.Poll(kStopCheckMs);
+    }
+}
+
+// See Worker.h
+void Worker::RunOpen(const std::atomic<bool> &running) {
+    const std::chrono::nanoseconds interval(static_cast<int64_t>(1e9 / _workload.rate));
+    auto due = std::chrono::steady_clock::now();
+
+    struct pollfd events;
+    events.fd = _client.fd();
+    events.events = POLLIN;
+
+    while (running.load(std::memory_order_relaxed)) {
+        auto now = std::chrono::steady_clock::now();
+        while (due <= now) {
+            Issue(due);
+            due += interval;
+        }
+        _client.Poll(0);
+
+        // Poll takes milliseconds, schedule needs finer sleeps than that
+        now = std::chrono::steady_clock::now();
+        if (due > now) {
+            auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(due - now).count();
+            struct timespec timeout;
+            timeout.tv_sec = wait / 1000000000;
+            timeout.tv_nsec = wait % 1000000000;
+            if (ppoll(&events, 1, &timeout, nullptr) == -1 && errno != EINTR) {
+                throw std::runtime_error("Failed to wait for responses: " + std::string(strerror(errno)));
+            }
+        }
+    }
+}
+
+// See Worker.h
+void Worker::Issue(std::chrono::steady_clock::time_point due) {
+    std::string key = Key(_workload.keys->Next(_random));
+    auto done = [this, due](Client::Response &response) {
+        auto latency = std::chrono::steady_clock::now() - due;
+        _latency.Record(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+        if (!response.ok) {
+            failed++;
+        } else if (!response.values.empty()) {
+            hits++;
+        } else if (response.status == "END") {
+            misses++;
+        }
+    };
+
+    if (std::uniform_real_distribution<double>(0, 1)(_random) < _workload.set_share) {
+        sets++;
+        _client.Set(key, _value.substr(0, _workload.values.Next(_random)), done);
+    } else {
+        gets++;
+        _client.Get({key}, done);
+    }
+}
+
+// See Worker.h
+std::string Worker::Key(uint64_t index) const { return _workload.key_prefix + std::to_string(index); }
+
+} // namespace Bench
+} // namespace Afina
@@ -0,0 +1,93 @@
+#ifndef AFINA_BENCH_WORKER_H
+#define AFINA_BENCH_WORKER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/client/AsyncClient.h>
+#include <afina/metrics/Histogram.h>
+
+#include "Distribution.h"
+
+namespace Afina {
+namespace Bench {
+
+/**
+ * What every load thread does
+ */
+struct Workload {
+    std::vector<std::string> servers;
+    Client::AsyncClient::Options client;
+
+    std::shared_ptr<const KeyDistribution> keys;
+    std::string key_prefix = "bench:";
+    ValueSize values = ValueSize(ValueSize::Type::kFixed, 32, 32);
+
+    // Share of requests that are sets, the rest are gets
+    double set_share = 0.1;
+
+    // Requests per second issued by a single thread, 0 keeps pipelines full instead
+    double rate = 0;
+};
+
+/**
+ * # Load thread
+ * Drives its own AsyncClient, so threads share nothing but the workload description.
+ *
+ * Closed loop keeps every connection pipeline full, the next request goes as soon as some response arrives.
+ * Such a generator slows down together with server and never asks for anything while server stalls, so
+ * latency is measured only for requests that were lucky to be sent ("coordinated omission").
+ *
+ * Open loop sends requests on a fixed schedule no matter how server keeps up, latency is counted from the
+ * moment request was due, not from the moment it got written. Requests server isn't fast enough for wait in
+ * client and their wait is a part of latency, like it is for real users.
+ */
+class Worker {
+public:
+    Worker(const Workload &workload, uint64_t seed);
+
+    /**
+     * Stores keys [first, last) once, so that gets of the run find something. Returns number of keys not stored
+     */
+    uint64_t Prefill(uint64_t first, uint64_t last);
+
+    /**
+     * Issues requests until running gets false, then waits for the ones in flight
+     */
+    void Run(const std::atomic<bool> &running);
+
+    // Latency in microseconds of requests issued by Run
+    const Metrics::Histogram &latency() const { return _latency; }
+
+    uint64_t sets = 0;
+    uint64_t gets = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t failed = 0;
+
+private:
+    void RunClosed(const std::atomic<bool> &running);
+    void RunOpen(const std::atomic<bool> &running);
+
+    /**
+     * Sends random request, latency is counted from due time
+     */
+    void Issue(std::chrono::steady_clock::time_point due);
+
+    std::string Key(uint64_t index) const;
+
+    const Workload &_workload;
+    Random _random;
+    Client::AsyncClient _client;
+    Metrics::Histogram _latency;
+    std::string _value;
+};
+
+} // namespace Bench
+} // namespace Afina
+
+#endif // AFINA_BENCH_WORKER_H
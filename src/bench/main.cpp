@@ -0,0 +1,220 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include <afina/metrics/Histogram.h>
+
+#include "Distribution.h"
+#include "Report.h"
+#include "Worker.h"
+
+using namespace Afina;
+
+namespace {
+
+/**
+ * Parses "<a>:<b>" pair of numbers
+ */
+std::pair<double, double> parse_pair(const std::string &text, const std::string &what) {
+    std::size_t colon = text.find(':');
+    try {
+        if (colon != std::string::npos) {
+            return std::make_pair(std::stod(text.substr(0, colon)), std::stod(text.substr(colon + 1)));
+        }
+    } catch (std::exception &) {
+    }
+    throw std::runtime_error("Bad " + what + ": " + text + ", expected <a>:<b>");
+}
+
+int positive(const cxxopts::Options &options, const std::string &name, int value) {
+    if (options.count(name) > 0) {
+        value = options[name].as<int>();
+    }
+    if (value <= 0) {
+        throw std::runtime_error("Option " + name + " must be positive");
+    }
+    return value;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("afina-bench", "Load generator for memcached text protocol servers");
+    try {
+        options.add_options()("s,server", "Server to load, could be given several times (default 127.0.0.1:8080)",
+                              cxxopts::value<std::vector<std::string>>());
+        options.add_options()("t,threads", "Number of load threads (default 1)", cxxopts::value<int>());
+        options.add_options()("c,connections", "Connections of each thread to each server (default 1)",
+                              cxxopts::value<int>());
+        options.add_options()("p,pipeline", "Requests in flight on a single connection (default 16)",
+                              cxxopts::value<int>());
+        options.add_options()("d,duration", "Seconds to run (default 10)", cxxopts::value<int>());
+        options.add_options()("r,rate", "Requests per second of all threads on a fixed schedule, 0 keeps pipelines "
+                                        "full (default 0)",
+                              cxxopts::value<int>());
+        options.add_options()("ratio", "Sets to gets ratio (default 1:10)", cxxopts::value<std::string>());
+        options.add_options()("keys", "Number of distinct keys (default 10000)", cxxopts::value<int>());
+        options.add_options()("key-prefix", "Prefix of every key (default bench:)", cxxopts::value<std::string>());
+        options.add_options()("key-distribution", "uniform, zipf or hotspot (default uniform)",
+                              cxxopts::value<std::string>());
+        options.add_options()("zipf-theta", "Skew of zipf distribution in (0, 1) (default 0.99)",
+                              cxxopts::value<double>());
+        options.add_options()("hotspot", "Hot keys fraction and their requests share (default 0.2:0.8)",
+                              cxxopts::value<std::string>());
+        options.add_options()("value-size", "Value size <N> or range <MIN>-<MAX> (default 32)",
+                              cxxopts::value<std::string>());
+        options.add_options()("value-distribution", "Sizes in range: uniform, normal or exponential (default uniform)",
+                              cxxopts::value<std::string>());
+        options.add_options()("prefill", "Store every key once before the run");
+        options.add_options()("hdr-out", "File to write HdrHistogram percentile distribution to",
+                              cxxopts::value<std::string>());
+        options.add_options()("seed", "Seed of random generators", cxxopts::value<int>());
+        options.add_options()("h,help", "Print usage info");
+        options.parse(argc, argv);
+
+        if (options.count("help") > 0) {
+            std::cerr << options.help() << std::endl;
+            return 0;
+        }
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    try {
+        Bench::Workload workload;
+        workload.servers = {"127.0.0.1:8080"};
+        if (options.count("server") > 0) {
+            workload.servers = options["server"].as<std::vector<std::string>>();
+        }
+        workload.client.connections = positive(options, "connections", 1);
+        workload.client.pipeline = positive(options, "pipeline", 16);
+        if (options.count("key-prefix") > 0) {
+            workload.key_prefix = options["key-prefix"].as<std::string>();
+        }
+
+        const int threads = positive(options, "threads", 1);
+        const int duration = positive(options, "duration", 10);
+        const uint64_t keys = positive(options, "keys", 10000);
+
+        int rate = 0;
+        if (options.count("rate") > 0 && (rate = options["rate"].as<int>()) < 0) {
+            throw std::runtime_error("Rate can't be negative");
+        }
+        workload.rate = static_cast<double>(rate) / threads;
+
+        auto ratio = parse_pair(options.count("ratio") > 0 ? options["ratio"].as<std::string>() : "1:10", "ratio");
+        if (ratio.first < 0 || ratio.second < 0 || ratio.first + ratio.second <= 0) {
+            throw std::runtime_error("Ratio needs non negative parts and at least one request");
+        }
+        workload.set_share = ratio.first / (ratio.first + ratio.second);
+
+        std::string distribution = "uniform";
+        if (options.count("key-distribution") > 0) {
+            distribution = options["key-distribution"].as<std::string>();
+        }
+        if (distribution == "uniform") {
+            workload.keys = std::make_shared<Bench::UniformKeys>(keys);
+        } else if (distribution == "zipf") {
+            double theta = options.count("zipf-theta") > 0 ? options["zipf-theta"].as<double>() : 0.99;
+            workload.keys = std::make_shared<Bench::ZipfianKeys>(keys, theta);
+        } else if (distribution == "hotspot") {
+            auto hot = parse_pair(options.count("hotspot") > 0 ? options["hotspot"].as<std::string>() : "0.2:0.8",
+                                  "hotspot");
+            workload.keys = std::make_shared<Bench::HotspotKeys>(keys, hot.first, hot.second);
+        } else {
+            throw std::runtime_error("Unknown key distribution");
+        }
+
+        workload.values = Bench::ValueSize::Parse(
+            options.count("value-size") > 0 ? options["value-size"].as<std::string>() : "32",
+            options.count("value-distribution") > 0 ? options["value-distribution"].as<std::string>() : "uniform");
+
+        uint64_t seed = options.count("seed") > 0 ? options["seed"].as<int>() : std::random_device()();
+        std::vector<std::unique_ptr<Bench::Worker>> workers;
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back(new Bench::Worker(workload, seed + i));
+        }
+
+        // Step 1: every thread stores its own part of keys
+        if (options.count("prefill") > 0) {
+            std::atomic<uint64_t> not_stored(0);
+            std::vector<std::thread> fill;
+            for (int i = 0; i < threads; i++) {
+                fill.emplace_back([&, i]() {
+                    not_stored += workers[i]->Prefill(keys * i / threads, keys * (i + 1) / threads);
+                });
+            }
+            for (auto &t : fill) {
+                t.join();
+            }
+            std::cout << "Prefilled " << keys - not_stored << " of " << keys << " keys" << std::endl;
+        }
+
+        // Step 2: measured run
+        std::cout << "Running " << duration << "s: " << threads << " threads, " << workload.client.connections
+                  << " connections per server, pipeline " << workload.client.pipeline << ", "
+                  << (rate > 0 ? std::to_string(rate) + " requests/s" : std::string("closed loop")) << std::endl;
+
+        std::atomic<bool> running(true);
+        std::vector<std::thread> load;
+        auto start = std::chrono::steady_clock::now();
+        for (auto &worker : workers) {
+            load.emplace_back(&Bench::Worker::Run, worker.get(), std::cref(running));
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(duration));
+        running = false;
+        for (auto &t : load) {
+            t.join();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Step 3: report
+        Metrics::Histogram latency;
+        uint64_t sets = 0, gets = 0, hits = 0, misses = 0, failed = 0;
+        for (auto &worker : workers) {
+            latency.Merge(worker->latency());
+            sets += worker->sets;
+            gets += worker->gets;
+            hits += worker->hits;
+            misses += worker->misses;
+            failed += worker->failed;
+        }
+
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "Requests %llu (%.1f/s): sets %llu, gets %llu (hits %llu, misses %llu), failed %llu\n",
+                      static_cast<unsigned long long>(sets + gets), (sets + gets) / elapsed,
+                      static_cast<unsigned long long>(sets), static_cast<unsigned long long>(gets),
+                      static_cast<unsigned long long>(hits), static_cast<unsigned long long>(misses),
+                      static_cast<unsigned long long>(failed));
+        std::cout << line;
+        std::snprintf(line, sizeof(line),
+                      "Latency ms: p50 %.3f, p90 %.3f, p99 %.3f, p99.9 %.3f, p99.99 %.3f, max %.3f\n",
+                      latency.Percentile(50) / 1000.0, latency.Percentile(90) / 1000.0,
+                      latency.Percentile(99) / 1000.0, latency.Percentile(99.9) / 1000.0,
+                      latency.Percentile(99.99) / 1000.0, latency.Max() / 1000.0);
+        std::cout << line;
+
+        if (options.count("hdr-out") > 0) {
+            std::ofstream out(options["hdr-out"].as<std::string>());
+            if (!out) {
+                throw std::runtime_error("Failed to open " + options["hdr-out"].as<std::string>());
+            }
+            Bench::WritePercentiles(out, latency, 1000.0);
+        }
+    } catch (std::exception &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
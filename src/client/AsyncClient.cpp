@@ -0,0 +1,318 @@
+#include <afina/client/AsyncClient.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <network/common/Listener.h>
+
+#include "Connection.h"
+#include "HashRing.h"
+
+namespace Afina {
+namespace Client {
+
+namespace {
+
+// Events handled by a single epoll_wait
+constexpr int kMaxEvents = 64;
+
+// Longest key memcached accepts
+constexpr std::size_t kMaxKey = 250;
+
+void check_key(const std::string &key) {
+    if (key.empty() || key.size() > kMaxKey) {
+        throw std::runtime_error("Key must be 1 to 250 bytes long");
+    }
+    for (char c : key) {
+        if (static_cast<unsigned char>(c) <= ' ' || c == 0x7f) {
+            throw std::runtime_error("Key must not contain spaces or control characters");
+        }
+    }
+}
+
+// Values found by parts of multi-get, callback gets them once the last part is done
+struct Gather {
+    std::size_t parts;
+    Response response;
+    Callback callback;
+};
+
+} // namespace
+
+// Connections of a single server and requests waiting for room in them
+struct Server {
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::deque<Request> backlog;
+};
+
+// See AsyncClient.h
+struct AsyncClient::State {
+    Options options;
+    int epoll = -1;
+    std::deque<Server> servers;
+    std::unique_ptr<HashRing> ring;
+
+    // Requests given by user and not completed yet
+    std::size_t in_flight = 0;
+
+    ~State() {
+        servers.clear();
+        if (epoll != -1) {
+            close(epoll);
+        }
+    }
+
+    /**
+     * Connection of the server with the least requests in flight, null if all of them are full
+     */
+    Connection *Pick(Server &s) {
+        Connection *best = s.connections.front().get();
+        for (auto &connection : s.connections) {
+            if (connection->depth() < best->depth()) {
+                best = connection.get();
+            }
+        }
+        return best->depth() < options.pipeline ? best : nullptr;
+    }
+
+    /**
+     * Passes request to a connection or leaves it in backlog if all are full. Backlog keeps requests in order
+     */
+    void Submit(std::size_t server, Request &&request) {
+        Server &s = servers[server];
+        Connection *connection = s.backlog.empty() ? Pick(s) : nullptr;
+        if (connection == nullptr) {
+            s.backlog.push_back(std::move(request));
+            return;
+        }
+        connection->Send(std::move(request));
+    }
+
+    /**
+     * Moves requests from backlogs into connections that got room, returns number of requests failed
+     */
+    std::size_t Dispatch() {
+        std::size_t failed = 0;
+        for (auto &s : servers) {
+            Connection *connection;
+            while (!s.backlog.empty() && (connection = Pick(s)) != nullptr) {
+                Request request = std::move(s.backlog.front());
+                s.backlog.pop_front();
+                failed += connection->Send(std::move(request)) ? 0 : 1;
+            }
+        }
+        return failed;
+    }
+
+    /**
+     * Writes output of all connections, returns number of requests failed
+     */
+    std::size_t Flush() {
+        std::size_t failed = 0;
+        for (auto &server : servers) {
+            for (auto &connection : server.connections) {
+                if (connection->has_output()) {
+                    failed += connection->Flush();
+                }
+            }
+        }
+        return failed;
+    }
+
+    /**
+     * Wraps user callback to count requests in flight
+     */
+    Callback Track(Callback callback) {
+        in_flight++;
+        return [this, callback](Response &response) {
+            in_flight--;
+            callback(response);
+        };
+    }
+
+    void Store(const char *command, const std::string &key, const std::string &value, uint32_t flags,
+               Callback callback) {
+        check_key(key);
+        Request request;
+        request.text.reserve(key.size() + value.size() + 64);
+        request.text.append(command);
+        request.text.append(" ");
+        request.text.append(key);
+        request.text.append(" " + std::to_string(flags) + " 0 " + std::to_string(value.size()) + "\r\n");
+        request.text.append(value);
+        request.text.append("\r\n");
+        request.kind = ResponseParser::Kind::kStorage;
+        request.callback = Track(std::move(callback));
+        Submit(ring->Server(key), std::move(request));
+    }
+};
+
+// See AsyncClient.h
+AsyncClient::AsyncClient(const std::vector<std::string> &servers) : AsyncClient(servers, Options()) {}
+
+// See AsyncClient.h
+AsyncClient::AsyncClient(const std::vector<std::string> &servers, Options options) : _state(new State()) {
+    if (servers.empty()) {
+        throw std::runtime_error("Client needs at least one server");
+    }
+    _state->options = options;
+    _state->options.connections = std::max<std::size_t>(options.connections, 1);
+    _state->options.pipeline = std::max<std::size_t>(options.pipeline, 1);
+
+    _state->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (_state->epoll == -1) {
+        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    }
+
+    // Ring is built from canonical addresses, so that the same server spelled differently lands the same
+    std::vector<std::string> names;
+    _state->servers.resize(servers.size());
+    for (std::size_t i = 0; i < servers.size(); i++) {
+        Network::Listener::Address address = Network::Listener::Parse(servers[i]);
+        names.push_back(address.ToString());
+        for (std::size_t c = 0; c < _state->options.connections; c++) {
+            _state->servers[i].connections.emplace_back(
+                new Connection(_state->epoll, address, _state->options.reconnect_delay));
+        }
+    }
+    _state->ring.reset(new HashRing(names));
+}
+
+// See AsyncClient.h
+AsyncClient::~AsyncClient() {}
+
+// See AsyncClient.h
+void AsyncClient::Get(const std::vector<std::string> &keys, Callback callback) {
+    if (keys.empty()) {
+        throw std::runtime_error("Get needs at least one key");
+    }
+
+    // Keys of each server go in a single command
+    std::vector<std::string> commands(_state->servers.size());
+    for (auto &key : keys) {
+        check_key(key);
+        std::string &command = commands[_state->ring->Server(key)];
+        command.append(command.empty() ? "get " : " ");
+        command.append(key);
+    }
+
+    std::shared_ptr<Gather> gather(new Gather());
+    gather->parts = commands.size() - std::count(commands.begin(), commands.end(), std::string());
+    gather->callback = _state->Track(std::move(callback));
+
+    for (std::size_t i = 0; i < commands.size(); i++) {
+        if (commands[i].empty()) {
+            continue;
+        }
+
+        Request request;
+        request.text = std::move(commands[i]);
+        request.text.append("\r\n");
+        request.kind = ResponseParser::Kind::kRetrieval;
+        request.callback = [gather](Response &response) {
+            Response &merged = gather->response;
+            if (merged.values.empty()) {
+                merged.values = std::move(response.values);
+            } else {
+                std::move(response.values.begin(), response.values.end(), std::back_inserter(merged.values));
+            }
+            // Failed part only loses its keys, the error stays in status for callers that care
+            merged.ok = merged.ok || response.ok;
+            if (!response.ok || merged.status.empty()) {
+                merged.status = std::move(response.status);
+            }
+            if (--gather->parts == 0) {
+                gather->callback(merged);
+            }
+        };
+        _state->Submit(i, std::move(request));
+    }
+}
+
+// See AsyncClient.h
+void AsyncClient::Set(const std::string &key, const std::string &value, Callback callback, uint32_t flags) {
+    _state->Store("set", key, value, flags, std::move(callback));
+}
+
+// See AsyncClient.h
+void AsyncClient::Add(const std::string &key, const std::string &value, Callback callback, uint32_t flags) {
+    _state->Store("add", key, value, flags, std::move(callback));
+}
+
+// See AsyncClient.h
+void AsyncClient::Append(const std::string &key, const std::string &value, Callback callback, uint32_t flags) {
+    _state->Store("append", key, value, flags, std::move(callback));
+}
+
+// See AsyncClient.h
+void AsyncClient::Stats(std::size_t server, Callback callback) {
+    if (server >= _state->servers.size()) {
+        throw std::runtime_error("No server " + std::to_string(server));
+    }
+
+    Request request;
+    request.text = "stats\r\n";
+    request.kind = ResponseParser::Kind::kRetrieval;
+    request.callback = _state->Track(std::move(callback));
+    _state->Submit(server, std::move(request));
+}
+
+// See AsyncClient.h
+std::size_t AsyncClient::Poll(int timeout_ms) {
+    std::size_t completed = _state->Dispatch();
+    completed += _state->Flush();
+
+    // Nothing would wake wait up
+    if (_state->in_flight == 0) {
+        return completed;
+    }
+
+    struct epoll_event events[kMaxEvents];
+    int n = epoll_wait(_state->epoll, events, kMaxEvents, timeout_ms);
+    if (n == -1) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        throw std::runtime_error("Failed to wait for events: " + std::string(strerror(errno)));
+    }
+
+    for (int i = 0; i < n; i++) {
+        Connection *connection = static_cast<Connection *>(events[i].data.ptr);
+        completed += connection->OnEvent(events[i].events);
+    }
+
+    // Responses freed room in pipelines and callbacks may have queued more
+    completed += _state->Dispatch();
+    completed += _state->Flush();
+    return completed;
+}
+
+// See AsyncClient.h
+void AsyncClient::Wait() {
+    while (_state->in_flight > 0) {
+        Poll(-1);
+    }
+}
+
+// See AsyncClient.h
+std::size_t AsyncClient::InFlight() const { return _state->in_flight; }
+
+// See AsyncClient.h
+int AsyncClient::fd() const { return _state->epoll; }
+
+// See AsyncClient.h
+std::size_t AsyncClient::Servers() const { return _state->servers.size(); }
+
+// See AsyncClient.h
+std::size_t AsyncClient::ServerOf(const std::string &key) const { return _state->ring->Server(key); }
+
+} // namespace Client
+} // namespace Afina
@@ -0,0 +1,246 @@
+#include "Connection.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Client {
+
+namespace {
+
+// Bytes read by a single recv
+constexpr std::size_t kReadChunk = 64 * 1024;
+
+// Written part of output is dropped once it grows that large, so output doesn't move on every write
+constexpr std::size_t kCompactThreshold = 64 * 1024;
+
+} // namespace
+
+// See Connection.h
+Connection::Connection(int epoll, const Network::Listener::Address &address,
+                       std::chrono::milliseconds reconnect_delay)
+    : _epoll(epoll), _address(address), _reconnect_delay(reconnect_delay), _socket(-1), _connecting(false),
+      _events(0), _output_offset(0) {}
+
+// See Connection.h
+Connection::~Connection() {
+    if (_socket != -1) {
+        close(_socket);
+    }
+}
+
+// See Connection.h
+bool Connection::Send(Request &&request) {
+    if (_socket == -1) {
+        try {
+            if (std::chrono::steady_clock::now() < _retry_after) {
+                throw std::runtime_error("server failed recently");
+            }
+            Connect();
+        } catch (std::runtime_error &ex) {
+            Response response;
+            response.status = std::string("CONNECTION_ERROR ") + ex.what();
+            request.callback(response);
+            return false;
+        }
+    }
+
+    _output.append(request.text);
+    _inflight.push_back(std::move(request));
+    _inflight.back().text.clear();
+    return true;
+}
+
+// See Connection.h
+void Connection::Connect() {
+    const int family = _address.addr.ss_family;
+    _socket = socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_socket == -1) {
+        throw std::runtime_error("socket() failed: " + std::string(strerror(errno)));
+    }
+
+    // Pipelined requests are flushed explicitly, Nagle would only hold the last one back
+    int opts = 1;
+    if (family != AF_UNIX) {
+        setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &opts, sizeof(opts));
+    }
+
+    _connecting = false;
+    if (connect(_socket, reinterpret_cast<const struct sockaddr *>(&_address.addr), _address.len) == -1) {
+        if (errno != EINPROGRESS) {
+            int err = errno;
+            close(_socket);
+            _socket = -1;
+            _retry_after = std::chrono::steady_clock::now() + _reconnect_delay;
+            throw std::runtime_error("connect() to " + _address.ToString() + " failed: " + strerror(err));
+        }
+        _connecting = true;
+    }
+
+    _events = EPOLLIN | EPOLLOUT;
+    struct epoll_event event;
+    event.events = _events;
+    event.data.ptr = this;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, _socket, &event) == -1) {
+        close(_socket);
+        _socket = -1;
+        throw std::runtime_error("epoll_ctl() failed: " + std::string(strerror(errno)));
+    }
+}
+
+// See Connection.h
+std::size_t Connection::Flush() {
+    if (_socket == -1 || _connecting) {
+        return 0;
+    }
+
+    while (has_output()) {
+        ssize_t n = send(_socket, _output.data() + _output_offset, _output.size() - _output_offset, MSG_NOSIGNAL);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return Fail("send() failed: " + std::string(strerror(errno)));
+        }
+        _output_offset += n;
+    }
+
+    if (!has_output()) {
+        _output.clear();
+        _output_offset = 0;
+    } else if (_output_offset > kCompactThreshold) {
+        _output.erase(0, _output_offset);
+        _output_offset = 0;
+    }
+    UpdateEvents();
+    return 0;
+}
+
+// See Connection.h
+std::size_t Connection::OnEvent(uint32_t events) {
+    if (_connecting) {
+        int error = 0;
+        socklen_t len = sizeof(error);
+        if (getsockopt(_socket, SOL_SOCKET, SO_ERROR, &error, &len) == -1 || error != 0) {
+            return Fail("connect() to " + _address.ToString() + " failed: " + strerror(error ? error : errno));
+        }
+        if (!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            return 0;
+        }
+        _connecting = false;
+    }
+
+    std::size_t completed = 0;
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        completed += Read();
+    }
+    if (_socket != -1 && (events & EPOLLOUT)) {
+        completed += Flush();
+    }
+    return completed;
+}
+
+// See Connection.h
+std::size_t Connection::Read() {
+    char buffer[kReadChunk];
+    std::size_t completed = 0;
+    while (_socket != -1) {
+        ssize_t n = recv(_socket, buffer, sizeof(buffer), 0);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return completed + Fail("recv() failed: " + std::string(strerror(errno)));
+        } else if (n == 0) {
+            return completed + Fail("connection closed by server");
+        }
+
+        std::size_t pos = 0;
+        while (pos < std::size_t(n)) {
+            if (_inflight.empty()) {
+                return completed + Fail("unexpected data from server");
+            }
+
+            bool done = false;
+            try {
+                pos += _parser.Parse(buffer + pos, n - pos, _inflight.front().kind, _response, done);
+            } catch (std::runtime_error &ex) {
+                return completed + Fail(ex.what());
+            }
+            if (!done) {
+                continue;
+            }
+
+            // Callback may queue more requests, so request leaves the queue first
+            Request request = std::move(_inflight.front());
+            _inflight.pop_front();
+            Response response = std::move(_response);
+            _response = Response();
+            _parser.Reset();
+            request.callback(response);
+            completed++;
+        }
+
+        if (std::size_t(n) < sizeof(buffer)) {
+            break;
+        }
+    }
+    return completed;
+}
+
+// See Connection.h
+std::size_t Connection::Fail(const std::string &reason) {
+    if (_socket != -1) {
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, _socket, nullptr);
+        close(_socket);
+        _socket = -1;
+    }
+    _connecting = false;
+    _events = 0;
+    _retry_after = std::chrono::steady_clock::now() + _reconnect_delay;
+
+    _output.clear();
+    _output_offset = 0;
+    _parser.Reset();
+    _response = Response();
+
+    // Callbacks may send new requests, they must not get into the list being failed
+    std::deque<Request> failed;
+    failed.swap(_inflight);
+    for (auto &request : failed) {
+        Response response;
+        response.status = "CONNECTION_ERROR " + reason;
+        request.callback(response);
+    }
+    return failed.size();
+}
+
+// See Connection.h
+void Connection::UpdateEvents() {
+    uint32_t events = EPOLLIN | (has_output() || _connecting ? uint32_t(EPOLLOUT) : 0);
+    if (_socket == -1 || events == _events) {
+        return;
+    }
+
+    struct epoll_event event;
+    event.events = events;
+    event.data.ptr = this;
+    if (epoll_ctl(_epoll, EPOLL_CTL_MOD, _socket, &event) == 0) {
+        _events = events;
+    }
+}
+
+} // namespace Client
+} // namespace Afina
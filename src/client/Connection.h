@@ -0,0 +1,107 @@
+#ifndef AFINA_CLIENT_CONNECTION_H
+#define AFINA_CLIENT_CONNECTION_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include <afina/client/AsyncClient.h>
+#include <network/common/Listener.h>
+
+#include "ResponseParser.h"
+
+namespace Afina {
+namespace Client {
+
+/**
+ * Command text with the way to parse its response and whom to tell about it
+ */
+struct Request {
+    std::string text;
+    ResponseParser::Kind kind;
+    Callback callback;
+};
+
+/**
+ * # Pipelined connection to a single server
+ * Requests are appended to output right away and wait for responses in order they were sent. Socket is
+ * nonblocking and registered in client's epoll with pointer to the connection, connect happens lazily on
+ * the first request.
+ */
+class Connection {
+public:
+    Connection(int epoll, const Network::Listener::Address &address, std::chrono::milliseconds reconnect_delay);
+    ~Connection();
+
+    /**
+     * Queues request, returns false if it was completed with error right away: server failed recently
+     */
+    bool Send(Request &&request);
+
+    /**
+     * Writes as much of output as socket takes, returns number of requests failed if connection breaks
+     */
+    std::size_t Flush();
+
+    /**
+     * Handles epoll events of the socket, returns number of requests completed
+     */
+    std::size_t OnEvent(uint32_t events);
+
+    std::size_t depth() const { return _inflight.size(); }
+
+    bool has_output() const { return _output_offset < _output.size(); }
+
+private:
+    Connection(const Connection &) = delete;
+    Connection &operator=(const Connection &) = delete;
+
+    /**
+     * Starts nonblocking connect, throws std::runtime_error if it fails right away
+     */
+    void Connect();
+
+    /**
+     * Reads and parses everything socket has
+     */
+    std::size_t Read();
+
+    /**
+     * Closes socket and completes all requests in flight with CONNECTION_ERROR, returns their number
+     */
+    std::size_t Fail(const std::string &reason);
+
+    /**
+     * Registers interest in writes while there is output or connect is in progress
+     */
+    void UpdateEvents();
+
+    int _epoll;
+    Network::Listener::Address _address;
+    std::chrono::milliseconds _reconnect_delay;
+
+    int _socket;
+    bool _connecting;
+    uint32_t _events;
+
+    // Requests are refused till then after failure
+    std::chrono::steady_clock::time_point _retry_after;
+
+    // Requests not written yet, written part is skipped by offset
+    std::string _output;
+    std::size_t _output_offset;
+
+    // Requests written or queued for writing, oldest first
+    std::deque<Request> _inflight;
+
+    // Response to the oldest request so far
+    ResponseParser _parser;
+    Response _response;
+};
+
+} // namespace Client
+} // namespace Afina
+
+#endif // AFINA_CLIENT_CONNECTION_H
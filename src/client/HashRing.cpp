@@ -0,0 +1,146 @@
+#include "HashRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Afina {
+namespace Client {
+
+namespace {
+
+inline uint32_t rotl(uint32_t x, int c) { return (x << c) | (x >> (32 - c)); }
+
+// RFC 1321 constants: shift amounts and integer parts of sines
+const int kShifts[64] = {7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 5, 9,  14, 20, 5, 9,
+                         14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+                         4, 11, 16, 23, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
+
+const uint32_t kSines[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+
+void md5_block(uint32_t state[4], const unsigned char *block) {
+    uint32_t m[16];
+    for (int i = 0; i < 16; i++) {
+        m[i] = uint32_t(block[4 * i]) | uint32_t(block[4 * i + 1]) << 8 | uint32_t(block[4 * i + 2]) << 16 |
+               uint32_t(block[4 * i + 3]) << 24;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    for (int i = 0; i < 64; i++) {
+        uint32_t f;
+        int g;
+        if (i < 16) {
+            f = (b & c) | (~b & d);
+            g = i;
+        } else if (i < 32) {
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) % 16;
+        } else if (i < 48) {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) % 16;
+        } else {
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+        }
+        uint32_t next = b + rotl(a + f + kSines[i] + m[g], kShifts[i]);
+        a = d;
+        d = c;
+        c = b;
+        b = next;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+// Point on the circle from 4 digest bytes, little endian as in libketama
+inline uint32_t point(const unsigned char *digest, int i) {
+    return uint32_t(digest[3 + i * 4]) << 24 | uint32_t(digest[2 + i * 4]) << 16 | uint32_t(digest[1 + i * 4]) << 8 |
+           uint32_t(digest[i * 4]);
+}
+
+} // namespace
+
+constexpr std::size_t HashRing::kPoints;
+
+// See HashRing.h
+void HashRing::Md5(const char *data, std::size_t size, unsigned char digest[16]) {
+    uint32_t state[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+
+    std::size_t done = 0;
+    for (; done + 64 <= size; done += 64) {
+        md5_block(state, bytes + done);
+    }
+
+    // Tail is padded with 0x80, zeros and bit length, which could take one more block
+    unsigned char tail[128];
+    std::size_t rest = size - done;
+    std::memcpy(tail, bytes + done, rest);
+    tail[rest] = 0x80;
+    std::size_t tail_size = rest + 1 + 8 <= 64 ? 64 : 128;
+    std::memset(tail + rest + 1, 0, tail_size - rest - 1);
+    uint64_t bits = uint64_t(size) * 8;
+    for (int i = 0; i < 8; i++) {
+        tail[tail_size - 8 + i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+    for (std::size_t i = 0; i < tail_size; i += 64) {
+        md5_block(state, tail + i);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            digest[i * 4 + j] = static_cast<unsigned char>(state[i] >> (8 * j));
+        }
+    }
+}
+
+// See HashRing.h
+HashRing::HashRing(const std::vector<std::string> &servers) : _servers(servers.size()) {
+    if (servers.empty()) {
+        throw std::runtime_error("Hash ring needs at least one server");
+    }
+
+    // Every digest gives 4 points
+    _points.reserve(servers.size() * kPoints);
+    for (std::size_t s = 0; s < servers.size(); s++) {
+        for (std::size_t i = 0; i < kPoints / 4; i++) {
+            std::string name = servers[s] + "-" + std::to_string(i);
+            unsigned char digest[16];
+            Md5(name.data(), name.size(), digest);
+            for (int j = 0; j < 4; j++) {
+                _points.emplace_back(point(digest, j), s);
+            }
+        }
+    }
+    std::sort(_points.begin(), _points.end());
+}
+
+// See HashRing.h
+std::size_t HashRing::Server(const char *key, std::size_t size) const {
+    if (_servers == 1) {
+        return 0;
+    }
+
+    unsigned char digest[16];
+    Md5(key, size, digest);
+    uint32_t hash = point(digest, 0);
+
+    auto it = std::lower_bound(_points.begin(), _points.end(), std::make_pair(hash, std::size_t(0)));
+    if (it == _points.end()) {
+        it = _points.begin();
+    }
+    return it->second;
+}
+
+} // namespace Client
+} // namespace Afina
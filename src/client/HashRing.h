@@ -0,0 +1,52 @@
+#ifndef AFINA_CLIENT_HASH_RING_H
+#define AFINA_CLIENT_HASH_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Afina {
+namespace Client {
+
+/**
+ * # Consistent hashing of keys to servers
+ * Ketama continuum, the one memcached clients agree on: every server gets 160 points on a 32 bit circle
+ * from MD5 of "<name>-<i>", key goes to the server of the first point at or after first 4 bytes of its MD5.
+ * Adding or removing a server moves only keys of its points, about 1/N of them.
+ */
+class HashRing {
+public:
+    // Points per server
+    static constexpr std::size_t kPoints = 160;
+
+    /**
+     * Builds ring for servers identified by names, index of server in the list is what Server returns
+     */
+    explicit HashRing(const std::vector<std::string> &servers);
+
+    /**
+     * Index of server owning the key
+     */
+    std::size_t Server(const char *key, std::size_t size) const;
+    std::size_t Server(const std::string &key) const { return Server(key.data(), key.size()); }
+
+    std::size_t size() const { return _servers; }
+
+    /**
+     * MD5 digest of data, ring exposes it since any ketama compatible code needs the same one
+     */
+    static void Md5(const char *data, std::size_t size, unsigned char digest[16]);
+
+private:
+    std::size_t _servers;
+
+    // Points sorted by hash with server index
+    std::vector<std::pair<uint32_t, std::size_t>> _points;
+};
+
+} // namespace Client
+} // namespace Afina
+
+#endif // AFINA_CLIENT_HASH_RING_H
@@ -0,0 +1,111 @@
+#include "ResponseParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Afina {
+namespace Client {
+
+namespace {
+
+// Longer line means peer is not a memcached server
+constexpr std::size_t kMaxLine = 4096;
+
+inline bool starts_with(const std::string &line, const char *prefix) {
+    return line.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+} // namespace
+
+// See ResponseParser.h
+void ResponseParser::Reset() {
+    _line.clear();
+    _block_left = 0;
+}
+
+// See ResponseParser.h
+std::size_t ResponseParser::Parse(const char *data, std::size_t size, Kind kind, Response &out, bool &done) {
+    done = false;
+    std::size_t pos = 0;
+    while (pos < size && !done) {
+        if (_block_left > 0) {
+            // Data block of the last value, its \r\n terminator is dropped
+            std::size_t n = std::min(_block_left, size - pos);
+            std::string &value = out.values.back().data;
+            std::size_t payload = _block_left > 2 ? std::min(n, _block_left - 2) : 0;
+            value.append(data + pos, payload);
+            pos += n;
+            _block_left -= n;
+            continue;
+        }
+
+        const char *eol = static_cast<const char *>(std::memchr(data + pos, '\n', size - pos));
+        if (eol == nullptr) {
+            _line.append(data + pos, size - pos);
+            pos = size;
+        } else {
+            _line.append(data + pos, eol - (data + pos));
+            pos = eol - data + 1;
+            if (!_line.empty() && _line.back() == '\r') {
+                _line.pop_back();
+            }
+            Line(_line, kind, out, done);
+            _line.clear();
+        }
+
+        if (_line.size() > kMaxLine) {
+            throw std::runtime_error("Response line is too long");
+        }
+    }
+    return pos;
+}
+
+// See ResponseParser.h
+void ResponseParser::Line(const std::string &line, Kind kind, Response &out, bool &done) {
+    if (line == "ERROR" || starts_with(line, "CLIENT_ERROR") || starts_with(line, "SERVER_ERROR")) {
+        out.ok = false;
+        out.status = line;
+        done = true;
+        return;
+    }
+
+    if (kind == Kind::kStorage) {
+        out.ok = line == "STORED";
+        out.status = line;
+        done = true;
+        return;
+    }
+
+    if (line == "END") {
+        out.ok = true;
+        out.status = line;
+        done = true;
+    } else if (starts_with(line, "VALUE ")) {
+        // VALUE <key> <flags> <bytes>
+        char key[251];
+        unsigned long flags, bytes;
+        if (line.size() > 300 || std::sscanf(line.c_str(), "VALUE %250s %lu %lu", key, &flags, &bytes) != 3) {
+            throw std::runtime_error("Malformed VALUE line: " + line);
+        }
+        out.values.emplace_back();
+        out.values.back().key = key;
+        out.values.back().flags = flags;
+        out.values.back().data.reserve(bytes);
+        _block_left = bytes + 2;
+    } else if (starts_with(line, "STAT ")) {
+        // STAT <name> <value>, value goes as data
+        std::size_t space = line.find(' ', 5);
+        out.values.emplace_back();
+        out.values.back().key = line.substr(5, space == std::string::npos ? std::string::npos : space - 5);
+        out.values.back().flags = 0;
+        if (space != std::string::npos) {
+            out.values.back().data = line.substr(space + 1);
+        }
+    } else {
+        throw std::runtime_error("Unexpected response line: " + line);
+    }
+}
+
+} // namespace Client
+} // namespace Afina
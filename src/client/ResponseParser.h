@@ -0,0 +1,45 @@
+#ifndef AFINA_CLIENT_RESPONSE_PARSER_H
+#define AFINA_CLIENT_RESPONSE_PARSER_H
+
+#include <cstddef>
+#include <string>
+
+#include <afina/client/AsyncClient.h>
+
+namespace Afina {
+namespace Client {
+
+/**
+ * # Memcached text response parser
+ * Incremental: takes bytes as they arrive, possibly split anywhere, and fills in response to the command
+ * at the head of the pipeline. Storage commands get a single status line, retrieval ones get VALUE/STAT
+ * items up to END. ERROR, CLIENT_ERROR and SERVER_ERROR line completes any command.
+ */
+class ResponseParser {
+public:
+    enum class Kind { kStorage, kRetrieval };
+
+    /**
+     * Parses bytes of response of the given kind, returns number of bytes consumed. Sets done once the
+     * response is complete, bytes after it belong to the next one. Throws std::runtime_error if server
+     * sends something that is not a response, connection can't be trusted after that
+     */
+    std::size_t Parse(const char *data, std::size_t size, Kind kind, Response &out, bool &done);
+
+    void Reset();
+
+private:
+    // Handles complete line without \r\n
+    void Line(const std::string &line, Kind kind, Response &out, bool &done);
+
+    // Line collected so far
+    std::string _line;
+
+    // Bytes of data block left to read including its trailing \r\n, zero while reading lines
+    std::size_t _block_left = 0;
+};
+
+} // namespace Client
+} // namespace Afina
+
+#endif // AFINA_CLIENT_RESPONSE_PARSER_H
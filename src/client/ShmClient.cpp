@@ -0,0 +1,232 @@
+#include <afina/client/ShmClient.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <network/common/Handoff.h>
+#include <network/common/Listener.h>
+#include <network/shm/Ring.h>
+
+namespace Afina {
+namespace Client {
+
+using Network::Shm::Ring;
+using Network::Shm::Segment;
+
+// Descriptors and mapping of attached client
+struct ShmClient::State {
+    int control = -1;
+    int request_event = -1;
+    int response_event = -1;
+
+    void *memory = MAP_FAILED;
+    std::size_t size = 0;
+
+    // Client produces requests and consumes responses
+    Ring requests;
+    Ring responses;
+
+    ~State() {
+        if (memory != MAP_FAILED) {
+            munmap(memory, size);
+        }
+        for (int fd : {control, request_event, response_event}) {
+            if (fd != -1) {
+                close(fd);
+            }
+        }
+    }
+};
+
+// See ShmClient.h
+ShmClient::ShmClient() : _spin(std::thread::hardware_concurrency() == 1 ? 0 : 50) {}
+
+// See ShmClient.h
+ShmClient::~ShmClient() {}
+
+// See ShmClient.h
+void ShmClient::Connect(const std::string &address, uint32_t capacity) {
+    Close();
+
+    Network::Listener::Address server = Network::Listener::Parse(address);
+    if (server.CanReusePort()) {
+        throw std::runtime_error("Shared memory server is reachable through unix socket only: " + address);
+    }
+
+    std::unique_ptr<State> state(new State());
+    state->control = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (state->control == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+    if (connect(state->control, reinterpret_cast<const struct sockaddr *>(&server.addr), server.len) == -1) {
+        throw std::runtime_error("Failed to connect to " + address + ": " + strerror(errno));
+    }
+
+    // Segment is sealed against resizing: server must be sure its mapping stays valid
+    state->size = Segment::Size(capacity);
+    int memfd = memfd_create("afina-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd == -1) {
+        throw std::runtime_error("Failed to create segment: " + std::string(strerror(errno)));
+    }
+    if (ftruncate(memfd, state->size) == -1 ||
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1) {
+        int err = errno;
+        close(memfd);
+        throw std::runtime_error("Failed to size segment: " + std::string(strerror(err)));
+    }
+    state->memory = mmap(nullptr, state->size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (state->memory == MAP_FAILED) {
+        int err = errno;
+        close(memfd);
+        throw std::runtime_error("Failed to map segment: " + std::string(strerror(err)));
+    }
+
+    Segment::Init(state->memory, capacity);
+    Segment *segment = static_cast<Segment *>(state->memory);
+    if (!Segment::Valid(segment, state->size)) {
+        close(memfd);
+        throw std::runtime_error("Invalid ring capacity " + std::to_string(capacity));
+    }
+    state->requests = Ring(&segment->requests, segment->Data(), capacity);
+    state->responses = Ring(&segment->responses, segment->Data() + capacity, capacity);
+
+    state->request_event = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    state->response_event = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (state->request_event == -1 || state->response_event == -1) {
+        close(memfd);
+        throw std::runtime_error("Failed to create event file descriptor: " + std::string(strerror(errno)));
+    }
+
+    // Server confirms once segment is mapped, so requests are never sent into nowhere
+    try {
+        Network::Handoff::Send(state->control, {memfd, state->request_event, state->response_event});
+    } catch (...) {
+        close(memfd);
+        throw;
+    }
+    close(memfd);
+    if (!Network::Handoff::WaitConfirm(state->control, 1000)) {
+        throw std::runtime_error("Server refused shared memory segment");
+    }
+
+    _state = std::move(state);
+}
+
+// See ShmClient.h
+void ShmClient::Close() { _state.reset(); }
+
+// See ShmClient.h
+std::size_t ShmClient::MaxRequest() const {
+    if (!_state) {
+        return 0;
+    }
+    return Ring::MaxRecord(_state->requests.capacity());
+}
+
+// See ShmClient.h
+bool ShmClient::Send(const char *data, std::size_t size) {
+    if (!_state) {
+        throw std::runtime_error("Client is not connected");
+    }
+    if (size > MaxRequest()) {
+        throw std::runtime_error("Request is too large");
+    }
+
+    if (!_state->requests.Push(data, size)) {
+        return false;
+    }
+    if (_state->requests.NeedsSignal()) {
+        eventfd_write(_state->request_event, 1);
+    }
+    return true;
+}
+
+// See ShmClient.h
+bool ShmClient::Receive(std::string &response, std::chrono::milliseconds timeout) {
+    if (!_state) {
+        throw std::runtime_error("Client is not connected");
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    for (;;) {
+        const char *data;
+        std::size_t size;
+        if (_state->responses.Peek(data, size)) {
+            response.assign(data, size);
+            _state->responses.Pop();
+            return true;
+        }
+        if (_state->responses.Broken()) {
+            throw std::runtime_error("Server broke response ring");
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        if (elapsed < _spin) {
+            Network::Shm::Relax();
+            continue;
+        }
+
+        int timeout_ms = -1;
+        if (timeout.count() >= 0) {
+            auto left = timeout - std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+            if (left.count() <= 0) {
+                return false;
+            }
+            timeout_ms = left.count();
+        }
+        if (_state->responses.PrepareWait()) {
+            Wait(timeout_ms);
+            _state->responses.CancelWait();
+        }
+    }
+}
+
+// See ShmClient.h
+std::string ShmClient::Execute(const std::string &request) {
+    // Ring is full of requests sent earlier, nothing but taking their responses would free it
+    if (!Send(request)) {
+        throw std::runtime_error("Request ring is full, take responses first");
+    }
+
+    std::string response;
+    Receive(response);
+    return response;
+}
+
+// See ShmClient.h
+void ShmClient::Wait(int timeout_ms) {
+    struct pollfd fds[2];
+    fds[0].fd = _state->response_event;
+    fds[0].events = POLLIN;
+    fds[1].fd = _state->control;
+    fds[1].events = POLLIN;
+
+    if (poll(fds, 2, timeout_ms) == -1) {
+        if (errno == EINTR) {
+            return;
+        }
+        throw std::runtime_error("Failed to wait for response: " + std::string(strerror(errno)));
+    }
+
+    if (fds[0].revents & POLLIN) {
+        eventfd_t value;
+        eventfd_read(_state->response_event, &value);
+    }
+
+    // Server sends nothing over control socket, readable means it is closed
+    if (fds[1].revents) {
+        throw std::runtime_error("Server closed shared memory session");
+    }
+}
+
+} // namespace Client
+} // namespace Afina
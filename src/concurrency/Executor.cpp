@@ -1,16 +1,21 @@
 #include <afina/concurrency/Executor.h>
 #include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/logger.h>
 
 namespace Afina {
 namespace Concurrency {
 
 Executor::Executor(int low_watermark, int hight_watermark, int max_queue_size, int idle_time) :
+        state(State::kStopped),
         low_watermark(low_watermark),
         hight_watermark(hight_watermark),
         max_queue_size(max_queue_size),
-        idle_time(idle_time) {}
+        idle_time(idle_time),
+        free_threads(0) {}
 
-Executor::~Executor() {}
+Executor::~Executor() { Stop(true); }
 
 void Executor::Start(std::shared_ptr<spdlog::logger> logger) {
     _logger = std::move(logger);
@@ -19,57 +24,61 @@ void Executor::Start(std::shared_ptr<spdlog::logger> logger) {
     for (int i = 0; i < low_watermark; i++) {
         threads.push_back(std::thread(&perform, this));
     }
-    free_threads = 0;
 }
 
 void Executor::Stop(bool await) {
-    if (state == State::kStopped) {
-        return;
-    }
     std::unique_lock<std::mutex> lock(mutex);
-    state = State::kStopping;
-    empty_condition.notify_all();
+    if (state == State::kRun) {
+        // Threads finish the queue and leave, the last one reports that pool is stopped
+        state = threads.empty() ? State::kStopped : State::kStopping;
+        empty_condition.notify_all();
+    }
     if (await) {
         stop_condition.wait(lock, [this]() { return (this->state == Executor::State::kStopped); });
     }
-    state = State::kStopped;
 }
 
 void perform(Executor *executor) {
-    // new thread
-    while (executor->state == Executor::State::kRun) {
-        std::function<void()> task;
-        {
-            std::unique_lock<std::mutex> lock(executor->mutex);
-            auto time_until = std::chrono::system_clock::now() + std::chrono::milliseconds(executor->idle_time);
-            while (executor->tasks.empty() && executor->state == Executor::State::kRun) {
-                // waiting
-                executor->free_threads++;
-                if (executor->empty_condition.wait_until(lock, time_until) == std::cv_status::timeout) {
-                    if (executor->threads.size() > executor->low_watermark) {
-                        executor->_erase_thread();
-                        return;
-                    } else {
-                        executor->empty_condition.wait(lock);
-                    }
-                }
-                executor->free_threads--;
+    std::unique_lock<std::mutex> lock(executor->mutex);
+    for (;;) {
+        if (executor->tasks.empty()) {
+            // Queued tasks are completed even if pool is stopping
+            if (executor->state != Executor::State::kRun) {
+                break;
+            }
+
+            executor->free_threads++;
+            bool woken = executor->empty_condition.wait_for(
+                lock, std::chrono::milliseconds(executor->idle_time),
+                [executor]() { return !executor->tasks.empty() || executor->state != Executor::State::kRun; });
+            executor->free_threads--;
+
+            // Too many threads are waiting for work, this one isn't needed
+            if (!woken && executor->threads.size() > executor->low_watermark) {
+                executor->_erase_thread();
+                return;
             }
-            // stop waiting
-            if (executor->tasks.empty()) {
-                continue;
+            continue;
+        }
+
+        std::function<void()> task = std::move(executor->tasks.front());
+        executor->tasks.pop_front();
+
+        lock.unlock();
+        try {
+            task();
+        } catch (std::exception &ex) {
+            if (executor->_logger) {
+                executor->_logger->error("Task failed: {}", ex.what());
             }
-            task = executor->tasks.front();
-            executor->tasks.pop_front();
         }
-        task();
+        lock.lock();
     }
-    {
-        std::unique_lock<std::mutex> lock(executor->mutex);
-        executor->_erase_thread();
-        if (executor->threads.empty()) {
-            executor->stop_condition.notify_all();
-        }
+
+    executor->_erase_thread();
+    if (executor->threads.empty()) {
+        executor->state = Executor::State::kStopped;
+        executor->stop_condition.notify_all();
     }
 }
 
@@ -78,7 +87,6 @@ void Executor::_erase_thread() {
     auto iter = std::find_if(threads.begin(), threads.end(), [=](std::thread &t) { return (t.get_id() == cur_thread_id); });
     if (iter != threads.end()) {
         iter->detach();
-        free_threads--;
         threads.erase(iter);
         return;
     }
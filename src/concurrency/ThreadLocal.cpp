@@ -0,0 +1,135 @@
+#include <afina/concurrency/ThreadLocal.h>
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+#include <pthread.h>
+
+namespace Afina {
+namespace Concurrency {
+
+thread_local ThreadLocalBase::ThreadEntry *ThreadLocalBase::_current = nullptr;
+
+void thread_local_exit(void *ptr);
+
+namespace {
+
+/**
+ * Everything that is shared between all ThreadLocal instances and threads
+ */
+struct Registry {
+    Registry() {
+        if (pthread_key_create(&key, &thread_local_exit) != 0) {
+            throw std::runtime_error("Failed to create thread key");
+        }
+    }
+
+    // Protects everything below
+    std::mutex mutex;
+
+    // Key is used only to get notification once thread exits
+    pthread_key_t key;
+
+    // All threads that have slots
+    std::vector<ThreadLocalBase::ThreadEntry *> threads;
+
+    // Alive instances indexed by their ids, nullptr marks free id
+    std::vector<ThreadLocalBase *> instances;
+};
+
+Registry &registry() {
+    // Never destroyed: threads could exit after static destructors were run
+    static Registry *instance = new Registry();
+    return *instance;
+}
+
+} // namespace
+
+// Invoked by pthread once thread that has slots exits
+void thread_local_exit(void *ptr) {
+    ThreadLocalBase::ThreadEntry *entry = static_cast<ThreadLocalBase::ThreadEntry *>(ptr);
+    Registry &reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (std::size_t id = 0; id < entry->slots.size(); id++) {
+            if (entry->slots[id] != nullptr && reg.instances[id] != nullptr) {
+                reg.instances[id]->destroy(entry->slots[id], true);
+            }
+        }
+        reg.threads.erase(std::remove(reg.threads.begin(), reg.threads.end(), entry), reg.threads.end());
+    }
+
+    ThreadLocalBase::_current = nullptr;
+    delete entry;
+}
+
+// See ThreadLocal.h
+ThreadLocalBase::ThreadLocalBase() {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    auto it = std::find(reg.instances.begin(), reg.instances.end(), nullptr);
+    _id = it - reg.instances.begin();
+    if (it == reg.instances.end()) {
+        reg.instances.push_back(this);
+    } else {
+        *it = this;
+    }
+}
+
+// See ThreadLocal.h
+ThreadLocalBase::~ThreadLocalBase() {}
+
+// See ThreadLocal.h
+void ThreadLocalBase::release() {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto entry : reg.threads) {
+        if (_id < entry->slots.size() && entry->slots[_id] != nullptr) {
+            destroy(entry->slots[_id], false);
+            entry->slots[_id] = nullptr;
+        }
+    }
+    reg.instances[_id] = nullptr;
+}
+
+// See ThreadLocal.h
+void ThreadLocalBase::visit(void (*fn)(void *, void *), void *ctx) const {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto entry : reg.threads) {
+        if (_id < entry->slots.size() && entry->slots[_id] != nullptr) {
+            fn(entry->slots[_id], ctx);
+        }
+    }
+}
+
+// See ThreadLocal.h
+void *ThreadLocalBase::create_slot() {
+    Registry &reg = registry();
+
+    // Allocation happens outside of the lock, it could be expensive or even throw
+    void *slot = allocate();
+
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (_current == nullptr) {
+        _current = new ThreadEntry();
+        if (pthread_setspecific(reg.key, _current) != 0) {
+            delete _current;
+            _current = nullptr;
+            destroy(slot, false);
+            throw std::runtime_error("Failed to register thread");
+        }
+        reg.threads.push_back(_current);
+    }
+
+    if (_current->slots.size() <= _id) {
+        _current->slots.resize(reg.instances.size(), nullptr);
+    }
+    _current->slots[_id] = slot;
+    return slot;
+}
+
+} // namespace Concurrency
+} // namespace Afina
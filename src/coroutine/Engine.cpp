@@ -85,6 +85,73 @@ void Engine::Enter(context &ctx) {
     Restore(ctx);
 }
 
+// See Engine.h
+void Engine::Idle() {
+    for (;;) {
+        if (alive != nullptr) {
+            // Never returns, control comes back here via idle context once again
+            Enter(*alive);
+        }
+
+        if (blocked == nullptr || !_unblocker) {
+            return;
+        }
+        _unblocker(*this);
+    }
+}
+
+// See Engine.h
+void Engine::block(void *routine_) {
+    context *routine = (routine_ != nullptr) ? static_cast<context *>(routine_) : cur_routine;
+    if (routine == nullptr || routine == idle_ctx || routine->is_blocked) {
+        return;
+    }
+
+    Unlink(alive, routine);
+    Push(blocked, routine);
+    routine->is_blocked = true;
+
+    if (routine == cur_routine) {
+        // Returns once routine is unblocked and scheduled again
+        Enter((alive != nullptr) ? *alive : *idle_ctx);
+    }
+}
+
+// See Engine.h
+void Engine::unblock(void *routine_) {
+    context *routine = static_cast<context *>(routine_);
+    if (routine == nullptr || !routine->is_blocked) {
+        return;
+    }
+
+    Unlink(blocked, routine);
+    Push(alive, routine);
+    routine->is_blocked = false;
+}
+
+// See Engine.h
+void Engine::Unlink(context *&list, context *routine) {
+    if (routine->prev != nullptr) {
+        routine->prev->next = routine->next;
+    }
+    if (routine->next != nullptr) {
+        routine->next->prev = routine->prev;
+    }
+    if (list == routine) {
+        list = routine->next;
+    }
+    routine->prev = routine->next = nullptr;
+}
+
+// See Engine.h
+void Engine::Push(context *&list, context *routine) {
+    routine->prev = nullptr;
+    routine->next = list;
+    if (list != nullptr) {
+        list->prev = routine;
+    }
+    list = routine;
+}
 
 } // namespace Coroutine
 } // namespace Afina
@@ -1,5 +1,6 @@
 #include <afina/Storage.h>
 #include <afina/execute/Get.h>
+#include <afina/metrics/Counters.h>
 
 #include <iostream>
 #include <iterator>
@@ -21,6 +22,13 @@ to indicate the end of response.
 
 */
 
+namespace {
+
+// Expected size of a value, request doesn't tell it
+constexpr std::size_t kKeyCost = 1024;
+
+} // namespace
+
 void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
     std::stringstream keyStream;
     copy(_keys.begin(), _keys.end(), std::ostream_iterator<std::string>(keyStream, " "));
@@ -28,10 +36,16 @@ void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
 
     std::stringstream outStream;
 
+    Metrics::Counters &counters = Metrics::Counters::Instance();
+    counters.Add(Metrics::kGets, _keys.size());
+
     std::string value;
     for (auto &key : _keys) {
-        if (!storage.Get(key, value))
+        if (!storage.Get(key, value)) {
+            counters.Add(Metrics::kMisses);
             continue;
+        }
+        counters.Add(Metrics::kHits);
         outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
         outStream << value << "\r\n";
     }
@@ -40,5 +54,7 @@ void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
     out = outStream.str();
 }
 
+std::size_t Get::Cost(const std::string &args) const { return _keys.size() * kKeyCost; }
+
 } // namespace Execute
 } // namespace Afina
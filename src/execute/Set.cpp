@@ -1,5 +1,6 @@
 #include <afina/Storage.h>
 #include <afina/execute/Set.h>
+#include <afina/metrics/Counters.h>
 
 #include <iostream>
 
@@ -8,6 +9,7 @@ namespace Execute {
 
 // memcached protocol: "set" means "store this data".
 void Set::Execute(Storage &storage, const std::string &args, std::string &out) {
+    Metrics::Counters::Instance().Add(Metrics::kSets);
     std::cout << "Set(" << _key << "): " << args << std::endl;
     storage.Put(_key, args);
     out = "STORED";
@@ -1,14 +1,85 @@
 #include <afina/Storage.h>
 #include <afina/execute/Stats.h>
+#include <afina/metrics/Counters.h>
+#include <afina/metrics/Histogram.h>
+#include <afina/metrics/Latency.h>
 
+#include <chrono>
+#include <ctime>
 #include <iostream>
 #include <iterator>
 #include <sstream>
 
+#include <unistd.h>
+
 namespace Afina {
 namespace Execute {
 
-void Stats::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("END"); }
+/* memcached protocol:
+
+The server responds with a list of lines of the form:
+
+STAT <name> <value>\r\n
+
+The server terminates this list with the line
+
+END\r\n
+
+*/
+void Stats::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::stringstream outStream;
+    if (_args.empty()) {
+        General(outStream);
+    } else if (_args.size() == 1 && _args[0] == "latency") {
+        Latency(outStream);
+    } else {
+        out = "CLIENT_ERROR unknown stats subcommand";
+        return;
+    }
+    outStream << "END"; // networking layer should add the last \r\n
+
+    out = outStream.str();
+}
+
+// See Stats.h
+void Stats::General(std::stringstream &out) {
+    Metrics::Counters &counters = Metrics::Counters::Instance();
+
+    int64_t values[Metrics::kCountersCount];
+    counters.Collect(values);
+
+    auto uptime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - counters.Started());
+
+    out << "STAT pid " << getpid() << "\r\n";
+    out << "STAT uptime " << uptime.count() << "\r\n";
+    out << "STAT time " << std::time(nullptr) << "\r\n";
+    for (std::size_t i = 0; i < Metrics::kCountersCount; i++) {
+        out << "STAT " << Metrics::kCounterNames[i] << " " << values[i] << "\r\n";
+    }
+}
+
+// See Stats.h
+void Stats::Latency(std::stringstream &out) {
+    Metrics::Latency &latency = Metrics::Latency::Instance();
+
+    out << "STAT sample_rate " << latency.SampleRate() << "\r\n";
+    for (std::size_t i = 0; i < Metrics::kCommandTypesCount; i++) {
+        Metrics::Histogram histogram;
+        latency.Collect(static_cast<Metrics::CommandType>(i), histogram);
+
+        uint64_t count = histogram.Count();
+        if (count == 0) {
+            continue;
+        }
+
+        const char *name = Metrics::kCommandTypeNames[i];
+        out << "STAT " << name << ":samples " << count << "\r\n";
+        out << "STAT " << name << ":p50_ns " << histogram.Percentile(50.0) << "\r\n";
+        out << "STAT " << name << ":p99_ns " << histogram.Percentile(99.0) << "\r\n";
+        out << "STAT " << name << ":p999_ns " << histogram.Percentile(99.9) << "\r\n";
+        out << "STAT " << name << ":max_ns " << histogram.Max() << "\r\n";
+    }
+}
 
 } // namespace Execute
 } // namespace Afina
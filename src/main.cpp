@@ -1,30 +1,54 @@
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include <atomic>
+#include <poll.h>
 #include <semaphore.h>
 #include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
 #include <thread>
+#include <unistd.h>
 
 #include <cxxopts.hpp>
 
 #include <afina/Storage.h>
 #include <afina/Version.h>
 #include <afina/logging/Service.h>
+#include <afina/metrics/Latency.h>
 #include <afina/network/Server.h>
 
 #include "logging/ServiceImpl.h"
 #include "network/mt_blocking/ServerImpl.h"
+#include "network/common/Handoff.h"
+#include "network/common/Listener.h"
+#include "network/common/MemoryBudget.h"
+#include "network/common/RateLimiter.h"
 #include "network/mt_nonblocking/ServerImpl.h"
+#include "network/proxy/ServerImpl.h"
 #include "network/st_blocking/ServerImpl.h"
+#include "network/st_coroutine/ServerImpl.h"
+#include "network/shm/ServerImpl.h"
 #include "network/st_nonblocking/ServerImpl.h"
+#include "network/udp/ServerImpl.h"
+#include "network/uring/ServerImpl.h"
 
+#include "replication/Primary.h"
+#include "replication/Replica.h"
+
+#include "storage/HotKeyCache.h"
 #include "storage/SimpleLRU.h"
 #include "storage/ThreadSafeSimpleLRU.h"
 
 using namespace Afina;
 
+// Signal set that to notify application about time to stop
+sem_t stop_semaphore;
+volatile sig_atomic_t stop_reason = 0;
+
 /**
  * Whole application class
  */
@@ -58,23 +82,259 @@ public:
             throw std::runtime_error("Unknown storage type");
         }
 
-        // Step 2: Configure network
+        // Serve the hottest keys from per-core replicas
+        if (options.count("hot-keys") > 0) {
+            storage = std::make_shared<Afina::Backend::HotKeyCache>(storage);
+        }
+
+        // Replication decorates storage on top of everything, so it sees all writes. Replica thread writes
+        // concurrently with network, so storage has to be thread safe
+        if (options.count("replication-listen") > 0 && options.count("replica-of") > 0) {
+            throw std::runtime_error("Server can't be primary and replica at the same time");
+        }
+        if (options.count("replication-listen") > 0 || options.count("replica-of") > 0) {
+            if (storage_type == "st_lru") {
+                throw std::runtime_error("Replication needs thread safe storage");
+            }
+        }
+        if (options.count("replication-listen") > 0) {
+            int backlog = 64;
+            if (options.count("replication-backlog") > 0) {
+                backlog = options["replication-backlog"].as<int>();
+                if (backlog <= 0) {
+                    throw std::runtime_error("Replication backlog must be positive");
+                }
+            }
+            std::string address = options["replication-listen"].as<std::string>();
+            Network::Listener::Parse(address);
+            storage = std::make_shared<Afina::Replication::Primary>(storage, logService, address,
+                                                                    static_cast<std::size_t>(backlog) << 20);
+        } else if (options.count("replica-of") > 0) {
+            storage = std::make_shared<Afina::Replication::Replica>(storage, logService,
+                                                                    options["replica-of"].as<std::string>());
+        }
+
+        // Step 2: Configure metrics
+        if (options.count("latency-sample-rate") > 0) {
+            int rate = options["latency-sample-rate"].as<int>();
+            if (rate < 0) {
+                throw std::runtime_error("Latency sample rate must not be negative");
+            }
+            Afina::Metrics::Latency::Instance().SetSampleRate(rate);
+        }
+
+        // Step 3: Configure network
         std::string network_type = "st_block";
         if (options.count("network") > 0) {
             network_type = options["network"].as<std::string>();
         }
 
-        if (network_type == "st_block") {
+        if (options.count("max-conn-memory") > 0) {
+            int limit = options["max-conn-memory"].as<int>();
+            if (limit <= 0) {
+                throw std::runtime_error("Connection memory limit must be positive");
+            }
+            Afina::Network::MemoryBudget::Instance().SetLimit(static_cast<std::size_t>(limit) << 20);
+        }
+
+        int offload_threads = 0;
+        if (options.count("offload-threads") > 0) {
+            offload_threads = options["offload-threads"].as<int>();
+            if (offload_threads < 0) {
+                throw std::runtime_error("Number of offload threads can't be negative");
+            }
+        }
+        if (offload_threads > 0) {
+            // Pool executes commands concurrently with the workers
+            if (storage_type == "st_lru") {
+                throw std::runtime_error("Offload threads need thread safe storage");
+            }
+            if (network_type != "mt_nonblock" && network_type != "mt_reuseport") {
+                throw std::runtime_error("Offload threads need mt_nonblock or mt_reuseport network");
+            }
+        }
+
+        // Client buckets live on the workers of event driven multi threaded server
+        Afina::Network::RateLimiter::Limit rate_limit;
+        if (options.count("rate-limit-ops") > 0) {
+            int ops = options["rate-limit-ops"].as<int>();
+            if (ops < 0) {
+                throw std::runtime_error("Rate limit must not be negative");
+            }
+            rate_limit.ops = ops;
+        }
+        if (options.count("rate-limit-bytes") > 0) {
+            int bytes = options["rate-limit-bytes"].as<int>();
+            if (bytes < 0) {
+                throw std::runtime_error("Rate limit must not be negative");
+            }
+            rate_limit.bytes = bytes;
+        }
+        if (options.count("rate-limit-by") > 0) {
+            std::string key = options["rate-limit-by"].as<std::string>();
+            if (key == "address") {
+                rate_limit.key = Afina::Network::RateLimiter::Limit::Key::kAddress;
+            } else if (key == "listener") {
+                rate_limit.key = Afina::Network::RateLimiter::Limit::Key::kListener;
+            } else {
+                throw std::runtime_error("Unknown rate limit key");
+            }
+        }
+        if (rate_limit.enabled() && network_type != "mt_nonblock" && network_type != "mt_reuseport") {
+            throw std::runtime_error("Rate limits need mt_nonblock or mt_reuseport network");
+        }
+
+        // Proxy forwards keys to backends instead of keeping them in storage
+        std::string mode = "server";
+        if (options.count("mode") > 0) {
+            mode = options["mode"].as<std::string>();
+        }
+        if (mode != "server" && mode != "proxy") {
+            throw std::runtime_error("Unknown mode");
+        }
+
+        if (mode == "proxy") {
+            if (options.count("backend") == 0) {
+                throw std::runtime_error("Proxy needs at least one backend");
+            }
+            std::vector<std::string> backends = options["backend"].as<std::vector<std::string>>();
+            for (auto &backend : backends) {
+                Network::Listener::Parse(backend);
+            }
+
+            Client::AsyncClient::Options proxy_options;
+            if (options.count("backend-connections") > 0) {
+                int connections = options["backend-connections"].as<int>();
+                if (connections <= 0) {
+                    throw std::runtime_error("Number of backend connections must be positive");
+                }
+                proxy_options.connections = connections;
+            }
+            if (options.count("backend-pipeline") > 0) {
+                int pipeline = options["backend-pipeline"].as<int>();
+                if (pipeline <= 0) {
+                    throw std::runtime_error("Backend pipeline depth must be positive");
+                }
+                proxy_options.pipeline = pipeline;
+            }
+            if (options.count("udp-port") > 0 || options.count("shm-listen") > 0) {
+                throw std::runtime_error("Proxy serves TCP and unix socket clients only");
+            }
+            if (options.count("replication-listen") > 0 || options.count("replica-of") > 0) {
+                throw std::runtime_error("Proxy keeps no keys to replicate");
+            }
+            server = std::make_shared<Afina::Network::Proxy::ServerImpl>(storage, logService, backends, proxy_options);
+        } else if (network_type == "st_block") {
             server = std::make_shared<Afina::Network::STblocking::ServerImpl>(storage, logService);
         } else if (network_type == "mt_block") {
             server = std::make_shared<Afina::Network::MTblocking::ServerImpl>(storage, logService);
         } else if (network_type == "st_nonblock") {
             server = std::make_shared<Afina::Network::STnonblock::ServerImpl>(storage, logService);
-        } else if (network_type == "mt_nonblock") {
-            server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(storage, logService);
+        } else if (network_type == "st_coroutine") {
+            server = std::make_shared<Afina::Network::STcoroutine::ServerImpl>(storage, logService);
+        } else if (network_type == "mt_nonblock" || network_type == "mt_reuseport") {
+            auto mt_server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(
+                storage, logService, network_type == "mt_reuseport", options.count("pin-workers") > 0,
+                options.count("rebalance") > 0, offload_threads);
+            mt_server->SetRateLimit(rate_limit);
+            server = mt_server;
+        } else if (network_type == "uring") {
+            server = std::make_shared<Afina::Network::Uring::ServerImpl>(storage, logService,
+                                                                         options.count("uring-sqpoll") > 0);
         } else {
             throw std::runtime_error("Unknown network type");
         }
+
+        std::chrono::seconds idle_timeout(300), read_timeout(5);
+        if (options.count("idle-timeout") > 0) {
+            idle_timeout = std::chrono::seconds(options["idle-timeout"].as<int>());
+        }
+        if (options.count("read-timeout") > 0) {
+            read_timeout = std::chrono::seconds(options["read-timeout"].as<int>());
+        }
+        if (idle_timeout.count() < 0 || read_timeout.count() < 0) {
+            throw std::runtime_error("Timeouts must not be negative");
+        }
+        server->SetTimeouts(idle_timeout, read_timeout);
+
+        // Listen addresses are checked before anything is started, server parses them again on start
+        if (options.count("listen") > 0) {
+            listen_addresses = options["listen"].as<std::vector<std::string>>();
+            for (auto &address : listen_addresses) {
+                Network::Listener::Parse(address);
+            }
+            server->SetAddresses(listen_addresses);
+        }
+
+        // UDP frontend serves the same storage next to TCP server, so storage is always shared between threads
+        if (options.count("udp-port") > 0) {
+            int port = options["udp-port"].as<int>();
+            if (port <= 0 || port > 65535) {
+                throw std::runtime_error("Invalid UDP port");
+            }
+            if (storage_type == "st_lru") {
+                throw std::runtime_error("UDP frontend needs thread safe storage");
+            }
+            udp_port = port;
+
+            udp_workers = 1;
+            if (options.count("udp-workers") > 0) {
+                int workers = options["udp-workers"].as<int>();
+                if (workers <= 0) {
+                    throw std::runtime_error("Number of UDP workers must be positive");
+                }
+                udp_workers = workers;
+            }
+            udp_server = std::make_shared<Afina::Network::Udp::ServerImpl>(storage, logService);
+        }
+
+        // Shared memory frontend for co-located clients, same storage sharing as UDP one
+        if (options.count("shm-listen") > 0) {
+            std::string address = options["shm-listen"].as<std::string>();
+            if (Network::Listener::Parse(address).CanReusePort()) {
+                throw std::runtime_error("Shared memory frontend listens on unix socket only");
+            }
+            if (storage_type == "st_lru") {
+                throw std::runtime_error("Shared memory frontend needs thread safe storage");
+            }
+
+            int spin = 50;
+            if (options.count("shm-spin") > 0) {
+                spin = options["shm-spin"].as<int>();
+                if (spin < 0) {
+                    throw std::runtime_error("Shared memory spin must not be negative");
+                }
+            }
+
+            shm_workers = 1;
+            if (options.count("shm-workers") > 0) {
+                int workers = options["shm-workers"].as<int>();
+                if (workers <= 0) {
+                    throw std::runtime_error("Number of shared memory workers must be positive");
+                }
+                shm_workers = workers;
+            }
+            shm_server =
+                std::make_shared<Afina::Network::Shm::ServerImpl>(storage, logService, std::chrono::microseconds(spin));
+            shm_server->SetAddresses({address});
+        }
+
+        // Step 4: graceful restart. Blocking servers can't stop accepting without shutting listening socket down
+        if (options.count("handoff") > 0) {
+            if (network_type == "st_block" || network_type == "mt_block") {
+                throw std::runtime_error("Graceful restart needs event driven network");
+            }
+            handoff_path = options["handoff"].as<std::string>();
+        }
+
+        n_workers = 2;
+        if (options.count("workers") > 0) {
+            int workers = options["workers"].as<int>();
+            if (workers <= 0) {
+                throw std::runtime_error("Number of workers must be positive");
+            }
+            n_workers = workers;
+        }
     }
 
     // Start services in correct order
@@ -86,34 +346,169 @@ public:
         log->warn("Start storage");
         storage->Start();
 
-        // TODO: configure network service
         const uint16_t port = 8080;
-        log->warn("Start network on {}", port);
-        server->Start(port, 2, 2);
+        for (auto &address : Network::Listener::Parse(listen_addresses, port)) {
+            log->warn("Start network on {}", address.ToString());
+        }
+
+        // Take listening sockets over from the running process, if there is one
+        int predecessor = -1;
+        if (!handoff_path.empty()) {
+            predecessor = Network::Handoff::Connect(handoff_path);
+            if (predecessor != -1) {
+                std::vector<int> sockets = Network::Handoff::Receive(predecessor);
+                if (sockets.empty()) {
+                    close(predecessor);
+                    throw std::runtime_error("Running process has no sockets to hand over");
+                }
+                log->warn("Took over {} listening sockets", sockets.size());
+                server->SetListeners(std::move(sockets));
+            }
+        }
+        server->Start(port, 2, n_workers);
+        if (udp_server) {
+            udp_server->Start(udp_port, 1, udp_workers);
+        }
+        if (shm_server) {
+            shm_server->Start(0, 1, shm_workers);
+        }
+
+        // Previous process stops accepting and drains once it gets confirmation
+        if (predecessor != -1) {
+            Network::Handoff::Confirm(predecessor);
+            close(predecessor);
+        }
+        if (!handoff_path.empty()) {
+            StartHandoff();
+        }
     }
 
     // Stop services in correct order
     void Stop() {
         auto log = logService->select("root");
         log->warn("Stop application");
+        StopHandoff();
+        if (shm_server) {
+            shm_server->Stop();
+        }
+        if (udp_server) {
+            udp_server->Stop();
+        }
         server->Stop();
         server->Join();
+        if (udp_server) {
+            udp_server->Join();
+        }
+        if (shm_server) {
+            shm_server->Join();
+        }
 
         storage->Stop();
         logService->Stop();
     }
 
 private:
+    // Waits for the next process on the handoff socket
+    void StartHandoff() {
+        _handoff_socket = Network::Handoff::Listen(handoff_path);
+        _handoff_event = eventfd(0, EFD_CLOEXEC);
+        if (_handoff_event == -1) {
+            throw std::runtime_error("Failed to create handoff event");
+        }
+        _handed_over = false;
+        _handoff_thread = std::thread(&Application::OnHandoff, this);
+    }
+
+    void StopHandoff() {
+        if (!_handoff_thread.joinable()) {
+            return;
+        }
+        eventfd_write(_handoff_event, 1);
+        _handoff_thread.join();
+
+        close(_handoff_event);
+        close(_handoff_socket);
+
+        // Once handed over, socket file belongs to the successor
+        if (!_handed_over) {
+            unlink(handoff_path.c_str());
+        }
+    }
+
+    // Hands listening sockets over to the successor and stops application once it confirms
+    void OnHandoff() {
+        auto log = logService->select("root");
+        struct pollfd fds[2];
+        fds[0].fd = _handoff_socket;
+        fds[0].events = POLLIN;
+        fds[1].fd = _handoff_event;
+        fds[1].events = POLLIN;
+
+        for (;;) {
+            if (poll(fds, 2, -1) == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                log->error("Handoff socket poll failed: {}", strerror(errno));
+                return;
+            }
+            if (fds[1].revents != 0) {
+                return;
+            }
+
+            int channel = accept4(_handoff_socket, nullptr, nullptr, SOCK_CLOEXEC);
+            if (channel == -1) {
+                continue;
+            }
+
+            bool confirmed = false;
+            try {
+                Network::Handoff::Send(channel, server->Listeners());
+                confirmed = Network::Handoff::WaitConfirm(channel, 10000);
+            } catch (std::runtime_error &ex) {
+                log->error("Failed to hand sockets over: {}", ex.what());
+            }
+            close(channel);
+
+            if (confirmed) {
+                log->warn("Listening sockets are handed over, stop application");
+                _handed_over = true;
+                stop_reason = SIGTERM;
+                sem_post(&stop_semaphore);
+                return;
+            }
+            log->warn("Successor failed to take sockets over, keep serving");
+        }
+    }
+
     std::shared_ptr<Afina::Logging::Config> logConfig;
     std::shared_ptr<Afina::Logging::Service> logService;
 
     std::shared_ptr<Afina::Storage> storage;
     std::shared_ptr<Afina::Network::Server> server;
-};
 
-// Signal set that to notify application about time to stop
-sem_t stop_semaphore;
-volatile sig_atomic_t stop_reason = 0;
+    // Optional memcached UDP frontend
+    std::shared_ptr<Afina::Network::Server> udp_server;
+    uint16_t udp_port = 0;
+    uint32_t udp_workers = 0;
+
+    // Optional shared memory frontend
+    std::shared_ptr<Afina::Network::Server> shm_server;
+    uint32_t shm_workers = 0;
+
+    // Number of network threads
+    uint32_t n_workers;
+
+    // Addresses to accept TCP and unix socket connections on, see Network::Listener
+    std::vector<std::string> listen_addresses;
+
+    // Graceful restart: unix socket the successor connects to, see Network::Handoff
+    std::string handoff_path;
+    int _handoff_socket = -1;
+    int _handoff_event = -1;
+    bool _handed_over = false;
+    std::thread _handoff_thread;
+};
 
 // Catch user desire to stop the server
 void on_term(int signum, siginfo_t *siginfo, void *data) {
@@ -129,6 +524,52 @@ int main(int argc, char **argv) {
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
+        options.add_options()("mode", "server keeps keys itself, proxy spreads them over backends",
+                              cxxopts::value<std::string>());
+        options.add_options()("backend", "Server to forward keys to in proxy mode, could be given several times",
+                              cxxopts::value<std::vector<std::string>>());
+        options.add_options()("backend-connections", "Connections of each proxy worker to each backend",
+                              cxxopts::value<int>());
+        options.add_options()("backend-pipeline", "Requests in flight on a single backend connection",
+                              cxxopts::value<int>());
+        options.add_options()("l,listen", "Address to accept connections on, could be given several times",
+                              cxxopts::value<std::vector<std::string>>());
+        options.add_options()("w,workers", "Number of network workers", cxxopts::value<int>());
+        options.add_options()("pin-workers", "Pin each network worker to its own CPU");
+        options.add_options()("rebalance", "Migrate connections from busy network workers to less loaded ones");
+        options.add_options()("offload-threads", "Threads to execute expensive commands on, 0 executes all on workers",
+                              cxxopts::value<int>());
+        options.add_options()("udp-port", "Serve memcached UDP protocol on that port too", cxxopts::value<int>());
+        options.add_options()("udp-workers", "Number of UDP workers", cxxopts::value<int>());
+        options.add_options()("shm-listen", "Unix socket to attach shared memory clients on",
+                              cxxopts::value<std::string>());
+        options.add_options()("shm-workers", "Number of shared memory workers", cxxopts::value<int>());
+        options.add_options()("shm-spin", "Microseconds shared memory workers poll rings before sleeping",
+                              cxxopts::value<int>());
+        options.add_options()("uring-sqpoll", "Let kernel thread poll io_uring submission queue");
+        options.add_options()("idle-timeout", "Close connections idle for that many seconds, 0 disables",
+                              cxxopts::value<int>());
+        options.add_options()("read-timeout", "Seconds to receive started command completely, 0 disables",
+                              cxxopts::value<int>());
+        options.add_options()("rate-limit-ops", "Commands per second each client may execute, 0 is unlimited",
+                              cxxopts::value<int>());
+        options.add_options()("rate-limit-bytes", "Bytes per second each client may send, 0 is unlimited",
+                              cxxopts::value<int>());
+        options.add_options()("rate-limit-by", "Tell clients apart by source address or by listener they connected to",
+                              cxxopts::value<std::string>());
+        options.add_options()("max-conn-memory", "Memory limit for all connection buffers in megabytes",
+                              cxxopts::value<int>());
+        options.add_options()("handoff", "Unix socket to take listening sockets over from running process through",
+                              cxxopts::value<std::string>());
+        options.add_options()("hot-keys", "Replicate hot keys into per-core read caches");
+        options.add_options()("replication-listen", "Address to stream writes to replicas from",
+                              cxxopts::value<std::string>());
+        options.add_options()("replication-backlog", "Megabytes of writes kept for replicas that lag behind",
+                              cxxopts::value<int>());
+        options.add_options()("replica-of", "Replicate primary listening on that address, client writes are rejected",
+                              cxxopts::value<std::string>());
+        options.add_options()("latency-sample-rate", "Measure latency of each N-th command, 0 disables",
+                              cxxopts::value<int>());
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
 
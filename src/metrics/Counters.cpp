@@ -0,0 +1,41 @@
+#include <afina/metrics/Counters.h>
+
+namespace Afina {
+namespace Metrics {
+
+const char *const kCounterNames[kCountersCount] = {
+    "cmd_get",       "get_hits",         "get_misses",       "cmd_set",          "evictions",
+    "get_expired",   "bytes_read",       "bytes_written",    "curr_connections", "total_connections",
+    "rate_limited",
+};
+
+// See Counters.h
+Counters &Counters::Instance() {
+    // Never destroyed: threads could update counters after static destructors were run
+    static Counters *instance = new Counters();
+    return *instance;
+}
+
+// See Counters.h
+Counters::Counters()
+    : _started(std::chrono::steady_clock::now()), _local([this](Block &block) {
+          for (std::size_t i = 0; i < kCountersCount; i++) {
+              _retired.values[i].fetch_add(block.values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+          }
+      }) {}
+
+// See Counters.h
+void Counters::Collect(int64_t (&out)[kCountersCount]) const {
+    for (std::size_t i = 0; i < kCountersCount; i++) {
+        out[i] = _retired.values[i].load(std::memory_order_relaxed);
+    }
+
+    _local.for_each([&out](const Block &block) {
+        for (std::size_t i = 0; i < kCountersCount; i++) {
+            out[i] += block.values[i].load(std::memory_order_relaxed);
+        }
+    });
+}
+
+} // namespace Metrics
+} // namespace Afina
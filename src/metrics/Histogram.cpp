@@ -0,0 +1,89 @@
+#include <afina/metrics/Histogram.h>
+
+namespace Afina {
+namespace Metrics {
+
+constexpr unsigned Histogram::kSubBucketBits;
+constexpr unsigned Histogram::kMaxBits;
+constexpr uint64_t Histogram::kSubBuckets;
+constexpr std::size_t Histogram::kBuckets;
+
+// See Histogram.h
+void Histogram::Merge(const Histogram &other) {
+    for (std::size_t i = 0; i < kBuckets; i++) {
+        uint64_t count = other._counts[i].load(std::memory_order_relaxed);
+        if (count > 0) {
+            _counts[i].fetch_add(count, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t max = other.Max();
+    uint64_t current = _max.load(std::memory_order_relaxed);
+    while (max > current && !_max.compare_exchange_weak(current, max, std::memory_order_relaxed)) {
+        continue;
+    }
+}
+
+// See Histogram.h
+void Histogram::Reset() {
+    for (auto &c : _counts) {
+        c.store(0, std::memory_order_relaxed);
+    }
+    _max.store(0, std::memory_order_relaxed);
+}
+
+// See Histogram.h
+uint64_t Histogram::Count() const {
+    uint64_t total = 0;
+    for (auto &c : _counts) {
+        total += c.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// See Histogram.h
+uint64_t Histogram::Percentile(double percentile) const {
+    uint64_t total = Count();
+    if (total == 0) {
+        return 0;
+    }
+
+    // Rank of the value we are looking for, 1-based
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    } else if (rank > total) {
+        rank = total;
+    }
+
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; i++) {
+        seen += _counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t value = LowestOf(i) + WidthOf(i) / 2;
+            return value < Max() ? value : Max();
+        }
+    }
+    return Max();
+}
+
+// See Histogram.h
+uint64_t Histogram::LowestOf(std::size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+
+    unsigned shift = bucket / kSubBuckets - 1;
+    return (kSubBuckets + bucket % kSubBuckets) << shift;
+}
+
+// See Histogram.h
+uint64_t Histogram::WidthOf(std::size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return 1;
+    }
+    return uint64_t(1) << (bucket / kSubBuckets - 1);
+}
+
+} // namespace Metrics
+} // namespace Afina
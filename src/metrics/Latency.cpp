@@ -0,0 +1,48 @@
+#include <afina/metrics/Latency.h>
+
+namespace Afina {
+namespace Metrics {
+
+const char *const kCommandTypeNames[kCommandTypesCount] = {"get", "set", "add", "append", "replace", "stats", "other"};
+
+// See Latency.h
+CommandType CommandTypeOf(const std::string &name) {
+    if (name == "get" || name == "gets") {
+        return kCommandGet;
+    } else if (name == "set") {
+        return kCommandSet;
+    } else if (name == "add") {
+        return kCommandAdd;
+    } else if (name == "append" || name == "prepend") {
+        return kCommandAppend;
+    } else if (name == "replace") {
+        return kCommandReplace;
+    } else if (name == "stats") {
+        return kCommandStats;
+    }
+    return kCommandOther;
+}
+
+// See Latency.h
+Latency &Latency::Instance() {
+    // Never destroyed: threads could record latency after static destructors were run
+    static Latency *instance = new Latency();
+    return *instance;
+}
+
+// See Latency.h
+Latency::Latency()
+    : _sample_rate(16), _local([this](Block &block) {
+          for (std::size_t i = 0; i < kCommandTypesCount; i++) {
+              _retired[i].Merge(block.histograms[i]);
+          }
+      }) {}
+
+// See Latency.h
+void Latency::Collect(CommandType type, Histogram &out) const {
+    out.Merge(_retired[type]);
+    _local.for_each([type, &out](const Block &block) { out.Merge(block.histograms[type]); });
+}
+
+} // namespace Metrics
+} // namespace Afina
@@ -0,0 +1,278 @@
+#include "EdgeConnection.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/metrics/Counters.h>
+#include <afina/metrics/Latency.h>
+
+namespace Afina {
+namespace Network {
+
+namespace {
+
+// Per wakeup budget: connection that has more to read goes to the end of the server ready list
+constexpr std::size_t kReadBudget = 64 * 1024;
+constexpr std::size_t kCommandBudget = 1024;
+
+} // namespace
+
+// See EdgeConnection.h
+EdgeConnection::EdgeConnection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl)
+    : _socket(s), _logger(std::move(pl)), pStorage(std::move(ps)) {
+    std::memset(&_event, 0, sizeof(struct epoll_event));
+
+    Metrics::Counters::Instance().Add(Metrics::kTotalConnections);
+    Metrics::Counters::Instance().Add(Metrics::kCurrConnections);
+}
+
+// See EdgeConnection.h
+EdgeConnection::~EdgeConnection() { Metrics::Counters::Instance().Add(Metrics::kCurrConnections, -1); }
+
+// See EdgeConnection.h
+void EdgeConnection::Start() {
+    _logger->debug("Connection on {} socket started", _socket);
+
+    // Edge triggered socket is registered once for everything, connection state decides what to do
+    // on wakeup, so there is no epoll_ctl per state change
+    _event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+}
+
+// See EdgeConnection.h
+void EdgeConnection::OnError() {
+    _logger->warn("Connection on {} socket has error", _socket);
+    is_alive = false;
+}
+
+// See EdgeConnection.h
+void EdgeConnection::OnClose() {
+    _logger->debug("Connection on {} socket closed", _socket);
+    is_alive = false;
+}
+
+// See EdgeConnection.h
+void EdgeConnection::StopReading() { is_reading = false; }
+
+// See EdgeConnection.h
+void EdgeConnection::Throttle() {
+    _logger->debug("Connection on {} socket is out of tokens", _socket);
+    throttled = true;
+    input_pending = true;
+    Metrics::Counters::Instance().Add(Metrics::kRateLimited);
+}
+
+// See EdgeConnection.h
+void EdgeConnection::DoRead() {
+    if (!is_reading) {
+        // Stopped while waiting for its turn, responses of the batch are still to be sent
+        if (is_alive && !output.empty()) {
+            DoWrite();
+        }
+        return;
+    }
+
+    // Nothing else is executed until offloaded command is back or client gets tokens, socket is read after that
+    if (Executing() || throttled) {
+        input_pending = true;
+        return;
+    }
+
+    _logger->debug("Do read on {} socket", _socket);
+    input_pending = false;
+    bool yielded = false;
+    try {
+        // Tokens are refilled once per wakeup, that is precise enough for a batch
+        RateLimiter::Clock::time_point now;
+        if (bucket != nullptr) {
+            now = RateLimiter::Clock::now();
+        }
+
+        std::size_t commands = 0, bytes = 0;
+        for (;;) {
+            // Commands left in the buffer by the previous wakeup go first
+            ProcessInput(commands, now);
+            if (throttled) {
+                break;
+            }
+            if (Executing()) {
+                // Responses before offloaded command are sent together with its result
+                input_pending = true;
+                yielded = true;
+                break;
+            }
+            if (commands >= kCommandBudget || bytes >= kReadBudget) {
+                _logger->debug("Connection on {} socket used up its budget", _socket);
+                input_pending = true;
+                yielded = true;
+                break;
+            }
+
+            // Client doesn't take its responses, leave the rest of commands in the socket until it does
+            if (MemoryBudget::Instance().OverBudget(output.size())) {
+                _logger->debug("Connection on {} socket paused with {} bytes queued", _socket, output.size());
+                input_pending = true;
+                break;
+            }
+
+            std::size_t available = 0;
+            char *tail = client_buffer.Reserve(available);
+            if (tail == nullptr) {
+                throw std::runtime_error("Command is too long");
+            }
+            if (bucket != nullptr) {
+                std::size_t allowance = limiter->Allowance(*bucket, now);
+                if (allowance == 0) {
+                    Throttle();
+                    break;
+                }
+                available = std::min(available, allowance);
+            }
+
+            ssize_t got_bytes = read(_socket, tail, available);
+            if (got_bytes == 0) {
+                // Client is done with sending, but still waits for responses
+                _logger->debug("Connection on {} socket got EOF", _socket);
+                is_reading = false;
+                break;
+            } else if (got_bytes == -1) {
+                if (errno == EINTR) {
+                    continue;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                throw std::runtime_error(std::string(strerror(errno)));
+            }
+
+            client_buffer.Commit(got_bytes);
+            bytes += got_bytes;
+            if (bucket != nullptr) {
+                limiter->TakeBytes(*bucket, got_bytes);
+            }
+            _logger->debug("Got {} bytes from socket", got_bytes);
+            Metrics::Counters::Instance().Add(Metrics::kBytesRead, got_bytes);
+        }
+    } catch (std::runtime_error &ex) {
+        _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+        is_alive = false;
+    }
+
+    // Input batch is done, push all its responses at once instead of waiting for EPOLLOUT. Connection
+    // that just gives way to others goes on with the same batch on its next turn
+    if (is_alive && !output.empty() && !yielded) {
+        DoWrite();
+    }
+}
+
+// See EdgeConnection.h
+void EdgeConnection::ProcessInput(std::size_t &commands, RateLimiter::Clock::time_point now) {
+    // Single block of data read from the socket could trigger inside actions a multiple times,
+    // for example:
+    // - read#0: [<command1 start>]
+    // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
+    // Command left by throttle may be complete with nothing else in the buffer
+    while ((!client_buffer.empty() || (command_to_execute && arg_remains == 0)) && commands < kCommandBudget) {
+        _logger->debug("Process {} bytes", client_buffer.size());
+        // There is no command yet
+        if (!command_to_execute) {
+            std::size_t parsed = 0;
+            if (parser.Parse(client_buffer.data(), client_buffer.size(), parsed)) {
+                // There is no command to be launched, continue to parse input stream
+                // Here we are, current chunk finished some command, process it
+                _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
+                command_to_execute = parser.Build(arg_remains);
+                if (arg_remains > MemoryBudget::kArgumentLimit) {
+                    throw std::runtime_error("Value is too large");
+                }
+                if (arg_remains > 0) {
+                    arg_remains += 2;
+                }
+            }
+
+            // Parsed might fails to consume any bytes from input stream. In real life that could happens,
+            // for example, because we are working with UTF-16 chars and only 1 byte left in stream
+            if (parsed == 0) {
+                break;
+            } else {
+                client_buffer.Consume(parsed);
+            }
+        }
+
+        // There is command, but we still wait for argument to arrive...
+        if (command_to_execute && arg_remains > 0) {
+            _logger->debug("Fill argument: {} bytes of {}", client_buffer.size(), arg_remains);
+            // There is some parsed command, and now we are reading argument
+            std::size_t to_read = std::min(arg_remains, client_buffer.size());
+            argument_for_command.append(client_buffer.data(), to_read);
+
+            client_buffer.Consume(to_read);
+            arg_remains -= to_read;
+        }
+
+        // Client out of tokens keeps command till they are refilled
+        if (command_to_execute && arg_remains == 0 && bucket != nullptr && !limiter->TakeCommand(*bucket, now)) {
+            Throttle();
+            break;
+        }
+
+        // Thre is command & argument, but subclass executes it elsewhere
+        if (command_to_execute && arg_remains == 0 && Offload()) {
+            parser.Reset();
+            read_deadline = false;
+            break;
+        }
+
+        // Thre is command & argument - RUN!
+        if (command_to_execute && arg_remains == 0) {
+            _logger->debug("Start command execution");
+
+            uint64_t started = Metrics::Latency::Instance().Start();
+            std::string result;
+            command_to_execute->Execute(*pStorage, argument_for_command, result);
+
+            // Save response
+            output.Append(result);
+            output.Append("\r\n", 2);
+            Metrics::Latency::Instance().Finish(parser.Name(), started);
+
+            // Prepare for the next command
+            command_to_execute.reset();
+            argument_for_command.resize(0);
+            parser.Reset();
+            commands++;
+
+            // Client makes progress, next command gets its own read deadline
+            read_deadline = false;
+        }
+    }
+}
+
+// See EdgeConnection.h
+void EdgeConnection::DoWrite() {
+    _logger->debug("Do write on {} socket", _socket);
+
+    while (!output.empty()) {
+        ssize_t written = output.Flush(_socket);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Edge triggered EPOLLOUT comes once socket has space again
+                break;
+            }
+
+            _logger->error("Failed to send response on descriptor {}: {}", _socket, strerror(errno));
+            is_alive = false;
+            return;
+        }
+        Metrics::Counters::Instance().Add(Metrics::kBytesWritten, written);
+    }
+}
+
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,152 @@
+#ifndef AFINA_NETWORK_COMMON_EDGE_CONNECTION_H
+#define AFINA_NETWORK_COMMON_EDGE_CONNECTION_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <sys/epoll.h>
+
+#include <afina/execute/Command.h>
+#include <network/common/InputBuffer.h>
+#include <network/common/MemoryBudget.h>
+#include <network/common/OutputQueue.h>
+#include <network/common/RateLimiter.h>
+#include <network/common/TimerWheel.h>
+#include <protocol/Parser.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+class Storage;
+
+namespace Network {
+
+/**
+ * # Edge triggered client connection
+ * Read loop shared by st_nonblock and mt_nonblock. Socket is registered in epoll once for everything with
+ * EPOLLET, so connection must drain it itself. Each wakeup reads and executes commands until EAGAIN, but no
+ * more than per wakeup budget allows, so that single heavy client can't starve others: connection that has
+ * input left reports it through hasInputReady and the server serves it again once others got their turn.
+ * Responses are sent once all commands of the batch are executed, so that pipelined requests are answered
+ * with a single writev.
+ *
+ * Client out of tokens gets throttled if connection has a rate limiter, and subclass may take a command away
+ * to execute it elsewhere, see Offload. Connection is owned by a single thread at a time, nothing here is
+ * synchronized.
+ *
+ * Subclass constructor must point _event.data.ptr and timer.data to itself, servers cast them back to their own
+ * connection type
+ */
+class EdgeConnection {
+public:
+    EdgeConnection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl);
+    virtual ~EdgeConnection();
+
+    inline bool isAlive() const { return is_alive; }
+
+    /**
+     * Connection doesn't accept new commands any more: either client closed its side or
+     * server is going down
+     */
+    inline bool isReading() const { return is_reading; }
+
+    /**
+     * There are responses that are not sent yet, or the one being executed elsewhere
+     */
+    inline bool hasPendingOutput() const { return !output.empty() || Executing(); }
+
+    /**
+     * Part of a command is received, the rest must arrive within read timeout. Client owes nothing
+     * while its command is executed elsewhere
+     */
+    inline bool hasCommandInProgress() const {
+        return !Executing() && (!client_buffer.empty() || command_to_execute);
+    }
+
+    /**
+     * Socket may have more commands that were left there by read budget or memory budget. Socket is
+     * edge triggered, so epoll won't report them again and server has to call DoRead by itself
+     */
+    inline bool hasInputReady() const {
+        return is_alive && is_reading && input_pending && !Executing() && !throttled &&
+               !MemoryBudget::Instance().OverBudget(output.size());
+    }
+
+    void Start();
+
+protected:
+    void OnError();
+
+    void OnClose();
+
+    /**
+     * Reads and executes commands available on the socket, see class description
+     */
+    void DoRead();
+
+    void DoWrite();
+
+    /**
+     * Stop reading new commands, already queued responses are still to be sent
+     */
+    void StopReading();
+
+    /**
+     * Called with a complete command before it is executed inline. Returns true if command was taken away,
+     * connection then does nothing else until Executing turns false
+     */
+    virtual bool Offload() { return false; }
+
+    /**
+     * Command taken by Offload is not done yet
+     */
+    virtual bool Executing() const { return false; }
+
+    // Client is out of tokens, stop till server resumes connection
+    void Throttle();
+
+    int _socket;
+    struct epoll_event _event;
+
+    bool is_alive = true;
+    bool is_reading = true;
+
+    // Socket wasn't read till EAGAIN, and connection is queued in the server ready list
+    bool input_pending = false;
+    bool in_ready_list = false;
+
+    std::shared_ptr<spdlog::logger> _logger;
+
+    InputBuffer client_buffer;
+    std::size_t arg_remains;
+    Protocol::Parser parser;
+    std::string argument_for_command;
+    std::unique_ptr<Execute::Command> command_to_execute;
+    std::shared_ptr<Afina::Storage> pStorage;
+
+    // Idle or read deadline, owned by the server timer wheel
+    TimerWheel::Timer timer;
+    bool read_deadline = false;
+
+    // Responses of all commands read so far, flushed once whole input batch is processed
+    OutputQueue output;
+
+    // Tokens of the client, nullptr if there are no limits
+    RateLimiter *limiter = nullptr;
+    RateLimiter::Bucket *bucket = nullptr;
+
+    // Out of tokens, server resumes connection once bucket is refilled
+    bool throttled = false;
+
+private:
+    // Executes complete commands received so far, while commands budget and client tokens allow
+    void ProcessInput(std::size_t &commands, RateLimiter::Clock::time_point now);
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_EDGE_CONNECTION_H
@@ -0,0 +1,188 @@
+#include "Handoff.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+
+namespace {
+
+sockaddr_un make_address(const std::string &path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Handoff socket path is too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    return addr;
+}
+
+} // namespace
+
+constexpr std::size_t Handoff::kMaxSockets;
+
+// See Handoff.h
+int Handoff::Listen(const std::string &path) {
+    sockaddr_un addr = make_address(path);
+
+    int s = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (s == -1) {
+        throw std::runtime_error("Failed to open handoff socket: " + std::string(strerror(errno)));
+    }
+
+    unlink(path.c_str());
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        close(s);
+        throw std::runtime_error("Handoff socket bind() failed: " + std::string(strerror(errno)));
+    }
+
+    if (listen(s, 1) == -1) {
+        close(s);
+        throw std::runtime_error("Handoff socket listen() failed: " + std::string(strerror(errno)));
+    }
+    return s;
+}
+
+// See Handoff.h
+int Handoff::Connect(const std::string &path) {
+    sockaddr_un addr = make_address(path);
+
+    int s = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (s == -1) {
+        throw std::runtime_error("Failed to open handoff socket: " + std::string(strerror(errno)));
+    }
+
+    if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        int err = errno;
+        close(s);
+        if (err == ENOENT || err == ECONNREFUSED) {
+            return -1;
+        }
+        throw std::runtime_error("Handoff socket connect() failed: " + std::string(strerror(err)));
+    }
+    return s;
+}
+
+// See Handoff.h
+void Handoff::Send(int channel, const std::vector<int> &sockets) {
+    if (sockets.size() > kMaxSockets) {
+        throw std::runtime_error("Too many sockets to hand over");
+    }
+
+    // Count goes as payload: message with descriptors must carry at least one byte
+    uint32_t count = sockets.size();
+    struct iovec iov;
+    iov.iov_base = &count;
+    iov.iov_len = sizeof(count);
+
+    char control[CMSG_SPACE(kMaxSockets * sizeof(int))];
+    std::memset(control, 0, sizeof(control));
+
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (!sockets.empty()) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sockets.size() * sizeof(int));
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sockets.size() * sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), sockets.data(), sockets.size() * sizeof(int));
+    }
+
+    ssize_t sent;
+    while ((sent = sendmsg(channel, &msg, MSG_NOSIGNAL)) == -1 && errno == EINTR) {
+    }
+    if (sent != sizeof(count)) {
+        throw std::runtime_error("Failed to send sockets: " + std::string(strerror(errno)));
+    }
+}
+
+// See Handoff.h
+std::vector<int> Handoff::Receive(int channel) {
+    uint32_t count = 0;
+    struct iovec iov;
+    iov.iov_base = &count;
+    iov.iov_len = sizeof(count);
+
+    char control[CMSG_SPACE(kMaxSockets * sizeof(int))];
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t got;
+    while ((got = recvmsg(channel, &msg, MSG_CMSG_CLOEXEC)) == -1 && errno == EINTR) {
+    }
+    if (got != sizeof(count)) {
+        throw std::runtime_error("Failed to receive sockets: " +
+                                 std::string(got == -1 ? strerror(errno) : "channel closed"));
+    }
+
+    std::vector<int> sockets;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        std::size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const char *data = reinterpret_cast<const char *>(CMSG_DATA(cmsg));
+        for (std::size_t i = 0; i < n; i++) {
+            int s;
+            std::memcpy(&s, data + i * sizeof(int), sizeof(int));
+            sockets.push_back(s);
+        }
+    }
+
+    if ((msg.msg_flags & MSG_CTRUNC) || sockets.size() != count) {
+        for (int s : sockets) {
+            close(s);
+        }
+        throw std::runtime_error("Sockets were lost in handoff");
+    }
+    return sockets;
+}
+
+// See Handoff.h
+void Handoff::Confirm(int channel) {
+    char ack = 1;
+    ssize_t sent;
+    while ((sent = send(channel, &ack, 1, MSG_NOSIGNAL)) == -1 && errno == EINTR) {
+    }
+    if (sent != 1) {
+        throw std::runtime_error("Failed to confirm handoff: " + std::string(strerror(errno)));
+    }
+}
+
+// See Handoff.h
+bool Handoff::WaitConfirm(int channel, int timeout_ms) {
+    struct pollfd pfd;
+    pfd.fd = channel;
+    pfd.events = POLLIN;
+
+    int ready;
+    while ((ready = poll(&pfd, 1, timeout_ms)) == -1 && errno == EINTR) {
+    }
+    if (ready <= 0) {
+        return false;
+    }
+
+    char ack = 0;
+    return recv(channel, &ack, 1, 0) == 1 && ack == 1;
+}
+
+} // namespace Network
+} // namespace Afina
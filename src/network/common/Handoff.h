@@ -0,0 +1,62 @@
+#ifndef AFINA_NETWORK_COMMON_HANDOFF_H
+#define AFINA_NETWORK_COMMON_HANDOFF_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Listening sockets handoff
+ * Graceful restart support. Running process waits for its successor on a unix socket, successor
+ * connects, receives listening sockets as SCM_RIGHTS and confirms once it accepts on them. Only after
+ * that the old process stops accepting and drains its connections. Listening sockets are never closed
+ * in between, so kernel keeps queueing connections and nobody is refused during deploy.
+ *
+ * Exchange on the channel:
+ * - old -> new: socket count and descriptors in a single message
+ * - new -> old: single confirmation byte, EOF means successor failed and old process keeps serving
+ */
+class Handoff {
+public:
+    // Upper bound of descriptors passed in one message
+    static constexpr std::size_t kMaxSockets = 64;
+
+    /**
+     * Binds unix socket to wait for successor on, stale socket file left by previous process is replaced
+     */
+    static int Listen(const std::string &path);
+
+    /**
+     * Connects to process waiting on the given path. Returns -1 if nobody waits there
+     */
+    static int Connect(const std::string &path);
+
+    /**
+     * Passes descriptors over unix socket, they stay open in the sender as well
+     */
+    static void Send(int channel, const std::vector<int> &sockets);
+
+    /**
+     * Receives descriptors sent by Send, they are CLOEXEC in receiver
+     */
+    static std::vector<int> Receive(int channel);
+
+    /**
+     * Successor side: tells that sockets are taken over
+     */
+    static void Confirm(int channel);
+
+    /**
+     * Predecessor side: waits for confirmation no longer than timeout_ms. Returns false if successor
+     * closed channel, failed or timed out
+     */
+    static bool WaitConfirm(int channel, int timeout_ms);
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_HANDOFF_H
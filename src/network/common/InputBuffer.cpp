@@ -0,0 +1,81 @@
+#include "InputBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "MemoryBudget.h"
+
+namespace Afina {
+namespace Network {
+
+constexpr std::size_t InputBuffer::kInitialSize;
+
+// See InputBuffer.h
+InputBuffer::InputBuffer(std::size_t max_size)
+    : _capacity(0), _max_size(std::max(max_size, kInitialSize)), _begin(0), _end(0) {}
+
+// See InputBuffer.h
+InputBuffer::~InputBuffer() { MemoryBudget::Instance().Release(_capacity); }
+
+// See InputBuffer.h
+void InputBuffer::Consume(std::size_t n) {
+    _begin += n;
+    if (_begin == _end) {
+        _begin = _end = 0;
+
+        // Large command is gone, no need to keep memory for it
+        if (_capacity > kInitialSize) {
+            MemoryBudget::Instance().Release(_capacity);
+            _buffer.reset();
+            _capacity = 0;
+        }
+    }
+}
+
+// See InputBuffer.h
+char *InputBuffer::Reserve(std::size_t &available) {
+    if (_capacity == 0) {
+        _buffer.reset(new char[kInitialSize]);
+        _capacity = kInitialSize;
+        MemoryBudget::Instance().Acquire(_capacity);
+    }
+
+    if (_end == _capacity && _begin > 0) {
+        // Tail is exhausted, move unparsed remainder to the start
+        std::memmove(_buffer.get(), _buffer.get() + _begin, _end - _begin);
+        _end -= _begin;
+        _begin = 0;
+    } else if (_end == _capacity && _capacity < _max_size) {
+        // Remainder occupies whole buffer
+        std::size_t capacity = std::min(_capacity * 2, _max_size);
+        std::unique_ptr<char[]> buffer(new char[capacity]);
+        std::memcpy(buffer.get(), _buffer.get(), _end);
+        _buffer.swap(buffer);
+        MemoryBudget::Instance().Acquire(capacity - _capacity);
+        _capacity = capacity;
+    }
+
+    available = _capacity - _end;
+    return available > 0 ? _buffer.get() + _end : nullptr;
+}
+
+// See InputBuffer.h
+bool InputBuffer::Append(const char *data, std::size_t size) {
+    while (size > 0) {
+        std::size_t available = 0;
+        char *tail = Reserve(available);
+        if (tail == nullptr) {
+            return false;
+        }
+
+        std::size_t chunk = std::min(size, available);
+        std::memcpy(tail, data, chunk);
+        Commit(chunk);
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+} // namespace Network
+} // namespace Afina
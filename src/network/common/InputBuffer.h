@@ -0,0 +1,75 @@
+#ifndef AFINA_NETWORK_COMMON_INPUT_BUFFER_H
+#define AFINA_NETWORK_COMMON_INPUT_BUFFER_H
+
+#include <cstddef>
+#include <memory>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Connection input buffer
+ * Bytes received from the socket and not yet consumed by the parser are in [begin, end). Parser
+ * consumes data by moving begin forward, so there is no data shuffling per command. Unparsed
+ * remainder is moved to the buffer start only once there is no more free space at the tail, and
+ * buffer is grown if remainder occupies it completely, up to the given limit.
+ *
+ * Memory is allocated on the first read and released once buffer gets empty after it was grown,
+ * so idle connections cost nothing above initial size. Memory held is reported to MemoryBudget.
+ */
+class InputBuffer {
+public:
+    static constexpr std::size_t kInitialSize = 4096;
+
+    /**
+     * @param max_size buffer never grows above that, single command line must fit in it
+     */
+    explicit InputBuffer(std::size_t max_size = 1 << 20);
+    ~InputBuffer();
+
+    /**
+     * Unparsed bytes
+     */
+    inline const char *data() const { return _buffer.get() + _begin; }
+    inline std::size_t size() const { return _end - _begin; }
+    inline bool empty() const { return _begin == _end; }
+
+    /**
+     * Parser is done with the first n bytes
+     */
+    void Consume(std::size_t n);
+
+    /**
+     * Returns free space to receive data into, its size is stored in available. Compacts or grows
+     * buffer if there is no space at the tail. Returns nullptr if buffer is full and can't grow
+     */
+    char *Reserve(std::size_t &available);
+
+    /**
+     * Appends n bytes received into the space returned by Reserve
+     */
+    inline void Commit(std::size_t n) { _end += n; }
+
+    /**
+     * Copies data into the buffer, returns false if it doesn't fit under the limit
+     */
+    bool Append(const char *data, std::size_t size);
+
+    inline std::size_t capacity() const { return _capacity; }
+
+private:
+    InputBuffer(const InputBuffer &) = delete;
+    InputBuffer &operator=(const InputBuffer &) = delete;
+
+    std::unique_ptr<char[]> _buffer;
+    std::size_t _capacity;
+    std::size_t _max_size;
+
+    std::size_t _begin;
+    std::size_t _end;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_INPUT_BUFFER_H
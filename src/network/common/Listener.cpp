@@ -0,0 +1,311 @@
+#include "Listener.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+
+namespace {
+
+const char kUnixPrefix[] = "unix:";
+
+// Socket file of a process that is gone still exists, but refuses connections
+bool is_served(const struct sockaddr_un *un, socklen_t len) {
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (probe == -1) {
+        return true;
+    }
+    bool served = connect(probe, reinterpret_cast<const struct sockaddr *>(un), len) == 0 || errno != ECONNREFUSED;
+    close(probe);
+    return served;
+}
+
+uint16_t parse_port(const std::string &spec, const std::string &port) {
+    if (port.empty() || port.size() > 5 || port.find_first_not_of("0123456789") != std::string::npos) {
+        throw std::runtime_error("Invalid port in listen address: " + spec);
+    }
+    unsigned long value = std::stoul(port);
+    if (value == 0 || value > 65535) {
+        throw std::runtime_error("Invalid port in listen address: " + spec);
+    }
+    return uint16_t(value);
+}
+
+} // namespace
+
+// See Listener.h
+bool Listener::Address::CanReusePort() const { return addr.ss_family != AF_UNIX; }
+
+// See Listener.h
+std::string Listener::Address::ToString() const {
+    char host[INET6_ADDRSTRLEN];
+    if (addr.ss_family == AF_INET) {
+        auto in = reinterpret_cast<const struct sockaddr_in *>(&addr);
+        inet_ntop(AF_INET, &in->sin_addr, host, sizeof(host));
+        return std::string(host) + ":" + std::to_string(ntohs(in->sin_port));
+    } else if (addr.ss_family == AF_INET6) {
+        auto in6 = reinterpret_cast<const struct sockaddr_in6 *>(&addr);
+        inet_ntop(AF_INET6, &in6->sin6_addr, host, sizeof(host));
+        return "[" + std::string(host) + "]:" + std::to_string(ntohs(in6->sin6_port));
+    } else if (addr.ss_family == AF_UNIX) {
+        auto un = reinterpret_cast<const struct sockaddr_un *>(&addr);
+        std::size_t path_len = len - offsetof(struct sockaddr_un, sun_path);
+        if (path_len > 0 && un->sun_path[0] == '\0') {
+            return kUnixPrefix + std::string("@") + std::string(un->sun_path + 1, path_len - 1);
+        }
+        return kUnixPrefix + std::string(un->sun_path, strnlen(un->sun_path, path_len));
+    }
+    return "unknown";
+}
+
+// See Listener.h
+bool Listener::Address::operator==(const Address &other) const {
+    return len == other.len && std::memcmp(&addr, &other.addr, len) == 0;
+}
+
+// See Listener.h
+Listener::Address Listener::Parse(const std::string &spec) {
+    Address address;
+    std::memset(&address.addr, 0, sizeof(address.addr));
+
+    if (spec.compare(0, sizeof(kUnixPrefix) - 1, kUnixPrefix) == 0) {
+        std::string path = spec.substr(sizeof(kUnixPrefix) - 1);
+        auto un = reinterpret_cast<struct sockaddr_un *>(&address.addr);
+        if (path.empty() || path == "@" || path.size() >= sizeof(un->sun_path)) {
+            throw std::runtime_error("Invalid unix socket path in listen address: " + spec);
+        }
+
+        // Abstract socket name starts with zero byte and isn't terminated
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, path.data(), path.size());
+        address.len = offsetof(struct sockaddr_un, sun_path) + path.size();
+        if (path[0] == '@') {
+            un->sun_path[0] = '\0';
+        } else {
+            address.len++;
+        }
+        return address;
+    }
+
+    // IPv6 address is bracketed, so that its colons are not taken for the port separator
+    std::string host, port;
+    std::size_t colon = spec.rfind(':');
+    if (!spec.empty() && spec[0] == '[') {
+        std::size_t bracket = spec.find(']');
+        if (bracket == std::string::npos || colon != bracket + 1) {
+            throw std::runtime_error("Invalid IPv6 listen address: " + spec);
+        }
+        host = spec.substr(1, bracket - 1);
+        port = spec.substr(colon + 1);
+
+        auto in6 = reinterpret_cast<struct sockaddr_in6 *>(&address.addr);
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(parse_port(spec, port));
+        if (inet_pton(AF_INET6, host.c_str(), &in6->sin6_addr) != 1) {
+            throw std::runtime_error("Invalid IPv6 listen address: " + spec);
+        }
+        address.len = sizeof(struct sockaddr_in6);
+        return address;
+    }
+
+    if (colon != std::string::npos) {
+        host = spec.substr(0, colon);
+        port = spec.substr(colon + 1);
+    } else {
+        port = spec;
+    }
+
+    auto in = reinterpret_cast<struct sockaddr_in *>(&address.addr);
+    in->sin_family = AF_INET;
+    in->sin_port = htons(parse_port(spec, port));
+    if (host.empty()) {
+        in->sin_addr.s_addr = INADDR_ANY;
+    } else if (inet_pton(AF_INET, host.c_str(), &in->sin_addr) != 1) {
+        throw std::runtime_error("Invalid IPv4 listen address: " + spec);
+    }
+    address.len = sizeof(struct sockaddr_in);
+    return address;
+}
+
+// See Listener.h
+std::vector<Listener::Address> Listener::Parse(const std::vector<std::string> &specs, uint16_t port) {
+    std::vector<Address> result;
+    if (specs.empty()) {
+        result.push_back(Parse(std::to_string(port)));
+    }
+    for (auto &spec : specs) {
+        result.push_back(Parse(spec));
+    }
+    return result;
+}
+
+// See Listener.h
+Listener::Address Listener::Local(int socket) {
+    Address address;
+    std::memset(&address.addr, 0, sizeof(address.addr));
+    address.len = sizeof(address.addr);
+    if (getsockname(socket, reinterpret_cast<struct sockaddr *>(&address.addr), &address.len) == -1) {
+        throw std::runtime_error("Socket getsockname() failed: " + std::string(strerror(errno)));
+    }
+    return address;
+}
+
+// See Listener.h
+int Listener::Open(const Address &address, bool non_blocking, bool reuse_port) {
+    const int family = address.addr.ss_family;
+    int server_socket = socket(family, SOCK_STREAM | SOCK_CLOEXEC | (non_blocking ? SOCK_NONBLOCK : 0), 0);
+    if (server_socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    // Restarted server binds the port while connections of the previous one are in TIME_WAIT
+    int opts = 1;
+    if (family != AF_UNIX) {
+        if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1 ||
+            setsockopt(server_socket, SOL_SOCKET, SO_KEEPALIVE, &opts, sizeof(opts)) == -1 ||
+            (family == AF_INET6 && setsockopt(server_socket, IPPROTO_IPV6, IPV6_V6ONLY, &opts, sizeof(opts)) == -1)) {
+            close(server_socket);
+            throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+        }
+    }
+
+    if (reuse_port && setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt(SO_REUSEPORT) failed: " + std::string(strerror(errno)));
+    }
+
+    // Socket file of a process that crashed is replaced. Running server keeps its address, anything else is kept
+    if (family == AF_UNIX) {
+        auto un = reinterpret_cast<const struct sockaddr_un *>(&address.addr);
+        struct stat st;
+        if (un->sun_path[0] != '\0' && lstat(un->sun_path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+            if (is_served(un, address.len)) {
+                close(server_socket);
+                throw std::runtime_error("Socket bind() to " + address.ToString() + " failed: address in use");
+            }
+            unlink(un->sun_path);
+        }
+    }
+
+    if (bind(server_socket, reinterpret_cast<const struct sockaddr *>(&address.addr), address.len) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket bind() to " + address.ToString() + " failed: " + strerror(errno));
+    }
+
+    if (listen(server_socket, kBacklog) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    }
+    return server_socket;
+}
+
+// See Listener.h
+std::vector<int> Listener::Open(const std::vector<Address> &addresses, bool non_blocking, std::size_t count) {
+    std::vector<int> result;
+    try {
+        for (auto &address : addresses) {
+            bool reuse_port = address.CanReusePort() && count > 1;
+            for (std::size_t i = 0; i < (reuse_port ? count : 1); i++) {
+                result.push_back(Open(address, non_blocking, reuse_port));
+            }
+        }
+    } catch (...) {
+        for (int s : result) {
+            Close(s);
+        }
+        throw;
+    }
+    return result;
+}
+
+// See Listener.h
+void Listener::Close(int socket) {
+    struct sockaddr_un un;
+    socklen_t len = sizeof(un);
+    bool named = getsockname(socket, reinterpret_cast<struct sockaddr *>(&un), &len) == 0 && un.sun_family == AF_UNIX &&
+                 len > offsetof(struct sockaddr_un, sun_path) && un.sun_path[0] != '\0';
+    close(socket);
+
+    // Process the socket was handed over to still accepts on it, file is its now
+    if (named && !is_served(&un, len)) {
+        unlink(un.sun_path);
+    }
+}
+
+// See Listener.h
+std::vector<std::vector<int>> Listener::Distribute(const std::vector<int> &sockets, std::size_t workers) {
+    std::vector<std::pair<Address, std::vector<int>>> groups;
+    std::size_t n_workers = std::max<std::size_t>(workers, 1);
+    for (int s : sockets) {
+        Address address = Local(s);
+        auto it = std::find_if(groups.begin(), groups.end(), [&address](const std::pair<Address, std::vector<int>> &g) {
+            return g.first == address;
+        });
+        if (it == groups.end()) {
+            groups.emplace_back(address, std::vector<int>());
+            it = groups.end() - 1;
+        }
+        it->second.push_back(s);
+        n_workers = std::max(n_workers, it->second.size());
+    }
+
+    std::vector<std::vector<int>> result(n_workers);
+    for (std::size_t i = 0; i < n_workers; i++) {
+        for (auto &group : groups) {
+            result[i].push_back(group.second[i % group.second.size()]);
+        }
+    }
+    return result;
+}
+
+// See Listener.h
+int Listener::Accept(const std::vector<int> &sockets, struct sockaddr_storage *addr, socklen_t *len) {
+    std::vector<struct pollfd> fds(sockets.size());
+    for (std::size_t i = 0; i < sockets.size(); i++) {
+        fds[i].fd = sockets[i];
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+
+    if (poll(fds.data(), fds.size(), -1) == -1) {
+        return -1;
+    }
+    for (auto &fd : fds) {
+        if (fd.revents & POLLIN) {
+            int client_socket = accept4(fd.fd, reinterpret_cast<struct sockaddr *>(addr), len, SOCK_CLOEXEC);
+            if (client_socket != -1) {
+                return client_socket;
+            }
+        }
+    }
+    return -1;
+}
+
+// See Listener.h
+void Listener::SetNonBlocking(int socket, bool non_blocking) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    if (flags == -1) {
+        throw std::runtime_error("Failed to call fcntl to get socket flags");
+    }
+
+    flags = non_blocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    if (fcntl(socket, F_SETFL, flags) == -1) {
+        throw std::runtime_error("Failed to call fcntl to set socket flags");
+    }
+}
+
+} // namespace Network
+} // namespace Afina
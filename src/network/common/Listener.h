@@ -0,0 +1,101 @@
+#ifndef AFINA_NETWORK_COMMON_LISTENER_H
+#define AFINA_NETWORK_COMMON_LISTENER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Listening sockets
+ * Server accepts on any number of stream sockets, each one is bound to an address given as:
+ * - "8080" or ":8080": port on all IPv4 interfaces
+ * - "127.0.0.1:8080": IPv4 address and port
+ * - "[::1]:8080", "[::]:8080": IPv6 address and port, socket accepts IPv6 connections only
+ * - "unix:/run/afina.sock": unix socket file, removed by Close. File left by crashed process is replaced, the one
+ *   of running server is not
+ * - "unix:@afina": unix socket in the abstract namespace, it has no file and is gone with the last socket
+ *
+ * Unix sockets skip TCP/IP stack entirely, so co-located clients get noticeably lower latency
+ */
+class Listener {
+public:
+    // Connections waiting to be accepted, kernel caps it with net.core.somaxconn
+    static constexpr int kBacklog = 1024;
+
+    struct Address {
+        struct sockaddr_storage addr;
+        socklen_t len = 0;
+
+        /**
+         * Kernel balances connections between SO_REUSEPORT sockets bound to the same address, unix
+         * sockets can't be bound twice
+         */
+        bool CanReusePort() const;
+
+        std::string ToString() const;
+
+        bool operator==(const Address &other) const;
+    };
+
+    /**
+     * Parses address in one of the forms above, throws std::runtime_error if it is malformed
+     */
+    static Address Parse(const std::string &spec);
+
+    /**
+     * Parses all given addresses, port on all IPv4 interfaces if there are none
+     */
+    static std::vector<Address> Parse(const std::vector<std::string> &specs, uint16_t port);
+
+    /**
+     * Address the socket is bound to
+     */
+    static Address Local(int socket);
+
+    /**
+     * Opens stream socket listening on the address. With reuse_port several sockets could be bound to the same
+     * address and kernel balances incoming connections between them
+     */
+    static int Open(const Address &address, bool non_blocking, bool reuse_port);
+
+    /**
+     * Opens given number of sockets for each address that supports SO_REUSEPORT and a single one for the
+     * rest. Sockets opened are closed if any of them fails
+     */
+    static std::vector<int> Open(const std::vector<Address> &addresses, bool non_blocking, std::size_t count);
+
+    /**
+     * Closes listening socket. Its unix socket file is removed unless somebody still accepts on it, like the
+     * process the socket was handed over to
+     */
+    static void Close(int socket);
+
+    /**
+     * Distributes listening sockets between workers, so that every worker gets a socket for each address.
+     * Address bound by several sockets gives them out round robin, single socket is shared by all workers.
+     * Returns at least the given number of workers, more if some address has more sockets than that
+     */
+    static std::vector<std::vector<int>> Distribute(const std::vector<int> &sockets, std::size_t workers);
+
+    /**
+     * Blocks until connection arrives on any of non blocking sockets and accepts it. Returns -1 if woken up
+     * without connection, for example once sockets are shut down
+     */
+    static int Accept(const std::vector<int> &sockets, struct sockaddr_storage *addr, socklen_t *len);
+
+    /**
+     * Switches O_NONBLOCK of the socket taken over from another process
+     */
+    static void SetNonBlocking(int socket, bool non_blocking);
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_LISTENER_H
@@ -0,0 +1,61 @@
+#ifndef AFINA_NETWORK_COMMON_MAILBOX_H
+#define AFINA_NETWORK_COMMON_MAILBOX_H
+
+#include <atomic>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Multi producer single consumer mailbox
+ * Lock free intrusive stack: any thread pushes with a single CAS, owner takes everything at once with a
+ * single exchange and gets items back in the order they were pushed. Item must have `T *mailbox_next`
+ * member, which belongs to the mailbox while item is in it.
+ *
+ * Push reports whether mailbox was empty, so producer wakes consumer up only once per batch: consumer is
+ * expected to TakeAll after every wakeup.
+ */
+template <typename T> class Mailbox {
+public:
+    Mailbox() : _head(nullptr) {}
+
+    /**
+     * Returns true if mailbox was empty, i.e consumer needs to be woken up
+     */
+    bool Push(T *item) {
+        T *head = _head.load(std::memory_order_relaxed);
+        do {
+            item->mailbox_next = head;
+        } while (!_head.compare_exchange_weak(head, item, std::memory_order_release, std::memory_order_relaxed));
+        return head == nullptr;
+    }
+
+    /**
+     * Takes all items, returns first pushed one, the rest are linked through mailbox_next
+     */
+    T *TakeAll() {
+        T *head = _head.exchange(nullptr, std::memory_order_acquire);
+
+        T *first = nullptr;
+        while (head != nullptr) {
+            T *next = head->mailbox_next;
+            head->mailbox_next = first;
+            first = head;
+            head = next;
+        }
+        return first;
+    }
+
+    inline bool empty() const { return _head.load(std::memory_order_relaxed) == nullptr; }
+
+private:
+    Mailbox(const Mailbox &) = delete;
+    Mailbox &operator=(const Mailbox &) = delete;
+
+    std::atomic<T *> _head;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_MAILBOX_H
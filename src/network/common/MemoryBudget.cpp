@@ -0,0 +1,19 @@
+#include "MemoryBudget.h"
+
+namespace Afina {
+namespace Network {
+
+constexpr std::size_t MemoryBudget::kOutputLimit;
+constexpr std::size_t MemoryBudget::kArgumentLimit;
+
+// See MemoryBudget.h
+MemoryBudget &MemoryBudget::Instance() {
+    static MemoryBudget instance;
+    return instance;
+}
+
+// See MemoryBudget.h
+MemoryBudget::MemoryBudget() : _used(0), _limit(256 << 20) {}
+
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,61 @@
+#ifndef AFINA_NETWORK_COMMON_MEMORY_BUDGET_H
+#define AFINA_NETWORK_COMMON_MEMORY_BUDGET_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Connection buffers memory accounting
+ * Input and output buffers of all connections report memory they hold here. Once total goes above
+ * the limit, connections having responses queued stop reading new commands until their output is
+ * sent, so that clients which don't take responses can't make server grow without bound.
+ *
+ * Buffers are accounted in large chunks only (block or buffer allocation), so counter is not
+ * touched per command.
+ */
+class MemoryBudget {
+public:
+    // Per connection budgets: responses queued and size of a single value in a storage command
+    static constexpr std::size_t kOutputLimit = 1 << 20;
+    static constexpr std::size_t kArgumentLimit = 1 << 20;
+
+    /**
+     * Budget shared by all connections of the process
+     */
+    static MemoryBudget &Instance();
+
+    /**
+     * Sets ceiling for all connection buffers together, in bytes
+     */
+    inline void SetLimit(std::size_t limit) { _limit.store(limit, std::memory_order_relaxed); }
+
+    inline void Acquire(std::size_t n) { _used.fetch_add(n, std::memory_order_relaxed); }
+    inline void Release(std::size_t n) { _used.fetch_sub(n, std::memory_order_relaxed); }
+
+    inline std::size_t Used() const { return _used.load(std::memory_order_relaxed); }
+
+    inline bool Exhausted() const {
+        return _used.load(std::memory_order_relaxed) > _limit.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Connection having given number of bytes queued for sending should stop reading
+     */
+    inline bool OverBudget(std::size_t queued) const { return queued > kOutputLimit || (queued > 0 && Exhausted()); }
+
+private:
+    MemoryBudget();
+    MemoryBudget(const MemoryBudget &) = delete;
+    MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+    std::atomic<std::size_t> _used;
+    std::atomic<std::size_t> _limit;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_MEMORY_BUDGET_H
@@ -0,0 +1,172 @@
+#include "OutputQueue.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "MemoryBudget.h"
+
+namespace Afina {
+namespace Network {
+
+constexpr std::size_t OutputQueue::kBlockSize;
+
+struct OutputQueue::Block {
+    Block *next;
+
+    // Unsent data is in [begin, end)
+    std::size_t begin;
+    std::size_t end;
+
+    char data[kBlockSize];
+};
+
+namespace {
+
+/**
+ * Free blocks of the current thread. Connections are served by a single thread, so blocks are
+ * taken and returned without any synchronization
+ */
+template <typename Block> class BlockPool {
+public:
+    // Blocks above that are given back to allocator
+    static constexpr std::size_t kMaxFree = 256;
+
+    ~BlockPool() {
+        while (_free != nullptr) {
+            Block *b = _free;
+            _free = b->next;
+            delete b;
+        }
+    }
+
+    Block *Get() {
+        Block *b = _free;
+        if (b != nullptr) {
+            _free = b->next;
+            _count--;
+        } else {
+            b = new Block;
+        }
+
+        b->next = nullptr;
+        b->begin = b->end = 0;
+        MemoryBudget::Instance().Acquire(sizeof(Block));
+        return b;
+    }
+
+    void Put(Block *b) {
+        MemoryBudget::Instance().Release(sizeof(Block));
+        if (_count >= kMaxFree) {
+            delete b;
+            return;
+        }
+
+        b->next = _free;
+        _free = b;
+        _count++;
+    }
+
+private:
+    Block *_free = nullptr;
+    std::size_t _count = 0;
+};
+
+template <typename Block> BlockPool<Block> &pool() {
+    static thread_local BlockPool<Block> instance;
+    return instance;
+}
+
+} // namespace
+
+// See OutputQueue.h
+OutputQueue::OutputQueue() : _head(nullptr), _tail(nullptr), _size(0) {}
+
+// See OutputQueue.h
+OutputQueue::~OutputQueue() {
+    while (_head != nullptr) {
+        Block *b = _head;
+        _head = b->next;
+        pool<Block>().Put(b);
+    }
+}
+
+// See OutputQueue.h
+void OutputQueue::Append(const char *data, std::size_t size) {
+    _size += size;
+    while (size > 0) {
+        if (_tail == nullptr || _tail->end == kBlockSize) {
+            Block *b = pool<Block>().Get();
+            if (_tail == nullptr) {
+                _head = _tail = b;
+            } else {
+                _tail->next = b;
+                _tail = b;
+            }
+        }
+
+        std::size_t chunk = std::min(size, kBlockSize - _tail->end);
+        std::memcpy(_tail->data + _tail->end, data, chunk);
+        _tail->end += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+// See OutputQueue.h
+int OutputQueue::Fill(struct iovec *iov, int max) const {
+    int count = 0;
+    for (Block *b = _head; b != nullptr && count < max; b = b->next) {
+        if (b->end > b->begin) {
+            iov[count].iov_base = b->data + b->begin;
+            iov[count].iov_len = b->end - b->begin;
+            count++;
+        }
+    }
+    return count;
+}
+
+// See OutputQueue.h
+void OutputQueue::Advance(std::size_t n) {
+    _size -= n;
+    while (n > 0) {
+        std::size_t available = _head->end - _head->begin;
+        if (n < available) {
+            _head->begin += n;
+            break;
+        }
+
+        n -= available;
+        Block *b = _head;
+        _head = b->next;
+        if (_head == nullptr) {
+            _tail = nullptr;
+        }
+        pool<Block>().Put(b);
+    }
+
+    // Tail block is sent completely but still could be written into
+    if (_head != nullptr && _head->begin == _head->end && _head == _tail) {
+        pool<Block>().Put(_head);
+        _head = _tail = nullptr;
+    }
+}
+
+// See OutputQueue.h
+ssize_t OutputQueue::Flush(int fd) {
+    // Blocks are large, so usually there are just a few segments
+    struct iovec iov[std::min(IOV_MAX, 64)];
+    int count = Fill(iov, sizeof(iov) / sizeof(iov[0]));
+    if (count == 0) {
+        return 0;
+    }
+
+    ssize_t written = writev(fd, iov, count);
+    if (written > 0) {
+        Advance(written);
+    }
+    return written;
+}
+
+} // namespace Network
+} // namespace Afina
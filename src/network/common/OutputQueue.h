@@ -0,0 +1,71 @@
+#ifndef AFINA_NETWORK_COMMON_OUTPUT_QUEUE_H
+#define AFINA_NETWORK_COMMON_OUTPUT_QUEUE_H
+
+#include <cstddef>
+#include <string>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Connection output queue
+ * Responses are appended back to back into a chain of fixed size blocks, so many small pipelined
+ * responses share a block and go out with a single writev. Blocks are taken from a per-thread pool
+ * and returned there once sent, connection that has nothing to send owns no memory. Blocks owned
+ * by queues are reported to MemoryBudget.
+ *
+ * Data already in the queue never moves, so it is safe to hand iovecs to the kernel (io_uring) and
+ * keep appending while operation is in flight.
+ */
+class OutputQueue {
+public:
+    static constexpr std::size_t kBlockSize = 16 * 1024;
+
+    OutputQueue();
+    ~OutputQueue();
+
+    void Append(const char *data, std::size_t size);
+    inline void Append(const std::string &data) { Append(data.data(), data.size()); }
+
+    inline bool empty() const { return _size == 0; }
+
+    /**
+     * Number of bytes waiting to be sent
+     */
+    inline std::size_t size() const { return _size; }
+
+    /**
+     * Describes unsent data starting from the queue head with at most max segments, returns
+     * number of segments filled
+     */
+    int Fill(struct iovec *iov, int max) const;
+
+    /**
+     * Drops first n bytes which were sent
+     */
+    void Advance(std::size_t n);
+
+    /**
+     * Sends as much as possible with a single writev of up to IOV_MAX segments. Returns number of
+     * bytes sent or -1 with errno set just like writev does
+     */
+    ssize_t Flush(int fd);
+
+private:
+    OutputQueue(const OutputQueue &) = delete;
+    OutputQueue &operator=(const OutputQueue &) = delete;
+
+    struct Block;
+
+    Block *_head;
+    Block *_tail;
+    std::size_t _size;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_OUTPUT_QUEUE_H
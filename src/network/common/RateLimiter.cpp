@@ -0,0 +1,119 @@
+#include "RateLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <netdb.h>
+
+namespace Afina {
+namespace Network {
+
+namespace {
+
+// Bucket capacity: burst worth of the rate, but at least a single command or a decent read
+double capacity(uint64_t rate, double minimum) {
+    double burst = std::chrono::duration<double>(RateLimiter::kBurst).count();
+    return std::max(rate * burst, minimum);
+}
+
+} // namespace
+
+constexpr std::chrono::milliseconds RateLimiter::kBurst;
+
+// See RateLimiter.h
+std::string RateLimiter::Key(const struct sockaddr_storage &peer, socklen_t len, const std::string &listener) const {
+    if (_limit.key == Limit::Key::kListener) {
+        return listener;
+    }
+
+    char host[NI_MAXHOST];
+    if ((peer.ss_family == AF_INET || peer.ss_family == AF_INET6) &&
+        getnameinfo(reinterpret_cast<const struct sockaddr *>(&peer), len, host, sizeof(host), nullptr, 0,
+                    NI_NUMERICHOST) == 0) {
+        return host;
+    }
+    return "unix";
+}
+
+// See RateLimiter.h
+RateLimiter::Bucket *RateLimiter::Acquire(const std::string &key, Clock::time_point now) {
+    if (!_limit.enabled()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<Bucket> &bucket = _buckets[key];
+    if (!bucket) {
+        bucket.reset(new Bucket);
+        bucket->key = key;
+        bucket->ops = capacity(_limit.ops, 1);
+        bucket->bytes = capacity(_limit.bytes, 4096);
+        bucket->updated = now;
+    }
+    bucket->connections++;
+    return bucket.get();
+}
+
+// See RateLimiter.h
+void RateLimiter::Release(Bucket *bucket) {
+    if (bucket != nullptr && --bucket->connections == 0) {
+        _buckets.erase(bucket->key);
+    }
+}
+
+// See RateLimiter.h
+void RateLimiter::Refill(Bucket &bucket, Clock::time_point now) {
+    if (now <= bucket.updated) {
+        return;
+    }
+    double elapsed = std::chrono::duration<double>(now - bucket.updated).count();
+    bucket.updated = now;
+    if (_limit.ops > 0) {
+        bucket.ops = std::min(bucket.ops + elapsed * _limit.ops, capacity(_limit.ops, 1));
+    }
+    if (_limit.bytes > 0) {
+        bucket.bytes = std::min(bucket.bytes + elapsed * _limit.bytes, capacity(_limit.bytes, 4096));
+    }
+}
+
+// See RateLimiter.h
+bool RateLimiter::TakeCommand(Bucket &bucket, Clock::time_point now) {
+    if (_limit.ops == 0) {
+        return true;
+    }
+
+    // Bucket is refilled on every command, otherwise time passed while it was spent would be credited twice
+    Refill(bucket, now);
+    if (bucket.ops < 1) {
+        return false;
+    }
+    bucket.ops -= 1;
+    return true;
+}
+
+// See RateLimiter.h
+std::size_t RateLimiter::Allowance(Bucket &bucket, Clock::time_point now) {
+    if (_limit.bytes == 0) {
+        return std::numeric_limits<std::size_t>::max();
+    }
+
+    Refill(bucket, now);
+    return bucket.bytes < 1 ? 0 : static_cast<std::size_t>(bucket.bytes);
+}
+
+// See RateLimiter.h
+RateLimiter::Clock::duration RateLimiter::Delay(Bucket &bucket, Clock::time_point now) {
+    Refill(bucket, now);
+
+    double seconds = 0;
+    if (_limit.ops > 0 && bucket.ops < 1) {
+        seconds = std::max(seconds, (1 - bucket.ops) / _limit.ops);
+    }
+    if (_limit.bytes > 0 && bucket.bytes < 1) {
+        seconds = std::max(seconds, (1 - bucket.bytes) / _limit.bytes);
+    }
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+} // namespace Network
+} // namespace Afina
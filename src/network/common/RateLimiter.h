@@ -0,0 +1,122 @@
+#ifndef AFINA_NETWORK_COMMON_RATE_LIMITER_H
+#define AFINA_NETWORK_COMMON_RATE_LIMITER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <sys/socket.h>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Token buckets of clients
+ * Each client has a bucket of commands and a bucket of bytes, both are refilled at the configured rate and hold
+ * up to kBurst worth of it. Connection takes a token per command executed and per byte read, client out of tokens
+ * is not rejected: connection stops reading its socket till the bucket refills, so the client is slowed down by
+ * its own TCP window. Commands already in the socket are executed later, never dropped.
+ *
+ * Client is told apart either by its source address, so that all connections of a host share a bucket, or by
+ * listening address it connected to, so that a whole class of clients shares one. Clients over unix sockets have
+ * no address and share a single bucket.
+ *
+ * Limiter belongs to a single worker and is not thread safe, so admission is a couple of arithmetic operations
+ * without any lock or shared cache line. The price is that buckets are per worker: client whose connections are
+ * spread over several workers gets up to that many times the rate. Bucket is forgotten with the last connection
+ * of its client on the worker.
+ */
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Bucket holds that much of the rate, so short bursts pass without delay
+    static constexpr std::chrono::milliseconds kBurst{100};
+
+    struct Limit {
+        enum class Key { kAddress, kListener };
+
+        // Commands and bytes per second, zero is unlimited
+        uint64_t ops = 0;
+        uint64_t bytes = 0;
+
+        Key key = Key::kAddress;
+
+        inline bool enabled() const { return ops > 0 || bytes > 0; }
+    };
+
+    // Tokens of a single client, shared by all its connections on the worker
+    struct Bucket {
+        std::string key;
+        std::size_t connections = 0;
+
+        // Negative when client took more than there was, e.g. a command executed right after refill
+        double ops;
+        double bytes;
+        Clock::time_point updated;
+    };
+
+    RateLimiter() {}
+    explicit RateLimiter(const Limit &limit) : _limit(limit) {}
+
+    inline const Limit &limit() const { return _limit; }
+
+    /**
+     * Key of connection accepted from the given peer on the given listening address
+     */
+    std::string Key(const struct sockaddr_storage &peer, socklen_t len, const std::string &listener) const;
+
+    /**
+     * Bucket of the client connection belongs to, created full if client has no other connections. Returns nullptr
+     * if limits are disabled
+     */
+    Bucket *Acquire(const std::string &key, Clock::time_point now);
+
+    /**
+     * Connection is closed or moved to other worker
+     */
+    void Release(Bucket *bucket);
+
+    /**
+     * Takes a token for command, returns false if there is none and command has to wait
+     */
+    bool TakeCommand(Bucket &bucket, Clock::time_point now);
+
+    /**
+     * Bytes client could read now, zero if it has to wait
+     */
+    std::size_t Allowance(Bucket &bucket, Clock::time_point now);
+
+    /**
+     * Takes tokens for bytes read
+     */
+    inline void TakeBytes(Bucket &bucket, std::size_t bytes) {
+        if (_limit.bytes > 0) {
+            bucket.bytes -= bytes;
+        }
+    }
+
+    /**
+     * Time till client has tokens for both a command and a byte again
+     */
+    Clock::duration Delay(Bucket &bucket, Clock::time_point now);
+
+    /**
+     * Number of clients having connections on the worker
+     */
+    inline std::size_t size() const { return _buckets.size(); }
+
+private:
+    void Refill(Bucket &bucket, Clock::time_point now);
+
+    Limit _limit;
+    std::unordered_map<std::string, std::unique_ptr<Bucket>> _buckets;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_RATE_LIMITER_H
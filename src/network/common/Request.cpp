@@ -0,0 +1,65 @@
+#include "Request.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/execute/Command.h>
+#include <afina/metrics/Latency.h>
+
+#include "protocol/Parser.h"
+
+namespace Afina {
+namespace Network {
+
+// See Request.h
+void ExecuteRequest(Afina::Storage &storage, spdlog::logger &logger, const char *data, std::size_t size,
+                    std::string &out) {
+    Protocol::Parser parser;
+    try {
+        while (size > 0) {
+            std::size_t parsed = 0;
+            if (!parser.Parse(data, size, parsed)) {
+                throw std::runtime_error("Incomplete command");
+            }
+            data += parsed;
+            size -= parsed;
+
+            std::size_t arg_remains = 0;
+            std::unique_ptr<Execute::Command> command = parser.Build(arg_remains);
+
+            // Argument goes with its trailing \r\n, same as TCP servers pass it
+            std::string argument;
+            if (arg_remains > 0) {
+                arg_remains += 2;
+                if (size < arg_remains) {
+                    throw std::runtime_error("Incomplete argument");
+                }
+                argument.assign(data, arg_remains);
+                data += arg_remains;
+                size -= arg_remains;
+            }
+
+            logger.debug("Execute {} command", parser.Name());
+            uint64_t started = Metrics::Latency::Instance().Start();
+            std::string result;
+            command->Execute(storage, argument, result);
+            out.append(result);
+            out.append("\r\n");
+            Metrics::Latency::Instance().Finish(parser.Name(), started);
+
+            parser.Reset();
+        }
+    } catch (std::runtime_error &ex) {
+        logger.debug("Failed to process request: {}", ex.what());
+        out.append("CLIENT_ERROR ");
+        out.append(ex.what());
+        out.append("\r\n");
+    }
+}
+
+} // namespace Network
+} // namespace Afina
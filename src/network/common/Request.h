@@ -0,0 +1,31 @@
+#ifndef AFINA_NETWORK_COMMON_REQUEST_H
+#define AFINA_NETWORK_COMMON_REQUEST_H
+
+#include <cstddef>
+#include <string>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
+namespace Network {
+
+/**
+ * # Standalone request
+ * Request that comes as a whole and keeps no state till the next one: UDP datagram or shared memory
+ * record. Executes all commands of the request and appends their responses to out. Commands must be
+ * complete, the broken one gets CLIENT_ERROR and the rest of the request is dropped, while responses to
+ * commands executed before it are kept.
+ */
+void ExecuteRequest(Afina::Storage &storage, spdlog::logger &logger, const char *data, std::size_t size,
+                    std::string &out);
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_REQUEST_H
@@ -0,0 +1,103 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Afina {
+namespace Network {
+
+// See TimerWheel.h
+TimerWheel::Timer::~Timer() {
+    if (_wheel != nullptr) {
+        _wheel->Cancel(*this);
+    }
+}
+
+// See TimerWheel.h
+void TimerWheel::Timer::Unlink() {
+    _prev->_next = _next;
+    _next->_prev = _prev;
+    _prev = _next = nullptr;
+}
+
+// See TimerWheel.h
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, std::size_t slots, Clock::time_point now)
+    : _tick(tick), _start(now), _slots_count(slots), _slots(new Timer[slots]), _current(0), _count(0) {
+    assert(tick.count() > 0 && slots > 0);
+    for (std::size_t i = 0; i < _slots_count; i++) {
+        _slots[i]._prev = _slots[i]._next = &_slots[i];
+    }
+}
+
+// See TimerWheel.h
+TimerWheel::~TimerWheel() {
+    for (std::size_t i = 0; i < _slots_count; i++) {
+        Timer &slot = _slots[i];
+        while (slot._next != &slot) {
+            Cancel(*slot._next);
+        }
+    }
+}
+
+// See TimerWheel.h
+void TimerWheel::Schedule(Timer &timer, std::chrono::milliseconds delay, Clock::time_point now) {
+    if (timer._wheel != nullptr) {
+        timer._wheel->Cancel(timer);
+    }
+
+    // Wheel could be behind if loop was sleeping, so count from the actual time. Current tick is
+    // partially gone already, round up to be sure timer doesn't fire early
+    uint64_t ticks = delay.count() / _tick.count() + 1;
+    timer._expires = std::max(TickOf(now), _current) + ticks;
+
+    Timer &slot = _slots[timer._expires % _slots_count];
+    timer._prev = slot._prev;
+    timer._next = &slot;
+    slot._prev->_next = &timer;
+    slot._prev = &timer;
+
+    timer._wheel = this;
+    _count++;
+}
+
+// See TimerWheel.h
+void TimerWheel::Cancel(Timer &timer) {
+    if (timer._wheel != this) {
+        return;
+    }
+
+    timer.Unlink();
+    timer._wheel = nullptr;
+    _count--;
+}
+
+// See TimerWheel.h
+int TimerWheel::Timeout(Clock::time_point now) const {
+    if (_count == 0) {
+        return -1;
+    }
+
+    // Nearest slot having anything linked, timers there could belong to later rotations but
+    // waking up a bit early is harmless
+    uint64_t tick = _current + 1;
+    for (; tick < _current + _slots_count; tick++) {
+        const Timer &slot = _slots[tick % _slots_count];
+        if (slot._next != &slot) {
+            break;
+        }
+    }
+
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(_start + _tick * tick - now);
+    return left.count() > 0 ? left.count() : 0;
+}
+
+// See TimerWheel.h
+uint64_t TimerWheel::TickOf(Clock::time_point now) const {
+    if (now < _start) {
+        return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now - _start).count() / _tick.count();
+}
+
+} // namespace Network
+} // namespace Afina
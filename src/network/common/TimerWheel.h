@@ -0,0 +1,120 @@
+#ifndef AFINA_NETWORK_COMMON_TIMER_WHEEL_H
+#define AFINA_NETWORK_COMMON_TIMER_WHEEL_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Hashed timer wheel
+ * Time is split into ticks, wheel has a ring of slots and timer expiring at tick T is linked into
+ * slot T % slots. Timers are intrusive, so schedule, reschedule and cancel are just a couple of
+ * pointer updates, and each tick touches only timers of its own slot.
+ *
+ * Timer keeps absolute expiration tick, so timers further than one wheel rotation simply stay in
+ * the slot until their tick comes. Wheel is not thread safe, it belongs to a single event loop.
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Timer {
+    public:
+        Timer() : data(nullptr), _wheel(nullptr), _prev(nullptr), _next(nullptr), _expires(0) {}
+        ~Timer();
+
+        inline bool scheduled() const { return _wheel != nullptr; }
+
+        // Owner of the timer, passed back on expiration just like epoll_event::data
+        void *data;
+
+    private:
+        friend class TimerWheel;
+
+        Timer(const Timer &) = delete;
+        Timer &operator=(const Timer &) = delete;
+
+        void Unlink();
+
+        TimerWheel *_wheel;
+        Timer *_prev;
+        Timer *_next;
+        uint64_t _expires;
+    };
+
+    /**
+     * @param tick timer resolution, timer fires at most one tick later than requested
+     * @param slots number of slots in the ring
+     */
+    TimerWheel(std::chrono::milliseconds tick, std::size_t slots, Clock::time_point now = Clock::now());
+    ~TimerWheel();
+
+    /**
+     * (Re)arms timer to expire not earlier than in delay from now
+     */
+    void Schedule(Timer &timer, std::chrono::milliseconds delay, Clock::time_point now = Clock::now());
+
+    void Cancel(Timer &timer);
+
+    inline bool empty() const { return _count == 0; }
+
+    /**
+     * Milliseconds till the nearest tick having timers to process, suitable for epoll_wait.
+     * Returns -1 if there are no timers at all
+     */
+    int Timeout(Clock::time_point now = Clock::now()) const;
+
+    /**
+     * Moves wheel forward to the given time and calls on_expire(data) for every timer that is
+     * due. Timer is unlinked before the call, so callback may destroy its owner or schedule it again
+     */
+    template <typename F> void Advance(Clock::time_point now, F on_expire) {
+        uint64_t target = TickOf(now);
+
+        // If wheel wasn't moved for a whole rotation or more, each slot is visited just once
+        uint64_t last = std::min(target, _current + _slots_count);
+        while (_current < last) {
+            _current++;
+
+            Timer &slot = _slots[_current % _slots_count];
+            for (Timer *t = slot._next; t != &slot;) {
+                Timer *next = t->_next;
+                if (t->_expires <= target) {
+                    Cancel(*t);
+                    on_expire(t->data);
+                }
+                t = next;
+            }
+        }
+        _current = std::max(_current, target);
+    }
+
+private:
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    uint64_t TickOf(Clock::time_point now) const;
+
+    const std::chrono::milliseconds _tick;
+    const Clock::time_point _start;
+
+    // Slot heads, each one is a sentinel of a circular list
+    const std::size_t _slots_count;
+    std::unique_ptr<Timer[]> _slots;
+
+    // Last processed tick
+    uint64_t _current;
+
+    // Number of timers scheduled
+    std::size_t _count;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMMON_TIMER_WHEEL_H
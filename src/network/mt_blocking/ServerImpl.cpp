@@ -20,6 +20,9 @@
 #include <afina/Storage.h>
 #include <afina/execute/Command.h>
 #include <afina/logging/Service.h>
+#include <afina/metrics/Counters.h>
+#include <afina/metrics/Latency.h>
+#include <network/common/Listener.h>
 
 #include "protocol/Parser.h"
 
@@ -50,32 +53,8 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
         throw std::runtime_error("Unable to mask SIGPIPE");
     }
 
-    struct sockaddr_in server_addr;
-    std::memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;         // IPv4
-    server_addr.sin_port = htons(port);       // TCP port number
-    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
-
-    _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (_server_socket == -1) {
-        throw std::runtime_error("Failed to open socket");
-    }
-
-    int opts = 1;
-    if (setsockopt(_server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket setsockopt() failed");
-    }
-
-    if (bind(_server_socket, (struct sockaddr *) &server_addr, sizeof(server_addr)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket bind() failed");
-    }
-
-    if (listen(_server_socket, 5) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket listen() failed");
-    }
+    // Acceptor thread waits for a connection on any of non blocking sockets
+    _server_sockets = Listener::Open(Listener::Parse(listenAddresses, port), true, 1);
 
     running.store(true);
     _thread = std::thread(&ServerImpl::OnRun, this);
@@ -84,7 +63,9 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
 // See Server.h
 void ServerImpl::Stop() {
     running.store(false);
-    shutdown(_server_socket, SHUT_RDWR);
+    for (int s : _server_sockets) {
+        shutdown(s, SHUT_RDWR);
+    }
 
     for (int descriptor : client_descriptors)
         shutdown(descriptor, SHUT_RD);
@@ -95,7 +76,10 @@ void ServerImpl::Join() {
     assert(_thread.joinable());
     _thread.join();
     _executor.Stop(true);
-    close(_server_socket);
+    for (int s : _server_sockets) {
+        Listener::Close(s);
+    }
+    _server_sockets.clear();
 
 //    std::unique_lock<std::mutex> lk(one_thread_stopped);
 //    alive_workers_number.wait(lk, [this] { return this->workers == 0; });
@@ -108,12 +92,11 @@ void ServerImpl::OnRun() {
     while (running.load()) {
         _logger->debug("waiting for connection...");
 
-        // The call to accept() blocks until the incoming connection arrives
-        int client_socket;
-        struct sockaddr client_addr;
-
+        // The call blocks until the incoming connection arrives on any of listening sockets
+        struct sockaddr_storage client_addr;
         socklen_t client_addr_len = sizeof(client_addr);
-        if ((client_socket = accept(_server_socket, (struct sockaddr *) &client_addr, &client_addr_len)) == -1) {
+        int client_socket = Listener::Accept(_server_sockets, &client_addr, &client_addr_len);
+        if (client_socket == -1) {
             continue;
         }
 
@@ -122,7 +105,7 @@ void ServerImpl::OnRun() {
             std::string host = "unknown", port = "-1";
 
             char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
-            if (getnameinfo(&client_addr, client_addr_len, hbuf, sizeof(hbuf), sbuf, sizeof(sbuf),
+            if (getnameinfo((struct sockaddr *) &client_addr, client_addr_len, hbuf, sizeof(hbuf), sbuf, sizeof(sbuf),
                             NI_NUMERICHOST | NI_NUMERICSERV) == 0) {
                 host = hbuf;
                 port = sbuf;
@@ -130,11 +113,12 @@ void ServerImpl::OnRun() {
             _logger->debug("Accepted connection on descriptor {} (host={}, port={})\n", client_socket, host, port);
         }
 
-        // Configure read timeout
+        // Configure read timeout, thread blocked in read can't track command deadline, so connection
+        // is dropped once client keeps silence longer than idle timeout. Zero timeval means no timeout
         {
             struct timeval tv;
-            tv.tv_sec = 5; // TODO: make it configurable
-            tv.tv_usec = 0;
+            tv.tv_sec = idleTimeout.count() / 1000;
+            tv.tv_usec = (idleTimeout.count() % 1000) * 1000;
             setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, (const char *) &tv, sizeof tv);
         }
 
@@ -160,6 +144,9 @@ void ServerImpl::OnRun() {
 
 
 void ServerImpl::user_handler(int client_socket) {
+    Metrics::Counters &counters = Metrics::Counters::Instance();
+    counters.Add(Metrics::kTotalConnections);
+    counters.Add(Metrics::kCurrConnections);
 
     std::unique_ptr<Execute::Command> command_to_execute;
     std::string argument_for_command;
@@ -176,6 +163,7 @@ void ServerImpl::user_handler(int client_socket) {
         char client_buffer[4096];
         while ((read_bytes = read(client_socket, client_buffer, sizeof(client_buffer))) > 0) {
             _logger->debug("Got {} bytes from socket", read_bytes);
+            counters.Add(Metrics::kBytesRead, read_bytes);
 
             // Single block of data read from the socket could trigger inside actions a multiple times,
             // for example:
@@ -222,6 +210,7 @@ void ServerImpl::user_handler(int client_socket) {
                 if (command_to_execute && arg_remains == 0) {
                     _logger->debug("Start command execution");
 
+                    uint64_t started = Metrics::Latency::Instance().Start();
                     std::string result;
                     command_to_execute->Execute(*pStorage, argument_for_command, result);
 
@@ -230,6 +219,8 @@ void ServerImpl::user_handler(int client_socket) {
                     if (send(client_socket, result.data(), result.size(), 0) <= 0) {
                         throw std::runtime_error("Failed to send response");
                     }
+                    counters.Add(Metrics::kBytesWritten, result.size());
+                    Metrics::Latency::Instance().Finish(parser.Name(), started);
 
                     // Prepare for the next command
                     command_to_execute.reset();
@@ -250,6 +241,7 @@ void ServerImpl::user_handler(int client_socket) {
 
     // We are done with this connection
     close(client_socket);
+    counters.Add(Metrics::kCurrConnections, -1);
 
     {
         std::lock_guard<std::mutex> lg1(set_is_blocked);
@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <thread>
+#include <vector>
 
 #include <afina/network/Server.h>
 #include <condition_variable>
@@ -51,8 +52,8 @@ private:
     // bounds
     std::atomic<bool> running;
 
-    // Server socket to accept connections on
-    int _server_socket;
+    // Server sockets to accept connections on
+    std::vector<int> _server_sockets;
 
     // Thread to run network on
     std::thread _thread;
@@ -1,154 +1,59 @@
 #include "Connection.h"
 
-#include <iostream>
-#include <sys/socket.h>
-#include <sys/ioctl.h>
-#include <sys/socket.h>
-#include <sys/uio.h>
+#include <cassert>
+
+#include <spdlog/logger.h>
+
+#include <afina/metrics/Latency.h>
 
 namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
-// See Connection.h
-void Connection::Start() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _logger->debug("Connection on {} socket started", _socket);
-    _event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR; // без записи
-    _event.data.fd = _socket;
-    _event.data.ptr = this;
-}
+namespace {
 
-// See Connection.h
-void Connection::OnError() {
-    _logger->warn("Connection on {} socket has error", _socket);
-    is_alive.store(false);
-}
+// Commands estimated to be that expensive are executed out of the worker thread, if it has a pool
+constexpr std::size_t kOffloadCost = 64 * 1024;
 
-// See Connection.h
-void Connection::OnClose() {
-    _logger->debug("Connection on {} socket closed", _socket);
-    is_alive.store(false);
-}
+} // namespace
 
 // See Connection.h
-void Connection::DoRead() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _logger->debug("Do read on {} socket", _socket);
-    try {
-
-        int got_bytes = -1;
-        while ((got_bytes = read(_socket, client_buffer + already_read_bytes,
-                                 sizeof(client_buffer) - already_read_bytes)) > 0) {
-            already_read_bytes += got_bytes;
-            _logger->debug("Got {} bytes from socket", got_bytes);
-
-            // Single block of data read from the socket could trigger inside actions a multiple times,
-            // for example:
-            // - read#0: [<command1 start>]
-            // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
-            while (already_read_bytes > 0) {
-                _logger->debug("Process {} bytes", already_read_bytes);
-                // There is no command yet
-                if (!command_to_execute) {
-                    std::size_t parsed = 0;
-                    if (parser.Parse(client_buffer, already_read_bytes, parsed)) {
-                        // There is no command to be launched, continue to parse input stream
-                        // Here we are, current chunk finished some command, process it
-                        _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(arg_remains);
-                        if (arg_remains > 0) {
-                            arg_remains += 2;
-                        }
-                    }
-
-                    // Parsed might fails to consume any bytes from input stream. In real life that could happens,
-                    // for example, because we are working with UTF-16 chars and only 1 byte left in stream
-                    if (parsed == 0) {
-                        break;
-                    } else {
-                        std::memmove(client_buffer, client_buffer + parsed, already_read_bytes - parsed);
-                        already_read_bytes -= parsed;
-                    }
-                }
-
-                // There is command, but we still wait for argument to arrive...
-                if (command_to_execute && arg_remains > 0) {
-                    _logger->debug("Fill argument: {} bytes of {}", already_read_bytes, arg_remains);
-                    // There is some parsed command, and now we are reading argument
-                    std::size_t to_read = std::min(arg_remains, std::size_t(already_read_bytes));
-                    argument_for_command.append(client_buffer, to_read);
-
-                    std::memmove(client_buffer, client_buffer + to_read, already_read_bytes - to_read);
-                    arg_remains -= to_read;
-                    already_read_bytes -= to_read;
-                }
-
-                // Thre is command & argument - RUN!
-                if (command_to_execute && arg_remains == 0) {
-                    _logger->debug("Start command execution");
-
-                    std::string result;
-                    command_to_execute->Execute(*pStorage, argument_for_command, result);
-
-                    // Save response
-                    result += "\r\n";
-
-//                    std::lock_guard<std::mutex> lock(_mutex);
-                    answer_buf.push_back(result);
-                    _event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLOUT;
-
-
-                    // Prepare for the next command
-                    command_to_execute.reset();
-                    argument_for_command.resize(0);
-                    parser.Reset();
-                }
-            } // while (read_bytes)
-        }
-
-        is_alive.store(false);
-        if (got_bytes == 0) {
-            _logger->debug("Connection closed");
-        } else {
-            throw std::runtime_error(std::string(strerror(errno)));
-        }
-    } catch (std::runtime_error &ex) {
-        _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+bool Connection::Offload() {
+    // Thre is command & argument, but it would stall the whole worker
+    if (!can_offload || command_to_execute->Cost(argument_for_command) < kOffloadCost) {
+        return false;
     }
+    _logger->debug("Offload command execution");
+
+    offloaded = new Job;
+    offloaded->connection = this;
+    offloaded->command = std::move(command_to_execute);
+    offloaded->argument.swap(argument_for_command);
+    offloaded->name = parser.Name();
+    offloaded->started = Metrics::Latency::Instance().Start();
+    return true;
 }
 
 // See Connection.h
-void Connection::DoWrite() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _logger->debug("Do write on {} socket", _socket);
-
-    struct iovec iovecs[answer_buf.size()];
-    for (int i = 0; i < answer_buf.size(); i++) {
-        iovecs[i].iov_len = answer_buf[i].size();
-        iovecs[i].iov_base = &(answer_buf[i][0]);
-    }
-    iovecs[0].iov_base = static_cast<char *>(iovecs[0].iov_base) + cur_position;
+void Connection::OnOffloaded(Job &job) {
+    assert(offloaded == &job);
+    offloaded = nullptr;
+    in_flight = false;
 
-    int written;
-    if ((written = writev(_socket, iovecs, answer_buf.size())) <= 0) {
+    if (job.failed) {
+        _logger->error("Failed to process connection on descriptor {}: {}", _socket, job.result);
         is_alive = false;
-        throw std::runtime_error("Failed to send response");
+        return;
     }
 
-    cur_position += written;
+    output.Append(job.result);
+    output.Append("\r\n", 2);
+    Metrics::Latency::Instance().Finish(job.name, job.started);
 
-    int i = 0;
-    while ((i < answer_buf.size()) && ((cur_position - iovecs[i].iov_len) >= 0)) {
-        i++;
-        cur_position -= iovecs[i].iov_len;
+    // Rest of the batch goes on from the ready list and is sent in one go, otherwise flush right away
+    if (!hasInputReady()) {
+        DoWrite();
     }
-
-    answer_buf.erase(answer_buf.begin(), answer_buf.begin() + i);
-    if (answer_buf.empty()) {
-        _event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR; // без записи
-    }
-
 }
 
 } // namespace MTnonblock
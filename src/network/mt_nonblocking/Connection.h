@@ -3,72 +3,113 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_CONNECTION_H
 #define AFINA_NETWORK_MT_NONBLOCKING_CONNECTION_H
 
-#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
 
-#include <sys/epoll.h>
-#include <spdlog/logger.h>
 #include <afina/execute/Command.h>
-#include <protocol/Parser.h>
+#include <network/common/EdgeConnection.h>
+#include <network/common/Mailbox.h>
+#include <network/common/RateLimiter.h>
 
 namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
-class Connection {
+class Connection;
+
+// Connections out of tokens by the time they may go on, owned by worker
+using ThrottleQueue = std::multimap<RateLimiter::Clock::time_point, Connection *>;
+
+/**
+ * # Command executed on the thread pool
+ * Owns everything execution needs, so pool thread doesn't touch connection at all. Job comes back to the
+ * worker owning connection through its completion mailbox. Connection closed meanwhile detaches itself
+ * from the job, so the result is just dropped
+ */
+struct Job {
+    Connection *connection = nullptr;
+    std::unique_ptr<Execute::Command> command;
+    std::string argument;
+
+    // Command name and start time for latency metrics
+    std::string name;
+    uint64_t started = 0;
+
+    // Response, or error message if execution failed
+    std::string result;
+    bool failed = false;
+
+    // Link in the completion mailbox
+    Job *mailbox_next = nullptr;
+};
+
+/**
+ * # Client connection
+ * Belongs to exactly one Worker at a time, so all methods are called from the owning worker thread
+ * only and no synchronization required. Worker may hand connection over to other one through its
+ * mailbox, which publishes the whole connection state to the new owner.
+ *
+ * Expensive command may be executed on the thread pool, connection doesn't execute anything else
+ * until it is back, so that responses keep their order.
+ *
+ * Client that is rate limited and runs out of tokens gets throttled: connection stops reading and executing
+ * until worker resumes it, see RateLimiter
+ */
+class Connection : public EdgeConnection {
 public:
-    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl) :
-            _socket(s),
-            pStorage(std::move(ps)),
-            _logger(std::move(pl)) {
-        std::memset(&_event, 0, sizeof(struct epoll_event));
+    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl)
+        : EdgeConnection(s, std::move(ps), std::move(pl)) {
         _event.data.ptr = this;
-        is_alive.store(true);
-
-        // check if iterator is random_access
-        static_assert(std::is_same<std::iterator_traits<decltype(answer_buf.begin())>::iterator_category,
-                std::random_access_iterator_tag>::value, "requires random iterator");
+        timer.data = this;
     }
 
-    inline bool isAlive() const { return is_alive; }
-
-    void Start();
+    ~Connection() {
+        if (offloaded != nullptr && in_flight) {
+            offloaded->connection = nullptr;
+        } else {
+            delete offloaded;
+        }
+    }
 
 protected:
-    void OnError();
-
-    void OnClose();
+    /**
+     * Offloaded command is executed, queue its response and go on with input
+     */
+    void OnOffloaded(Job &job);
 
-    void DoRead();
+    // See EdgeConnection.h
+    bool Offload() override;
 
-    void DoWrite();
+    // See EdgeConnection.h
+    bool Executing() const override { return offloaded != nullptr; }
 
 private:
-    std::mutex _mutex;
-
     friend class Worker;
     friend class ServerImpl;
+    friend class Mailbox<Connection>;
 
-    int _socket;
-    struct epoll_event _event;
+    // Command which is too expensive to execute on the worker thread is passed to the thread pool
+    bool can_offload = false;
+    Job *offloaded = nullptr;
+    bool in_flight = false;
 
-    std::atomic<bool>is_alive;
-    std::shared_ptr<spdlog::logger> _logger;
+    // Client the tokens of connection belong to, see RateLimiter::Key
+    std::string client_key;
 
-    int already_read_bytes = 0;
-    char client_buffer[4096];
-    std::size_t arg_remains;
-    Protocol::Parser parser;
-    std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
-    std::shared_ptr<Afina::Storage> pStorage;
+    // Waiting in the worker throttle queue
+    bool in_throttle_queue = false;
+    ThrottleQueue::iterator throttle_it;
 
-    std::vector<std::string> answer_buf;
+    // Events processed during current balance window, see Worker::Rebalance
+    uint32_t activity = 0;
 
-    int cur_position = 0;
+    // Link in the mailbox of the worker connection migrates to
+    Connection *mailbox_next = nullptr;
 };
 
 } // namespace MTnonblock
 } // namespace Network
 } // namespace Afina
 
-#endif // AFINA_NETWORK_MT_NONBLOCKING_CONNECTION_H
\ No newline at end of file
+#endif // AFINA_NETWORK_MT_NONBLOCKING_CONNECTION_H
@@ -1,5 +1,6 @@
 #include "ServerImpl.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -9,6 +10,7 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <sched.h>
 #include <signal.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
@@ -19,7 +21,9 @@
 #include <spdlog/logger.h>
 
 #include <afina/Storage.h>
+#include <afina/concurrency/Executor.h>
 #include <afina/logging/Service.h>
+#include <network/common/Listener.h>
 
 #include "Utils.h"
 
@@ -27,8 +31,33 @@ namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
+namespace {
+
+// Commands waiting for offload threads
+constexpr int kOffloadQueue = 1024;
+
+// CPUs process may run on: taskset or cgroup cpuset may leave only a few of them, not necessarily the first ones
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+} // namespace
+
 // See Server.h
-ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, bool reuse_port,
+                       bool pin_workers, bool rebalance, uint32_t offload_threads)
+    : Server(ps, pl), _reuse_port(reuse_port), _pin_workers(pin_workers), _rebalance(rebalance),
+      _offload_threads(offload_threads) {}
 
 // See Server.h
 ServerImpl::~ServerImpl() {}
@@ -36,7 +65,6 @@ ServerImpl::~ServerImpl() {}
 // See Server.h
 void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
     _logger = pLogging->select("network");
-    _logger->info("Start st_nonblock network service");
 
     sigset_t sig_mask;
     sigemptyset(&sig_mask);
@@ -45,195 +73,103 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Unable to mask SIGPIPE");
     }
 
-    // Create server socket
-    struct sockaddr_in server_addr;
-    std::memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;         // IPv4
-    server_addr.sin_port = htons(port);       // TCP port number
-    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
-
-    _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (_server_socket == -1) {
-        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    // For each address either single socket shared by all workers or one SO_REUSEPORT socket per worker, unix
+    // sockets are always shared. Sockets taken over from the previous process are used as is, there is a worker
+    // for each socket of an address so that no accept queue is left unserved
+    n_workers = std::max<uint32_t>(n_workers, 1);
+    if (!inheritedListeners.empty()) {
+        _server_sockets.swap(inheritedListeners);
+        for (int s : _server_sockets) {
+            make_socket_non_blocking(s);
+        }
+    } else {
+        _server_sockets =
+            Listener::Open(Listener::Parse(listenAddresses, port), true, _reuse_port ? n_workers : 1);
     }
-
-    int opts = 1;
-    if (setsockopt(_server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    std::vector<std::vector<int>> worker_sockets = Listener::Distribute(_server_sockets, n_workers);
+    n_workers = worker_sockets.size();
+
+    _logger->info("Start mt_nonblock network service with {} workers{}{}, {} offload threads", n_workers,
+                  _reuse_port ? ", socket per worker" : "", _rebalance ? ", rebalancing" : "", _offload_threads);
+    if (_rate_limit.enabled()) {
+        _logger->info("Limit each {} to {} commands and {} bytes per second on every worker, zero is unlimited",
+                      _rate_limit.key == RateLimiter::Limit::Key::kAddress ? "client address" : "listener",
+                      _rate_limit.ops, _rate_limit.bytes);
     }
 
-    if (bind(_server_socket, (struct sockaddr *) &server_addr, sizeof(server_addr)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
+    // Every worker accepts connections by itself, there is no dedicated acceptors
+    if (n_acceptors > 1) {
+        _logger->debug("Acceptors are merged into workers, ignore n_acceptors={}", n_acceptors);
     }
 
-    make_socket_non_blocking(_server_socket);
-    if (listen(_server_socket, 5) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    // Pool has fixed size, queue is bounded so that overloaded pool makes workers execute commands inline
+    // instead of piling them up
+    if (_offload_threads > 0) {
+        _executor.reset(new Concurrency::Executor(_offload_threads, _offload_threads, kOffloadQueue, 1000));
+        _executor->Start(pLogging->select("network.executor"));
     }
 
-    _event_fd = eventfd(0, EFD_NONBLOCK);
-    if (_event_fd == -1) {
-        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    std::vector<int> cpus;
+    if (_pin_workers) {
+        cpus = allowed_cpus();
+        if (cpus.empty()) {
+            _logger->warn("Failed to get allowed cpus, workers are not pinned: {}", strerror(errno));
+        }
     }
 
-    _work_thread = std::thread(&ServerImpl::OnRun, this);
+    _workers.reserve(n_workers);
+    for (uint32_t i = 0; i < n_workers; i++) {
+        _workers.emplace_back(pStorage, pLogging, idleTimeout, readTimeout);
+    }
+    if (_rebalance && n_workers > 1) {
+        std::vector<Worker *> peers;
+        for (auto &worker : _workers) {
+            peers.push_back(&worker);
+        }
+        for (auto &worker : _workers) {
+            worker.SetPeers(peers);
+        }
+    }
+    for (auto &worker : _workers) {
+        worker.SetExecutor(_executor.get());
+        worker.SetRateLimit(_rate_limit);
+    }
+    for (uint32_t i = 0; i < n_workers; i++) {
+        int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+        _workers[i].Start(worker_sockets[i], cpu);
+    }
 }
 
 // See Server.h
 void ServerImpl::Stop() {
     _logger->warn("Stop network service");
 
-    // Wakeup threads that are sleep on epoll_wait
-    if (eventfd_write(_event_fd, 1)) {
-        throw std::runtime_error("Failed to wakeup workers");
-    }
-    for (auto client : client_connections) {
-        shutdown(client->_socket, SHUT_RD);
+    // Workers stop accepting and reading, but first send everything already executed
+    for (auto &worker : _workers) {
+        worker.Stop();
     }
 }
 
 // See Server.h
-void ServerImpl::Join() {
-    // Wait for work to be complete
-    _work_thread.join();
-
-    for (auto client : client_connections) {
-        close(client->_socket);
-        delete client;
-    }
+std::vector<int> ServerImpl::Listeners() const { return _server_sockets; }
 
-    client_connections.clear();
-}
-
-// See ServerImpl.h
-void ServerImpl::OnRun() {
-    _logger->info("Start acceptor");
-    int epoll_descr = epoll_create1(0);
-    if (epoll_descr == -1) {
-        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
-    }
-
-    struct epoll_event event;
-    event.events = EPOLLIN;
-    event.data.fd = _server_socket;
-    if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, _server_socket, &event)) {
-        throw std::runtime_error("Failed to add file descriptor to epoll");
-    }
-
-    struct epoll_event event2;
-    event2.events = EPOLLIN;
-    event2.data.fd = _event_fd;
-    if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, _event_fd, &event2)) {
-        throw std::runtime_error("Failed to add file descriptor to epoll");
+// See Server.h
+void ServerImpl::Join() {
+    for (auto &worker : _workers) {
+        worker.Join();
     }
 
-    bool run = true;
-    std::array<struct epoll_event, 64> mod_list;
-    while (run) {
-        int nmod = epoll_wait(epoll_descr, &mod_list[0], mod_list.size(), -1);
-        _logger->debug("Acceptor wakeup: {} events", nmod);
-
-        for (int i = 0; i < nmod; i++) {
-            struct epoll_event &current_event = mod_list[i];
-            if (current_event.data.fd == _event_fd) {
-                _logger->debug("Break acceptor due to stop signal");
-                run = false;
-                continue;
-            } else if (current_event.data.fd == _server_socket) {
-                OnNewConnection(epoll_descr);
-                continue;
-            }
-
-            // That is some connection!
-            Connection *pc = static_cast<Connection *>(current_event.data.ptr);
-
-            auto old_mask = pc->_event.events;
-            if ((current_event.events & EPOLLERR) || (current_event.events & EPOLLHUP)) {
-                pc->OnError();
-            } else if (current_event.events & EPOLLRDHUP) {
-                pc->OnClose();
-            } else {
-                // Depends on what connection wants...
-                if (current_event.events & EPOLLIN) {
-                    pc->DoRead();
-                }
-                if (current_event.events & EPOLLOUT) {
-                    pc->DoWrite();
-                }
-            }
-
-            // Does it alive?
-            if (!pc->isAlive()) {
-                if (epoll_ctl(epoll_descr, EPOLL_CTL_DEL, pc->_socket, &pc->_event)) {
-                    _logger->error("Failed to delete connection from epoll");
-                }
-
-                close(pc->_socket);
-                client_connections.erase(pc);
-                pc->OnClose();
-
-                delete pc;
-            } else if (pc->_event.events != old_mask) {
-                if (epoll_ctl(epoll_descr, EPOLL_CTL_MOD, pc->_socket, &pc->_event)) {
-                    _logger->error("Failed to change connection event mask");
-
-                    close(pc->_socket);
-                    pc->OnClose();
-
-                    delete pc;
-                }
-            }
-        }
+    // Commands still executing post their results to workers, which are destroyed after that
+    if (_executor) {
+        _executor->Stop(true);
     }
-    _logger->warn("Acceptor stopped");
-}
-
-void ServerImpl::OnNewConnection(int epoll_descr) {
-    for (;;) {
-        struct sockaddr in_addr;
-        socklen_t in_len;
-
-        // No need to make these sockets non blocking since accept4() takes care of it.
-        in_len = sizeof in_addr;
-        int infd = accept4(_server_socket, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
-        if (infd == -1) {
-            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
-                break; // We have processed all incoming connections.
-            } else {
-                _logger->error("Failed to accept socket");
-                break;
-            }
-        }
-
-        // Print host and service info.
-        char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
-        int retval =
-                getnameinfo(&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf, NI_NUMERICHOST | NI_NUMERICSERV);
-        if (retval == 0) {
-            _logger->info("Accepted connection on descriptor {} (host={}, port={})\n", infd, hbuf, sbuf);
-        }
+    _workers.clear();
+    _executor.reset();
 
-        // todo ASK cppreference.com: Return value non-null pointer
-        // Register the new FD to be monitored by epoll.
-        Connection *pc = new (std::nothrow) Connection(infd, pStorage, _logger);
-        if (pc == nullptr) {
-            throw std::runtime_error("Failed to allocate connection");
-        }
-        client_connections.insert(pc);
-
-        // Register connection in worker's epoll
-        pc->Start();
-        if (pc->isAlive()) {
-            if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
-                pc->OnError();
-                client_connections.erase(pc);
-                delete pc;
-            }
-        }
+    for (int s : _server_sockets) {
+        Listener::Close(s);
     }
+    _server_sockets.clear();
 }
 
 } // namespace MTnonblock
@@ -1,12 +1,13 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 #define AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 
+#include <memory>
 #include <thread>
 #include <vector>
 
 #include <afina/network/Server.h>
-#include <set>
-#include "Connection.h"
+
+#include "Worker.h"
 
 namespace spdlog {
 class logger;
@@ -16,18 +17,31 @@ namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
-// Forward declaration, see Worker.hseeing
-class Worker;
-
 /**
  * # Network resource manager implementation
- * Epoll based server
+ * Epoll based server, connections are accepted and served by a pool of workers each running
+ * its own epoll
  */
 class ServerImpl : public Server {
 public:
-    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    /**
+     * @param reuse_port each worker gets own SO_REUSEPORT listening socket, so kernel spreads
+     * connections between workers and nothing is shared on accept path
+     * @param pin_workers bind each worker thread to its own CPU among the ones process is allowed to run on
+     * @param rebalance let busy workers hand connections over to less loaded ones
+     * @param offload_threads size of the thread pool executing expensive commands, zero executes all
+     * commands on workers
+     */
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, bool reuse_port = false,
+               bool pin_workers = false, bool rebalance = false, uint32_t offload_threads = 0);
     ~ServerImpl();
 
+    /**
+     * Limits of each client, must be called before Start. Buckets are kept by every worker on its own, see
+     * RateLimiter
+     */
+    void SetRateLimit(const RateLimiter::Limit &limit) { _rate_limit = limit; }
+
     // See Server.h
     void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
 
@@ -37,9 +51,8 @@ public:
     // See Server.h
     void Join() override;
 
-protected:
-    void OnRun();
-    void OnNewConnection(int);
+    // See Server.h
+    std::vector<int> Listeners() const override;
 
 private:
     // logger to use
@@ -50,16 +63,27 @@ private:
     // Read-only
     uint16_t listen_port;
 
-    // Socket to accept new connection on, shared between acceptors
-    int _server_socket;
+    // Listen socket per worker in reuse port mode, otherwise single one shared by all workers
+    bool _reuse_port;
+
+    // Pin worker threads to CPUs
+    bool _pin_workers;
+
+    // Migrate connections between workers
+    bool _rebalance;
+
+    // Thread pool for expensive commands, shared by all workers
+    uint32_t _offload_threads;
+    std::unique_ptr<Concurrency::Executor> _executor;
 
-    // Custom event "device" used to wakeup workers
-    int _event_fd;
+    // Limits of each client
+    RateLimiter::Limit _rate_limit;
 
-    // IO thread
-    std::thread _work_thread;
+    // Sockets to accept new connection on
+    std::vector<int> _server_sockets;
 
-    std::set<Connection *> client_connections;
+    // Threads serving connections
+    std::vector<Worker> _workers;
 };
 
 } // namespace MTnonblock
@@ -1,6 +1,8 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_UTILS_H
 #define AFINA_NETWORK_MT_NONBLOCKING_UTILS_H
 
+#include <cstdint>
+
 namespace Afina {
 namespace Network {
 namespace MTnonblock {
@@ -1,17 +1,29 @@
 #include "Worker.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <chrono>
+#include <cstring>
 #include <functional>
-#include <iostream>
+#include <stdexcept>
 
 #include <netdb.h>
+#include <pthread.h>
+#include <sched.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <spdlog/logger.h>
 
+#include <afina/Storage.h>
+#include <afina/concurrency/Executor.h>
 #include <afina/logging/Service.h>
+#include <network/common/Listener.h>
+#include <network/common/TimerWheel.h>
 
 #include "Connection.h"
 #include "Utils.h"
@@ -20,49 +32,168 @@ namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
+namespace {
+
+// How long worker waits for clients to take queued responses once stop requested. Client
+// which doesn't read its socket must not block server shutdown forever
+constexpr std::chrono::milliseconds kDrainTimeout(5000);
+
+// Resolution of connection deadlines and size of the wheel, single rotation is about a minute
+constexpr std::chrono::milliseconds kTimerTick(250);
+constexpr std::size_t kTimerSlots = 256;
+
+// Balancing: load is measured in events per window. Worker migrates connections only if it is at least
+// one and a half times busier than average and not almost idle, at most kMaxMigrations per window
+constexpr std::chrono::milliseconds kBalanceWindow(1000);
+constexpr uint64_t kBalanceMinLoad = 1000;
+constexpr std::size_t kMaxMigrations = 32;
+
+} // namespace
+
 // See Worker.h
-Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
-    : _pStorage(ps), _pLogging(pl), isRunning(false), _epoll_fd(-1) {
-    // TODO: implementation here
-}
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
+               std::chrono::milliseconds idle_timeout, std::chrono::milliseconds read_timeout)
+    : _pStorage(ps), _pLogging(pl), isRunning(false), _epoll_fd(-1), _event_fd(-1), _cpu(-1),
+      _idle_timeout(idle_timeout), _read_timeout(read_timeout), _executor(nullptr), _window_events(0), _load(0) {}
 
 // See Worker.h
 Worker::~Worker() {
-    // TODO: implementation here
+    if (_thread.joinable()) {
+        Stop();
+        Join();
+    }
+
+    // Peers are joined as well by now, so nobody pushes into mailbox anymore
+    for (Connection *pc = _mailbox.TakeAll(); pc != nullptr;) {
+        Connection *next = pc->mailbox_next;
+        close(pc->_socket);
+        pc->OnClose();
+        delete pc;
+        pc = next;
+    }
+
+    // Executor is stopped by now, connections of these jobs are gone already
+    for (Job *job = _completions.TakeAll(); job != nullptr;) {
+        Job *next = job->mailbox_next;
+        delete job;
+        job = next;
+    }
+
+    if (_event_fd != -1) {
+        close(_event_fd);
+    }
+    if (_epoll_fd != -1) {
+        close(_epoll_fd);
+    }
 }
 
 // See Worker.h
-Worker::Worker(Worker &&other) { *this = std::move(other); }
+Worker::Worker(Worker &&other)
+    : isRunning(false), _epoll_fd(-1), _event_fd(-1), _cpu(-1), _executor(nullptr),
+      _window_events(0), _load(0) {
+    *this = std::move(other);
+}
 
 // See Worker.h
 Worker &Worker::operator=(Worker &&other) {
+    // Thread keeps pointer to the worker, so it is only possible to move worker that isn't started yet
+    assert(!_thread.joinable() && !other._thread.joinable());
+
     _pStorage = std::move(other._pStorage);
     _pLogging = std::move(other._pLogging);
     _logger = std::move(other._logger);
-    _thread = std::move(other._thread);
     _epoll_fd = other._epoll_fd;
+    _server_sockets = std::move(other._server_sockets);
+    _event_fd = other._event_fd;
+    _cpu = other._cpu;
+    _idle_timeout = other._idle_timeout;
+    _read_timeout = other._read_timeout;
+    _timers = std::move(other._timers);
+    _peers = std::move(other._peers);
+    _executor = other._executor;
+    _limiter = std::move(other._limiter);
 
     other._epoll_fd = -1;
+    other._event_fd = -1;
     return *this;
 }
 
 // See Worker.h
-void Worker::Start(int epoll_fd) {
+void Worker::Start(std::vector<int> server_sockets, int cpu) {
     if (isRunning.exchange(true) == false) {
         assert(_epoll_fd == -1);
-        _epoll_fd = epoll_fd;
         _logger = _pLogging->select("network.worker");
+        _server_sockets = std::move(server_sockets);
+        _cpu = cpu;
+
+        // Clients of a listening address share bucket on all its sockets
+        for (int s : _server_sockets) {
+            _listener_keys.push_back(Listener::Local(s).ToString());
+        }
+
+        _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (_epoll_fd == -1) {
+            throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+        }
+
+        _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_event_fd == -1) {
+            throw std::runtime_error("Failed to create event file descriptor: " + std::string(strerror(errno)));
+        }
+
+        struct epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
+            throw std::runtime_error("Failed to add event file descriptor to epoll");
+        }
+
+        // Server socket might be in epoll of each worker, exclusive wakeup avoids thundering herd
+        for (int s : _server_sockets) {
+            event.events = EPOLLIN | EPOLLEXCLUSIVE;
+            event.data.ptr = this;
+            if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, s, &event)) {
+                throw std::runtime_error("Failed to add server socket to epoll");
+            }
+        }
+
         _thread = std::thread(&Worker::OnRun, this);
     }
 }
 
 // See Worker.h
-void Worker::Stop() { isRunning = false; }
+void Worker::SetPeers(std::vector<Worker *> peers) {
+    assert(!_thread.joinable());
+    _peers = std::move(peers);
+}
+
+// See Worker.h
+void Worker::SetExecutor(Concurrency::Executor *executor) {
+    assert(!_thread.joinable());
+    _executor = executor;
+}
+
+// See Worker.h
+void Worker::SetRateLimit(const RateLimiter::Limit &limit) {
+    assert(!_thread.joinable());
+    _limiter = RateLimiter(limit);
+}
+
+// See Worker.h
+void Worker::Stop() {
+    isRunning = false;
+    if (_event_fd != -1 && eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup worker");
+    }
+}
 
 // See Worker.h
 void Worker::Join() {
     assert(_thread.joinable());
     _thread.join();
+
+    // Descriptors are closed by destructor: peers that are still running may wake this worker up
 }
 
 // See Worker.h
@@ -70,67 +201,462 @@ void Worker::OnRun() {
     assert(_epoll_fd >= 0);
     _logger->trace("OnRun");
 
-    // Process connection events
-    //
-    // Do not forget to use EPOLLEXCLUSIVE flag when register socket
-    // for events to avoid thundering herd type behavior.
-    int timeout = -1;
+    if (_cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(_cpu, &cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+            _logger->warn("Failed to pin worker to cpu {}", _cpu);
+        } else {
+            _logger->debug("Worker pinned to cpu {}", _cpu);
+        }
+    }
+
+    _timers.reset(new TimerWheel(kTimerTick, kTimerSlots));
+    _window_end = std::chrono::steady_clock::now() + kBalanceWindow;
+
+    bool draining = false;
+    std::chrono::steady_clock::time_point deadline;
     std::array<struct epoll_event, 64> mod_list;
-    while (isRunning) {
+    while (!draining || !_connections.empty()) {
+        // Sleep till the nearest connection deadline
+        int timeout = _timers->Timeout();
+        if (draining) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline -
+                                                                              std::chrono::steady_clock::now());
+            if (left.count() <= 0) {
+                _logger->warn("Drop {} connections which didn't take their responses", _connections.size());
+                break;
+            }
+            if (timeout < 0 || left.count() < timeout) {
+                timeout = left.count();
+            }
+        } else if (!_peers.empty()) {
+            // Idle worker must publish its load as well, otherwise peers see the stale one
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(_window_end -
+                                                                              std::chrono::steady_clock::now());
+            if (timeout < 0 || left.count() < timeout) {
+                timeout = std::max<int>(left.count(), 0);
+            }
+        }
+        if (!_throttled.empty()) {
+            // Round up, otherwise worker spins till the moment comes
+            auto left = std::chrono::duration_cast<std::chrono::microseconds>(_throttled.begin()->first -
+                                                                              RateLimiter::Clock::now());
+            int throttle_timeout = std::max<int>(0, (left.count() + 999) / 1000);
+            if (timeout < 0 || throttle_timeout < timeout) {
+                timeout = throttle_timeout;
+            }
+        }
+        if (!_ready.empty()) {
+            timeout = 0;
+        }
+
         int nmod = epoll_wait(_epoll_fd, &mod_list[0], mod_list.size(), timeout);
+        if (nmod == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            _logger->error("Worker failed to wait for events: {}", strerror(errno));
+            break;
+        }
         _logger->debug("Worker wokeup: {} events", nmod);
 
         for (int i = 0; i < nmod; i++) {
             struct epoll_event &current_event = mod_list[i];
 
             // nullptr is used by server for event_fd "interface", if we got here then server
-            // signals us to wakeup to process some state change, ignore it in INNER loop, react
-            // on changes in OUTHER loop
+            // signals us to wakeup to process some state change
             if (current_event.data.ptr == nullptr) {
+                eventfd_t value;
+                eventfd_read(_event_fd, &value);
+                if (!isRunning && !draining) {
+                    draining = true;
+                    deadline = std::chrono::steady_clock::now() + kDrainTimeout;
+                    StartDrain();
+                }
+                OnMigrated(draining);
+                OnOffloaded();
+                continue;
+            }
+
+            // Server socket has new connections
+            if (current_event.data.ptr == this) {
+                if (!draining) {
+                    OnNewConnection();
+                }
                 continue;
             }
 
             // Some connection gets new data
-            Connection *pconn = static_cast<Connection *>(current_event.data.ptr);
+            Connection *pc = static_cast<Connection *>(current_event.data.ptr);
+            if (_connections.find(pc) == _connections.end()) {
+                // Closed by event processed earlier in this batch
+                continue;
+            }
+
+            pc->activity++;
+            _window_events++;
+
             if ((current_event.events & EPOLLERR) || (current_event.events & EPOLLHUP)) {
                 _logger->debug("Got EPOLLERR or EPOLLHUP, value of returned events: {}", current_event.events);
-                pconn->OnError();
-            } else if (current_event.events & EPOLLRDHUP) {
-                _logger->debug("Got EPOLLRDHUP, value of returned events: {}", current_event.events);
-                pconn->OnClose();
+                pc->OnError();
             } else {
-                // Depends on what connection wants...
-                if (current_event.events & EPOLLIN) {
-                    _logger->trace("Got EPOLLIN");
-                    pconn->DoRead();
+                // Half closed connection still could have unread commands, read them all and
+                // then EOF stops reading
+                if (current_event.events & (EPOLLIN | EPOLLRDHUP)) {
+                    pc->DoRead();
                 }
-                if (current_event.events & EPOLLOUT) {
-                    _logger->trace("Got EPOLLOUT");
-                    pconn->DoWrite();
+                // Responses before offloaded command wait for its result, they are flushed together
+                if ((current_event.events & EPOLLOUT) && pc->isAlive() && pc->offloaded == nullptr) {
+                    pc->DoWrite();
                 }
             }
+            OnProcessed(pc);
+        }
 
-            // Rearm connection
-            if (pconn->isAlive()) {
-                pconn->_event.events |= EPOLLONESHOT;
-                int epoll_ctl_retval;
-                if ((epoll_ctl_retval = epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pconn->_socket, &pconn->_event))) {
-                    _logger->debug("epoll_ctl failed during connection rearm: error {}", epoll_ctl_retval);
-                    pconn->OnError();
-                    delete pconn;
-                }
+        // Connections which used up their budget continue after everybody else got a turn, the ones
+        // that are requeued now wait till the next round
+        for (std::size_t n = _ready.size(); n > 0 && !_ready.empty(); n--) {
+            Connection *pc = _ready.front();
+            _ready.pop_front();
+            pc->in_ready_list = false;
+
+            pc->activity++;
+            _window_events++;
+            pc->DoRead();
+            OnProcessed(pc);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (!_throttled.empty()) {
+            OnThrottled(now);
+        }
+
+        // Close connections which missed their deadlines
+        _timers->Advance(now, [this](void *data) {
+            Connection *pc = static_cast<Connection *>(data);
+            _logger->info("Close connection on descriptor {}: {} timeout", pc->_socket,
+                          pc->read_deadline ? "read" : "idle");
+            Close(pc);
+        });
+
+        if (!_peers.empty() && !draining && now >= _window_end) {
+            Rebalance();
+        }
+    }
+
+    while (!_connections.empty()) {
+        Close(*_connections.begin());
+    }
+    _timers.reset();
+    _logger->warn("Worker stopped");
+}
+
+// See Worker.h
+void Worker::OnNewConnection() {
+    // Sockets share the same wakeup, empty ones just answer EAGAIN
+    for (std::size_t i = 0; i < _server_sockets.size();) {
+        struct sockaddr_storage in_addr;
+        socklen_t in_len;
+
+        // No need to make these sockets non blocking since accept4() takes care of it.
+        in_len = sizeof in_addr;
+        int infd = accept4(_server_sockets[i], (struct sockaddr *)&in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (infd == -1) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                _logger->error("Failed to accept socket: {}", strerror(errno));
             }
-            // Or delete closed one
-            else {
-                if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pconn->_socket, &pconn->_event)) {
-                    std::cerr << "Failed to delete connection!" << std::endl;
-                }
-                delete pconn;
+            // Either all incoming connections are processed or other worker was faster
+            i++;
+            continue;
+        }
+
+        // Print host and service info.
+        char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
+        int retval = getnameinfo((struct sockaddr *)&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf,
+                                 NI_NUMERICHOST | NI_NUMERICSERV);
+        if (retval == 0) {
+            _logger->info("Accepted connection on descriptor {} (host={}, port={})", infd, hbuf, sbuf);
+        }
+
+        // Register the new FD to be monitored by epoll.
+        Connection *pc = new (std::nothrow) Connection(infd, _pStorage, _logger);
+        if (pc == nullptr) {
+            _logger->error("Failed to allocate connection");
+            close(infd);
+            continue;
+        }
+
+        pc->can_offload = (_executor != nullptr);
+        if (_limiter.limit().enabled()) {
+            pc->client_key = _limiter.Key(in_addr, in_len, _listener_keys[i]);
+            pc->limiter = &_limiter;
+            pc->bucket = _limiter.Acquire(pc->client_key, RateLimiter::Clock::now());
+        }
+        pc->Start();
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
+            _logger->error("Failed to register connection in epoll: {}", strerror(errno));
+            close(infd);
+            _limiter.Release(pc->bucket);
+            delete pc;
+            continue;
+        }
+        _connections.insert(pc);
+        ArmTimer(pc);
+    }
+}
+
+// See Worker.h
+void Worker::StartDrain() {
+    _logger->debug("Worker starts drain of {} connections", _connections.size());
+    for (int s : _server_sockets) {
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, s, nullptr)) {
+            _logger->error("Failed to delete server socket from epoll");
+        }
+    }
+
+    for (auto it = _connections.begin(); it != _connections.end();) {
+        Connection *pc = *it++;
+        pc->StopReading();
+        if (!pc->hasPendingOutput()) {
+            Close(pc);
+        }
+    }
+}
+
+// See Worker.h
+void Worker::ArmTimer(Connection *pc) {
+    // Throttled client isn't slow, it is server which doesn't read
+    bool in_progress = pc->isReading() && pc->hasCommandInProgress() && !pc->throttled;
+    std::chrono::milliseconds timeout = _idle_timeout;
+    if (in_progress) {
+        if (pc->read_deadline) {
+            return;
+        }
+        timeout = _read_timeout;
+    }
+    pc->read_deadline = in_progress;
+
+    if (timeout.count() > 0) {
+        _timers->Schedule(pc->timer, timeout);
+    } else {
+        _timers->Cancel(pc->timer);
+    }
+}
+
+// See Worker.h
+void Worker::Rebalance() {
+    uint64_t load = _window_events;
+    _window_events = 0;
+    _window_end = std::chrono::steady_clock::now() + kBalanceWindow;
+    _load.store(load, std::memory_order_relaxed);
+
+    // Peers publish their loads at their own pace, so compare with the last known ones
+    uint64_t total = 0, coolest_load = 0;
+    Worker *coolest = nullptr;
+    for (Worker *peer : _peers) {
+        uint64_t peer_load = (peer == this) ? load : peer->_load.load(std::memory_order_relaxed);
+        total += peer_load;
+        // Stopped peer would only drop what it gets. Peer stopping right after the check still takes the
+        // connection in its drain or closes it in destructor
+        if (peer == this || !peer->isRunning) {
+            continue;
+        }
+        if (coolest == nullptr || peer_load < coolest_load) {
+            coolest = peer;
+            coolest_load = peer_load;
+        }
+    }
+
+    // Migration costs a couple of syscalls and cold caches on the new worker, only significant skew is
+    // worth it
+    if (coolest != nullptr && load >= kBalanceMinLoad && 2 * load >= 3 * (total / _peers.size())) {
+        // Move about half of what would even the pair out, so that two workers don't keep passing the
+        // same connections back and forth
+        uint64_t excess = (load - coolest_load) / 4;
+
+        std::size_t moved = 0;
+        for (auto it = _connections.begin(); it != _connections.end() && excess > 0 && moved < kMaxMigrations;) {
+            Connection *pc = *it++;
+
+            // Connection hotter than the whole excess would just move the hot spot
+            if (pc->activity == 0 || pc->activity > excess || !pc->isReading() || pc->offloaded != nullptr ||
+                pc->throttled) {
+                continue;
             }
+            excess -= pc->activity;
+            Migrate(pc, *coolest);
+            moved++;
+        }
+        if (moved > 0) {
+            _logger->debug("Moved {} connections to other worker, load {} vs {}", moved, load, coolest_load);
         }
-        // TODO: Select timeout...
     }
-    _logger->warn("Worker stopped");
+
+    for (Connection *pc : _connections) {
+        pc->activity = 0;
+    }
+}
+
+// See Worker.h
+void Worker::Migrate(Connection *pc, Worker &to) {
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pc->_socket, nullptr)) {
+        _logger->error("Failed to delete connection from epoll");
+        return;
+    }
+    _timers->Cancel(pc->timer);
+    _connections.erase(pc);
+    if (pc->in_ready_list) {
+        _ready.erase(std::find(_ready.begin(), _ready.end(), pc));
+        pc->in_ready_list = false;
+    }
+    pc->activity = 0;
+
+    // Buckets are per worker, new owner gives connection the one of its own
+    _limiter.Release(pc->bucket);
+    pc->bucket = nullptr;
+    pc->limiter = nullptr;
+
+    // Mailbox release publishes the whole connection state to the new owner
+    if (to._mailbox.Push(pc) && eventfd_write(to._event_fd, 1)) {
+        _logger->error("Failed to wakeup worker");
+    }
+}
+
+// See Worker.h
+void Worker::OnMigrated(bool draining) {
+    for (Connection *pc = _mailbox.TakeAll(); pc != nullptr;) {
+        Connection *next = pc->mailbox_next;
+        pc->mailbox_next = nullptr;
+
+        if (draining) {
+            pc->StopReading();
+        }
+        if (_limiter.limit().enabled()) {
+            pc->limiter = &_limiter;
+            pc->bucket = _limiter.Acquire(pc->client_key, RateLimiter::Clock::now());
+        }
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
+            _logger->error("Failed to register migrated connection in epoll: {}", strerror(errno));
+            close(pc->_socket);
+            pc->OnClose();
+            _limiter.Release(pc->bucket);
+            delete pc;
+        } else {
+            _connections.insert(pc);
+
+            // Read deadline was counted by previous owner's wheel, restart it here
+            pc->read_deadline = false;
+            OnProcessed(pc);
+        }
+        pc = next;
+    }
+}
+
+// See Worker.h
+void Worker::Close(Connection *pc) {
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pc->_socket, nullptr)) {
+        _logger->error("Failed to delete connection from epoll");
+    }
+
+    close(pc->_socket);
+    pc->OnClose();
+    _connections.erase(pc);
+    if (pc->in_ready_list) {
+        _ready.erase(std::find(_ready.begin(), _ready.end(), pc));
+    }
+    if (pc->in_throttle_queue) {
+        _throttled.erase(pc->throttle_it);
+    }
+    _limiter.Release(pc->bucket);
+    delete pc;
+}
+
+// See Worker.h
+void Worker::OnProcessed(Connection *pc) {
+    if (!pc->isAlive() || (!pc->isReading() && !pc->hasPendingOutput())) {
+        Close(pc);
+        return;
+    }
+
+    if (pc->offloaded != nullptr && !pc->in_flight) {
+        Offload(pc);
+    }
+    if (pc->throttled && !pc->in_throttle_queue) {
+        Throttle(pc);
+    }
+    if (pc->hasInputReady() && !pc->in_ready_list) {
+        pc->in_ready_list = true;
+        _ready.push_back(pc);
+    }
+    ArmTimer(pc);
+}
+
+// See Worker.h
+void Worker::Throttle(Connection *pc) {
+    auto now = RateLimiter::Clock::now();
+    pc->throttle_it = _throttled.emplace(now + _limiter.Delay(*pc->bucket, now), pc);
+    pc->in_throttle_queue = true;
+}
+
+// See Worker.h
+void Worker::OnThrottled(RateLimiter::Clock::time_point now) {
+    // Connection that runs out of tokens again is queued anew, it waits till the next pass
+    std::vector<Connection *> resumed;
+    while (!_throttled.empty() && _throttled.begin()->first <= now) {
+        Connection *pc = _throttled.begin()->second;
+        _throttled.erase(_throttled.begin());
+        pc->in_throttle_queue = false;
+        pc->throttled = false;
+        resumed.push_back(pc);
+    }
+
+    for (Connection *pc : resumed) {
+        pc->activity++;
+        _window_events++;
+        pc->DoRead();
+        OnProcessed(pc);
+    }
+}
+
+// See Worker.h
+void Worker::Offload(Connection *pc) {
+    Job *job = pc->offloaded;
+    pc->in_flight = true;
+
+    // Job is the only thing shared with the pool thread, connection is touched once job is back here
+    auto execute = [this, job]() {
+        try {
+            job->command->Execute(*_pStorage, job->argument, job->result);
+        } catch (std::runtime_error &ex) {
+            job->result = ex.what();
+            job->failed = true;
+        }
+        if (_completions.Push(job) && eventfd_write(_event_fd, 1)) {
+            _logger->error("Failed to wakeup worker");
+        }
+    };
+
+    if (!_executor->Execute(execute)) {
+        _logger->debug("Thread pool is overloaded, execute command inline");
+        execute();
+    }
+}
+
+// See Worker.h
+void Worker::OnOffloaded() {
+    for (Job *job = _completions.TakeAll(); job != nullptr;) {
+        Job *next = job->mailbox_next;
+
+        Connection *pc = job->connection;
+        if (pc != nullptr) {
+            pc->OnOffloaded(*job);
+            OnProcessed(pc);
+        }
+        delete job;
+        job = next;
+    }
 }
 
 } // namespace MTnonblock
@@ -2,8 +2,17 @@
 #define AFINA_NETWORK_MT_NONBLOCKING_WORKER_H
 
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
 #include <thread>
+#include <vector>
+
+#include <network/common/Mailbox.h>
+#include <network/common/RateLimiter.h>
 
 namespace spdlog {
 class logger;
@@ -16,18 +25,54 @@ class Storage;
 namespace Logging {
 class Service;
 }
+namespace Concurrency {
+class Executor;
+}
 
 namespace Network {
+
+// Forward declaration, see common/TimerWheel.h
+class TimerWheel;
+
 namespace MTnonblock {
 
+// Forward declaration, see Connection.h
+class Connection;
+struct Job;
+using ThrottleQueue = std::multimap<RateLimiter::Clock::time_point, Connection *>;
+
 /**
  * # Thread running epoll
  * On Start spaws background thread that is doing epoll on the given server
- * socket and process incoming connections and its data
+ * socket and process incoming connections and its data.
+ *
+ * Each worker has its own epoll descriptor and a server socket for each listen address. Server socket is
+ * either shared and registered in all of them with EPOLLEXCLUSIVE, so kernel wakes up only one worker per
+ * incoming connection, or is owned by the worker (SO_REUSEPORT mode, TCP only). Accepted connection stays
+ * on the worker which accepted it, so connections are never shared between threads.
+ *
+ * Connections are edge triggered. Connection gets limited amount of work per wakeup, if there is more
+ * in its socket it is put to the worker ready list and continues once all other ready connections got
+ * their turn, without waiting for epoll to report it again.
+ *
+ * Long lived connections may leave some workers much busier than others. If balancing is enabled,
+ * worker measures its load over a window and hands some of its connections over to the least loaded
+ * peer through the peer's mailbox: connection is removed from one epoll and added to the other.
+ *
+ * Commands that are too expensive to execute inline could be passed to the thread pool shared by all
+ * workers, executed command comes back through the worker completion mailbox.
+ *
+ * Clients could be rate limited, token buckets live on the worker, see RateLimiter. Connection out of tokens
+ * waits in the throttle queue till its bucket refills, epoll wait is cut short to resume it in time
  */
 class Worker {
 public:
-    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl);
+    /**
+     * @param idle_timeout connection that does nothing that long is closed, zero disables
+     * @param read_timeout command started must be received completely within that time, zero disables
+     */
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
+           std::chrono::milliseconds idle_timeout, std::chrono::milliseconds read_timeout);
     ~Worker();
 
     Worker(Worker &&);
@@ -35,10 +80,30 @@ public:
 
     /**
      * Spaws new background thread that is doing epoll on the given server
-     * socket. Once connection accepted it must be registered and being processed
+     * sockets. Once connection accepted it must be registered and being processed
      * on this thread
+     *
+     * @param cpu if not negative thread is pinned to the given CPU
+     */
+    void Start(std::vector<int> server_sockets, int cpu = -1);
+
+    /**
+     * Workers to share load with, including this one. Must be called before Start, without peers
+     * connections are never migrated
+     */
+    void SetPeers(std::vector<Worker *> peers);
+
+    /**
+     * Thread pool to execute expensive commands on, must outlive worker threads and be stopped before
+     * the worker is destroyed. Must be called before Start, without pool all commands are executed inline
+     */
+    void SetExecutor(Concurrency::Executor *executor);
+
+    /**
+     * Limits of each client connections of this worker, must be called before Start. Without limits
+     * connections are never throttled
      */
-    void Start(int epoll_fd);
+    void SetRateLimit(const RateLimiter::Limit &limit);
 
     /**
      * Signal background thread to stop. After that signal thread must stop to
@@ -60,6 +125,70 @@ protected:
      */
     void OnRun();
 
+    /**
+     * Accept all pending connections from the server sockets
+     */
+    void OnNewConnection();
+
+    /**
+     * Stop accepting connections and reading commands, connections that have nothing
+     * to send are closed right away
+     */
+    void StartDrain();
+
+    /**
+     * Unregister connection from epoll and destroy it
+     */
+    void Close(Connection *pc);
+
+    /**
+     * Closes connection which is done after reading or writing, otherwise puts it to the ready list
+     * if it has more input and moves its deadline
+     */
+    void OnProcessed(Connection *pc);
+
+    /**
+     * Moves connection deadline after activity: read deadline is set once command starts and is not
+     * moved by partial data, otherwise idle deadline counts from now
+     */
+    void ArmTimer(Connection *pc);
+
+    /**
+     * Publishes load of the passed window and moves some connections to the least loaded peer if this
+     * worker is much busier than average
+     */
+    void Rebalance();
+
+    /**
+     * Hands connection over to the given worker
+     */
+    void Migrate(Connection *pc, Worker &to);
+
+    /**
+     * Takes connections handed over by peers
+     */
+    void OnMigrated(bool draining);
+
+    /**
+     * Puts connection which client is out of tokens to the throttle queue
+     */
+    void Throttle(Connection *pc);
+
+    /**
+     * Resumes throttled connections which buckets are refilled by now
+     */
+    void OnThrottled(RateLimiter::Clock::time_point now);
+
+    /**
+     * Passes connection's expensive command to the thread pool, executes it inline if pool is overloaded
+     */
+    void Offload(Connection *pc);
+
+    /**
+     * Takes commands executed on the thread pool back to their connections
+     */
+    void OnOffloaded();
+
 private:
     Worker(Worker &) = delete;
     Worker &operator=(Worker &) = delete;
@@ -81,6 +210,44 @@ private:
 
     // EPOLL descriptor using for events processing
     int _epoll_fd;
+
+    // Sockets to accept new connections on, one per address, either shared between all workers or own
+    std::vector<int> _server_sockets;
+
+    // Event "device" used by Stop to wakeup the thread
+    int _event_fd;
+
+    // CPU to pin thread to, -1 if any
+    int _cpu;
+
+    // Connection deadlines
+    std::chrono::milliseconds _idle_timeout;
+    std::chrono::milliseconds _read_timeout;
+    std::unique_ptr<TimerWheel> _timers;
+
+    // Connections owned by this worker
+    std::set<Connection *> _connections;
+
+    // Connections that used up their budget with more input left in the socket
+    std::deque<Connection *> _ready;
+
+    // Connections handed over by peers, owner is woken up through _event_fd
+    Mailbox<Connection> _mailbox;
+
+    // Thread pool for expensive commands and commands executed there, owner is woken up through _event_fd
+    Concurrency::Executor *_executor;
+    Mailbox<Job> _completions;
+
+    // Client token buckets, listening addresses clients could be told apart by and throttled connections
+    RateLimiter _limiter;
+    std::vector<std::string> _listener_keys;
+    ThrottleQueue _throttled;
+
+    // Balancing: events processed in the current window and load of the last window seen by peers
+    std::vector<Worker *> _peers;
+    uint64_t _window_events;
+    std::chrono::steady_clock::time_point _window_end;
+    std::atomic<uint64_t> _load;
 };
 
 } // namespace MTnonblock
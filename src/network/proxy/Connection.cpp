@@ -0,0 +1,284 @@
+#include "Connection.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/client/AsyncClient.h>
+#include <afina/execute/Command.h>
+#include <afina/metrics/Counters.h>
+#include <network/common/MemoryBudget.h>
+
+namespace Afina {
+namespace Network {
+namespace Proxy {
+
+namespace {
+
+// Commands of a single connection in flight, connection stops reading above that
+constexpr std::size_t kMaxInFlight = 1024;
+
+// Bytes read per wakeup, epoll is level triggered so the rest waits for the next turn
+constexpr std::size_t kReadBudget = 64 * 1024;
+
+bool is_storage(const std::string &name) {
+    return name == "set" || name == "add" || name == "append" || name == "prepend";
+}
+
+// Response to the client for request backend didn't complete
+std::string failure(const Client::Response &response) {
+    static const std::string connection_error = "CONNECTION_ERROR";
+    if (response.status.compare(0, connection_error.size(), connection_error) == 0) {
+        return "SERVER_ERROR backend" + response.status.substr(connection_error.size()) + "\r\n";
+    }
+    return response.status + "\r\n";
+}
+
+// Found values in order of requested keys, like a single server returns them
+std::string retrieval(const std::vector<std::string> &keys, const Client::Response &response) {
+    std::unordered_map<std::string, const Client::Value *> found;
+    for (auto &value : response.values) {
+        found.emplace(value.key, &value);
+    }
+
+    std::string out;
+    for (auto &key : keys) {
+        auto it = found.find(key);
+        if (it == found.end()) {
+            continue;
+        }
+        const Client::Value &value = *it->second;
+        out.append("VALUE " + key + " " + std::to_string(value.flags) + " " + std::to_string(value.data.size()) +
+                   "\r\n");
+        out.append(value.data);
+        out.append("\r\n");
+    }
+    out.append("END\r\n");
+    return out;
+}
+
+} // namespace
+
+// See Connection.h
+Connection::Connection(int s, Client::AsyncClient &client, Afina::Storage &storage, std::shared_ptr<spdlog::logger> pl,
+                       std::vector<Connection *> &completed)
+    : _socket(s), _client(client), _storage(storage), _logger(std::move(pl)), _completed(completed) {
+    timer.data = this;
+
+    Metrics::Counters::Instance().Add(Metrics::kTotalConnections);
+    Metrics::Counters::Instance().Add(Metrics::kCurrConnections);
+}
+
+// See Connection.h
+Connection::~Connection() {
+    for (auto &slot : slots) {
+        slot->owner = nullptr;
+    }
+    Metrics::Counters::Instance().Add(Metrics::kCurrConnections, -1);
+}
+
+// See Connection.h
+bool Connection::Paused() const {
+    return slots.size() >= kMaxInFlight || MemoryBudget::Instance().OverBudget(output.size());
+}
+
+// See Connection.h
+uint32_t Connection::Events() const {
+    uint32_t wanted = (is_reading && !Paused()) ? uint32_t(EPOLLIN | EPOLLRDHUP) : 0;
+    return wanted | (output.empty() ? 0 : uint32_t(EPOLLOUT));
+}
+
+// See Connection.h
+void Connection::DoRead() {
+    try {
+        std::size_t bytes = 0;
+        for (;;) {
+            // Commands left in the buffer by pause go first
+            ProcessInput();
+            if (!is_reading || Paused() || bytes >= kReadBudget) {
+                break;
+            }
+
+            std::size_t available = 0;
+            char *tail = client_buffer.Reserve(available);
+            if (tail == nullptr) {
+                throw std::runtime_error("Command is too long");
+            }
+
+            ssize_t got_bytes = read(_socket, tail, available);
+            if (got_bytes == 0) {
+                // Client is done with sending, but still waits for responses
+                _logger->debug("Connection on {} socket got EOF", _socket);
+                is_reading = false;
+                break;
+            } else if (got_bytes == -1) {
+                if (errno == EINTR) {
+                    continue;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                throw std::runtime_error(std::string(strerror(errno)));
+            }
+
+            client_buffer.Commit(got_bytes);
+            bytes += got_bytes;
+            Metrics::Counters::Instance().Add(Metrics::kBytesRead, got_bytes);
+        }
+    } catch (std::runtime_error &ex) {
+        _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+        is_alive = false;
+    }
+}
+
+// See Connection.h
+void Connection::ProcessInput() {
+    while (!client_buffer.empty() && !Paused()) {
+        if (!command_ready) {
+            std::size_t parsed = 0;
+            command_ready = parser.Parse(client_buffer.data(), client_buffer.size(), parsed);
+            if (command_ready && is_storage(parser.Name())) {
+                if (parser.Bytes() > MemoryBudget::kArgumentLimit) {
+                    throw std::runtime_error("Value is too large");
+                }
+                // Value is always followed by \r\n, even the empty one
+                arg_remains = parser.Bytes() + 2;
+            }
+            if (parsed == 0) {
+                break;
+            }
+            client_buffer.Consume(parsed);
+        }
+
+        if (command_ready && arg_remains > 0) {
+            std::size_t to_read = std::min(arg_remains, client_buffer.size());
+            argument_for_command.append(client_buffer.data(), to_read);
+            client_buffer.Consume(to_read);
+            arg_remains -= to_read;
+        }
+
+        if (command_ready && arg_remains == 0) {
+            Forward();
+            command_ready = false;
+            argument_for_command.resize(0);
+            parser.Reset();
+
+            // Client makes progress, next command gets its own read deadline
+            read_deadline = false;
+        }
+    }
+}
+
+// See Connection.h
+void Connection::Forward() {
+    const std::string &name = parser.Name();
+    _logger->debug("Forward {} on {} socket", name, _socket);
+
+    if (is_storage(name)) {
+        if (name == "prepend") {
+            throw std::runtime_error("Unsupported command");
+        }
+        if (argument_for_command.compare(argument_for_command.size() - 2, 2, "\r\n") != 0) {
+            throw std::runtime_error("Value is not terminated by \\r\\n");
+        }
+        argument_for_command.resize(argument_for_command.size() - 2);
+    }
+
+    std::shared_ptr<Slot> slot = std::make_shared<Slot>();
+    slot->owner = this;
+    slots.push_back(slot);
+
+    if (name == "stats") {
+        std::size_t body_size = 0;
+        std::unique_ptr<Execute::Command> command = parser.Build(body_size);
+        command->Execute(_storage, argument_for_command, slot->response);
+        slot->response.append("\r\n");
+        slot->done = true;
+        Complete();
+        return;
+    }
+
+    try {
+        // Backends are asked with plain get, response would come without CAS values the client asked for
+        if (name == "gets") {
+            throw std::runtime_error("gets is not supported by proxy");
+        }
+        if (name == "get") {
+            std::vector<std::string> keys = parser.Keys();
+            _client.Get(keys, [slot, keys](Client::Response &response) {
+                slot->response = response.ok ? retrieval(keys, response) : failure(response);
+                slot->done = true;
+                if (slot->owner != nullptr) {
+                    slot->owner->Complete();
+                }
+            });
+            return;
+        }
+
+        Client::Callback stored = [slot](Client::Response &response) {
+            slot->response = response.ok ? response.status + "\r\n" : failure(response);
+            slot->done = true;
+            if (slot->owner != nullptr) {
+                slot->owner->Complete();
+            }
+        };
+        const std::string &key = parser.Keys()[0];
+        if (name == "set") {
+            _client.Set(key, argument_for_command, stored, parser.Flags());
+        } else if (name == "add") {
+            _client.Add(key, argument_for_command, stored, parser.Flags());
+        } else {
+            _client.Append(key, argument_for_command, stored, parser.Flags());
+        }
+    } catch (std::runtime_error &ex) {
+        // Client rejects keys memcached wouldn't accept before anything is sent
+        slot->response = std::string("CLIENT_ERROR ") + ex.what() + "\r\n";
+        slot->done = true;
+        Complete();
+    }
+}
+
+// See Connection.h
+void Connection::Complete() {
+    bool moved = false;
+    while (!slots.empty() && slots.front()->done) {
+        output.Append(slots.front()->response);
+        slots.front()->owner = nullptr;
+        slots.pop_front();
+        moved = true;
+    }
+
+    if (moved && !in_completed) {
+        in_completed = true;
+        _completed.push_back(this);
+    }
+}
+
+// See Connection.h
+void Connection::DoWrite() {
+    while (!output.empty()) {
+        ssize_t written = output.Flush(_socket);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+
+            _logger->error("Failed to send response on descriptor {}: {}", _socket, strerror(errno));
+            is_alive = false;
+            return;
+        }
+        Metrics::Counters::Instance().Add(Metrics::kBytesWritten, written);
+    }
+}
+
+} // namespace Proxy
+} // namespace Network
+} // namespace Afina
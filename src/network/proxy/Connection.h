@@ -0,0 +1,127 @@
+#ifndef AFINA_NETWORK_PROXY_CONNECTION_H
+#define AFINA_NETWORK_PROXY_CONNECTION_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <network/common/InputBuffer.h>
+#include <network/common/OutputQueue.h>
+#include <network/common/TimerWheel.h>
+#include <protocol/Parser.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+class Storage;
+
+namespace Client {
+class AsyncClient;
+}
+
+namespace Network {
+namespace Proxy {
+
+/**
+ * # Client connection of the proxy
+ * Commands are parsed with the usual Protocol::Parser, but instead of being executed they are forwarded to
+ * backends through the worker AsyncClient: key goes to the backend owning it, multi-get is split between
+ * backends and merged back. Only stats is answered by proxy itself.
+ *
+ * Backends answer whenever they are ready, so every command takes a slot in order of arrival and its response
+ * is written once all commands before it are answered, client sees responses in the order of its commands.
+ * Connection closed with commands in flight leaves their slots orphaned, late responses are dropped.
+ */
+class Connection {
+public:
+    Connection(int s, Client::AsyncClient &client, Afina::Storage &storage, std::shared_ptr<spdlog::logger> pl,
+               std::vector<Connection *> &completed);
+    ~Connection();
+
+    inline bool isAlive() const { return is_alive; }
+
+    // Client closed its side, connection is done once responses are sent
+    inline bool isReading() const { return is_reading; }
+
+    inline bool hasPendingOutput() const { return !output.empty(); }
+
+    // Commands forwarded and not answered yet
+    inline bool hasCommandsInFlight() const { return !slots.empty(); }
+
+    // Part of a command is received, the rest must arrive within read timeout
+    inline bool hasCommandInProgress() const { return !client_buffer.empty() || arg_remains > 0; }
+
+    /**
+     * Epoll events connection waits for: no input while too many commands are in flight or responses are not
+     * taken by client
+     */
+    uint32_t Events() const;
+
+    // Reads and forwards commands till socket is drained or connection has to pause
+    void DoRead();
+
+    void DoWrite();
+
+    // Stop reading new commands, the ones in flight are still answered
+    void Shutdown() { is_reading = false; }
+
+private:
+    friend class Worker;
+
+    // Response of a single command, filled by backend callback
+    struct Slot {
+        Connection *owner;
+        bool done = false;
+        std::string response;
+    };
+
+    // Forwards complete commands buffered so far
+    void ProcessInput();
+
+    // Takes a slot for command just parsed and forwards it
+    void Forward();
+
+    // Moves answered commands from the head of slots into output
+    void Complete();
+
+    bool Paused() const;
+
+    int _socket;
+    Client::AsyncClient &_client;
+    Afina::Storage &_storage;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Connections having new responses, owned by worker
+    std::vector<Connection *> &_completed;
+    bool in_completed = false;
+
+    bool is_alive = true;
+    bool is_reading = true;
+
+    // Events connection is registered for in epoll
+    uint32_t events = 0;
+
+    InputBuffer client_buffer;
+    std::size_t arg_remains = 0;
+    Protocol::Parser parser;
+    bool command_ready = false;
+    std::string argument_for_command;
+
+    std::deque<std::shared_ptr<Slot>> slots;
+    OutputQueue output;
+
+    // Idle or read deadline in the worker timer wheel
+    TimerWheel::Timer timer;
+    bool read_deadline = false;
+};
+
+} // namespace Proxy
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_PROXY_CONNECTION_H
@@ -0,0 +1,94 @@
+#include "ServerImpl.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/logging/Service.h>
+#include <network/common/Listener.h>
+
+#include "Worker.h"
+
+namespace Afina {
+namespace Network {
+namespace Proxy {
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl,
+                       std::vector<std::string> backends, Client::AsyncClient::Options options)
+    : Server(ps, pl), _backends(std::move(backends)), _options(options) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
+    }
+
+    // Workers share nothing, so each gets its own SO_REUSEPORT socket and kernel spreads clients between them
+    n_workers = std::max<uint32_t>(n_workers, 1);
+    if (!inheritedListeners.empty()) {
+        _server_sockets.swap(inheritedListeners);
+        for (int s : _server_sockets) {
+            Listener::SetNonBlocking(s, true);
+        }
+    } else {
+        _server_sockets = Listener::Open(Listener::Parse(listenAddresses, port), true, n_workers);
+    }
+    std::vector<std::vector<int>> worker_sockets = Listener::Distribute(_server_sockets, n_workers);
+    n_workers = worker_sockets.size();
+
+    _logger->info("Start proxy network service with {} workers, {} backends, {} connections to each", n_workers,
+                  _backends.size(), _options.connections);
+    for (auto &backend : _backends) {
+        _logger->info("Proxy backend {}", backend);
+    }
+
+    for (uint32_t i = 0; i < n_workers; i++) {
+        _workers.emplace_back(new Worker(pStorage, pLogging, _backends, _options, idleTimeout, readTimeout));
+    }
+    for (uint32_t i = 0; i < n_workers; i++) {
+        _workers[i]->Start(worker_sockets[i]);
+    }
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop network service");
+
+    // Workers stop accepting and reading, but first answer commands already forwarded
+    for (auto &worker : _workers) {
+        worker->Stop();
+    }
+}
+
+// See Server.h
+std::vector<int> ServerImpl::Listeners() const { return _server_sockets; }
+
+// See Server.h
+void ServerImpl::Join() {
+    for (auto &worker : _workers) {
+        worker->Join();
+    }
+    _workers.clear();
+
+    for (int s : _server_sockets) {
+        Listener::Close(s);
+    }
+    _server_sockets.clear();
+}
+
+} // namespace Proxy
+} // namespace Network
+} // namespace Afina
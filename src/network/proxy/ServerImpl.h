@@ -0,0 +1,70 @@
+#ifndef AFINA_NETWORK_PROXY_SERVER_H
+#define AFINA_NETWORK_PROXY_SERVER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/client/AsyncClient.h>
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace Proxy {
+
+// Forward declaration, see Worker.h
+class Worker;
+
+/**
+ * # Consistent hashing proxy
+ * Speaks memcached text protocol to clients and spreads keys over backends with ketama ring, the same every
+ * ketama client builds, so backends could be filled by such clients directly too. Multi-key get is split between
+ * backends owning its keys and merged back into a single response. Each worker keeps its own pool of pipelined
+ * connections to every backend, see Worker.
+ *
+ * Storage given to the proxy is not used for keys, only stats command is answered by proxy itself.
+ */
+class ServerImpl : public Server {
+public:
+    /**
+     * @param backends servers to forward commands to, in any form AsyncClient takes
+     * @param options connections to each backend per worker and pipeline depth of each
+     */
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl,
+               std::vector<std::string> backends, Client::AsyncClient::Options options);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+    // See Server.h
+    std::vector<int> Listeners() const override;
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    std::vector<std::string> _backends;
+    Client::AsyncClient::Options _options;
+
+    // Listening sockets, SO_REUSEPORT one per worker where address allows
+    std::vector<int> _server_sockets;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+};
+
+} // namespace Proxy
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_PROXY_SERVER_H
@@ -0,0 +1,322 @@
+#include "Worker.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/logging/Service.h>
+#include <network/common/TimerWheel.h>
+
+#include "Connection.h"
+
+namespace Afina {
+namespace Network {
+namespace Proxy {
+
+namespace {
+
+// How long worker waits for backends to answer and clients to take responses once stop requested. Backend
+// that hangs must not block server shutdown forever
+constexpr std::chrono::milliseconds kDrainTimeout(5000);
+
+} // namespace
+
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
+               const std::vector<std::string> &backends, Client::AsyncClient::Options options,
+               std::chrono::milliseconds idle_timeout, std::chrono::milliseconds read_timeout)
+    : _pStorage(ps), _pLogging(pl), _idle_timeout(idle_timeout), _read_timeout(read_timeout), isRunning(false),
+      _epoll_fd(-1), _event_fd(-1), _client(new Client::AsyncClient(backends, options)) {}
+
+// See Worker.h
+Worker::~Worker() {
+    if (_thread.joinable()) {
+        Stop();
+        Join();
+    }
+}
+
+// See Worker.h
+void Worker::Start(const std::vector<int> &sockets) {
+    if (isRunning.exchange(true) == false) {
+        _logger = _pLogging->select("network.proxy");
+        _sockets = sockets;
+
+        _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (_epoll_fd == -1) {
+            throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+        }
+        _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_event_fd == -1) {
+            throw std::runtime_error("Failed to create event file descriptor: " + std::string(strerror(errno)));
+        }
+
+        // Everything but connections is told apart by address of the member holding its descriptor
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        for (int &s : _sockets) {
+            event.data.ptr = &s;
+            if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, s, &event)) {
+                throw std::runtime_error("Failed to add file descriptor to epoll");
+            }
+        }
+        event.data.ptr = &_event_fd;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
+            throw std::runtime_error("Failed to add file descriptor to epoll");
+        }
+        event.data.ptr = _client.get();
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _client->fd(), &event)) {
+            throw std::runtime_error("Failed to add file descriptor to epoll");
+        }
+
+        _thread = std::thread(&Worker::OnRun, this);
+    }
+}
+
+// See Worker.h
+void Worker::Stop() {
+    isRunning = false;
+    if (_event_fd != -1 && eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup worker");
+    }
+}
+
+// See Worker.h
+void Worker::Join() {
+    assert(_thread.joinable());
+    _thread.join();
+
+    close(_epoll_fd);
+    close(_event_fd);
+    _epoll_fd = _event_fd = -1;
+    _client.reset();
+}
+
+// See Worker.h
+void Worker::OnRun() {
+    // Deadlines resolution is a quarter of second, single wheel rotation is about a minute
+    _timers.reset(new TimerWheel(std::chrono::milliseconds(250), 256));
+
+    bool accepting = true;
+    std::chrono::steady_clock::time_point deadline;
+    std::array<struct epoll_event, 64> events;
+    while (accepting || !_connections.empty()) {
+        int timeout = _timers->Timeout();
+        if (!accepting) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline -
+                                                                              std::chrono::steady_clock::now());
+            if (left.count() <= 0) {
+                _logger->warn("Drop {} connections which didn't get their responses", _connections.size());
+                break;
+            }
+            if (timeout < 0 || left.count() < timeout) {
+                timeout = left.count();
+            }
+        }
+        if (!_completed.empty()) {
+            timeout = 0;
+        }
+
+        int n = epoll_wait(_epoll_fd, events.data(), events.size(), timeout);
+        if (n == -1 && errno != EINTR) {
+            _logger->error("Failed to wait for events: {}", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            void *ptr = events[i].data.ptr;
+            if (ptr == &_event_fd) {
+                eventfd_t value;
+                eventfd_read(_event_fd, &value);
+                if (!isRunning && accepting) {
+                    // Stop accepting and reading, commands in flight are answered before connection is closed
+                    accepting = false;
+                    deadline = std::chrono::steady_clock::now() + kDrainTimeout;
+                    for (int s : _sockets) {
+                        epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, s, nullptr);
+                    }
+                    for (auto it = _connections.begin(); it != _connections.end();) {
+                        Connection *pc = *it++;
+                        pc->Shutdown();
+                        OnProcessed(pc);
+                    }
+                }
+                continue;
+            } else if (ptr == _client.get()) {
+                _client->Poll(0);
+                continue;
+            } else if (!_sockets.empty() && ptr >= &_sockets.front() && ptr <= &_sockets.back()) {
+                if (accepting) {
+                    OnNewConnection(*static_cast<int *>(ptr));
+                }
+                continue;
+            }
+
+            Connection *pc = static_cast<Connection *>(ptr);
+            if (_connections.find(pc) == _connections.end()) {
+                // Closed by event processed earlier in this batch
+                continue;
+            }
+
+            if (events[i].events & EPOLLERR) {
+                _logger->warn("Connection on {} socket has error", pc->_socket);
+                pc->is_alive = false;
+            } else {
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+                    pc->DoRead();
+                }
+                if ((events[i].events & EPOLLOUT) && pc->isAlive()) {
+                    pc->DoWrite();
+                }
+            }
+            OnProcessed(pc);
+        }
+
+        // Commands forwarded above go to backends, responses already there are taken
+        _client->Poll(0);
+
+        // Write responses out, connections paused by too many commands in flight go on with buffered ones
+        std::vector<Connection *> completed;
+        completed.swap(_completed);
+        for (Connection *pc : completed) {
+            pc->in_completed = false;
+        }
+        for (Connection *pc : completed) {
+            if (_connections.find(pc) == _connections.end()) {
+                continue;
+            }
+            pc->DoWrite();
+            if (pc->isAlive() && pc->isReading() && !pc->client_buffer.empty()) {
+                pc->DoRead();
+            }
+            OnProcessed(pc);
+        }
+
+        // Commands resumed above are sent right away, their responses are written on the next pass
+        if (!completed.empty()) {
+            _client->Poll(0);
+        }
+
+        // Close connections which missed their deadlines
+        _timers->Advance(std::chrono::steady_clock::now(), [this](void *data) {
+            Connection *pc = static_cast<Connection *>(data);
+            _logger->info("Close connection on descriptor {}: {} timeout", pc->_socket,
+                          pc->read_deadline ? "read" : "idle");
+            CloseConnection(pc);
+        });
+    }
+
+    for (Connection *pc : _connections) {
+        close(pc->_socket);
+        delete pc;
+    }
+    _connections.clear();
+    _completed.clear();
+    _timers.reset();
+    _logger->debug("Proxy worker stopped");
+}
+
+// See Worker.h
+void Worker::OnNewConnection(int server_socket) {
+    for (;;) {
+        struct sockaddr_storage in_addr;
+        socklen_t in_len = sizeof(in_addr);
+        int infd = accept4(server_socket, (struct sockaddr *)&in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (infd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                _logger->error("Failed to accept socket: {}", strerror(errno));
+            }
+            break;
+        }
+
+        char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
+        if (getnameinfo((struct sockaddr *)&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf,
+                        NI_NUMERICHOST | NI_NUMERICSERV) == 0) {
+            _logger->debug("Accepted connection on descriptor {} (host={}, port={})", infd, hbuf, sbuf);
+        }
+
+        Connection *pc = new Connection(infd, *_client, *_pStorage, _logger, _completed);
+        pc->events = pc->Events();
+
+        struct epoll_event event;
+        event.events = pc->events;
+        event.data.ptr = pc;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, infd, &event)) {
+            _logger->error("Failed to add connection to epoll: {}", strerror(errno));
+            close(infd);
+            delete pc;
+            continue;
+        }
+        _connections.insert(pc);
+        ArmTimer(pc);
+    }
+}
+
+// See Worker.h
+void Worker::OnProcessed(Connection *pc) {
+    if (!pc->isAlive() || (!pc->isReading() && !pc->hasPendingOutput() && !pc->hasCommandsInFlight())) {
+        CloseConnection(pc);
+        return;
+    }
+
+    uint32_t wanted = pc->Events();
+    if (wanted != pc->events) {
+        struct epoll_event event;
+        event.events = wanted;
+        event.data.ptr = pc;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pc->_socket, &event)) {
+            _logger->error("Failed to modify connection events: {}", strerror(errno));
+        }
+        pc->events = wanted;
+    }
+    ArmTimer(pc);
+}
+
+// See Worker.h
+void Worker::CloseConnection(Connection *pc) {
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pc->_socket, nullptr)) {
+        _logger->error("Failed to delete connection from epoll");
+    }
+    _logger->debug("Connection on {} socket closed", pc->_socket);
+
+    close(pc->_socket);
+    _connections.erase(pc);
+    if (pc->in_completed) {
+        _completed.erase(std::find(_completed.begin(), _completed.end(), pc));
+    }
+    delete pc;
+}
+
+// See Worker.h
+void Worker::ArmTimer(Connection *pc) {
+    std::chrono::milliseconds timeout = _idle_timeout;
+    if (pc->hasCommandInProgress()) {
+        if (pc->read_deadline) {
+            return;
+        }
+        timeout = _read_timeout;
+    }
+    pc->read_deadline = pc->hasCommandInProgress();
+
+    if (timeout.count() > 0) {
+        _timers->Schedule(pc->timer, timeout);
+    } else {
+        _timers->Cancel(pc->timer);
+    }
+}
+
+} // namespace Proxy
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,112 @@
+#ifndef AFINA_NETWORK_PROXY_WORKER_H
+#define AFINA_NETWORK_PROXY_WORKER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/client/AsyncClient.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+namespace Logging {
+class Service;
+}
+
+namespace Network {
+
+// Forward declaration, see common/TimerWheel.h
+class TimerWheel;
+
+namespace Proxy {
+
+// Forward declaration, see Connection.h
+class Connection;
+
+/**
+ * # Proxy thread
+ * Accepts client connections on its own sockets and serves them from a single level triggered epoll. Worker owns
+ * an AsyncClient with its own pool of pipelined connections to every backend, client epoll descriptor is nested
+ * into the worker one, so backend responses wake worker up just like client commands do. Nothing is shared
+ * between workers.
+ */
+class Worker {
+public:
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
+           const std::vector<std::string> &backends, Client::AsyncClient::Options options,
+           std::chrono::milliseconds idle_timeout, std::chrono::milliseconds read_timeout);
+    ~Worker();
+
+    /**
+     * Spawns new background thread accepting on the given non blocking sockets
+     */
+    void Start(const std::vector<int> &sockets);
+
+    /**
+     * Signals background thread to stop: it stops accepting and reading, answers commands in flight and exits
+     */
+    void Stop();
+
+    /**
+     * Blocks calling thread until background one for this worker is actually been destoryed
+     */
+    void Join();
+
+protected:
+    void OnRun();
+
+    void OnNewConnection(int server_socket);
+
+    // Closes connection which is done, otherwise updates its epoll events and deadline
+    void OnProcessed(Connection *pc);
+
+    void CloseConnection(Connection *pc);
+
+    // Moves connection deadline after activity, read deadline is not moved by partial command data
+    void ArmTimer(Connection *pc);
+
+private:
+    Worker(const Worker &) = delete;
+    Worker &operator=(const Worker &) = delete;
+
+    std::shared_ptr<Afina::Storage> _pStorage;
+    std::shared_ptr<Afina::Logging::Service> _pLogging;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    std::chrono::milliseconds _idle_timeout;
+    std::chrono::milliseconds _read_timeout;
+
+    std::atomic<bool> isRunning;
+    std::thread _thread;
+
+    int _epoll_fd;
+    int _event_fd;
+    std::vector<int> _sockets;
+
+    // Backends, used by worker thread only
+    std::unique_ptr<Client::AsyncClient> _client;
+
+    std::set<Connection *> _connections;
+
+    // Connections that got responses since the last pass, see Connection
+    std::vector<Connection *> _completed;
+
+    // Connection deadlines, owned by worker thread
+    std::unique_ptr<TimerWheel> _timers;
+};
+
+} // namespace Proxy
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_PROXY_WORKER_H
@@ -0,0 +1,159 @@
+#include "Ring.h"
+
+#include <cstring>
+#include <new>
+
+namespace Afina {
+namespace Network {
+namespace Shm {
+
+namespace {
+
+// Rings smaller than that can't fit a useful request, larger ones are not worth the memory
+constexpr uint32_t kMinCapacity = 4096;
+constexpr uint32_t kMaxCapacity = 1u << 30;
+
+inline std::size_t align8(std::size_t size) { return (size + 7) & ~std::size_t(7); }
+
+void init_ring(RingHeader &ring) {
+    new (&ring.head) std::atomic<uint64_t>(0);
+    new (&ring.tail) std::atomic<uint64_t>(0);
+    new (&ring.sleeping) std::atomic<uint32_t>(0);
+}
+
+} // namespace
+
+constexpr uint32_t Segment::kMagic;
+constexpr uint32_t Segment::kVersion;
+constexpr std::size_t Ring::kRecordHeader;
+constexpr uint32_t Ring::kWrap;
+
+// See Ring.h
+std::size_t Segment::Size(uint32_t capacity) { return sizeof(Segment) + 2 * std::size_t(capacity); }
+
+// See Ring.h
+void Segment::Init(void *memory, uint32_t capacity) {
+    std::memset(memory, 0, sizeof(Segment));
+    Segment *segment = static_cast<Segment *>(memory);
+    segment->magic = kMagic;
+    segment->version = kVersion;
+    segment->capacity = capacity;
+    init_ring(segment->requests);
+    init_ring(segment->responses);
+}
+
+// See Ring.h
+bool Segment::Valid(const void *memory, std::size_t size) {
+    if (size < sizeof(Segment)) {
+        return false;
+    }
+
+    const Segment *segment = static_cast<const Segment *>(memory);
+    uint32_t capacity = segment->capacity;
+    return segment->magic == kMagic && segment->version == kVersion && capacity >= kMinCapacity &&
+           capacity <= kMaxCapacity && (capacity & (capacity - 1)) == 0 && Size(capacity) <= size;
+}
+
+// See Ring.h
+bool Ring::Push(const char *data, std::size_t size) {
+    if (size > MaxRecord(_capacity)) {
+        return false;
+    }
+
+    // Only offsets masked by capacity are used to write, so garbage positions can't move writes out of data
+    uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+    uint64_t head = _header->head.load(std::memory_order_acquire);
+    std::size_t need = kRecordHeader + align8(size);
+    std::size_t offset = tail & (_capacity - 1);
+    std::size_t pad = offset + need > _capacity ? _capacity - offset : 0;
+    if (tail - head > _capacity || tail - head + pad + need > _capacity) {
+        return false;
+    }
+
+    if (pad > 0) {
+        std::memcpy(_data + offset, &kWrap, sizeof(kWrap));
+        offset = 0;
+    }
+    uint32_t len = size;
+    std::memcpy(_data + offset, &len, sizeof(len));
+    std::memcpy(_data + offset + kRecordHeader, data, size);
+
+    // Sequentially consistent store is ordered before the check of sleeping flag in NeedsSignal
+    _header->tail.store(tail + pad + need, std::memory_order_seq_cst);
+    return true;
+}
+
+// See Ring.h
+bool Ring::Peek(const char *&data, std::size_t &size) {
+    uint64_t head = _header->head.load(std::memory_order_relaxed);
+    uint64_t tail = _header->tail.load(std::memory_order_acquire);
+    if (head == tail || _broken) {
+        return false;
+    }
+
+    uint64_t available = tail - head;
+    std::size_t offset = head & (_capacity - 1);
+    if (available > _capacity || (offset & 7) != 0) {
+        _broken = true;
+        return false;
+    }
+
+    // Length is copied once: peer could change it after the check
+    std::size_t pad = 0;
+    uint32_t len;
+    std::memcpy(&len, _data + offset, sizeof(len));
+    if (len == kWrap) {
+        pad = _capacity - offset;
+        offset = 0;
+        std::memcpy(&len, _data, sizeof(len));
+    }
+
+    std::size_t need = kRecordHeader + align8(len);
+    if (len > MaxRecord(_capacity) || offset + need > _capacity || pad + need > available) {
+        _broken = true;
+        return false;
+    }
+
+    data = _data + offset + kRecordHeader;
+    size = len;
+    _peeked = pad + need;
+    return true;
+}
+
+// See Ring.h
+void Ring::Pop() {
+    uint64_t head = _header->head.load(std::memory_order_relaxed);
+    _header->head.store(head + _peeked, std::memory_order_release);
+    _peeked = 0;
+}
+
+// See Ring.h
+bool Ring::Empty() const {
+    return _header->head.load(std::memory_order_relaxed) == _header->tail.load(std::memory_order_acquire);
+}
+
+// See Ring.h
+bool Ring::PrepareWait() {
+    // Pairs with Push: either producer sees the flag or consumer sees the new tail
+    _header->sleeping.store(1, std::memory_order_seq_cst);
+    if (_header->head.load(std::memory_order_relaxed) != _header->tail.load(std::memory_order_seq_cst)) {
+        _header->sleeping.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+// See Ring.h
+void Ring::CancelWait() { _header->sleeping.store(0, std::memory_order_relaxed); }
+
+// See Ring.h
+bool Ring::NeedsSignal() {
+    if (_header->sleeping.load(std::memory_order_seq_cst) == 0) {
+        return false;
+    }
+    return _header->sleeping.exchange(0, std::memory_order_acq_rel) != 0;
+}
+
+} // namespace Shm
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,157 @@
+#ifndef AFINA_NETWORK_SHM_RING_H
+#define AFINA_NETWORK_SHM_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Network {
+namespace Shm {
+
+// Ring positions live in memory shared with another process, they must never fall back to a lock
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "Shared memory needs lock free atomics");
+
+// Size of cache line, producer and consumer positions are kept apart to not bounce it between cores
+constexpr std::size_t kCacheLine = 64;
+
+/**
+ * Busy wait hint for the core: spinning side doesn't starve its sibling hyperthread
+ */
+inline void Relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * Positions of a single ring. Positions grow forever, offset in data is position modulo capacity
+ */
+struct RingHeader {
+    // Next byte to read, written by consumer only
+    alignas(kCacheLine) std::atomic<uint64_t> head;
+
+    // Next byte to write, written by producer only
+    alignas(kCacheLine) std::atomic<uint64_t> tail;
+
+    // Consumer is going to wait for eventfd, producer must signal it after the next push
+    alignas(kCacheLine) std::atomic<uint32_t> sleeping;
+};
+
+/**
+ * # Shared memory segment
+ * Client creates memfd with this header followed by data of request and response rings, each one of
+ * capacity bytes. Server gets the memfd with two eventfds over unix socket: client writes the first one
+ * when server sleeps on requests, server writes the second one when client sleeps on responses.
+ */
+struct Segment {
+    static constexpr uint32_t kMagic = 0x41464d53; // "AFMS"
+    static constexpr uint32_t kVersion = 1;
+
+    uint32_t magic;
+    uint32_t version;
+
+    // Bytes of data in each ring, power of two
+    uint32_t capacity;
+
+    RingHeader requests;
+    RingHeader responses;
+
+    /**
+     * Size of memfd for the given ring capacity
+     */
+    static std::size_t Size(uint32_t capacity);
+
+    /**
+     * Initializes header of a new segment
+     */
+    static void Init(void *memory, uint32_t capacity);
+
+    /**
+     * Checks header of segment mapped from peer. Only the header is trusted after that, positions are
+     * checked by Ring on every access
+     */
+    static bool Valid(const void *memory, std::size_t size);
+
+    /**
+     * Data of request ring followed by data of response ring. Capacity to find the second one must be taken
+     * from the checked copy, peer could change the header any time
+     */
+    char *Data() { return reinterpret_cast<char *>(this) + sizeof(Segment); }
+};
+
+/**
+ * # Single producer single consumer ring of records
+ * Each record is a 4 byte length followed by payload, padded to 8 bytes. Record never wraps: if it doesn't fit
+ * before the end of data, producer puts a wrap marker and starts from the beginning, so consumer always gets
+ * payload as a single piece right in shared memory.
+ *
+ * Peer may write anything into shared memory, so consumer checks every position and length it reads and
+ * reports ring as broken instead of reading out of bounds.
+ */
+class Ring {
+public:
+    // Longest record payload for the given capacity
+    static std::size_t MaxRecord(uint32_t capacity) { return capacity / 2 - kRecordHeader; }
+
+    Ring() : _header(nullptr), _data(nullptr), _capacity(0) {}
+    Ring(RingHeader *header, char *data, uint32_t capacity) : _header(header), _data(data), _capacity(capacity) {}
+
+    /**
+     * Producer: copies record into the ring. Returns false if there is no room for it yet
+     */
+    bool Push(const char *data, std::size_t size);
+
+    /**
+     * Consumer: points to payload of the oldest record without taking it. Returns false if ring is empty
+     */
+    bool Peek(const char *&data, std::size_t &size);
+
+    /**
+     * Consumer: frees the record returned by the last Peek
+     */
+    void Pop();
+
+    /**
+     * Consumer: ring contents or positions are inconsistent, peer is broken or malicious
+     */
+    bool Broken() const { return _broken; }
+
+    bool Empty() const;
+
+    uint32_t capacity() const { return _capacity; }
+
+    /**
+     * Consumer: announces that it is going to wait for signal. Returns false and takes announce back if
+     * something arrived meanwhile, so waiting would miss it
+     */
+    bool PrepareWait();
+
+    /**
+     * Consumer: done with waiting, producer doesn't have to signal anymore
+     */
+    void CancelWait();
+
+    /**
+     * Producer: called after pushes, returns true if consumer waits and must be signaled
+     */
+    bool NeedsSignal();
+
+private:
+    static constexpr std::size_t kRecordHeader = 8;
+    static constexpr uint32_t kWrap = 0xffffffff;
+
+    RingHeader *_header;
+    char *_data;
+    uint32_t _capacity;
+
+    // Bytes to free by Pop
+    std::size_t _peeked = 0;
+    bool _broken = false;
+};
+
+} // namespace Shm
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_SHM_RING_H
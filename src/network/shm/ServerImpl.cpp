@@ -0,0 +1,152 @@
+#include "ServerImpl.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/logging/Service.h>
+#include <network/common/Handoff.h>
+#include <network/common/Listener.h>
+
+#include "Session.h"
+#include "Worker.h"
+
+namespace Afina {
+namespace Network {
+namespace Shm {
+
+namespace {
+
+// Client that connected but doesn't pass its segment in time is dropped, so acceptor isn't stuck with it
+constexpr int kHandshakeTimeoutSec = 1;
+
+} // namespace
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl,
+                       std::chrono::microseconds spin)
+    : Server(ps, pl), _spin(spin), isRunning(false), _server_socket(-1), _next_worker(0) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+    n_workers = std::max<uint32_t>(n_workers, 1);
+
+    // Rings are mapped by processes on the same host only, so there is nothing to bind on TCP
+    if (listenAddresses.size() != 1) {
+        throw std::runtime_error("Shared memory server needs exactly one unix socket address");
+    }
+    Listener::Address address = Listener::Parse(listenAddresses[0]);
+    if (address.CanReusePort()) {
+        throw std::runtime_error("Shared memory server accepts on unix socket only: " + listenAddresses[0]);
+    }
+    _logger->info("Start shared memory network service on {} with {} workers", address.ToString(), n_workers);
+
+    // Spinning worker would only take the single core away from the client it waits for
+    if (std::thread::hardware_concurrency() == 1) {
+        _spin = std::chrono::microseconds(0);
+    }
+
+    _server_socket = Listener::Open(address, true, false);
+    isRunning = true;
+    for (uint32_t i = 0; i < n_workers; i++) {
+        _workers.emplace_back(new Worker(pStorage, pLogging, _spin));
+        _workers.back()->Start();
+    }
+    _thread = std::thread(&ServerImpl::OnRun, this);
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop shared memory network service");
+    isRunning = false;
+    shutdown(_server_socket, SHUT_RDWR);
+    for (auto &worker : _workers) {
+        worker->Stop();
+    }
+}
+
+// See Server.h
+void ServerImpl::Join() {
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    for (auto &worker : _workers) {
+        worker->Join();
+    }
+    _workers.clear();
+
+    Listener::Close(_server_socket);
+    _server_socket = -1;
+}
+
+// See ServerImpl.h
+void ServerImpl::OnRun() {
+    std::vector<int> sockets{_server_socket};
+    for (;;) {
+        struct sockaddr_storage client_addr;
+        socklen_t client_addr_len = sizeof(client_addr);
+        int control = Listener::Accept(sockets, &client_addr, &client_addr_len);
+        if (control == -1) {
+            // Woken up without connection: either socket is shut down by Stop or client gave up
+            if (!isRunning) {
+                break;
+            }
+            continue;
+        }
+        Attach(control);
+    }
+    _logger->debug("Shared memory acceptor stopped");
+}
+
+// See ServerImpl.h
+void ServerImpl::Attach(int control) {
+    std::vector<int> fds;
+    try {
+        struct timeval tv;
+        tv.tv_sec = kHandshakeTimeoutSec;
+        tv.tv_usec = 0;
+        if (setsockopt(control, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == -1) {
+            throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+        }
+
+        // Segment and eventfds come the same way listening sockets are handed over
+        fds = Handoff::Receive(control);
+        if (fds.size() != 3) {
+            throw std::runtime_error("Expected segment and two eventfds, got " + std::to_string(fds.size()) +
+                                     " descriptors");
+        }
+
+        std::unique_ptr<Session> session(new Session(control, fds[0], fds[1], fds[2]));
+        Handoff::Confirm(control);
+
+        _logger->debug("Attached shared memory client on {}", control);
+        _workers[_next_worker]->Add(std::move(session));
+        _next_worker = (_next_worker + 1) % _workers.size();
+    } catch (std::runtime_error &ex) {
+        // Session owns descriptors once constructed, even if it throws
+        _logger->error("Failed to attach shared memory client: {}", ex.what());
+        if (fds.size() != 3) {
+            close(control);
+            for (int fd : fds) {
+                close(fd);
+            }
+        }
+    }
+}
+
+} // namespace Shm
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,82 @@
+#ifndef AFINA_NETWORK_SHM_SERVER_H
+#define AFINA_NETWORK_SHM_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace Shm {
+
+// Forward declaration, see Worker.h
+class Worker;
+
+/**
+ * # Shared memory frontend
+ * Serves co-located clients through request/response rings in memory shared with them, see Ring.h. Client
+ * connects to unix socket given by SetAddresses and passes its segment and eventfds there, acceptor maps
+ * the segment and hands session to a worker. Runs next to one of TCP servers on the same storage.
+ */
+class ServerImpl : public Server {
+public:
+    /**
+     * @param spin time workers keep polling rings after the last request, see Worker.h
+     */
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl,
+               std::chrono::microseconds spin);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+protected:
+    /**
+     * Method executing by acceptor thread
+     */
+    void OnRun();
+
+    /**
+     * Gets segment from a new client and passes session to a worker
+     */
+    void Attach(int control);
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    std::chrono::microseconds _spin;
+
+    // Flag signals that acceptor should continue to operate
+    std::atomic<bool> isRunning;
+
+    // Unix socket clients connect to
+    int _server_socket;
+
+    // Thread accepting clients
+    std::thread _thread;
+
+    // Threads serving sessions, new one goes to the next worker
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::size_t _next_worker;
+};
+
+} // namespace Shm
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_SHM_SERVER_H
@@ -0,0 +1,81 @@
+#include "Session.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+namespace Shm {
+
+// See Session.h
+Session::Session(int control, int memfd, int request_event, int response_event)
+    : _control(control), _request_event(request_event), _response_event(response_event), _memory(MAP_FAILED),
+      _size(0) {
+    try {
+        // Shrunk file turns access to the mapping into SIGBUS, so client must give that up for good
+        int seals = fcntl(memfd, F_GET_SEALS);
+        if (seals == -1 || !(seals & F_SEAL_SHRINK)) {
+            throw std::runtime_error("Segment is not sealed against shrinking");
+        }
+
+        struct stat st;
+        if (fstat(memfd, &st) == -1) {
+            throw std::runtime_error("Failed to stat segment: " + std::string(strerror(errno)));
+        }
+        _size = st.st_size;
+
+        _memory = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+        if (_memory == MAP_FAILED) {
+            throw std::runtime_error("Failed to map segment: " + std::string(strerror(errno)));
+        }
+
+        Segment *segment = static_cast<Segment *>(_memory);
+        if (!Segment::Valid(segment, _size)) {
+            throw std::runtime_error("Malformed segment header");
+        }
+
+        uint32_t capacity = segment->capacity;
+        requests = Ring(&segment->requests, segment->Data(), capacity);
+        responses = Ring(&segment->responses, segment->Data() + capacity, capacity);
+    } catch (...) {
+        close(memfd);
+        Release();
+        throw;
+    }
+    close(memfd);
+}
+
+// See Session.h
+Session::~Session() { Release(); }
+
+// See Session.h
+void Session::Release() {
+    if (_memory != MAP_FAILED) {
+        munmap(_memory, _size);
+        _memory = MAP_FAILED;
+    }
+    for (int *fd : {&_control, &_request_event, &_response_event}) {
+        if (*fd != -1) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+// See Session.h
+void Session::SignalResponses() {
+    if (responses.NeedsSignal()) {
+        eventfd_write(_response_event, 1);
+    }
+}
+
+} // namespace Shm
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,63 @@
+#ifndef AFINA_NETWORK_SHM_SESSION_H
+#define AFINA_NETWORK_SHM_SESSION_H
+
+#include <cstddef>
+#include <string>
+
+#include "Ring.h"
+
+namespace Afina {
+namespace Network {
+namespace Shm {
+
+/**
+ * # Client attached through shared memory
+ * Owns control socket, segment mapping and eventfds passed by the client. Nothing goes through control socket
+ * after the handshake, it only tells that client is gone once it is readable.
+ */
+class Session {
+public:
+    /**
+     * Maps segment passed as memfd, throws std::runtime_error if it is malformed or could be shrunk by
+     * the client under server's feet. Takes ownership of all descriptors in any case
+     */
+    Session(int control, int memfd, int request_event, int response_event);
+    ~Session();
+
+    int control() const { return _control; }
+    int request_event() const { return _request_event; }
+
+    /**
+     * Wakes client up if it waits for responses
+     */
+    void SignalResponses();
+
+    // Server consumes requests and produces responses
+    Ring requests;
+    Ring responses;
+
+    // Response that had no room in the ring yet, goes before anything else
+    std::string pending;
+
+private:
+    Session(const Session &) = delete;
+    Session &operator=(const Session &) = delete;
+
+    /**
+     * Unmaps segment and closes descriptors
+     */
+    void Release();
+
+    int _control;
+    int _request_event;
+    int _response_event;
+
+    void *_memory;
+    std::size_t _size;
+};
+
+} // namespace Shm
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_SHM_SESSION_H
@@ -0,0 +1,243 @@
+#include "Worker.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/logging/Service.h>
+#include <afina/metrics/Counters.h>
+#include <network/common/Request.h>
+
+#include "Session.h"
+
+namespace Afina {
+namespace Network {
+namespace Shm {
+
+namespace {
+
+// Requests of a single session served in a row, so that busy client doesn't starve the rest
+constexpr int kBudget = 64;
+
+// Poll period while some response waits for room: client takes responses without telling server
+constexpr int kPendingPollMs = 1;
+
+} // namespace
+
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
+               std::chrono::microseconds spin)
+    : _pStorage(ps), _pLogging(pl), _spin(spin), isRunning(false), _event_fd(-1), _has_incoming(false) {}
+
+// See Worker.h
+Worker::~Worker() {
+    if (_thread.joinable()) {
+        Stop();
+        Join();
+    }
+}
+
+// See Worker.h
+void Worker::Start() {
+    if (isRunning.exchange(true) == false) {
+        _logger = _pLogging->select("network.shm");
+
+        _event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (_event_fd == -1) {
+            throw std::runtime_error("Failed to create event file descriptor: " + std::string(strerror(errno)));
+        }
+
+        _thread = std::thread(&Worker::OnRun, this);
+    }
+}
+
+// See Worker.h
+void Worker::Stop() {
+    isRunning = false;
+    if (_event_fd != -1 && eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup worker");
+    }
+}
+
+// See Worker.h
+void Worker::Join() {
+    assert(_thread.joinable());
+    _thread.join();
+
+    _sessions.clear();
+    {
+        std::lock_guard<std::mutex> lock(_incoming_mutex);
+        _incoming.clear();
+    }
+    close(_event_fd);
+    _event_fd = -1;
+}
+
+// See Worker.h
+void Worker::Add(std::unique_ptr<Session> session) {
+    {
+        std::lock_guard<std::mutex> lock(_incoming_mutex);
+        _incoming.push_back(std::move(session));
+    }
+    _has_incoming = true;
+    eventfd_write(_event_fd, 1);
+}
+
+// See Worker.h
+void Worker::TakeNew() {
+    std::lock_guard<std::mutex> lock(_incoming_mutex);
+    for (auto &session : _incoming) {
+        _sessions.push_back(std::move(session));
+    }
+    _incoming.clear();
+    _has_incoming = false;
+}
+
+// See Worker.h
+void Worker::OnRun() {
+    auto idle_since = std::chrono::steady_clock::now();
+    while (isRunning) {
+        if (_has_incoming.load(std::memory_order_relaxed)) {
+            TakeNew();
+        }
+
+        bool progress = false;
+        for (std::size_t i = 0; i < _sessions.size();) {
+            bool broken = false;
+            progress |= Serve(*_sessions[i], broken);
+            if (broken) {
+                _logger->warn("Close shared memory session with broken ring");
+                _sessions[i] = std::move(_sessions.back());
+                _sessions.pop_back();
+            } else {
+                i++;
+            }
+        }
+
+        // Clock is read only while idle, busy loop doesn't pay for it
+        if (progress) {
+            idle_since = std::chrono::steady_clock::time_point();
+            continue;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (idle_since == std::chrono::steady_clock::time_point()) {
+            idle_since = now;
+        }
+        if (now - idle_since < _spin) {
+            Relax();
+            continue;
+        }
+
+        Wait();
+        idle_since = std::chrono::steady_clock::time_point();
+    }
+    _logger->debug("Shared memory worker stopped");
+}
+
+// See Worker.h
+bool Worker::Serve(Session &session, bool &broken) {
+    bool progress = false;
+    if (!session.pending.empty()) {
+        if (!session.responses.Push(session.pending.data(), session.pending.size())) {
+            return false;
+        }
+        session.pending.clear();
+        progress = true;
+    }
+
+    const char *data;
+    std::size_t size;
+    for (int served = 0; served < kBudget && session.requests.Peek(data, size); served++) {
+        Metrics::Counters::Instance().Add(Metrics::kBytesRead, size);
+
+        _out.clear();
+        ExecuteRequest(*_pStorage, *_logger, data, size, _out);
+        session.requests.Pop();
+        progress = true;
+
+        if (_out.size() > Ring::MaxRecord(session.responses.capacity())) {
+            _out = "SERVER_ERROR response is too large\r\n";
+        }
+        Metrics::Counters::Instance().Add(Metrics::kBytesWritten, _out.size());
+
+        // Client is slow to take responses, requests wait in their ring till this one gets room
+        if (!session.responses.Push(_out.data(), _out.size())) {
+            session.pending.swap(_out);
+            break;
+        }
+    }
+
+    if (progress) {
+        session.SignalResponses();
+    }
+    broken = session.requests.Broken();
+    return progress;
+}
+
+// See Worker.h
+void Worker::Wait() {
+    // Announce sleep in every ring, something arrived meanwhile if any announce fails
+    bool pending = false;
+    std::size_t prepared = 0;
+    for (; prepared < _sessions.size(); prepared++) {
+        Session &session = *_sessions[prepared];
+        pending |= !session.pending.empty();
+        if (!session.requests.PrepareWait()) {
+            break;
+        }
+    }
+
+    if (prepared == _sessions.size()) {
+        std::vector<struct pollfd> fds(1 + 2 * _sessions.size());
+        fds[0].fd = _event_fd;
+        fds[0].events = POLLIN;
+        for (std::size_t i = 0; i < _sessions.size(); i++) {
+            fds[1 + 2 * i].fd = _sessions[i]->request_event();
+            fds[1 + 2 * i].events = POLLIN;
+            fds[2 + 2 * i].fd = _sessions[i]->control();
+            fds[2 + 2 * i].events = POLLIN;
+        }
+
+        if (poll(fds.data(), fds.size(), pending ? kPendingPollMs : -1) == -1 && errno != EINTR) {
+            _logger->error("Failed to poll sessions: {}", strerror(errno));
+        }
+
+        eventfd_t value;
+        if (fds[0].revents & POLLIN) {
+            eventfd_read(_event_fd, &value);
+        }
+
+        // Client sends nothing over control socket after handshake, so it is readable only once client is gone
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < _sessions.size(); i++) {
+            if (fds[1 + 2 * i].revents & POLLIN) {
+                eventfd_read(_sessions[i]->request_event(), &value);
+            }
+            if (fds[2 + 2 * i].revents) {
+                _logger->debug("Shared memory client is gone");
+                continue;
+            }
+            _sessions[kept++] = std::move(_sessions[i]);
+        }
+        _sessions.resize(kept);
+        prepared = kept;
+    }
+
+    for (std::size_t i = 0; i < prepared; i++) {
+        _sessions[i]->requests.CancelWait();
+    }
+}
+
+} // namespace Shm
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,128 @@
+#ifndef AFINA_NETWORK_SHM_WORKER_H
+#define AFINA_NETWORK_SHM_WORKER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+namespace Logging {
+class Service;
+}
+
+namespace Network {
+namespace Shm {
+
+// Forward declaration, see Session.h
+class Session;
+
+/**
+ * # Thread serving shared memory clients
+ * Polls request rings of its sessions in a loop and keeps spinning for a while after the last request, so
+ * a client sending requests back to back never waits for a wakeup and no syscall is made on either side.
+ * Once spin is over, worker announces that it sleeps in every ring and waits on their eventfds, client
+ * writes eventfd only when it sees that announce.
+ */
+class Worker {
+public:
+    /**
+     * @param spin time to keep polling rings after the last request before going to sleep
+     */
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
+           std::chrono::microseconds spin);
+    ~Worker();
+
+    /**
+     * Spaws background thread serving sessions
+     */
+    void Start();
+
+    /**
+     * Signal background thread to stop, requests not read yet are dropped
+     */
+    void Stop();
+
+    /**
+     * Blocks calling thread until background one is stopped
+     */
+    void Join();
+
+    /**
+     * Passes session to the worker, could be called from any thread
+     */
+    void Add(std::unique_ptr<Session> session);
+
+protected:
+    /**
+     * Method executing by background thread
+     */
+    void OnRun();
+
+    /**
+     * Executes requests of the session and puts responses into its ring, returns whether anything was done.
+     * Session that broke its ring is marked to be closed
+     */
+    bool Serve(Session &session, bool &broken);
+
+    /**
+     * Blocks until some session has requests, goes away or new session is added
+     */
+    void Wait();
+
+    /**
+     * Takes sessions added by Add
+     */
+    void TakeNew();
+
+private:
+    Worker(const Worker &) = delete;
+    Worker &operator=(const Worker &) = delete;
+
+    // afina services
+    std::shared_ptr<Afina::Storage> _pStorage;
+
+    // afina services
+    std::shared_ptr<Afina::Logging::Service> _pLogging;
+
+    // Logger to be used
+    std::shared_ptr<spdlog::logger> _logger;
+
+    std::chrono::microseconds _spin;
+
+    // Flag signals that thread should continue to operate
+    std::atomic<bool> isRunning;
+
+    // Thread serving sessions
+    std::thread _thread;
+
+    // Event "device" used by Stop and Add to wakeup the thread
+    int _event_fd;
+
+    // Sessions served by the thread, owned by it
+    std::vector<std::unique_ptr<Session>> _sessions;
+
+    // Sessions added but not taken by the thread yet
+    std::mutex _incoming_mutex;
+    std::vector<std::unique_ptr<Session>> _incoming;
+    std::atomic<bool> _has_incoming;
+
+    // Response being built, kept to reuse its memory
+    std::string _out;
+};
+
+} // namespace Shm
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_SHM_WORKER_H
@@ -20,6 +20,9 @@
 #include <afina/Storage.h>
 #include <afina/execute/Command.h>
 #include <afina/logging/Service.h>
+#include <afina/metrics/Counters.h>
+#include <afina/metrics/Latency.h>
+#include <network/common/Listener.h>
 
 #include "protocol/Parser.h"
 
@@ -48,58 +51,9 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
         throw std::runtime_error("Unable to mask SIGPIPE");
     }
 
-    // For IPv4 we use struct sockaddr_in:
-    // struct sockaddr_in {
-    //     short int          sin_family;  // Address family, AF_INET
-    //     unsigned short int sin_port;    // Port number
-    //     struct in_addr     sin_addr;    // Internet address
-    //     unsigned char      sin_zero[8]; // Same size as struct sockaddr
-    // };
-    //
-    // Note we need to convert the port to network order
-    struct sockaddr_in server_addr;
-    std::memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;         // IPv4
-    server_addr.sin_port = htons(port);       // TCP port number
-    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
-
-    // Arguments are:
-    // - Family: IPv4
-    // - Type: Full-duplex stream (reliable)
-    // - Protocol: TCP
-    _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (_server_socket == -1) {
-        throw std::runtime_error("Failed to open socket");
-    }
-
-    // when the server closes the socket,the connection must stay in the TIME_WAIT state to
-    // make sure the client received the acknowledgement that the connection has been terminated.
-    // During this time, this port is unavailable to other processes, unless we specify this option
-    //
-    // This option let kernel knows that we are OK that multiple threads/processes are listen on the
-    // same port. In a such case kernel will balance input traffic between all listeners (except those who
-    // are closed already)
-    int opts = 1;
-    if (setsockopt(_server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket setsockopt() failed");
-    }
-
-    // Bind the socket to the address. In other words let kernel know data for what address we'd
-    // like to see in the socket
-    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket bind() failed");
-    }
-
-    // Start listening. The second parameter is the "backlog", or the maximum number of
-    // connections that we'll allow to queue up. Note that listen() doesn't block until
-    // incoming connections arrive. It just makes the OS aware that this process is willing
-    // to accept connections on this socket (which is bound to a specific IP and port)
-    if (listen(_server_socket, 5) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket listen() failed");
-    }
+    // Sockets are non blocking, single thread waits for a connection on any of them with poll. Backlog is the
+    // maximum number of connections that kernel allows to queue up, listen() doesn't block until they arrive
+    _server_sockets = Listener::Open(Listener::Parse(listenAddresses, port), true, 1);
 
     running.store(true);
     _thread = std::thread(&ServerImpl::OnRun, this);
@@ -108,14 +62,19 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
 // See Server.h
 void ServerImpl::Stop() {
     running.store(false);
-    shutdown(_server_socket, SHUT_RDWR);
+    for (int s : _server_sockets) {
+        shutdown(s, SHUT_RDWR);
+    }
 }
 
 // See Server.h
 void ServerImpl::Join() {
     assert(_thread.joinable());
     _thread.join();
-    close(_server_socket);
+    for (int s : _server_sockets) {
+        Listener::Close(s);
+    }
+    _server_sockets.clear();
 }
 
 // See Server.h
@@ -132,11 +91,11 @@ void ServerImpl::OnRun() {
     while (running.load()) {
         _logger->debug("waiting for connection...");
 
-        // The call to accept() blocks until the incoming connection arrives
-        int client_socket;
-        struct sockaddr client_addr;
+        // The call blocks until the incoming connection arrives on any of listening sockets
+        struct sockaddr_storage client_addr;
         socklen_t client_addr_len = sizeof(client_addr);
-        if ((client_socket = accept(_server_socket, (struct sockaddr *)&client_addr, &client_addr_len)) == -1) {
+        int client_socket = Listener::Accept(_server_sockets, &client_addr, &client_addr_len);
+        if (client_socket == -1) {
             continue;
         }
 
@@ -145,7 +104,7 @@ void ServerImpl::OnRun() {
             std::string host = "unknown", port = "-1";
 
             char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
-            if (getnameinfo(&client_addr, client_addr_len, hbuf, sizeof(hbuf), sbuf, sizeof(sbuf),
+            if (getnameinfo((struct sockaddr *)&client_addr, client_addr_len, hbuf, sizeof(hbuf), sbuf, sizeof(sbuf),
                             NI_NUMERICHOST | NI_NUMERICSERV) == 0) {
                 host = hbuf;
                 port = sbuf;
@@ -153,11 +112,16 @@ void ServerImpl::OnRun() {
             _logger->debug("Accepted connection on descriptor {} (host={}, port={})\n", client_socket, host, port);
         }
 
-        // Configure read timeout
+        Metrics::Counters &counters = Metrics::Counters::Instance();
+        counters.Add(Metrics::kTotalConnections);
+        counters.Add(Metrics::kCurrConnections);
+
+        // Configure read timeout, thread blocked in read can't track command deadline, so connection
+        // is dropped once client keeps silence longer than idle timeout. Zero timeval means no timeout
         {
             struct timeval tv;
-            tv.tv_sec = 5; // TODO: make it configurable
-            tv.tv_usec = 0;
+            tv.tv_sec = idleTimeout.count() / 1000;
+            tv.tv_usec = (idleTimeout.count() % 1000) * 1000;
             setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, (const char *)&tv, sizeof tv);
         }
 
@@ -170,6 +134,7 @@ void ServerImpl::OnRun() {
             char client_buffer[4096];
             while ((readed_bytes = read(client_socket, client_buffer, sizeof(client_buffer))) > 0) {
                 _logger->debug("Got {} bytes from socket", readed_bytes);
+                counters.Add(Metrics::kBytesRead, readed_bytes);
 
                 // Single block of data read from the socket could trigger inside actions a multiple times,
                 // for example:
@@ -216,6 +181,7 @@ void ServerImpl::OnRun() {
                     if (command_to_execute && arg_remains == 0) {
                         _logger->debug("Start command execution");
 
+                        uint64_t started = Metrics::Latency::Instance().Start();
                         std::string result;
                         command_to_execute->Execute(*pStorage, argument_for_command, result);
 
@@ -224,6 +190,8 @@ void ServerImpl::OnRun() {
                         if (send(client_socket, result.data(), result.size(), 0) <= 0) {
                             throw std::runtime_error("Failed to send response");
                         }
+                        counters.Add(Metrics::kBytesWritten, result.size());
+                        Metrics::Latency::Instance().Finish(parser.Name(), started);
 
                         // Prepare for the next command
                         command_to_execute.reset();
@@ -244,6 +212,7 @@ void ServerImpl::OnRun() {
 
         // We are done with this connection
         close(client_socket);
+        counters.Add(Metrics::kCurrConnections, -1);
 
         // Prepare for the next command: just in case if connection was closed in the middle of executing something
         command_to_execute.reset();
@@ -0,0 +1,455 @@
+#include "ServerImpl.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/coroutine/Engine.h>
+#include <afina/execute/Command.h>
+#include <afina/logging/Service.h>
+#include <afina/metrics/Counters.h>
+#include <afina/metrics/Latency.h>
+#include <network/common/InputBuffer.h>
+#include <network/common/Listener.h>
+#include <network/common/MemoryBudget.h>
+
+#include "protocol/Parser.h"
+
+namespace Afina {
+namespace Network {
+namespace STcoroutine {
+
+namespace {
+
+// How long pending responses are sent once server is stopping
+constexpr std::chrono::milliseconds kDrainTimeout(5000);
+
+} // namespace
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _event_fd(-1), _epoll_fd(-1), _engine(nullptr), _stopping(false),
+      _dropping(false) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+    _logger->info("Start st_coroutine network service");
+
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
+    }
+
+    // Single acceptor serves all sockets, so one per address is enough
+    if (!inheritedListeners.empty()) {
+        _server_sockets.swap(inheritedListeners);
+        for (int s : _server_sockets) {
+            Listener::SetNonBlocking(s, true);
+        }
+    } else {
+        _server_sockets = Listener::Open(Listener::Parse(listenAddresses, port), true, 1);
+    }
+
+    _event_fd = eventfd(0, EFD_NONBLOCK);
+    if (_event_fd == -1) {
+        throw std::runtime_error("Failed to create event file descriptor: " + std::string(strerror(errno)));
+    }
+
+    _epoll_fd = epoll_create1(0);
+    if (_epoll_fd == -1) {
+        close(_event_fd);
+        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    }
+
+    // Listening sockets are level triggered: acceptor is woken up as long as there are connections to accept
+    _acceptor.reset(new Client(-1));
+    struct epoll_event event;
+    for (int s : _server_sockets) {
+        event.events = EPOLLIN;
+        event.data.ptr = _acceptor.get();
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, s, &event)) {
+            throw std::runtime_error("Failed to add file descriptor to epoll");
+        }
+    }
+
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
+        throw std::runtime_error("Failed to add file descriptor to epoll");
+    }
+
+    // Deadlines resolution is a quarter of second, single wheel rotation is about a minute
+    _timers.reset(new TimerWheel(std::chrono::milliseconds(250), 256));
+    _stopping = false;
+    _dropping = false;
+
+    _work_thread = std::thread(&ServerImpl::OnRun, this);
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop network service");
+
+    // Wakeup thread that is sleep on epoll_wait
+    if (eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup workers");
+    }
+}
+
+// See Server.h
+std::vector<int> ServerImpl::Listeners() const { return _server_sockets; }
+
+// See Server.h
+void ServerImpl::Join() {
+    // Wait for work to be complete
+    _work_thread.join();
+
+    close(_epoll_fd);
+    close(_event_fd);
+    for (int s : _server_sockets) {
+        Listener::Close(s);
+    }
+    _server_sockets.clear();
+    _acceptor.reset();
+    _timers.reset();
+}
+
+// See ServerImpl.h
+void ServerImpl::OnRun() {
+    _logger->info("Start acceptor");
+
+    // Engine must live above the coroutines stacks, so it is not swapped out along with them
+    Coroutine::Engine engine([this](Coroutine::Engine &e) { OnIdle(e); });
+    _engine = &engine;
+
+    // Returns once acceptor and all connections are done
+    engine.start(&ServerImpl::RunMain, this);
+
+    _engine = nullptr;
+    _logger->warn("Acceptor stopped");
+}
+
+// See ServerImpl.h
+void ServerImpl::OnIdle(Coroutine::Engine &engine) {
+    auto now = std::chrono::steady_clock::now();
+    int timeout = _timers->Timeout(now);
+    if (_stopping && !_dropping) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(_drain_deadline - now).count();
+        left = std::max<decltype(left)>(left, 0);
+        timeout = (timeout < 0) ? left : std::min<decltype(left)>(timeout, left);
+    }
+
+    int nevents = epoll_wait(_epoll_fd, _events.data(), _events.size(), timeout);
+    if (nevents == -1 && errno != EINTR) {
+        throw std::runtime_error("Failed to wait for events: " + std::string(strerror(errno)));
+    }
+    _logger->debug("Engine wakeup: {} events", nevents);
+
+    for (int i = 0; i < nevents; i++) {
+        Client *client = static_cast<Client *>(_events[i].data.ptr);
+        if (client != nullptr) {
+            engine.unblock(client->routine);
+            continue;
+        }
+
+        eventfd_t value;
+        eventfd_read(_event_fd, &value);
+        if (!_stopping) {
+            _logger->debug("Start drain of {} connections", _clients.size());
+            _stopping = true;
+            _drain_deadline = std::chrono::steady_clock::now() + kDrainTimeout;
+
+            // Level triggered listener with pending connection would keep waking the acceptor that is gone
+            for (int s : _server_sockets) {
+                if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, s, nullptr)) {
+                    _logger->error("Failed to delete server socket from epoll");
+                }
+            }
+            UnblockAll();
+        }
+    }
+
+    // Coroutine notices its timeout once gets control back
+    now = std::chrono::steady_clock::now();
+    _timers->Advance(now, [&engine](void *data) {
+        Client *client = static_cast<Client *>(data);
+        client->timed_out = true;
+        engine.unblock(client->routine);
+    });
+
+    if (_stopping && !_dropping && now >= _drain_deadline) {
+        _logger->warn("Drop {} connections with pending responses", _clients.size());
+        _dropping = true;
+        UnblockAll();
+    }
+}
+
+// See ServerImpl.h
+void ServerImpl::RunMain(ServerImpl *server) {
+    server->_acceptor->routine = server->_engine->run(&ServerImpl::RunAcceptor, std::move(server));
+}
+
+// See ServerImpl.h
+void ServerImpl::RunAcceptor(ServerImpl *server) {
+    server->Accept();
+
+    // Engine frees coroutine once it returns
+    server->_acceptor->routine = nullptr;
+}
+
+// See ServerImpl.h
+void ServerImpl::RunClient(ServerImpl *server, Client *client) {
+    server->Serve(*client);
+
+    // Closed descriptor leaves epoll as well
+    server->_clients.erase(client);
+    close(client->socket);
+    delete client;
+}
+
+// See ServerImpl.h
+void ServerImpl::Accept() {
+    // Sockets take turns, acceptor sleeps once none of them has a connection
+    std::size_t next = 0, idle = 0;
+    while (!_stopping) {
+        if (idle == _server_sockets.size()) {
+            idle = 0;
+            _engine->block();
+            continue;
+        }
+
+        int server_socket = _server_sockets[next];
+        next = (next + 1) % _server_sockets.size();
+        int client_socket = accept4(server_socket, nullptr, nullptr, SOCK_NONBLOCK);
+        if (client_socket == -1) {
+            if (errno != EINTR && errno != ECONNABORTED) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    _logger->error("Failed to accept socket: {}", strerror(errno));
+                }
+                idle++;
+            }
+            continue;
+        }
+        idle = 0;
+        _logger->debug("Accepted connection on descriptor {}", client_socket);
+
+        // Edge triggered: coroutine is unblocked once socket gets ready after it would block
+        Client *client = new Client(client_socket);
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = client;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, client_socket, &event)) {
+            _logger->error("Failed to add connection to epoll: {}", strerror(errno));
+            close(client_socket);
+            delete client;
+            continue;
+        }
+
+        _clients.insert(client);
+        client->routine = _engine->run(&ServerImpl::RunClient, this, std::move(client));
+    }
+}
+
+// See ServerImpl.h
+void ServerImpl::Serve(Client &client) {
+    Metrics::Counters &counters = Metrics::Counters::Instance();
+    counters.Add(Metrics::kTotalConnections);
+    counters.Add(Metrics::kCurrConnections);
+
+    std::unique_ptr<Execute::Command> command_to_execute;
+    std::string argument_for_command;
+    Protocol::Parser parser;
+    std::size_t arg_remains = 0;
+
+    // Buffers keep data on heap, so coroutine stack stays small and cheap to switch
+    InputBuffer client_buffer;
+    OutputQueue output;
+
+    // Process connection just like MTblocking does:
+    // - read commands until socket alive
+    // - execute each command
+    // - send responses of the whole batch
+    try {
+        ssize_t read_bytes = -1;
+        for (;;) {
+            ArmTimer(client, command_to_execute || !client_buffer.empty());
+
+            std::size_t available = 0;
+            char *tail = client_buffer.Reserve(available);
+            if (tail == nullptr) {
+                throw std::runtime_error("Command is too long");
+            }
+            if ((read_bytes = Read(client, tail, available)) <= 0) {
+                break;
+            }
+            client_buffer.Commit(read_bytes);
+            _logger->debug("Got {} bytes from socket", read_bytes);
+            counters.Add(Metrics::kBytesRead, read_bytes);
+
+            while (!client_buffer.empty()) {
+                // There is no command yet
+                if (!command_to_execute) {
+                    std::size_t parsed = 0;
+                    if (parser.Parse(client_buffer.data(), client_buffer.size(), parsed)) {
+                        _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
+                        command_to_execute = parser.Build(arg_remains);
+                        if (arg_remains > MemoryBudget::kArgumentLimit) {
+                            throw std::runtime_error("Value is too large");
+                        }
+                        if (arg_remains > 0) {
+                            arg_remains += 2;
+                        }
+                    }
+
+                    if (parsed == 0) {
+                        break;
+                    }
+                    client_buffer.Consume(parsed);
+                }
+
+                // There is command, but we still wait for argument to arrive...
+                if (command_to_execute && arg_remains > 0) {
+                    std::size_t to_read = std::min(arg_remains, client_buffer.size());
+                    argument_for_command.append(client_buffer.data(), to_read);
+
+                    client_buffer.Consume(to_read);
+                    arg_remains -= to_read;
+                }
+
+                // Thre is command & argument - RUN!
+                if (command_to_execute && arg_remains == 0) {
+                    uint64_t started = Metrics::Latency::Instance().Start();
+                    std::string result;
+                    command_to_execute->Execute(*pStorage, argument_for_command, result);
+
+                    output.Append(result);
+                    output.Append("\r\n", 2);
+                    Metrics::Latency::Instance().Finish(parser.Name(), started);
+
+                    // Prepare for the next command
+                    command_to_execute.reset();
+                    argument_for_command.resize(0);
+                    parser.Reset();
+                }
+            }
+
+            // Next batch isn't read until responses are taken, so slow reader can't make output grow
+            if (!output.empty() && !Write(client, output)) {
+                throw std::runtime_error("Failed to send response: " + std::string(strerror(errno)));
+            }
+        }
+
+        if (read_bytes == 0) {
+            _logger->debug("Connection closed");
+        } else {
+            throw std::runtime_error(std::string(strerror(errno)));
+        }
+    } catch (std::runtime_error &ex) {
+        if (client.timed_out) {
+            _logger->info("Close connection on descriptor {}: {} timeout", client.socket,
+                          client.read_deadline ? "read" : "idle");
+        } else {
+            _logger->error("Failed to process connection on descriptor {}: {}", client.socket, ex.what());
+        }
+    }
+
+    counters.Add(Metrics::kCurrConnections, -1);
+}
+
+// See ServerImpl.h
+ssize_t ServerImpl::Read(Client &client, char *buf, std::size_t size) {
+    for (;;) {
+        if (_stopping) {
+            return 0;
+        }
+        if (client.timed_out) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+
+        ssize_t got_bytes = read(client.socket, buf, size);
+        if (got_bytes >= 0) {
+            return got_bytes;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            return -1;
+        }
+        if (errno != EINTR) {
+            _engine->block();
+        }
+    }
+}
+
+// See ServerImpl.h
+bool ServerImpl::Write(Client &client, OutputQueue &output) {
+    while (!output.empty()) {
+        if (_dropping || client.timed_out) {
+            errno = ETIMEDOUT;
+            return false;
+        }
+
+        ssize_t written = output.Flush(client.socket);
+        if (written == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return false;
+            }
+            if (errno != EINTR) {
+                _engine->block();
+            }
+            continue;
+        }
+        Metrics::Counters::Instance().Add(Metrics::kBytesWritten, written);
+    }
+    return true;
+}
+
+// See ServerImpl.h
+void ServerImpl::ArmTimer(Client &client, bool in_progress) {
+    std::chrono::milliseconds timeout = idleTimeout;
+    if (in_progress) {
+        if (client.read_deadline) {
+            return;
+        }
+        timeout = readTimeout;
+    }
+    client.read_deadline = in_progress;
+
+    if (timeout.count() > 0) {
+        _timers->Schedule(client.timer, timeout);
+    } else {
+        _timers->Cancel(client.timer);
+    }
+}
+
+// See ServerImpl.h
+void ServerImpl::UnblockAll() {
+    if (_acceptor->routine != nullptr) {
+        _engine->unblock(_acceptor->routine);
+    }
+    for (Client *client : _clients) {
+        _engine->unblock(client->routine);
+    }
+}
+
+} // namespace STcoroutine
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,145 @@
+#ifndef AFINA_NETWORK_ST_COROUTINE_SERVER_H
+#define AFINA_NETWORK_ST_COROUTINE_SERVER_H
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+
+#include <afina/network/Server.h>
+#include <network/common/OutputQueue.h>
+#include <network/common/TimerWheel.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Coroutine {
+class Engine;
+}
+
+namespace Network {
+namespace STcoroutine {
+
+/**
+ * # Network resource manager implementation
+ * Single threaded epoll server, each connection is served by its own coroutine written as plain
+ * blocking code. Once socket would block, coroutine blocks itself in the engine, and when every
+ * coroutine waits for something, engine lets server to wait in epoll_wait and unblock coroutines
+ * whose sockets got ready.
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+    // See Server.h
+    std::vector<int> Listeners() const override;
+
+protected:
+    /**
+     * Socket being served by a coroutine. Lives on heap as it is shared between the coroutine, epoll
+     * and the timer wheel, coroutine stack is swapped out each time it blocks
+     */
+    struct Client {
+        explicit Client(int s) : socket(s), routine(nullptr), read_deadline(false), timed_out(false) {
+            timer.data = this;
+        }
+
+        int socket;
+
+        // Coroutine serving the socket, see Engine::run
+        void *routine;
+
+        // Idle or read deadline
+        TimerWheel::Timer timer;
+        bool read_deadline;
+        bool timed_out;
+    };
+
+    void OnRun();
+
+    // Engine unblocker: waits for socket events and deadlines, unblocks coroutines interested in them
+    void OnIdle(Coroutine::Engine &engine);
+
+    // Coroutine bodies, main one just spawns acceptor as engine doesn't expose handle of the main routine
+    static void RunMain(ServerImpl *server);
+    static void RunAcceptor(ServerImpl *server);
+    static void RunClient(ServerImpl *server, Client *client);
+
+    void Accept();
+    void Serve(Client &client);
+
+    /**
+     * Reads whatever is available, blocks coroutine while there is nothing. Returns 0 once peer closed
+     * connection or server is stopping, -1 on error or timeout
+     */
+    ssize_t Read(Client &client, char *buf, std::size_t size);
+
+    /**
+     * Sends the whole queue, blocks coroutine while socket buffer is full. Returns false on error, timeout
+     * or once drain deadline is over
+     */
+    bool Write(Client &client, OutputQueue &output);
+
+    // Moves connection deadline after activity, read deadline is not moved by partial command data
+    void ArmTimer(Client &client, bool in_progress);
+
+    // Wakes up every coroutine so it could notice stop
+    void UnblockAll();
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Sockets to accept new connections on, one per address
+    std::vector<int> _server_sockets;
+
+    // Custom event "device" used to stop server
+    int _event_fd;
+
+    int _epoll_fd;
+
+    // IO thread
+    std::thread _work_thread;
+
+    // Valid only in IO thread while it runs
+    Coroutine::Engine *_engine;
+
+    // Pseudo client for the listening socket
+    std::unique_ptr<Client> _acceptor;
+
+    // Connections being served
+    std::set<Client *> _clients;
+
+    // Connection deadlines, owned by IO thread
+    std::unique_ptr<TimerWheel> _timers;
+
+    std::array<struct epoll_event, 64> _events;
+
+    // No new commands are read once server is stopping, pending responses are still sent until drain
+    // deadline, then connections are dropped
+    bool _stopping;
+    bool _dropping;
+    std::chrono::steady_clock::time_point _drain_deadline;
+};
+
+} // namespace STcoroutine
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_ST_COROUTINE_SERVER_H
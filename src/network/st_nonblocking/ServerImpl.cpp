@@ -1,6 +1,8 @@
 #include "ServerImpl.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -20,6 +22,7 @@
 
 #include <afina/Storage.h>
 #include <afina/logging/Service.h>
+#include <network/common/Listener.h>
 
 #include "Utils.h"
 
@@ -27,6 +30,14 @@ namespace Afina {
 namespace Network {
 namespace STnonblock {
 
+namespace {
+
+// How long server waits for clients to take queued responses once stop requested. Client
+// which doesn't read its socket must not block server shutdown forever
+constexpr std::chrono::milliseconds kDrainTimeout(5000);
+
+} // namespace
+
 // See Server.h
 ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
 
@@ -45,33 +56,14 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Unable to mask SIGPIPE");
     }
 
-    // Create server socket
-    struct sockaddr_in server_addr;
-    std::memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;         // IPv4
-    server_addr.sin_port = htons(port);       // TCP port number
-    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
-
-    _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (_server_socket == -1) {
-        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
-    }
-
-    int opts = 1;
-    if (setsockopt(_server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
-    }
-
-    if (bind(_server_socket, (struct sockaddr *) &server_addr, sizeof(server_addr)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
-    }
-
-    make_socket_non_blocking(_server_socket);
-    if (listen(_server_socket, 5) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    // Single thread accepts on all sockets, so one per address is enough
+    if (!inheritedListeners.empty()) {
+        _server_sockets.swap(inheritedListeners);
+        for (int s : _server_sockets) {
+            make_socket_non_blocking(s);
+        }
+    } else {
+        _server_sockets = Listener::Open(Listener::Parse(listenAddresses, port), true, 1);
     }
 
     _event_fd = eventfd(0, EFD_NONBLOCK);
@@ -92,10 +84,18 @@ void ServerImpl::Stop() {
     }
 }
 
+// See Server.h
+std::vector<int> ServerImpl::Listeners() const { return _server_sockets; }
+
 // See Server.h
 void ServerImpl::Join() {
     // Wait for work to be complete
     _work_thread.join();
+
+    for (int s : _server_sockets) {
+        Listener::Close(s);
+    }
+    _server_sockets.clear();
 }
 
 // See ServerImpl.h
@@ -106,11 +106,13 @@ void ServerImpl::OnRun() {
         throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
     }
 
-    struct epoll_event event;
-    event.events = EPOLLIN;
-    event.data.fd = _server_socket;
-    if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, _server_socket, &event)) {
-        throw std::runtime_error("Failed to add file descriptor to epoll");
+    for (int s : _server_sockets) {
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = s;
+        if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, s, &event)) {
+            throw std::runtime_error("Failed to add file descriptor to epoll");
+        }
     }
 
     struct epoll_event event2;
@@ -120,81 +122,119 @@ void ServerImpl::OnRun() {
         throw std::runtime_error("Failed to add file descriptor to epoll");
     }
 
-    bool run = true;
+    // Deadlines resolution is a quarter of second, single wheel rotation is about a minute
+    _timers.reset(new TimerWheel(std::chrono::milliseconds(250), 256));
+
+    bool draining = false;
+    std::chrono::steady_clock::time_point deadline;
     std::array<struct epoll_event, 64> mod_list;
-    while (run) {
-        int nmod = epoll_wait(epoll_descr, &mod_list[0], mod_list.size(), -1);
+    while (!draining || !client_connections.empty()) {
+        int timeout = _timers->Timeout();
+        if (draining) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline -
+                                                                              std::chrono::steady_clock::now());
+            if (left.count() <= 0) {
+                _logger->warn("Drop {} connections which didn't take their responses", client_connections.size());
+                break;
+            }
+            if (timeout < 0 || left.count() < timeout) {
+                timeout = left.count();
+            }
+        }
+        if (!_ready.empty()) {
+            timeout = 0;
+        }
+
+        int nmod = epoll_wait(epoll_descr, &mod_list[0], mod_list.size(), timeout);
+        if (nmod == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            _logger->error("Acceptor failed to wait for events: {}", strerror(errno));
+            break;
+        }
         _logger->debug("Acceptor wakeup: {} events", nmod);
 
         for (int i = 0; i < nmod; i++) {
             struct epoll_event &current_event = mod_list[i];
             if (current_event.data.fd == _event_fd) {
-                _logger->debug("Break acceptor due to stop signal");
-                run = false;
+                eventfd_t value;
+                eventfd_read(_event_fd, &value);
+                if (!draining) {
+                    _logger->debug("Drain acceptor due to stop signal");
+                    draining = true;
+                    deadline = std::chrono::steady_clock::now() + kDrainTimeout;
+                    StartDrain(epoll_descr);
+                }
                 continue;
-            } else if (current_event.data.fd == _server_socket) {
-                OnNewConnection(epoll_descr);
+            } else if (std::find(_server_sockets.begin(), _server_sockets.end(), current_event.data.fd) !=
+                       _server_sockets.end()) {
+                if (!draining) {
+                    OnNewConnection(epoll_descr, current_event.data.fd);
+                }
                 continue;
             }
 
             // That is some connection!
             Connection *pc = static_cast<Connection *>(current_event.data.ptr);
+            if (client_connections.find(pc) == client_connections.end()) {
+                // Closed by event processed earlier in this batch
+                continue;
+            }
 
-            auto old_mask = pc->_event.events;
             if ((current_event.events & EPOLLERR) || (current_event.events & EPOLLHUP)) {
                 pc->OnError();
-            } else if (current_event.events & EPOLLRDHUP) {
-                pc->OnClose();
             } else {
-                // Depends on what connection wants...
-                if (current_event.events & EPOLLIN) {
+                // Half closed connection still could have unread commands, read them all and
+                // then EOF stops reading
+                if (current_event.events & (EPOLLIN | EPOLLRDHUP)) {
                     pc->DoRead();
                 }
-                if (current_event.events & EPOLLOUT) {
+                if ((current_event.events & EPOLLOUT) && pc->isAlive()) {
                     pc->DoWrite();
                 }
             }
+            OnProcessed(epoll_descr, pc);
+        }
 
-            // Does it alive?
-            if (!pc->isAlive()) {
-                if (epoll_ctl(epoll_descr, EPOLL_CTL_DEL, pc->_socket, &pc->_event)) {
-                    _logger->error("Failed to delete connection from epoll");
-                }
-
-                close(pc->_socket);
-                client_connections.erase(pc);
-                pc->OnClose();
-
-                delete pc;
-            } else if (pc->_event.events != old_mask) {
-                if (epoll_ctl(epoll_descr, EPOLL_CTL_MOD, pc->_socket, &pc->_event)) {
-                    _logger->error("Failed to change connection event mask");
-
-                    close(pc->_socket);
-                    pc->OnClose();
+        // Connections which used up their budget continue after everybody else got a turn
+        for (std::size_t n = _ready.size(); n > 0 && !_ready.empty(); n--) {
+            Connection *pc = _ready.front();
+            _ready.pop_front();
+            pc->in_ready_list = false;
 
-                    delete pc;
-                }
-            }
+            pc->DoRead();
+            OnProcessed(epoll_descr, pc);
         }
+
+        // Close connections which missed their deadlines
+        _timers->Advance(std::chrono::steady_clock::now(), [this, epoll_descr](void *data) {
+            Connection *pc = static_cast<Connection *>(data);
+            _logger->info("Close connection on descriptor {}: {} timeout", pc->_socket,
+                          pc->read_deadline ? "read" : "idle");
+            CloseConnection(epoll_descr, pc);
+        });
     }
     for (auto client : client_connections) {
         close(client->_socket);
         delete client;
     }
     client_connections.clear();
+    _ready.clear();
+    _timers.reset();
+    close(epoll_descr);
 
     _logger->warn("Acceptor stopped");
 }
 
-void ServerImpl::OnNewConnection(int epoll_descr) {
+void ServerImpl::OnNewConnection(int epoll_descr, int server_socket) {
     for (;;) {
-        struct sockaddr in_addr;
+        struct sockaddr_storage in_addr;
         socklen_t in_len;
 
         // No need to make these sockets non blocking since accept4() takes care of it.
         in_len = sizeof in_addr;
-        int infd = accept4(_server_socket, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        int infd = accept4(server_socket, (struct sockaddr *)&in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (infd == -1) {
             if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
                 break; // We have processed all incoming connections.
@@ -206,8 +246,8 @@ void ServerImpl::OnNewConnection(int epoll_descr) {
 
         // Print host and service info.
         char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
-        int retval =
-                getnameinfo(&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf, NI_NUMERICHOST | NI_NUMERICSERV);
+        int retval = getnameinfo((struct sockaddr *)&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf,
+                                 NI_NUMERICHOST | NI_NUMERICSERV);
         if (retval == 0) {
             _logger->info("Accepted connection on descriptor {} (host={}, port={})\n", infd, hbuf, sbuf);
         }
@@ -227,11 +267,79 @@ void ServerImpl::OnNewConnection(int epoll_descr) {
                 pc->OnError();
                 client_connections.erase(pc);
                 delete pc;
+            } else {
+                ArmTimer(pc);
             }
         }
     }
 }
 
+// See ServerImpl.h
+void ServerImpl::StartDrain(int epoll_descr) {
+    _logger->debug("Start drain of {} connections", client_connections.size());
+    for (int s : _server_sockets) {
+        if (epoll_ctl(epoll_descr, EPOLL_CTL_DEL, s, nullptr)) {
+            _logger->error("Failed to delete server socket from epoll");
+        }
+    }
+
+    for (auto it = client_connections.begin(); it != client_connections.end();) {
+        Connection *pc = *it++;
+        pc->StopReading();
+        if (!pc->hasPendingOutput()) {
+            CloseConnection(epoll_descr, pc);
+        }
+    }
+}
+
+// See ServerImpl.h
+void ServerImpl::CloseConnection(int epoll_descr, Connection *pc) {
+    if (epoll_ctl(epoll_descr, EPOLL_CTL_DEL, pc->_socket, &pc->_event)) {
+        _logger->error("Failed to delete connection from epoll");
+    }
+
+    close(pc->_socket);
+    client_connections.erase(pc);
+    if (pc->in_ready_list) {
+        _ready.erase(std::find(_ready.begin(), _ready.end(), pc));
+    }
+    pc->OnClose();
+
+    delete pc;
+}
+
+// See ServerImpl.h
+void ServerImpl::OnProcessed(int epoll_descr, Connection *pc) {
+    if (!pc->isAlive() || (!pc->isReading() && !pc->hasPendingOutput())) {
+        CloseConnection(epoll_descr, pc);
+        return;
+    }
+
+    if (pc->hasInputReady() && !pc->in_ready_list) {
+        pc->in_ready_list = true;
+        _ready.push_back(pc);
+    }
+    ArmTimer(pc);
+}
+
+// See ServerImpl.h
+void ServerImpl::ArmTimer(Connection *pc) {
+    std::chrono::milliseconds timeout = idleTimeout;
+    if (pc->hasCommandInProgress()) {
+        if (pc->read_deadline) {
+            return;
+        }
+        timeout = readTimeout;
+    }
+    pc->read_deadline = pc->hasCommandInProgress();
+
+    if (timeout.count() > 0) {
+        _timers->Schedule(pc->timer, timeout);
+    } else {
+        _timers->Cancel(pc->timer);
+    }
+}
+
 } // namespace STnonblock
 } // namespace Network
 } // namespace Afina
@@ -1,6 +1,8 @@
 #ifndef AFINA_NETWORK_ST_NONBLOCKING_SERVER_H
 #define AFINA_NETWORK_ST_NONBLOCKING_SERVER_H
 
+#include <deque>
+#include <memory>
 #include <thread>
 #include <vector>
 
@@ -21,7 +23,9 @@ class Worker;
 
 /**
  * # Network resource manager implementation
- * Epoll based server
+ * Epoll based server. Connections are edge triggered and get limited amount of work per wakeup,
+ * connection having more input left is served again from the ready list once others got their turn.
+ * Stop drains: server stops accepting and reading, but sends responses to commands already executed
  */
 class ServerImpl : public Server {
 public:
@@ -37,9 +41,24 @@ public:
     // See Server.h
     void Join() override;
 
+    // See Server.h
+    std::vector<int> Listeners() const override;
+
 protected:
     void OnRun();
-    void OnNewConnection(int);
+    void OnNewConnection(int epoll_descr, int server_socket);
+
+    // Unregister connection from epoll and destroy it
+    void CloseConnection(int epoll_descr, Connection *pc);
+
+    // Stops accepting and reading, connections without queued responses are closed right away
+    void StartDrain(int epoll_descr);
+
+    // Closes connection which is done, otherwise queues it if it has more input and moves its deadline
+    void OnProcessed(int epoll_descr, Connection *pc);
+
+    // Moves connection deadline after activity, read deadline is not moved by partial command data
+    void ArmTimer(Connection *pc);
 
 private:
     // logger to use
@@ -50,8 +69,8 @@ private:
     // Read-only
     uint16_t listen_port;
 
-    // Socket to accept new connection on, shared between acceptors
-    int _server_socket;
+    // Sockets to accept new connections on, one per address
+    std::vector<int> _server_sockets;
 
     // Custom event "device" used to wakeup workers
     int _event_fd;
@@ -60,6 +79,12 @@ private:
     std::thread _work_thread;
 
     std::set<Connection *> client_connections;
+
+    // Connections that used up their budget with more input left in the socket
+    std::deque<Connection *> _ready;
+
+    // Connection deadlines, owned by IO thread
+    std::unique_ptr<TimerWheel> _timers;
 };
 
 } // namespace STnonblock
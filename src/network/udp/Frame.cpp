@@ -0,0 +1,42 @@
+#include "Frame.h"
+
+#include <cstring>
+#include <limits>
+
+#include <arpa/inet.h>
+
+namespace Afina {
+namespace Network {
+namespace Udp {
+
+// See Frame.h
+bool ReadHeader(const char *data, std::size_t size, FrameHeader &header) {
+    if (size < kHeaderSize) {
+        return false;
+    }
+
+    uint16_t fields[4];
+    std::memcpy(fields, data, kHeaderSize);
+    header.request_id = ntohs(fields[0]);
+    header.sequence = ntohs(fields[1]);
+    header.total = ntohs(fields[2]);
+    header.reserved = ntohs(fields[3]);
+    return true;
+}
+
+// See Frame.h
+void WriteHeader(const FrameHeader &header, char *out) {
+    uint16_t fields[4] = {htons(header.request_id), htons(header.sequence), htons(header.total),
+                          htons(header.reserved)};
+    std::memcpy(out, fields, kHeaderSize);
+}
+
+// See Frame.h
+std::size_t FrameCount(std::size_t size) {
+    std::size_t count = size == 0 ? 1 : (size + kMaxPayload - 1) / kMaxPayload;
+    return count > std::numeric_limits<uint16_t>::max() ? 0 : count;
+}
+
+} // namespace Udp
+} // namespace Network
+} // namespace Afina
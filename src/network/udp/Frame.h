@@ -0,0 +1,55 @@
+#ifndef AFINA_NETWORK_UDP_FRAME_H
+#define AFINA_NETWORK_UDP_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Network {
+namespace Udp {
+
+/**
+ * # Memcached UDP frame header
+ * Each datagram starts with 8 bytes, all fields are 16 bit in network byte order:
+ * - request id, chosen by client and copied into every datagram of the response
+ * - sequence number of the datagram within the message
+ * - total number of datagrams in the message
+ * - reserved, must be zero
+ *
+ * Request must fit into a single datagram, response is split into as many as needed
+ */
+struct FrameHeader {
+    uint16_t request_id = 0;
+    uint16_t sequence = 0;
+    uint16_t total = 0;
+    uint16_t reserved = 0;
+};
+
+// Size of the frame header
+constexpr std::size_t kHeaderSize = 8;
+
+// Largest datagram sent, including header. Keeps responses below usual MTU, same as memcached does
+constexpr std::size_t kMaxDatagram = 1400;
+constexpr std::size_t kMaxPayload = kMaxDatagram - kHeaderSize;
+
+/**
+ * Reads header from the start of datagram, returns false if datagram is too short to have one
+ */
+bool ReadHeader(const char *data, std::size_t size, FrameHeader &header);
+
+/**
+ * Writes header into kHeaderSize bytes
+ */
+void WriteHeader(const FrameHeader &header, char *out);
+
+/**
+ * Number of datagrams response of the given size is split into, zero if there are too many of them
+ * to be numbered. Empty response still takes a datagram
+ */
+std::size_t FrameCount(std::size_t size);
+
+} // namespace Udp
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_UDP_FRAME_H
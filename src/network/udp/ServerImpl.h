@@ -0,0 +1,54 @@
+#ifndef AFINA_NETWORK_UDP_SERVER_H
+#define AFINA_NETWORK_UDP_SERVER_H
+
+#include <memory>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace Udp {
+
+// Forward declaration, see Worker.h
+class Worker;
+
+/**
+ * # Memcached UDP frontend
+ * Serves requests sent as memcached UDP datagrams, see Frame.h. Runs next to one of TCP servers on the
+ * same storage: each worker has its own SO_REUSEPORT socket bound to the given port
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Socket per worker
+    std::vector<int> _sockets;
+
+    // Threads serving sockets
+    std::vector<std::unique_ptr<Worker>> _workers;
+};
+
+} // namespace Udp
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_UDP_SERVER_H
@@ -0,0 +1,242 @@
+#include "Worker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/logging/Service.h>
+#include <afina/metrics/Counters.h>
+#include <network/common/Request.h>
+
+#include "Frame.h"
+
+namespace Afina {
+namespace Network {
+namespace Udp {
+
+namespace {
+
+// Datagrams read by a single recvmmsg
+constexpr std::size_t kBatch = 64;
+
+// Largest request accepted, longer ones are truncated by the kernel and answered with error
+constexpr std::size_t kMaxRequest = 8192;
+
+} // namespace
+
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
+    : _pStorage(ps), _pLogging(pl), isRunning(false), _socket(-1), _event_fd(-1) {}
+
+// See Worker.h
+Worker::~Worker() {
+    if (_thread.joinable()) {
+        Stop();
+        Join();
+    }
+}
+
+// See Worker.h
+void Worker::Start(int socket) {
+    if (isRunning.exchange(true) == false) {
+        _logger = _pLogging->select("network.udp");
+        _socket = socket;
+
+        _event_fd = eventfd(0, EFD_CLOEXEC);
+        if (_event_fd == -1) {
+            throw std::runtime_error("Failed to create event file descriptor: " + std::string(strerror(errno)));
+        }
+
+        // Receive buffers never move, so message headers are set up once
+        _in_data.resize(kBatch * kMaxRequest);
+        _in_iov.resize(kBatch);
+        _in_addrs.resize(kBatch);
+        _in_msgs.resize(kBatch);
+        for (std::size_t i = 0; i < kBatch; i++) {
+            _in_iov[i].iov_base = &_in_data[i * kMaxRequest];
+            _in_iov[i].iov_len = kMaxRequest;
+
+            std::memset(&_in_msgs[i], 0, sizeof(_in_msgs[i]));
+            _in_msgs[i].msg_hdr.msg_name = &_in_addrs[i];
+            _in_msgs[i].msg_hdr.msg_iov = &_in_iov[i];
+            _in_msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        _responses.resize(kBatch);
+        _request_ids.resize(kBatch);
+
+        _thread = std::thread(&Worker::OnRun, this);
+    }
+}
+
+// See Worker.h
+void Worker::Stop() {
+    isRunning = false;
+    if (_event_fd != -1 && eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup worker");
+    }
+}
+
+// See Worker.h
+void Worker::Join() {
+    assert(_thread.joinable());
+    _thread.join();
+
+    close(_event_fd);
+    _event_fd = -1;
+}
+
+// See Worker.h
+void Worker::OnRun() {
+    struct pollfd fds[2];
+    fds[0].fd = _socket;
+    fds[0].events = POLLIN;
+    fds[1].fd = _event_fd;
+    fds[1].events = POLLIN;
+
+    while (isRunning) {
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            _logger->error("Failed to poll socket: {}", strerror(errno));
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            OnReadable();
+        }
+    }
+    _logger->debug("UDP worker stopped");
+}
+
+// See Worker.h
+void Worker::OnReadable() {
+    while (isRunning) {
+        for (std::size_t i = 0; i < kBatch; i++) {
+            _in_msgs[i].msg_hdr.msg_namelen = sizeof(_in_addrs[i]);
+            _in_msgs[i].msg_hdr.msg_flags = 0;
+        }
+
+        int got = recvmmsg(_socket, _in_msgs.data(), kBatch, MSG_DONTWAIT, nullptr);
+        if (got == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                _logger->error("Failed to receive datagrams: {}", strerror(errno));
+            }
+            return;
+        }
+        _logger->debug("Got {} datagrams", got);
+
+        for (int i = 0; i < got; i++) {
+            const char *data = static_cast<const char *>(_in_iov[i].iov_base);
+            std::size_t size = _in_msgs[i].msg_len;
+            Metrics::Counters::Instance().Add(Metrics::kBytesRead, size);
+
+            // Nobody to reply to without request id
+            FrameHeader header;
+            if (!ReadHeader(data, size, header)) {
+                _logger->debug("Drop datagram of {} bytes without frame header", size);
+                _request_ids[i] = -1;
+                continue;
+            }
+            _request_ids[i] = header.request_id;
+
+            std::string &out = _responses[i];
+            out.clear();
+            if (_in_msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                out = "SERVER_ERROR request is too large\r\n";
+            } else if (header.sequence != 0 || header.total != 1) {
+                out = "SERVER_ERROR multi-datagram requests are not supported\r\n";
+            } else {
+                ExecuteRequest(*_pStorage, *_logger, data + kHeaderSize, size - kHeaderSize, out);
+            }
+        }
+        Reply(got);
+
+        // Socket is empty most likely, don't waste a syscall to make sure
+        if (std::size_t(got) < kBatch) {
+            return;
+        }
+    }
+}
+
+// See Worker.h
+void Worker::Reply(std::size_t count) {
+    std::size_t frames = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        if (_request_ids[i] == -1) {
+            continue;
+        }
+        if (FrameCount(_responses[i].size()) == 0) {
+            _responses[i] = "SERVER_ERROR response is too large\r\n";
+        }
+        frames += FrameCount(_responses[i].size());
+    }
+
+    // Vectors are sized before the first pointer into them is taken
+    _out_headers.resize(frames * kHeaderSize);
+    _out_iov.resize(frames * 2);
+    _out_msgs.resize(frames);
+
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        if (_request_ids[i] == -1) {
+            continue;
+        }
+
+        const std::string &response = _responses[i];
+        FrameHeader header;
+        header.request_id = uint16_t(_request_ids[i]);
+        header.total = uint16_t(FrameCount(response.size()));
+        for (std::size_t offset = 0; header.sequence < header.total; header.sequence++, n++) {
+            std::size_t len = std::min(kMaxPayload, response.size() - offset);
+
+            char *head = &_out_headers[n * kHeaderSize];
+            WriteHeader(header, head);
+            _out_iov[2 * n].iov_base = head;
+            _out_iov[2 * n].iov_len = kHeaderSize;
+            _out_iov[2 * n + 1].iov_base = const_cast<char *>(response.data() + offset);
+            _out_iov[2 * n + 1].iov_len = len;
+            offset += len;
+
+            struct msghdr &msg = _out_msgs[n].msg_hdr;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_name = &_in_addrs[i];
+            msg.msg_namelen = _in_msgs[i].msg_hdr.msg_namelen;
+            msg.msg_iov = &_out_iov[2 * n];
+            msg.msg_iovlen = 2;
+        }
+    }
+
+    for (std::size_t sent = 0; sent < frames;) {
+        int done = sendmmsg(_socket, &_out_msgs[sent], frames - sent, MSG_DONTWAIT);
+        if (done == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // UDP gives no delivery guarantee anyway, rest of the batch is lost like on a busy network
+            _logger->debug("Drop {} datagrams: {}", frames - sent, strerror(errno));
+            return;
+        }
+
+        for (int i = 0; i < done; i++) {
+            Metrics::Counters::Instance().Add(Metrics::kBytesWritten, _out_msgs[sent + i].msg_len);
+        }
+        sent += done;
+    }
+}
+
+} // namespace Udp
+} // namespace Network
+} // namespace Afina
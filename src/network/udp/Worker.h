@@ -0,0 +1,116 @@
+#ifndef AFINA_NETWORK_UDP_WORKER_H
+#define AFINA_NETWORK_UDP_WORKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+namespace Logging {
+class Service;
+}
+
+namespace Network {
+namespace Udp {
+
+/**
+ * # Thread serving UDP socket
+ * Each worker has its own SO_REUSEPORT socket, so kernel spreads datagrams between workers and there is
+ * nothing shared but storage. Datagrams are read in batches with a single recvmmsg, every datagram is a
+ * standalone request: commands in it are executed right away and responses to the whole batch are sent
+ * with sendmmsg. There is no per client state at all.
+ */
+class Worker {
+public:
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl);
+    ~Worker();
+
+    /**
+     * Spaws background thread serving the given socket
+     */
+    void Start(int socket);
+
+    /**
+     * Signal background thread to stop, requests not read yet are dropped
+     */
+    void Stop();
+
+    /**
+     * Blocks calling thread until background one is stopped
+     */
+    void Join();
+
+protected:
+    /**
+     * Method executing by background thread
+     */
+    void OnRun();
+
+    /**
+     * Reads datagrams in batches until socket is empty and answers them
+     */
+    void OnReadable();
+
+    /**
+     * Splits responses of the batch into datagrams and sends them
+     */
+    void Reply(std::size_t count);
+
+private:
+    Worker(const Worker &) = delete;
+    Worker &operator=(const Worker &) = delete;
+
+    // afina services
+    std::shared_ptr<Afina::Storage> _pStorage;
+
+    // afina services
+    std::shared_ptr<Afina::Logging::Service> _pLogging;
+
+    // Logger to be used
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Flag signals that thread should continue to operate
+    std::atomic<bool> isRunning;
+
+    // Thread serving requests in this worker
+    std::thread _thread;
+
+    // Socket to serve, owned by server
+    int _socket;
+
+    // Event "device" used by Stop to wakeup the thread
+    int _event_fd;
+
+    // Receive batch: datagram buffers and sender addresses, kept across batches
+    std::vector<char> _in_data;
+    std::vector<struct iovec> _in_iov;
+    std::vector<struct sockaddr_storage> _in_addrs;
+    std::vector<struct mmsghdr> _in_msgs;
+
+    // Responses of the current batch by datagram and request ids to send them with, -1 if datagram is dropped
+    std::vector<std::string> _responses;
+    std::vector<int> _request_ids;
+
+    // Send batch: header and response slice for each datagram
+    std::vector<char> _out_headers;
+    std::vector<struct iovec> _out_iov;
+    std::vector<struct mmsghdr> _out_msgs;
+};
+
+} // namespace Udp
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_UDP_WORKER_H
@@ -0,0 +1,139 @@
+#include "Connection.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <afina/metrics/Counters.h>
+#include <afina/metrics/Latency.h>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+// See Connection.h
+Connection::Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl)
+    : _socket(s), _logger(std::move(pl)), pStorage(std::move(ps)) {
+    std::memset(&_msg, 0, sizeof(_msg));
+    _msg.msg_iov = _iov;
+    timer.data = this;
+    Metrics::Counters::Instance().Add(Metrics::kTotalConnections);
+    Metrics::Counters::Instance().Add(Metrics::kCurrConnections);
+}
+
+// See Connection.h
+Connection::~Connection() { Metrics::Counters::Instance().Add(Metrics::kCurrConnections, -1); }
+
+// See Connection.h
+void Connection::OnError() {
+    _logger->warn("Connection on {} socket has error", _socket);
+    is_alive = false;
+}
+
+// See Connection.h
+void Connection::Consume(const char *data, std::size_t size) {
+    if (!is_reading) {
+        return;
+    }
+    Metrics::Counters::Instance().Add(Metrics::kBytesRead, size);
+
+    try {
+        if (client_buffer.empty()) {
+            // Parse right from the provided buffer, only unparsed tail is copied
+            std::size_t consumed = Process(data, size);
+            if (!client_buffer.Append(data + consumed, size - consumed)) {
+                throw std::runtime_error("Command is too long");
+            }
+        } else {
+            if (!client_buffer.Append(data, size)) {
+                throw std::runtime_error("Command is too long");
+            }
+            client_buffer.Consume(Process(client_buffer.data(), client_buffer.size()));
+        }
+    } catch (std::runtime_error &ex) {
+        _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+        is_alive = false;
+    }
+}
+
+// See Connection.h
+std::size_t Connection::Process(const char *data, std::size_t size) {
+    std::size_t consumed = 0;
+
+    // Single block of data could trigger inside actions a multiple times, see STnonblock
+    while (consumed < size) {
+        // There is no command yet
+        if (!command_to_execute) {
+            std::size_t parsed = 0;
+            if (parser.Parse(data + consumed, size - consumed, parsed)) {
+                _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
+                command_to_execute = parser.Build(arg_remains);
+                if (arg_remains > MemoryBudget::kArgumentLimit) {
+                    throw std::runtime_error("Value is too large");
+                }
+                if (arg_remains > 0) {
+                    arg_remains += 2;
+                }
+            }
+
+            if (parsed == 0) {
+                break;
+            }
+            consumed += parsed;
+        }
+
+        // There is command, but we still wait for argument to arrive...
+        if (command_to_execute && arg_remains > 0) {
+            std::size_t to_read = std::min(arg_remains, size - consumed);
+            argument_for_command.append(data + consumed, to_read);
+
+            consumed += to_read;
+            arg_remains -= to_read;
+        }
+
+        // Thre is command & argument - RUN!
+        if (command_to_execute && arg_remains == 0) {
+            uint64_t started = Metrics::Latency::Instance().Start();
+            std::string result;
+            command_to_execute->Execute(*pStorage, argument_for_command, result);
+
+            output.Append(result);
+            output.Append("\r\n", 2);
+            Metrics::Latency::Instance().Finish(parser.Name(), started);
+
+            // Prepare for the next command
+            command_to_execute.reset();
+            argument_for_command.resize(0);
+            parser.Reset();
+        }
+    }
+    return consumed;
+}
+
+// See Connection.h
+bool Connection::PrepareSend() {
+    if (_send_in_flight || output.empty()) {
+        return false;
+    }
+
+    _msg.msg_iovlen = output.Fill(_iov, kSendSegments);
+    _send_in_flight = true;
+    return true;
+}
+
+// See Connection.h
+void Connection::OnSent(std::size_t written) {
+    Metrics::Counters::Instance().Add(Metrics::kBytesWritten, written);
+    output.Advance(written);
+    _send_in_flight = false;
+}
+
+// See Connection.h
+void Connection::OnSendFailed() {
+    _send_in_flight = false;
+    output.Advance(output.size());
+    is_alive = false;
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
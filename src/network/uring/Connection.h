@@ -0,0 +1,129 @@
+#ifndef AFINA_NETWORK_URING_CONNECTION_H
+#define AFINA_NETWORK_URING_CONNECTION_H
+
+#include <memory>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/execute/Command.h>
+#include <network/common/InputBuffer.h>
+#include <network/common/MemoryBudget.h>
+#include <network/common/OutputQueue.h>
+#include <network/common/TimerWheel.h>
+#include <protocol/Parser.h>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+/**
+ * # Client connection
+ * Data arrives from multishot recv completions and responses leave through sends issued by the
+ * owning Worker. Connection itself never makes syscalls, it only parses input, executes commands
+ * and keeps responses until they are sent.
+ *
+ * At most one send is in flight, so that responses are never reordered. Responses produced while
+ * send is in flight are appended to the output queue behind the data being sent and go out with
+ * a single next sendmsg.
+ */
+class Connection {
+public:
+    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl);
+    ~Connection();
+
+    inline int socket() const { return _socket; }
+
+    inline bool isAlive() const { return is_alive; }
+
+    inline bool isReading() const { return is_reading; }
+
+    /**
+     * Part of a command is received, the rest must arrive within read timeout
+     */
+    inline bool hasCommandInProgress() const { return !client_buffer.empty() || command_to_execute; }
+
+    /**
+     * Process bytes received from the client, responses are queued for sending
+     */
+    void Consume(const char *data, std::size_t size);
+
+    /**
+     * Client closed its side or server is going down, no more commands will be accepted
+     */
+    void StopReading() { is_reading = false; }
+
+    void OnError();
+
+    /**
+     * There is something to be sent and no send in flight yet. If so, describes queued output in
+     * the message returned by sendMessage, it must stay untouched until send completes
+     */
+    bool PrepareSend();
+
+    inline const struct msghdr *sendMessage() const { return &_msg; }
+
+    /**
+     * Send completed with the given number of bytes
+     */
+    void OnSent(std::size_t written);
+
+    /**
+     * Send failed, nothing else could be sent
+     */
+    void OnSendFailed();
+
+    inline bool hasPendingOutput() const { return !output.empty(); }
+
+    /**
+     * Client doesn't take its responses, no more input should be received until it does
+     */
+    inline bool isOverBudget() const { return MemoryBudget::Instance().OverBudget(output.size()); }
+
+private:
+    friend class Worker;
+
+    // Operations issued by the worker and not completed yet, connection can't be destroyed until
+    // all of them are done since kernel keeps pointers into it
+    bool recv_armed = false;
+    bool cancel_issued = false;
+
+    // Idle or read deadline in the worker timer wheel
+    TimerWheel::Timer timer;
+    bool read_deadline = false;
+
+    int _socket;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    bool is_alive = true;
+    bool is_reading = true;
+
+    // Parses and executes commands from the given block, returns number of bytes consumed
+    std::size_t Process(const char *data, std::size_t size);
+
+    // Tail of the received data which parser wasn't able to consume yet
+    InputBuffer client_buffer;
+    std::size_t arg_remains;
+    Protocol::Parser parser;
+    std::string argument_for_command;
+    std::unique_ptr<Execute::Command> command_to_execute;
+    std::shared_ptr<Afina::Storage> pStorage;
+
+    // Responses not sent yet, head of the queue is owned by the send in flight
+    OutputQueue output;
+
+    // Message of the send in flight
+    static constexpr int kSendSegments = 64;
+    struct iovec _iov[kSendSegments];
+    struct msghdr _msg;
+    bool _send_in_flight = false;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_URING_CONNECTION_H
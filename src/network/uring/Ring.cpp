@@ -0,0 +1,253 @@
+#include "Ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+namespace {
+
+int io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+void *map_ring(int fd, std::size_t size, off_t offset) {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    if (ptr == MAP_FAILED) {
+        throw std::runtime_error("Failed to map io_uring: " + std::string(strerror(errno)));
+    }
+    return ptr;
+}
+
+} // namespace
+
+// See Ring.h
+Ring::Ring(unsigned entries, bool sqpoll)
+    : _fd(-1), _sqpoll(sqpoll), _sq_ptr(nullptr), _sq_size(0), _cq_ptr(nullptr), _cq_size(0), _sqes(nullptr),
+      _sqes_size(0), _sq_local_head(0), _sq_local_tail(0) {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 2;
+    if (sqpoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = 1000;
+    } else {
+        // Ring is used by a single thread, so kernel could skip some locking and interrupts
+        params.flags |= IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+    }
+
+    _fd = io_uring_setup(entries, &params);
+    if (_fd == -1 && errno == EINVAL && !sqpoll) {
+        // Older kernels do not know about optimization flags
+        params.flags &= ~(IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN);
+        _fd = io_uring_setup(entries, &params);
+    }
+    if (_fd == -1) {
+        throw std::runtime_error("Failed to setup io_uring: " + std::string(strerror(errno)));
+    }
+
+    try {
+        _sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        _cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            _sq_size = _cq_size = std::max(_sq_size, _cq_size);
+        }
+
+        _sq_ptr = map_ring(_fd, _sq_size, IORING_OFF_SQ_RING);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            _cq_ptr = _sq_ptr;
+        } else {
+            _cq_ptr = map_ring(_fd, _cq_size, IORING_OFF_CQ_RING);
+        }
+
+        _sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+        _sqes = static_cast<struct io_uring_sqe *>(map_ring(_fd, _sqes_size, IORING_OFF_SQES));
+    } catch (...) {
+        Release();
+        throw;
+    }
+
+    char *sq = static_cast<char *>(_sq_ptr);
+    _sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    _sq_flags = reinterpret_cast<unsigned *>(sq + params.sq_off.flags);
+    _sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    _sq_entries = params.sq_entries;
+    _sq_local_head = _sq_local_tail = *_sq_tail;
+
+    // SQE slots are never reordered, so index array is an identity map
+    unsigned *array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < _sq_entries; i++) {
+        array[i] = i;
+    }
+
+    char *cq = static_cast<char *>(_cq_ptr);
+    _cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+}
+
+// See Ring.h
+Ring::~Ring() { Release(); }
+
+// See Ring.h
+void Ring::Release() {
+    if (_sqes != nullptr) {
+        munmap(_sqes, _sqes_size);
+    }
+    if (_cq_ptr != nullptr && _cq_ptr != _sq_ptr) {
+        munmap(_cq_ptr, _cq_size);
+    }
+    if (_sq_ptr != nullptr) {
+        munmap(_sq_ptr, _sq_size);
+    }
+    if (_fd != -1) {
+        close(_fd);
+    }
+}
+
+// See Ring.h
+struct io_uring_sqe *Ring::GetSqe() {
+    while (_sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries) {
+        // Queue is full, give everything to the kernel to free slots
+        Submit(0);
+    }
+
+    struct io_uring_sqe *sqe = &_sqes[_sq_local_tail & _sq_mask];
+    _sq_local_tail++;
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+// See Ring.h
+unsigned Ring::Flush() {
+    if (_sq_local_head != _sq_local_tail) {
+        _sq_local_head = _sq_local_tail;
+        __atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+    }
+    return _sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+}
+
+// See Ring.h
+bool Ring::Submit(unsigned wait_nr) {
+    unsigned to_submit = Flush();
+    unsigned flags = 0;
+    if (_sqpoll) {
+        // Kernel thread might go to sleep right before new tail was published, tail store must be
+        // ordered with flags load
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(_sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP) {
+            flags |= IORING_ENTER_SQ_WAKEUP;
+        } else if (to_submit > 0 && wait_nr == 0) {
+            // Kernel thread is running and picks SQEs up by itself
+            return true;
+        }
+    }
+
+    if (to_submit == 0 && wait_nr == 0 && flags == 0) {
+        return true;
+    }
+
+    if (wait_nr > 0) {
+        flags |= IORING_ENTER_GETEVENTS;
+    }
+    if (io_uring_enter(_fd, to_submit, wait_nr, flags) == -1) {
+        if (errno == EINTR) {
+            return false;
+        }
+        if (errno == EAGAIN || errno == EBUSY) {
+            // Completion queue is overflown, caller must reap completions first
+            return true;
+        }
+        throw std::runtime_error("Failed to enter io_uring: " + std::string(strerror(errno)));
+    }
+    return true;
+}
+
+// See Ring.h
+BufferRing::BufferRing(Ring &ring, uint16_t group, unsigned entries, std::size_t buffer_size)
+    : _ring(ring), _group(group), _entries(entries), _buffer_size(buffer_size), _br(nullptr), _buffers(nullptr),
+      _local_tail(0) {
+    if (entries == 0 || (entries & (entries - 1)) != 0 || entries > 32768) {
+        throw std::runtime_error("Number of provided buffers must be power of two");
+    }
+
+    _br_size = entries * sizeof(struct io_uring_buf);
+    void *br = mmap(nullptr, _br_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (br == MAP_FAILED) {
+        throw std::runtime_error("Failed to allocate buffer ring: " + std::string(strerror(errno)));
+    }
+    _br = static_cast<struct io_uring_buf_ring *>(br);
+
+    void *buffers = mmap(nullptr, entries * buffer_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffers == MAP_FAILED) {
+        munmap(_br, _br_size);
+        throw std::runtime_error("Failed to allocate buffers: " + std::string(strerror(errno)));
+    }
+    _buffers = static_cast<char *>(buffers);
+
+    struct io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(_br);
+    reg.ring_entries = entries;
+    reg.bgid = group;
+    if (io_uring_register(_ring.fd(), IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+        munmap(_buffers, _entries * _buffer_size);
+        munmap(_br, _br_size);
+        throw std::runtime_error("Failed to register buffer ring: " + std::string(strerror(errno)));
+    }
+
+    for (unsigned i = 0; i < entries; i++) {
+        Recycle(i);
+    }
+    Publish();
+}
+
+// See Ring.h
+BufferRing::~BufferRing() {
+    struct io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.bgid = _group;
+    io_uring_register(_ring.fd(), IORING_UNREGISTER_PBUF_RING, &reg, 1);
+
+    munmap(_buffers, _entries * _buffer_size);
+    munmap(_br, _br_size);
+}
+
+// See Ring.h
+void BufferRing::Recycle(uint16_t bid) {
+    // Kernel header declares bufs as flexible array wrapped into a struct with empty member, which
+    // is not empty in C++ and shifts the array. Buffers start right at the beginning of the ring
+    struct io_uring_buf *bufs = reinterpret_cast<struct io_uring_buf *>(_br);
+    struct io_uring_buf &buf = bufs[_local_tail & (_entries - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(Buffer(bid));
+    buf.len = _buffer_size;
+    buf.bid = bid;
+    _local_tail++;
+}
+
+// See Ring.h
+void BufferRing::Publish() { __atomic_store_n(&_br->tail, _local_tail, __ATOMIC_RELEASE); }
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
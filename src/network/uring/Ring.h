@@ -0,0 +1,147 @@
+#ifndef AFINA_NETWORK_URING_RING_H
+#define AFINA_NETWORK_URING_RING_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+/**
+ * # Minimal io_uring wrapper
+ * Owns the ring created by raw io_uring_setup syscall and memory shared with the kernel. Ring
+ * must be used by the single thread which created it.
+ *
+ * SQEs taken by GetSqe are queued locally and handed to the kernel all at once by Submit, which
+ * also waits for completions in the same syscall. In SQPOLL mode kernel thread picks SQEs up by
+ * itself and syscall is only needed to wake it up or to wait.
+ */
+class Ring {
+public:
+    /**
+     * @param entries size of submission queue, completion queue is twice as big
+     * @param sqpoll use kernel thread polling submission queue
+     */
+    Ring(unsigned entries, bool sqpoll);
+    ~Ring();
+
+    /**
+     * Returns cleared SQE to fill, if submission queue is full it is flushed first
+     */
+    struct io_uring_sqe *GetSqe();
+
+    /**
+     * Hands all queued SQEs to the kernel and waits until at least wait_nr completions
+     * available. Returns false if wait was interrupted by a signal
+     */
+    bool Submit(unsigned wait_nr);
+
+    /**
+     * Calls f for each available completion and consumes it, returns number of completions
+     */
+    template <typename F> unsigned ForEachCqe(F &&f) {
+        unsigned head = *_cq_head;
+        unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        for (; head != tail; head++, count++) {
+            f(_cqes[head & _cq_mask]);
+        }
+        __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    inline int fd() const { return _fd; }
+
+private:
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    // Unmaps shared memory and closes the ring
+    void Release();
+
+    // Makes locally queued SQEs visible to the kernel, returns number of them
+    unsigned Flush();
+
+    int _fd;
+    bool _sqpoll;
+
+    // Shared rings memory
+    void *_sq_ptr;
+    std::size_t _sq_size;
+    void *_cq_ptr;
+    std::size_t _cq_size;
+    struct io_uring_sqe *_sqes;
+    std::size_t _sqes_size;
+
+    // Submission queue
+    unsigned *_sq_head;
+    unsigned *_sq_tail;
+    unsigned *_sq_flags;
+    unsigned _sq_mask;
+    unsigned _sq_entries;
+
+    // SQEs taken but not yet published to the kernel are in [_sq_local_head, _sq_local_tail)
+    unsigned _sq_local_head;
+    unsigned _sq_local_tail;
+
+    // Completion queue
+    unsigned *_cq_head;
+    unsigned *_cq_tail;
+    unsigned _cq_mask;
+    struct io_uring_cqe *_cqes;
+};
+
+/**
+ * # Provided buffers ring
+ * Pool of equally sized buffers registered in the ring under the given group. Kernel picks buffer
+ * by itself once data arrives, so there is no memory pinned by connections waiting for data.
+ * Buffer must be given back with Recycle once its data is consumed.
+ */
+class BufferRing {
+public:
+    /**
+     * @param entries number of buffers, power of two
+     * @param buffer_size size of each buffer
+     */
+    BufferRing(Ring &ring, uint16_t group, unsigned entries, std::size_t buffer_size);
+    ~BufferRing();
+
+    inline uint16_t group() const { return _group; }
+
+    inline char *Buffer(uint16_t bid) { return _buffers + std::size_t(bid) * _buffer_size; }
+
+    /**
+     * Returns buffer back to the pool, kernel sees it after Publish
+     */
+    void Recycle(uint16_t bid);
+
+    /**
+     * Makes all recycled buffers visible to the kernel
+     */
+    void Publish();
+
+private:
+    BufferRing(const BufferRing &) = delete;
+    BufferRing &operator=(const BufferRing &) = delete;
+
+    Ring &_ring;
+    uint16_t _group;
+    unsigned _entries;
+    std::size_t _buffer_size;
+
+    struct io_uring_buf_ring *_br;
+    std::size_t _br_size;
+    char *_buffers;
+
+    // Tail including recycled but not yet published buffers
+    uint16_t _local_tail;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_URING_RING_H
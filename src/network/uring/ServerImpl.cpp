@@ -0,0 +1,88 @@
+#include "ServerImpl.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/logging/Service.h>
+
+#include <network/common/Listener.h>
+
+#include "Worker.h"
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, bool sqpoll)
+    : Server(ps, pl), _sqpoll(sqpoll) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+
+    // Sockets taken over from the previous process are shared by workers, there is a worker for each one.
+    // Sockets must be blocking: accept is completed by the kernel once connection arrives, while nonblocking
+    // one completes with EAGAIN right away. Flag is on the open file, so previous process may have set it
+    n_workers = std::max<uint32_t>(n_workers, 1);
+    if (!inheritedListeners.empty()) {
+        for (int s : inheritedListeners) {
+            Listener::SetNonBlocking(s, false);
+        }
+        _server_sockets.swap(inheritedListeners);
+    } else {
+        _server_sockets = Listener::Open(Listener::Parse(listenAddresses, port), false, n_workers);
+    }
+
+    std::vector<std::vector<int>> worker_sockets = Listener::Distribute(_server_sockets, n_workers);
+    n_workers = worker_sockets.size();
+    _logger->info("Start uring network service with {} workers{}", n_workers, _sqpoll ? ", sqpoll" : "");
+
+    for (uint32_t i = 0; i < n_workers; i++) {
+        _workers.emplace_back(new Worker(pStorage, pLogging, _sqpoll, idleTimeout, readTimeout));
+        _workers.back()->Start(worker_sockets[i]);
+    }
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop network service");
+    for (auto &worker : _workers) {
+        worker->Stop();
+    }
+}
+
+// See Server.h
+std::vector<int> ServerImpl::Listeners() const { return _server_sockets; }
+
+// See Server.h
+void ServerImpl::Join() {
+    for (auto &worker : _workers) {
+        worker->Join();
+    }
+    _workers.clear();
+
+    for (int s : _server_sockets) {
+        Listener::Close(s);
+    }
+    _server_sockets.clear();
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
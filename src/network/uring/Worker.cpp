@@ -0,0 +1,456 @@
+#include "Worker.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/logging/Service.h>
+#include <network/common/TimerWheel.h>
+
+#include "Connection.h"
+#include "Ring.h"
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+namespace {
+
+// Submission queue size, completion queue is twice as big
+constexpr unsigned kRingEntries = 1024;
+
+// Provided buffers for recv, buffer is returned back right after data is parsed so they are only
+// needed for connections which have data in the current batch of completions
+constexpr unsigned kBuffers = 512;
+constexpr std::size_t kBufferSize = 4096;
+
+// How long worker waits for clients to take queued responses once stop requested
+constexpr long kDrainTimeoutSec = 5;
+
+// Resolution of connection deadlines and size of the wheel, single rotation is about a minute
+constexpr std::chrono::milliseconds kTimerTick(250);
+constexpr std::size_t kTimerSlots = 256;
+
+// Deadlines scheduled after tick is armed could be earlier than it, so thread wakes up at least
+// that often while there are timers
+constexpr std::chrono::milliseconds kMaxTick(1000);
+
+} // namespace
+
+constexpr uint64_t Worker::kOpBits;
+constexpr uint64_t Worker::kOpMask;
+
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, bool sqpoll,
+               std::chrono::milliseconds idle_timeout, std::chrono::milliseconds read_timeout)
+    : _pStorage(ps), _pLogging(pl), _sqpoll(sqpoll), isRunning(false), _event_fd(-1),
+      _event_value(0), _inflight(0), _draining(false), _timeout_armed(false), _idle_timeout(idle_timeout),
+      _read_timeout(read_timeout), _tick_armed(false) {}
+
+// See Worker.h
+Worker::~Worker() {
+    if (_thread.joinable()) {
+        Stop();
+        Join();
+    }
+}
+
+// See Worker.h
+void Worker::Start(std::vector<int> server_sockets) {
+    if (isRunning.exchange(true) == false) {
+        _logger = _pLogging->select("network.worker");
+        _server_sockets = std::move(server_sockets);
+
+        _event_fd = eventfd(0, EFD_CLOEXEC);
+        if (_event_fd == -1) {
+            throw std::runtime_error("Failed to create event file descriptor: " + std::string(strerror(errno)));
+        }
+
+        std::promise<void> ready;
+        std::future<void> started = ready.get_future();
+        _thread = std::thread(&Worker::OnRun, this, std::move(ready));
+        try {
+            started.get();
+        } catch (...) {
+            _thread.join();
+            close(_event_fd);
+            _event_fd = -1;
+            isRunning = false;
+            throw;
+        }
+    }
+}
+
+// See Worker.h
+void Worker::Stop() {
+    isRunning = false;
+    if (_event_fd != -1 && eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup worker");
+    }
+}
+
+// See Worker.h
+void Worker::Join() {
+    assert(_thread.joinable());
+    _thread.join();
+
+    close(_event_fd);
+    _event_fd = -1;
+}
+
+// See Worker.h
+void Worker::OnRun(std::promise<void> ready) {
+    // Ring is created by the thread that uses it: single issuer ring accepts submissions from its creator only
+    try {
+        _ring.reset(new Ring(kRingEntries, _sqpoll));
+        _buffers.reset(new BufferRing(*_ring, 0, kBuffers, kBufferSize));
+    } catch (std::runtime_error &) {
+        ready.set_exception(std::current_exception());
+        return;
+    }
+    ready.set_value();
+
+    _timers.reset(new TimerWheel(kTimerTick, kTimerSlots));
+
+    ArmWakeup();
+    for (std::size_t i = 0; i < _server_sockets.size(); i++) {
+        ArmAccept(i);
+    }
+    while (!_draining || !_connections.empty() || _inflight > 0) {
+        if (_draining && _connections.empty() && _timeout_armed) {
+            // Nothing left to wait for
+            struct io_uring_sqe *sqe = _ring->GetSqe();
+            sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+            sqe->addr = kTimeout;
+            sqe->user_data = kCancel;
+            _inflight++;
+            _timeout_armed = false;
+        }
+        if (_draining && _connections.empty() && _tick_armed) {
+            struct io_uring_sqe *sqe = _ring->GetSqe();
+            sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+            sqe->addr = reinterpret_cast<uint64_t>(&_tick_timeout) | kTimeout;
+            sqe->user_data = kCancel;
+            _inflight++;
+            _tick_armed = false;
+        }
+
+        if (!_ring->Submit(1)) {
+            continue;
+        }
+
+        _ring->ForEachCqe([this](const struct io_uring_cqe &cqe) {
+            if (!(cqe.flags & IORING_CQE_F_MORE)) {
+                _inflight--;
+            }
+
+            Connection *pc = reinterpret_cast<Connection *>(cqe.user_data & ~kOpMask);
+            switch (cqe.user_data & kOpMask) {
+            case kAccept:
+                OnAccept(cqe.user_data >> kOpBits, cqe.res, cqe.flags);
+                break;
+
+            case kWakeup:
+                if (isRunning) {
+                    ArmWakeup();
+                } else if (!_draining) {
+                    StartDrain();
+                }
+                break;
+
+            case kRecv:
+                OnRecv(pc, cqe.res, cqe.flags);
+                break;
+
+            case kSend:
+                OnSend(pc, cqe.res);
+                break;
+
+            case kTimeout:
+                if (cqe.user_data != kTimeout) {
+                    // Periodic tick, close connections which missed their deadlines
+                    _tick_armed = false;
+                    _timers->Advance(std::chrono::steady_clock::now(), [this](void *data) {
+                        Connection *conn = static_cast<Connection *>(data);
+                        _logger->info("Close connection on descriptor {}: {} timeout", conn->socket(),
+                                      conn->read_deadline ? "read" : "idle");
+                        conn->OnError();
+                        if (conn->_send_in_flight) {
+                            Cancel(reinterpret_cast<uint64_t>(conn) | kSend);
+                        }
+                        Check(conn);
+                    });
+                    break;
+                }
+
+                _timeout_armed = false;
+                if (cqe.res == -ETIME) {
+                    _logger->warn("Drop {} connections which didn't take their responses", _connections.size());
+                    for (auto it = _connections.begin(); it != _connections.end();) {
+                        Connection *conn = *it++;
+                        conn->OnError();
+                        if (conn->_send_in_flight) {
+                            Cancel(reinterpret_cast<uint64_t>(conn) | kSend);
+                        }
+                        Check(conn);
+                    }
+                }
+                break;
+
+            default:
+                // Cancel and close results are of no interest
+                break;
+            }
+        });
+
+        // Data from all buffers consumed in this batch is parsed already
+        _buffers->Publish();
+        ArmTick();
+    }
+
+    _timers.reset();
+    _buffers.reset();
+    _ring.reset();
+    _logger->warn("Worker stopped");
+}
+
+// See Worker.h
+void Worker::ArmAccept(std::size_t index) {
+    struct io_uring_sqe *sqe = _ring->GetSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = _server_sockets[index];
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = (index << kOpBits) | kAccept;
+    _inflight++;
+}
+
+// See Worker.h
+void Worker::ArmWakeup() {
+    struct io_uring_sqe *sqe = _ring->GetSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = _event_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&_event_value);
+    sqe->len = sizeof(_event_value);
+    sqe->user_data = kWakeup;
+    _inflight++;
+}
+
+// See Worker.h
+void Worker::ArmRecv(Connection *pc) {
+    struct io_uring_sqe *sqe = _ring->GetSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = pc->socket();
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = _buffers->group();
+    sqe->user_data = reinterpret_cast<uint64_t>(pc) | kRecv;
+    pc->recv_armed = true;
+    pc->cancel_issued = false;
+    _inflight++;
+}
+
+// See Worker.h
+void Worker::SendNext(Connection *pc) {
+    struct io_uring_sqe *sqe = _ring->GetSqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = pc->socket();
+    sqe->addr = reinterpret_cast<uint64_t>(pc->sendMessage());
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = reinterpret_cast<uint64_t>(pc) | kSend;
+    _inflight++;
+}
+
+// See Worker.h
+void Worker::Cancel(uint64_t user_data) {
+    struct io_uring_sqe *sqe = _ring->GetSqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = user_data;
+    sqe->user_data = kCancel;
+    _inflight++;
+}
+
+// See Worker.h
+void Worker::OnAccept(std::size_t index, int res, uint32_t flags) {
+    if (res >= 0) {
+        if (_draining) {
+            close(res);
+        } else {
+            _logger->debug("Accepted connection on descriptor {}", res);
+            Connection *pc = new Connection(res, _pStorage, _logger);
+            _connections.insert(pc);
+            ArmRecv(pc);
+            ArmTimer(pc);
+        }
+    } else if (res != -ECANCELED) {
+        _logger->error("Failed to accept socket: {}", strerror(-res));
+    }
+
+    if (!(flags & IORING_CQE_F_MORE) && !_draining) {
+        ArmAccept(index);
+    }
+}
+
+// See Worker.h
+void Worker::OnRecv(Connection *pc, int res, uint32_t flags) {
+    pc->recv_armed = (flags & IORING_CQE_F_MORE) != 0;
+
+    if (flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        if (res > 0) {
+            pc->Consume(_buffers->Buffer(bid), res);
+        }
+        _buffers->Recycle(bid);
+    }
+
+    if (res == 0) {
+        // Client is done with sending, but still waits for responses
+        pc->StopReading();
+    } else if (res < 0 && res != -ENOBUFS && res != -ECANCELED) {
+        _logger->debug("Recv on descriptor {} failed: {}", pc->socket(), strerror(-res));
+        pc->OnError();
+    }
+
+    if (pc->isAlive() && pc->PrepareSend()) {
+        SendNext(pc);
+    }
+    UpdateRecv(pc);
+    if (pc->isAlive()) {
+        ArmTimer(pc);
+    }
+    Check(pc);
+}
+
+// See Worker.h
+void Worker::OnSend(Connection *pc, int res) {
+    if (res < 0) {
+        _logger->debug("Send on descriptor {} failed: {}", pc->socket(), strerror(-res));
+        pc->OnSendFailed();
+    } else {
+        pc->OnSent(res);
+        if (pc->PrepareSend()) {
+            SendNext(pc);
+        }
+        UpdateRecv(pc);
+        if (pc->isAlive()) {
+            ArmTimer(pc);
+        }
+    }
+    Check(pc);
+}
+
+// See Worker.h
+void Worker::UpdateRecv(Connection *pc) {
+    bool wanted = pc->isAlive() && pc->isReading() && !pc->isOverBudget();
+    if (wanted && !pc->recv_armed) {
+        // Multishot recv stops once it runs out of buffers or it was cancelled
+        ArmRecv(pc);
+    } else if (pc->recv_armed && !pc->cancel_issued && pc->isAlive() && pc->isReading() && pc->isOverBudget()) {
+        // Client doesn't take responses, leave its data in the socket
+        Cancel(reinterpret_cast<uint64_t>(pc) | kRecv);
+        pc->cancel_issued = true;
+    }
+}
+
+// See Worker.h
+void Worker::ArmTimer(Connection *pc) {
+    bool in_progress = pc->isReading() && pc->hasCommandInProgress();
+    std::chrono::milliseconds timeout = _idle_timeout;
+    if (in_progress) {
+        if (pc->read_deadline) {
+            return;
+        }
+        timeout = _read_timeout;
+    }
+    pc->read_deadline = in_progress;
+
+    if (timeout.count() > 0) {
+        _timers->Schedule(pc->timer, timeout);
+    } else {
+        _timers->Cancel(pc->timer);
+    }
+}
+
+// See Worker.h
+void Worker::ArmTick() {
+    if (_tick_armed || _timers->empty()) {
+        return;
+    }
+
+    std::chrono::milliseconds wait(std::min<long>(_timers->Timeout(), kMaxTick.count()));
+    _tick_timeout.tv_sec = wait.count() / 1000;
+    _tick_timeout.tv_nsec = (wait.count() % 1000) * 1000000;
+
+    struct io_uring_sqe *sqe = _ring->GetSqe();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = reinterpret_cast<uint64_t>(&_tick_timeout);
+    sqe->len = 1;
+    sqe->user_data = reinterpret_cast<uint64_t>(&_tick_timeout) | kTimeout;
+    _tick_armed = true;
+    _inflight++;
+}
+
+// See Worker.h
+void Worker::StartDrain() {
+    _logger->debug("Worker starts drain of {} connections", _connections.size());
+    _draining = true;
+    for (std::size_t i = 0; i < _server_sockets.size(); i++) {
+        Cancel((i << kOpBits) | kAccept);
+    }
+
+    _drain_timeout.tv_sec = kDrainTimeoutSec;
+    _drain_timeout.tv_nsec = 0;
+    struct io_uring_sqe *sqe = _ring->GetSqe();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = reinterpret_cast<uint64_t>(&_drain_timeout);
+    sqe->len = 1;
+    sqe->user_data = kTimeout;
+    _timeout_armed = true;
+    _inflight++;
+
+    for (auto it = _connections.begin(); it != _connections.end();) {
+        Connection *pc = *it++;
+        pc->StopReading();
+        Check(pc);
+    }
+}
+
+// See Worker.h
+void Worker::Check(Connection *pc) {
+    if (pc->isAlive() && (pc->isReading() || pc->hasPendingOutput())) {
+        return;
+    }
+
+    if (pc->recv_armed) {
+        if (!pc->cancel_issued) {
+            Cancel(reinterpret_cast<uint64_t>(pc) | kRecv);
+            pc->cancel_issued = true;
+        }
+        return;
+    }
+    if (pc->_send_in_flight) {
+        return;
+    }
+
+    struct io_uring_sqe *sqe = _ring->GetSqe();
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = pc->socket();
+    sqe->user_data = kClose;
+    _inflight++;
+
+    _connections.erase(pc);
+    delete pc;
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,166 @@
+#ifndef AFINA_NETWORK_URING_WORKER_H
+#define AFINA_NETWORK_URING_WORKER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <linux/time_types.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+namespace Logging {
+class Service;
+}
+
+namespace Network {
+
+// Forward declaration, see common/TimerWheel.h
+class TimerWheel;
+
+namespace Uring {
+
+class Connection;
+class Ring;
+class BufferRing;
+
+/**
+ * # Thread running io_uring
+ * Each worker has own ring and listening sockets. Accept and recv are multishot, so they are
+ * armed once and keep producing completions. Data lands into provided buffers chosen by the kernel.
+ * All operations issued while processing a batch of completions are submitted together with the
+ * next wait, so single io_uring_enter serves many connections.
+ */
+class Worker {
+public:
+    /**
+     * @param idle_timeout connection that does nothing that long is closed, zero disables
+     * @param read_timeout command started must be received completely within that time, zero disables
+     */
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, bool sqpoll,
+           std::chrono::milliseconds idle_timeout, std::chrono::milliseconds read_timeout);
+    ~Worker();
+
+    /**
+     * Spaws background thread accepting connections on the given sockets. Waits till the thread sets up its
+     * ring and throws if it fails
+     */
+    void Start(std::vector<int> server_sockets);
+
+    /**
+     * Signal background thread to stop. It stops accepting connections and reading commands,
+     * sends responses to commands already read and then exits
+     */
+    void Stop();
+
+    /**
+     * Blocks calling thread until background one is stopped
+     */
+    void Join();
+
+protected:
+    /**
+     * Method executing by background thread, reports whether ring is set up through ready
+     */
+    void OnRun(std::promise<void> ready);
+
+private:
+    Worker(const Worker &) = delete;
+    Worker &operator=(const Worker &) = delete;
+
+    // Kinds of operations, stored in low bits of user_data. Accept keeps index of its socket above them
+    enum Op : uint64_t { kAccept = 1, kWakeup, kRecv, kSend, kTimeout, kCancel, kClose };
+    static constexpr uint64_t kOpBits = 3;
+    static constexpr uint64_t kOpMask = (1 << kOpBits) - 1;
+
+    void ArmAccept(std::size_t index);
+    void ArmWakeup();
+    void ArmRecv(Connection *pc);
+    void SendNext(Connection *pc);
+    void Cancel(uint64_t user_data);
+
+    /**
+     * Arms recv if connection wants input or cancels it if connection is over its memory budget
+     */
+    void UpdateRecv(Connection *pc);
+
+    void OnAccept(std::size_t index, int res, uint32_t flags);
+    void OnRecv(Connection *pc, int res, uint32_t flags);
+    void OnSend(Connection *pc, int res);
+
+    /**
+     * Stop accepting and reading, connections are closed once their output is sent
+     */
+    void StartDrain();
+
+    /**
+     * Destroys connection if it is done and nothing refers to it
+     */
+    void Check(Connection *pc);
+
+    /**
+     * Moves connection deadline after activity, read deadline is not moved by partial command data
+     */
+    void ArmTimer(Connection *pc);
+
+    /**
+     * Arms timeout waking the thread to expire connection deadlines, if there are any
+     */
+    void ArmTick();
+
+    // afina services
+    std::shared_ptr<Afina::Storage> _pStorage;
+    std::shared_ptr<Afina::Logging::Service> _pLogging;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    bool _sqpoll;
+
+    // Flag signals that thread should continue to operate
+    std::atomic<bool> isRunning;
+
+    std::thread _thread;
+
+    // Listening sockets, one for each address server is bound to. Owned by server
+    std::vector<int> _server_sockets;
+
+    // Event "device" used by Stop to wakeup the thread and buffer the wakeup is read into
+    int _event_fd;
+    uint64_t _event_value;
+
+    // Everything below is owned by the background thread
+    std::unique_ptr<Ring> _ring;
+    std::unique_ptr<BufferRing> _buffers;
+
+    // Number of operations submitted which are not completed yet
+    std::size_t _inflight;
+    bool _draining;
+    bool _timeout_armed;
+    struct __kernel_timespec _drain_timeout;
+
+    // Connection deadlines, wheel is moved by periodic timeout while there are timers in it
+    std::chrono::milliseconds _idle_timeout;
+    std::chrono::milliseconds _read_timeout;
+    std::unique_ptr<TimerWheel> _timers;
+    bool _tick_armed;
+    struct __kernel_timespec _tick_timeout;
+
+    std::set<Connection *> _connections;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_URING_WORKER_H
@@ -32,6 +32,9 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                     state = State::spKey;
                 } else if (name == "get" || name == "gets") {
                     state = State::sgKey;
+                } else if (name == "stats" && c == ' ') {
+                    // stats <subcommand>, arguments are collected the same way as keys
+                    state = State::sgKey;
                 } else if (name == "stats") {
                     state = State::sLF;
                     continue;
@@ -177,7 +180,7 @@ std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
     } else if (name == "get") {
         return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
     } else if (name == "stats") {
-        return std::unique_ptr<Execute::Command>(new Execute::Stats());
+        return std::unique_ptr<Execute::Command>(new Execute::Stats(keys));
     } else {
         throw std::runtime_error("Unsupported command");
     }
@@ -55,6 +55,12 @@ public:
 
     inline const std::string &Name() const { return name; }
 
+    // Fields of the parsed command for those who forward it instead of building: keys of retrieval or the
+    // single key of storage command, arguments of stats
+    inline const std::vector<std::string> &Keys() const { return keys; }
+    inline uint32_t Flags() const { return flags; }
+    inline uint32_t Bytes() const { return bytes; }
+
 private:
     /**
      * State of the command parser. Prefixes are:
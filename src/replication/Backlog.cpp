@@ -0,0 +1,74 @@
+#include "Backlog.h"
+
+namespace Afina {
+namespace Replication {
+
+// See Backlog.h
+Backlog::Backlog(std::size_t capacity) : _capacity(capacity), _first(0), _size(0), _waiting(0), _wakeups(0) {}
+
+// See Backlog.h
+void Backlog::Append(Op op, const std::string &key, const std::string &value) {
+    std::string record;
+    record.reserve(RecordSize(key, value));
+    AppendRecord(op, key, value, record);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _size += record.size();
+    _records.push_back(std::move(record));
+    while (_size > _capacity && _records.size() > 1) {
+        _size -= _records.front().size();
+        _records.pop_front();
+        _first++;
+    }
+    if (_waiting > 0) {
+        _appended.notify_all();
+    }
+}
+
+// See Backlog.h
+uint64_t Backlog::Next() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _first + _records.size();
+}
+
+// See Backlog.h
+bool Backlog::Contains(uint64_t seq) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return seq >= _first && seq <= _first + _records.size();
+}
+
+// See Backlog.h
+Backlog::Status Backlog::Read(uint64_t seq, std::size_t max_bytes, std::chrono::milliseconds timeout, std::string &out,
+                              uint32_t &count) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (seq == _first + _records.size()) {
+        uint64_t wakeups = _wakeups;
+        _waiting++;
+        _appended.wait_for(lock, timeout, [&] { return seq != _first + _records.size() || wakeups != _wakeups; });
+        _waiting--;
+    }
+
+    if (seq < _first || seq > _first + _records.size()) {
+        return Status::kLost;
+    }
+
+    count = 0;
+    for (std::size_t i = seq - _first; i < _records.size(); i++) {
+        if (count > 0 && out.size() + _records[i].size() > max_bytes) {
+            break;
+        }
+        out.append(_records[i]);
+        count++;
+    }
+    return count > 0 ? Status::kOk : Status::kEmpty;
+}
+
+// See Backlog.h
+void Backlog::Wake() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _wakeups++;
+    _appended.notify_all();
+}
+
+} // namespace Replication
+} // namespace Afina
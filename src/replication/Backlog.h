@@ -0,0 +1,85 @@
+#ifndef AFINA_REPLICATION_BACKLOG_H
+#define AFINA_REPLICATION_BACKLOG_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "Stream.h"
+
+namespace Afina {
+namespace Replication {
+
+/**
+ * # Bounded mutation log of the primary
+ * Keeps the latest mutations as raw records, see Stream.h, each one has a position: sequence number counted from
+ * zero since primary start. Log is bounded in bytes, append drops the oldest records instead of waiting for
+ * replicas to take them, so client writes never wait for a slow replica. Replica which position is dropped has to
+ * start over from a snapshot.
+ *
+ * Thread safe: mutations are appended by client threads, every replica reads it from its own thread
+ */
+class Backlog {
+public:
+    enum class Status {
+        // Records are read
+        kOk,
+        // Nothing new within timeout or reader is woken up
+        kEmpty,
+        // Position is dropped from the log or never was there
+        kLost
+    };
+
+    explicit Backlog(std::size_t capacity);
+
+    /**
+     * Logs mutation, the oldest ones are dropped to stay within capacity
+     */
+    void Append(Op op, const std::string &key, const std::string &value);
+
+    /**
+     * Position the next mutation gets
+     */
+    uint64_t Next() const;
+
+    /**
+     * Whether reading could continue from the position
+     */
+    bool Contains(uint64_t seq) const;
+
+    /**
+     * Appends records starting from the position to out while they fit into max_bytes, at least one is taken.
+     * If there are no records yet, waits for them up to timeout
+     */
+    Status Read(uint64_t seq, std::size_t max_bytes, std::chrono::milliseconds timeout, std::string &out,
+                uint32_t &count);
+
+    /**
+     * Wakes up all readers waiting for records
+     */
+    void Wake();
+
+private:
+    const std::size_t _capacity;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _appended;
+
+    // Records of positions from _first on and their total size
+    std::deque<std::string> _records;
+    uint64_t _first;
+    std::size_t _size;
+
+    // Readers waiting for records and number of Wake calls, so that a woken reader leaves
+    std::size_t _waiting;
+    uint64_t _wakeups;
+};
+
+} // namespace Replication
+} // namespace Afina
+
+#endif // AFINA_REPLICATION_BACKLOG_H
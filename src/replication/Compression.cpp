@@ -0,0 +1,152 @@
+#include "Compression.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace Afina {
+namespace Replication {
+
+namespace {
+
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kMaxOffset = 65535;
+constexpr int kHashBits = 12;
+
+inline uint32_t read32(const char *p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hash(uint32_t value) { return (value * 2654435761u) >> (32 - kHashBits); }
+
+// Length above the token nibble as 255 continued bytes
+void put_length(std::size_t length, std::string &out) {
+    while (length >= 255) {
+        out.push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+void put_sequence(const char *literals, std::size_t n_literals, std::size_t offset, std::size_t match,
+                  std::string &out) {
+    std::size_t match_code = match > 0 ? match - kMinMatch : 0;
+    uint8_t token = static_cast<uint8_t>((n_literals < 15 ? n_literals : 15) << 4);
+    token |= static_cast<uint8_t>(match_code < 15 ? match_code : 15);
+    out.push_back(static_cast<char>(token));
+    if (n_literals >= 15) {
+        put_length(n_literals - 15, out);
+    }
+    out.append(literals, n_literals);
+
+    if (match > 0) {
+        out.push_back(static_cast<char>(offset & 0xff));
+        out.push_back(static_cast<char>(offset >> 8));
+        if (match_code >= 15) {
+            put_length(match_code - 15, out);
+        }
+    }
+}
+
+std::size_t get_length(const uint8_t *&in, const uint8_t *end) {
+    std::size_t length = 0;
+    for (;;) {
+        if (in == end) {
+            throw std::runtime_error("Compressed data is truncated");
+        }
+        uint8_t byte = *in++;
+        length += byte;
+        if (byte != 255) {
+            return length;
+        }
+    }
+}
+
+} // namespace
+
+// See Compression.h
+void Compress(const char *data, std::size_t size, std::string &out) {
+    // Positions are stored plus one, zero is an empty slot
+    std::vector<uint32_t> table(1 << kHashBits, 0);
+
+    std::size_t anchor = 0;
+    std::size_t i = 0;
+    while (i + kMinMatch <= size) {
+        uint32_t sequence = read32(data + i);
+        uint32_t &slot = table[hash(sequence)];
+        std::size_t candidate = slot;
+        slot = static_cast<uint32_t>(i + 1);
+
+        if (candidate == 0 || i + 1 - candidate > kMaxOffset || read32(data + candidate - 1) != sequence) {
+            i++;
+            continue;
+        }
+        candidate--;
+
+        std::size_t match = kMinMatch;
+        while (i + match < size && data[candidate + match] == data[i + match]) {
+            match++;
+        }
+        put_sequence(data + anchor, i - anchor, i - candidate, match, out);
+        i += match;
+        anchor = i;
+    }
+    put_sequence(data + anchor, size - anchor, 0, 0, out);
+}
+
+// See Compression.h
+void Decompress(const char *data, std::size_t size, std::size_t raw_size, std::string &out) {
+    const uint8_t *in = reinterpret_cast<const uint8_t *>(data);
+    const uint8_t *end = in + size;
+    std::size_t start = out.size();
+    out.reserve(start + raw_size);
+
+    while (in < end) {
+        uint8_t token = *in++;
+        std::size_t n_literals = token >> 4;
+        if (n_literals == 15) {
+            n_literals += get_length(in, end);
+        }
+        if (n_literals > static_cast<std::size_t>(end - in) || out.size() - start + n_literals > raw_size) {
+            throw std::runtime_error("Compressed literals are out of bounds");
+        }
+        out.append(reinterpret_cast<const char *>(in), n_literals);
+        in += n_literals;
+        if (in == end) {
+            break;
+        }
+
+        if (end - in < 2) {
+            throw std::runtime_error("Compressed data is truncated");
+        }
+        std::size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        std::size_t match = (token & 0x0f) + kMinMatch;
+        if ((token & 0x0f) == 15) {
+            match += get_length(in, end);
+        }
+        if (offset == 0 || offset > out.size() - start || out.size() - start + match > raw_size) {
+            throw std::runtime_error("Compressed match is out of bounds");
+        }
+
+        // Match overlapping bytes it produces repeats them, so it is copied byte by byte
+        std::size_t from = out.size() - offset;
+        if (offset >= match) {
+            out.append(out, from, match);
+        } else {
+            for (std::size_t j = 0; j < match; j++) {
+                out.push_back(out[from + j]);
+            }
+        }
+    }
+
+    if (out.size() - start != raw_size) {
+        throw std::runtime_error("Decompressed size mismatch");
+    }
+}
+
+} // namespace Replication
+} // namespace Afina
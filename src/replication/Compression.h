@@ -0,0 +1,33 @@
+#ifndef AFINA_REPLICATION_COMPRESSION_H
+#define AFINA_REPLICATION_COMPRESSION_H
+
+#include <cstddef>
+#include <string>
+
+namespace Afina {
+namespace Replication {
+
+/**
+ * # Block compression of the replication stream
+ * Byte oriented LZ77 in the spirit of LZ4: input is split into sequences of literals followed by a back reference
+ * into the last 64KB of output. Each sequence starts with a token byte, high nibble is a number of literals, low
+ * one is a match length above the minimal 4 bytes, value 15 of either is continued by bytes added to it while they
+ * are 255. Literals follow, then 2 byte little endian offset of the match. The last sequence has literals only.
+ *
+ * Stream is mostly keys sharing prefixes and repeating values, that compresses well at speed of a memory copy.
+ */
+
+/**
+ * Appends compressed data to out
+ */
+void Compress(const char *data, std::size_t size, std::string &out);
+
+/**
+ * Appends data decompressed to raw_size bytes to out, throws std::runtime_error if data is malformed
+ */
+void Decompress(const char *data, std::size_t size, std::size_t raw_size, std::string &out);
+
+} // namespace Replication
+} // namespace Afina
+
+#endif // AFINA_REPLICATION_COMPRESSION_H
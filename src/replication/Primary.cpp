@@ -0,0 +1,264 @@
+#include "Primary.h"
+
+#include <random>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/logging/Service.h>
+
+namespace Afina {
+namespace Replication {
+
+namespace {
+
+// Replica must say hello within that time
+constexpr int kHelloTimeout = 5;
+
+// Replica that takes nothing for that long is dropped
+constexpr int kSendTimeout = 60;
+
+void set_timeout(int socket, int option, int seconds) {
+    struct timeval tv;
+    tv.tv_sec = seconds;
+    tv.tv_usec = 0;
+    if (setsockopt(socket, SOL_SOCKET, option, &tv, sizeof(tv)) == -1) {
+        throw std::runtime_error("Failed to set socket timeout");
+    }
+}
+
+} // namespace
+
+constexpr std::size_t Primary::kBatchSize;
+constexpr std::chrono::milliseconds Primary::kPingPeriod;
+
+// See Primary.h
+Primary::Primary(std::shared_ptr<Afina::Storage> backend, std::shared_ptr<Afina::Logging::Service> pl,
+                 const std::string &address, std::size_t backlog_size)
+    : _backend(backend), _pLogging(pl), _address(address), _backlog(backlog_size), _run_id(0), _running(false),
+      _socket(-1) {}
+
+// See Primary.h
+Primary::~Primary() {
+    if (_running) {
+        Stop();
+    }
+}
+
+// See Primary.h
+void Primary::Start() {
+    _backend->Start();
+    _logger = _pLogging->select("replication");
+
+    // Zero is reserved for replica that has never been synced
+    std::random_device random;
+    while (_run_id == 0) {
+        _run_id = (static_cast<uint64_t>(random()) << 32) | random();
+    }
+
+    _socket = Network::Listener::Open(Network::Listener::Parse(_address), true, false);
+    _running = true;
+    _acceptor = std::thread(&Primary::OnAccept, this);
+    _logger->info("Accept replicas on {}", Address().ToString());
+}
+
+// See Primary.h
+void Primary::Stop() {
+    if (_running.exchange(false)) {
+        shutdown(_socket, SHUT_RDWR);
+        _acceptor.join();
+        Network::Listener::Close(_socket);
+        _socket = -1;
+
+        // Replica threads take the lock on exit, so they are joined without it
+        std::list<Session> sessions;
+        {
+            std::lock_guard<std::mutex> lock(_sessions_mutex);
+            sessions.swap(_sessions);
+            for (auto &session : sessions) {
+                shutdown(session.socket, SHUT_RDWR);
+            }
+        }
+        _backlog.Wake();
+        for (auto &session : sessions) {
+            session.thread.join();
+            close(session.socket);
+        }
+    }
+    _backend->Stop();
+}
+
+// See Primary.h
+bool Primary::Put(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    if (!_backend->Put(key, value)) {
+        return false;
+    }
+    _backlog.Append(Op::kPut, key, value);
+    return true;
+}
+
+// See Primary.h
+bool Primary::PutIfAbsent(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    if (!_backend->PutIfAbsent(key, value)) {
+        return false;
+    }
+    _backlog.Append(Op::kPut, key, value);
+    return true;
+}
+
+// See Primary.h
+bool Primary::Set(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    if (!_backend->Set(key, value)) {
+        return false;
+    }
+    _backlog.Append(Op::kPut, key, value);
+    return true;
+}
+
+// See Primary.h
+bool Primary::Delete(const std::string &key) {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    if (!_backend->Delete(key)) {
+        return false;
+    }
+    _backlog.Append(Op::kDelete, key, std::string());
+    return true;
+}
+
+// See Primary.h
+void Primary::OnAccept() {
+    while (_running) {
+        struct sockaddr_storage addr;
+        socklen_t len = sizeof(addr);
+        int socket = Network::Listener::Accept({_socket}, &addr, &len);
+        if (socket == -1) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_sessions_mutex);
+        if (!_running) {
+            close(socket);
+            break;
+        }
+
+        // Forget replicas that are gone
+        for (auto it = _sessions.begin(); it != _sessions.end();) {
+            if (it->done) {
+                it->thread.join();
+                close(it->socket);
+                it = _sessions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        _sessions.emplace_back();
+        Session &session = _sessions.back();
+        session.socket = socket;
+        session.thread = std::thread(&Primary::OnReplica, this, &session);
+    }
+}
+
+// See Primary.h
+void Primary::OnReplica(Session *session) {
+    try {
+        Serve(session->socket);
+    } catch (std::runtime_error &ex) {
+        if (_running) {
+            _logger->warn("Replica on descriptor {} is gone: {}", session->socket, ex.what());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_sessions_mutex);
+    session->done = true;
+}
+
+// See Primary.h
+void Primary::Serve(int socket) {
+    set_timeout(socket, SO_RCVTIMEO, kHelloTimeout);
+    set_timeout(socket, SO_SNDTIMEO, kSendTimeout);
+
+    std::string raw;
+    FrameHeader hello = ReceiveFrame(socket, raw);
+    if (hello.type != static_cast<uint32_t>(Frame::kHello)) {
+        throw std::runtime_error("Replica must start with hello");
+    }
+
+    uint64_t seq = hello.seq;
+    bool resync = hello.run_id != _run_id || !_backlog.Contains(seq);
+    if (!resync) {
+        _logger->info("Replica on descriptor {} continues from {}", socket, seq);
+    }
+
+    while (_running) {
+        if (resync) {
+            seq = SendSnapshot(socket);
+            resync = false;
+        }
+
+        std::string batch;
+        uint32_t count = 0;
+        switch (_backlog.Read(seq, kBatchSize, kPingPeriod, batch, count)) {
+        case Backlog::Status::kOk:
+            SendFrame(socket, Frame::kBatch, seq, _run_id, count, batch);
+            seq += count;
+            break;
+        case Backlog::Status::kEmpty:
+            SendFrame(socket, Frame::kPing, seq, _run_id);
+            break;
+        case Backlog::Status::kLost:
+            _logger->warn("Replica on descriptor {} fell behind the backlog at {}, resync", socket, seq);
+            resync = true;
+            break;
+        }
+    }
+}
+
+// See Primary.h
+uint64_t Primary::SendSnapshot(int socket) {
+    // Writes ordered before that position are in backend already, the ones after it are replayed from the log.
+    // Scan may see some of the latter too, but records are whole values, so replaying them again converges
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        seq = _backlog.Next();
+    }
+
+    // Backend may hold its own lock while scanning, so nothing is sent from the visitor: chunks are compressed
+    // as they fill up and only compressed frames are kept till the scan is over
+    std::string frames, chunk;
+    uint32_t count = 0;
+    std::size_t keys = 0;
+    PackFrame(Frame::kSnapshotBegin, seq, _run_id, 0, std::string(), frames);
+    bool scanned = _backend->Scan([&](const std::string &key, const std::string &value) {
+        if (count > 0 && chunk.size() + RecordSize(key, value) > kBatchSize) {
+            PackFrame(Frame::kSnapshot, seq, _run_id, count, chunk, frames);
+            chunk.clear();
+            count = 0;
+        }
+        AppendRecord(Op::kPut, key, value, chunk);
+        count++;
+        keys++;
+    });
+    if (!scanned) {
+        throw std::runtime_error("Storage doesn't support snapshots");
+    }
+    if (count > 0) {
+        PackFrame(Frame::kSnapshot, seq, _run_id, count, chunk, frames);
+    }
+    PackFrame(Frame::kSnapshotEnd, seq, _run_id, 0, std::string(), frames);
+    SendPacked(socket, frames);
+
+    _logger->info("Sent snapshot of {} keys at {} to replica on descriptor {}", keys, seq, socket);
+    return seq;
+}
+
+} // namespace Replication
+} // namespace Afina
@@ -0,0 +1,136 @@
+#ifndef AFINA_REPLICATION_PRIMARY_H
+#define AFINA_REPLICATION_PRIMARY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <afina/Storage.h>
+#include <network/common/Listener.h>
+
+#include "Backlog.h"
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Logging {
+class Service;
+}
+
+namespace Replication {
+
+/**
+ * # Primary side of asynchronous replication
+ * Decorates storage: every successful mutation is applied to backend and appended to the bounded Backlog under a
+ * single lock, so the log has mutations in the order backend got them. Set, add and append reach storage as Put,
+ * so the log has puts and deletes only.
+ *
+ * Replicas connect to a dedicated address, each one is served by its own thread that streams log to it in
+ * compressed batches, see Stream.h. Replica which is new, comes from another run or lags behind the log gets a
+ * snapshot: backend is scanned without the write lock, pairs are kept compressed only, then sent and followed by
+ * the log from the position taken before the scan. Client writes wait for neither the network nor replica.
+ *
+ * All writes must go through decorator, backend must be thread safe
+ */
+class Primary : public Afina::Storage {
+public:
+    // Raw bytes of records in a single frame
+    static constexpr std::size_t kBatchSize = 64 * 1024;
+
+    // Idle replica gets ping that often
+    static constexpr std::chrono::milliseconds kPingPeriod{1000};
+
+    /**
+     * @param backend storage to delegate to
+     * @param pl logging service
+     * @param address to accept replicas on, see Network::Listener
+     * @param backlog_size bytes of records kept for replicas that lag behind
+     */
+    Primary(std::shared_ptr<Afina::Storage> backend, std::shared_ptr<Afina::Logging::Service> pl,
+            const std::string &address, std::size_t backlog_size);
+    ~Primary();
+
+    // Implements Afina::Storage interface
+    void Start() override;
+
+    // Implements Afina::Storage interface
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override { return _backend->Get(key, value); }
+
+    // Implements Afina::Storage interface
+    bool Scan(const std::function<void(const std::string &key, const std::string &value)> &visit) override {
+        return _backend->Scan(visit);
+    }
+
+    /**
+     * Address replicas are accepted on, once started
+     */
+    Network::Listener::Address Address() const { return Network::Listener::Local(_socket); }
+
+private:
+    Primary(const Primary &) = delete;
+    Primary &operator=(const Primary &) = delete;
+
+    // Connection of a single replica
+    struct Session {
+        int socket;
+        std::thread thread;
+        bool done = false;
+    };
+
+    void OnAccept();
+
+    void OnReplica(Session *session);
+
+    // Streams log to replica till connection fails or primary stops
+    void Serve(int socket);
+
+    // Sends all pairs of backend, returns the log position replica continues from
+    uint64_t SendSnapshot(int socket);
+
+    std::shared_ptr<Afina::Storage> _backend;
+    std::shared_ptr<Afina::Logging::Service> _pLogging;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    std::string _address;
+    Backlog _backlog;
+
+    // Orders backend mutations with log appends
+    std::mutex _write_mutex;
+
+    // Id of this run, replicas use it to tell whether their position is still meaningful
+    uint64_t _run_id;
+
+    std::atomic<bool> _running;
+    int _socket;
+    std::thread _acceptor;
+
+    std::mutex _sessions_mutex;
+    std::list<Session> _sessions;
+};
+
+} // namespace Replication
+} // namespace Afina
+
+#endif // AFINA_REPLICATION_PRIMARY_H
@@ -0,0 +1,207 @@
+#include "Replica.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/logging/Service.h>
+#include <network/common/Listener.h>
+
+#include "Primary.h"
+#include "Stream.h"
+
+namespace Afina {
+namespace Replication {
+
+namespace {
+
+// Primary that doesn't ping for that many periods is considered dead
+constexpr int kMissedPings = 3;
+
+} // namespace
+
+// See Replica.h
+Replica::Replica(std::shared_ptr<Afina::Storage> backend, std::shared_ptr<Afina::Logging::Service> pl,
+                 const std::string &primary, std::chrono::milliseconds retry)
+    : _backend(backend), _pLogging(pl), _primary(primary), _retry(retry), _run_id(0), _next(0), _running(false),
+      _socket(-1) {}
+
+// See Replica.h
+Replica::~Replica() {
+    if (_thread.joinable()) {
+        Stop();
+    }
+}
+
+// See Replica.h
+void Replica::Start() {
+    // Fail early on address that couldn't work
+    Network::Listener::Parse(_primary);
+
+    _backend->Start();
+    _logger = _pLogging->select("replication");
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _running = true;
+    _thread = std::thread(&Replica::OnRun, this);
+}
+
+// See Replica.h
+void Replica::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+        if (_socket != -1) {
+            shutdown(_socket, SHUT_RDWR);
+        }
+        _stopped.notify_all();
+    }
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    _backend->Stop();
+}
+
+// See Replica.h
+void Replica::OnRun() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        lock.unlock();
+        try {
+            Sync();
+        } catch (std::runtime_error &ex) {
+            _logger->warn("Replication from {} failed: {}", _primary, ex.what());
+        }
+
+        lock.lock();
+        _stopped.wait_for(lock, _retry, [this] { return !_running; });
+    }
+}
+
+// See Replica.h
+void Replica::Sync() {
+    Network::Listener::Address address = Network::Listener::Parse(_primary);
+    int socket = ::socket(address.addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running) {
+            close(socket);
+            return;
+        }
+        _socket = socket;
+    }
+
+    try {
+        if (connect(socket, reinterpret_cast<const struct sockaddr *>(&address.addr), address.len) == -1) {
+            throw std::runtime_error("Failed to connect: " + std::string(strerror(errno)));
+        }
+
+        struct timeval tv;
+        tv.tv_sec = kMissedPings * std::chrono::duration_cast<std::chrono::seconds>(Primary::kPingPeriod).count();
+        tv.tv_usec = 0;
+        if (setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == -1) {
+            throw std::runtime_error("Failed to set socket timeout");
+        }
+
+        SendFrame(socket, Frame::kHello, _next, _run_id);
+        Apply(socket);
+    } catch (std::runtime_error &) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _socket = -1;
+        close(socket);
+        if (!_running) {
+            return;
+        }
+        throw;
+    }
+}
+
+// See Replica.h
+void Replica::Apply(int socket) {
+    std::string raw, key, value;
+    Op op;
+
+    // Keys to delete once snapshot is over
+    std::unordered_set<std::string> stale;
+    bool in_snapshot = false;
+    for (;;) {
+        FrameHeader header = ReceiveFrame(socket, raw);
+        RecordReader records(raw);
+        uint32_t count = 0;
+
+        switch (static_cast<Frame>(header.type)) {
+        case Frame::kSnapshotBegin:
+            // Half applied snapshot can't be continued
+            _run_id = 0;
+            in_snapshot = true;
+            stale.clear();
+            _backend->Scan([&stale](const std::string &key, const std::string &) { stale.insert(key); });
+            _logger->info("Take snapshot at {} from {}", header.seq, _primary);
+            break;
+
+        case Frame::kSnapshot:
+            if (!in_snapshot) {
+                throw std::runtime_error("Snapshot data out of snapshot");
+            }
+            while (records.Next(op, key, value)) {
+                _backend->Put(key, value);
+                stale.erase(key);
+            }
+            break;
+
+        case Frame::kSnapshotEnd:
+            if (!in_snapshot) {
+                throw std::runtime_error("Snapshot end out of snapshot");
+            }
+            for (auto &key : stale) {
+                _backend->Delete(key);
+            }
+            _logger->info("Snapshot at {} is applied, {} stale keys deleted", header.seq, stale.size());
+            stale.clear();
+            in_snapshot = false;
+            _run_id = header.run_id;
+            _next = header.seq;
+            break;
+
+        case Frame::kBatch:
+            if (in_snapshot || header.run_id != _run_id || header.seq != _next) {
+                throw std::runtime_error("Mutations stream has a gap");
+            }
+            while (records.Next(op, key, value)) {
+                if (op == Op::kPut) {
+                    _backend->Put(key, value);
+                } else {
+                    _backend->Delete(key);
+                }
+                count++;
+            }
+            if (count != header.count) {
+                throw std::runtime_error("Batch has wrong number of records");
+            }
+            _next += count;
+            break;
+
+        case Frame::kPing:
+            if (in_snapshot || header.run_id != _run_id || header.seq != _next) {
+                throw std::runtime_error("Primary is out of sync");
+            }
+            break;
+
+        default:
+            throw std::runtime_error("Unexpected frame");
+        }
+    }
+}
+
+} // namespace Replication
+} // namespace Afina
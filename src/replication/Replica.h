@@ -0,0 +1,110 @@
+#ifndef AFINA_REPLICATION_REPLICA_H
+#define AFINA_REPLICATION_REPLICA_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <afina/Storage.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Logging {
+class Service;
+}
+
+namespace Replication {
+
+/**
+ * # Replica side of asynchronous replication
+ * Decorates storage: reads go to backend, client writes are rejected, backend is changed by background thread
+ * only. Thread connects to primary, takes snapshot if primary asks for it, then applies mutations stream as it
+ * comes. Keys replica had before snapshot which snapshot doesn't have are deleted once it is over.
+ *
+ * Connection that fails or primary that is silent for a few ping periods is reconnected, replica asks to continue
+ * from the position it has applied and gets either the rest of the log or a new snapshot. Replica lags behind
+ * primary and has LRU of its own, so it may evict keys primary still has.
+ *
+ * Backend must be thread safe
+ */
+class Replica : public Afina::Storage {
+public:
+    /**
+     * @param backend storage to delegate reads to
+     * @param pl logging service
+     * @param primary address of primary replication socket, see Network::Listener
+     * @param retry delay between connection attempts
+     */
+    Replica(std::shared_ptr<Afina::Storage> backend, std::shared_ptr<Afina::Logging::Service> pl,
+            const std::string &primary, std::chrono::milliseconds retry = std::chrono::milliseconds(1000));
+    ~Replica();
+
+    // Implements Afina::Storage interface
+    void Start() override;
+
+    // Implements Afina::Storage interface
+    void Stop() override;
+
+    // Implements Afina::Storage interface, replica is read only
+    bool Put(const std::string &, const std::string &) override { return false; }
+
+    // Implements Afina::Storage interface, replica is read only
+    bool PutIfAbsent(const std::string &, const std::string &) override { return false; }
+
+    // Implements Afina::Storage interface, replica is read only
+    bool Set(const std::string &, const std::string &) override { return false; }
+
+    // Implements Afina::Storage interface, replica is read only
+    bool Delete(const std::string &) override { return false; }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override { return _backend->Get(key, value); }
+
+    // Implements Afina::Storage interface
+    bool Scan(const std::function<void(const std::string &key, const std::string &value)> &visit) override {
+        return _backend->Scan(visit);
+    }
+
+private:
+    Replica(const Replica &) = delete;
+    Replica &operator=(const Replica &) = delete;
+
+    void OnRun();
+
+    // Connects to primary and applies what it sends till connection fails
+    void Sync();
+
+    // Applies stream on the connected socket
+    void Apply(int socket);
+
+    std::shared_ptr<Afina::Storage> _backend;
+    std::shared_ptr<Afina::Logging::Service> _pLogging;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    std::string _primary;
+    std::chrono::milliseconds _retry;
+
+    // Primary run and position of the next mutation, zero run means there is nothing to continue
+    uint64_t _run_id;
+    uint64_t _next;
+
+    // Guards the state below, Stop shuts connection down to wake thread up
+    std::mutex _mutex;
+    std::condition_variable _stopped;
+    bool _running;
+    int _socket;
+
+    std::thread _thread;
+};
+
+} // namespace Replication
+} // namespace Afina
+
+#endif // AFINA_REPLICATION_REPLICA_H
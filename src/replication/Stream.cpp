@@ -0,0 +1,142 @@
+#include "Stream.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/socket.h>
+
+#include "Compression.h"
+
+namespace Afina {
+namespace Replication {
+
+namespace {
+
+void append_size(uint32_t size, std::string &out) { out.append(reinterpret_cast<const char *>(&size), sizeof(size)); }
+
+void receive_all(int socket, char *data, std::size_t size) {
+    while (size > 0) {
+        ssize_t got = recv(socket, data, size, 0);
+        if (got == 0) {
+            throw std::runtime_error("Connection closed by peer");
+        } else if (got == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                throw std::runtime_error("Peer is silent for too long");
+            }
+            throw std::runtime_error("Failed to receive frame: " + std::string(strerror(errno)));
+        }
+        data += got;
+        size -= got;
+    }
+}
+
+} // namespace
+
+// See Stream.h
+void AppendRecord(Op op, const std::string &key, const std::string &value, std::string &out) {
+    out.push_back(static_cast<char>(op));
+    append_size(static_cast<uint32_t>(key.size()), out);
+    append_size(static_cast<uint32_t>(value.size()), out);
+    out.append(key);
+    out.append(value);
+}
+
+// See Stream.h
+bool RecordReader::Next(Op &op, std::string &key, std::string &value) {
+    if (_pos == _data.size()) {
+        return false;
+    }
+
+    uint32_t sizes[2];
+    if (_data.size() - _pos < 1 + sizeof(sizes)) {
+        throw std::runtime_error("Record is truncated");
+    }
+    op = static_cast<Op>(_data[_pos]);
+    if (op != Op::kPut && op != Op::kDelete) {
+        throw std::runtime_error("Unknown record operation");
+    }
+    std::memcpy(sizes, _data.data() + _pos + 1, sizeof(sizes));
+    _pos += 1 + sizeof(sizes);
+
+    if (_data.size() - _pos < static_cast<std::size_t>(sizes[0]) + sizes[1]) {
+        throw std::runtime_error("Record is truncated");
+    }
+    key.assign(_data, _pos, sizes[0]);
+    value.assign(_data, _pos + sizes[0], sizes[1]);
+    _pos += static_cast<std::size_t>(sizes[0]) + sizes[1];
+    return true;
+}
+
+// See Stream.h
+void PackFrame(Frame type, uint64_t seq, uint64_t run_id, uint32_t count, const std::string &raw, std::string &out) {
+    // Payload is compressed right after the header, which is filled once its size is known
+    std::size_t start = out.size();
+    out.resize(start + sizeof(FrameHeader));
+    if (!raw.empty()) {
+        Compress(raw.data(), raw.size(), out);
+    }
+
+    FrameHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kMagic;
+    header.type = static_cast<uint32_t>(type);
+    header.count = count;
+    header.raw_size = static_cast<uint32_t>(raw.size());
+    header.size = static_cast<uint32_t>(out.size() - start - sizeof(header));
+    header.seq = seq;
+    header.run_id = run_id;
+    std::memcpy(&out[start], &header, sizeof(header));
+}
+
+// See Stream.h
+void SendPacked(int socket, const std::string &frames) {
+    std::size_t sent = 0;
+    while (sent < frames.size()) {
+        ssize_t n = send(socket, frames.data() + sent, frames.size() - sent, MSG_NOSIGNAL);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to send frame: " + std::string(strerror(errno)));
+        }
+        sent += n;
+    }
+}
+
+// See Stream.h
+void SendFrame(int socket, Frame type, uint64_t seq, uint64_t run_id, uint32_t count, const std::string &raw) {
+    std::string frame;
+    PackFrame(type, seq, run_id, count, raw, frame);
+    SendPacked(socket, frame);
+}
+
+// See Stream.h
+FrameHeader ReceiveFrame(int socket, std::string &raw) {
+    FrameHeader header;
+    receive_all(socket, reinterpret_cast<char *>(&header), sizeof(header));
+    if (header.magic != kMagic) {
+        throw std::runtime_error("Peer doesn't speak replication protocol");
+    }
+    if (header.type < static_cast<uint32_t>(Frame::kHello) || header.type > static_cast<uint32_t>(Frame::kPing)) {
+        throw std::runtime_error("Unknown frame type");
+    }
+    if (header.size > kMaxPayload || header.raw_size > kMaxPayload) {
+        throw std::runtime_error("Frame is too large");
+    }
+
+    raw.clear();
+    if (header.size > 0) {
+        std::string payload(header.size, '\0');
+        receive_all(socket, &payload[0], payload.size());
+        Decompress(payload.data(), payload.size(), header.raw_size, raw);
+    } else if (header.raw_size > 0) {
+        throw std::runtime_error("Frame payload is missing");
+    }
+    return header;
+}
+
+} // namespace Replication
+} // namespace Afina
@@ -0,0 +1,104 @@
+#ifndef AFINA_REPLICATION_STREAM_H
+#define AFINA_REPLICATION_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Afina {
+namespace Replication {
+
+/**
+ * # Replication stream
+ * Primary and replica talk over a dedicated stream socket in frames: fixed header followed by payload. Replica
+ * sends the only frame, kHello, with the run and the position it wants to continue from. Primary answers with
+ * either the rest of its mutation log or a snapshot followed by the log from the snapshot position:
+ *
+ *   kSnapshotBegin, kSnapshot..., kSnapshotEnd, then kBatch or kPing forever
+ *
+ * Snapshot and batch payloads are records compressed together, see Compression.h, kPing tells idle replica that
+ * primary is alive. Position is a sequence number of mutation in the primary log, run is a random id primary
+ * picks on start, positions of different runs have nothing in common.
+ *
+ * Integers are in host byte order, magic number in each header rejects peers of different byte order
+ */
+enum class Frame : uint32_t { kHello = 1, kSnapshotBegin, kSnapshot, kSnapshotEnd, kBatch, kPing };
+
+struct FrameHeader {
+    uint32_t magic;
+    uint32_t type;
+
+    // Records in payload
+    uint32_t count;
+
+    // Payload size before and after compression
+    uint32_t raw_size;
+    uint32_t size;
+    uint32_t reserved;
+
+    // Position of the first record in kBatch, the next record position in the rest
+    uint64_t seq;
+    uint64_t run_id;
+};
+
+// Mutation carried by a record, set, add and append reach storage as Put
+enum class Op : uint8_t { kPut = 1, kDelete = 2 };
+
+constexpr uint32_t kMagic = 0x41465250;
+
+// Frames above that size are malformed
+constexpr std::size_t kMaxPayload = 64 << 20;
+
+/**
+ * Appends record to the raw payload: op byte, 4 bytes of key size, 4 bytes of value size, key and value
+ */
+void AppendRecord(Op op, const std::string &key, const std::string &value, std::string &out);
+
+/**
+ * Bytes record takes in raw payload
+ */
+inline std::size_t RecordSize(const std::string &key, const std::string &value) {
+    return 1 + 2 * sizeof(uint32_t) + key.size() + value.size();
+}
+
+/**
+ * Walks records of raw payload, throws std::runtime_error if it is malformed
+ */
+class RecordReader {
+public:
+    RecordReader(const std::string &data) : _data(data), _pos(0) {}
+
+    // Returns false once payload is over
+    bool Next(Op &op, std::string &key, std::string &value);
+
+private:
+    const std::string &_data;
+    std::size_t _pos;
+};
+
+/**
+ * Appends frame with compressed payload to out, ready to be sent as is
+ */
+void PackFrame(Frame type, uint64_t seq, uint64_t run_id, uint32_t count, const std::string &raw, std::string &out);
+
+/**
+ * Writes frames packed before to the blocking socket, throws std::runtime_error if it fails
+ */
+void SendPacked(int socket, const std::string &frames);
+
+/**
+ * Packs frame and writes it to the blocking socket, throws std::runtime_error if it fails
+ */
+void SendFrame(int socket, Frame type, uint64_t seq, uint64_t run_id, uint32_t count = 0,
+               const std::string &raw = std::string());
+
+/**
+ * Reads frame from the blocking socket and decompresses its payload into raw, throws std::runtime_error if socket
+ * fails, times out, is closed or frame is malformed
+ */
+FrameHeader ReceiveFrame(int socket, std::string &raw);
+
+} // namespace Replication
+} // namespace Afina
+
+#endif // AFINA_REPLICATION_STREAM_H
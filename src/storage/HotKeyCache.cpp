@@ -0,0 +1,142 @@
+#include "HotKeyCache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace Afina {
+namespace Backend {
+
+constexpr std::size_t HotKeyCache::kStripes;
+constexpr std::size_t HotKeyCache::kSketchDepth;
+constexpr std::size_t HotKeyCache::kSketchWidth;
+constexpr uint32_t HotKeyCache::kRefreshPeriod;
+
+// See HotKeyCache.h
+HotKeyCache::HotKeyCache(std::shared_ptr<Afina::Storage> backend, std::size_t replica_size, uint32_t hot_threshold,
+                         uint32_t sample_rate)
+    : _backend(std::move(backend)), _hot_threshold(hot_threshold), _sample_rate(std::max<uint32_t>(sample_rate, 1)),
+      _versions(new std::atomic<uint64_t>[kStripes]), _shards(std::max<std::size_t>(replica_size, 1)) {
+    for (std::size_t i = 0; i < kStripes; i++) {
+        _versions[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// See Storage.h
+bool HotKeyCache::Put(const std::string &key, const std::string &value) {
+    bool result = _backend->Put(key, value);
+    invalidate(key);
+    return result;
+}
+
+// See Storage.h
+bool HotKeyCache::PutIfAbsent(const std::string &key, const std::string &value) {
+    bool result = _backend->PutIfAbsent(key, value);
+    invalidate(key);
+    return result;
+}
+
+// See Storage.h
+bool HotKeyCache::Set(const std::string &key, const std::string &value) {
+    bool result = _backend->Set(key, value);
+    invalidate(key);
+    return result;
+}
+
+// See Storage.h
+bool HotKeyCache::Delete(const std::string &key) {
+    bool result = _backend->Delete(key);
+    invalidate(key);
+    return result;
+}
+
+// See Storage.h
+bool HotKeyCache::Get(const std::string &key, std::string &value) {
+    std::size_t hash = std::hash<std::string>()(key);
+
+    // Version must be taken before backend access: if write happens after that point, replica
+    // filled with the value read below will never match stripe again
+    uint64_t ver = version(hash).load(std::memory_order_acquire);
+
+    // Thread could be migrated while holding the shard, so the one who came next just goes to the
+    // backend instead of waiting
+    bool hot = false;
+    {
+        auto shard = _shards.try_lock_local();
+        if (shard) {
+            Entry &entry = shard->entries[(hash >> 7) % shard->entries.size()];
+            bool same_key = entry.used && entry.hash == hash && entry.key == key;
+            if (same_key && entry.version == ver && (++entry.hits % kRefreshPeriod) != 0) {
+                value = entry.value;
+                return true;
+            }
+
+            if (same_key) {
+                // Either stale or time to refresh, it is still hot anyway
+                hot = true;
+            } else if ((++shard->ticks % _sample_rate) == 0) {
+                hot = touch(*shard, hash) >= _hot_threshold;
+            }
+        }
+    }
+
+    if (!_backend->Get(key, value)) {
+        // Nothing to replicate, stale entry (if any) dies by version or gets overwritten
+        return false;
+    }
+
+    if (hot) {
+        // Thread might be on the other CPU already, that is fine: correctness is guarded by version
+        auto target = _shards.try_lock_local();
+        if (target) {
+            Entry &entry = target->entries[(hash >> 7) % target->entries.size()];
+            entry.used = true;
+            entry.hash = hash;
+            entry.version = ver;
+            entry.hits = 0;
+            entry.key = key;
+            entry.value = value;
+        }
+    }
+    return true;
+}
+
+// See HotKeyCache.h
+uint32_t HotKeyCache::touch(Shard &shard, std::size_t hash) {
+    // TinyLFU style aging: once enough samples collected, halve all counters so that keys which
+    // were hot long time ago fade out
+    if (++shard.samples >= kSketchWidth * 8) {
+        shard.samples = 0;
+        for (auto &c : shard.counters) {
+            c >>= 1;
+        }
+    }
+
+    // Conservative update: increment only counters which are equal to current estimation
+    std::size_t h1 = hash;
+    std::size_t h2 = (hash >> 17) | 1;
+    uint8_t *cells[kSketchDepth];
+    uint8_t estimation = UINT8_MAX;
+    for (std::size_t i = 0; i < kSketchDepth; i++) {
+        cells[i] = &shard.counters[i * kSketchWidth + ((h1 + i * h2) & (kSketchWidth - 1))];
+        estimation = std::min(estimation, *cells[i]);
+    }
+
+    if (estimation < UINT8_MAX) {
+        for (std::size_t i = 0; i < kSketchDepth; i++) {
+            if (*cells[i] == estimation) {
+                (*cells[i])++;
+            }
+        }
+        estimation++;
+    }
+    return estimation;
+}
+
+// See HotKeyCache.h
+void HotKeyCache::invalidate(const std::string &key) {
+    std::size_t hash = std::hash<std::string>()(key);
+    version(hash).fetch_add(1, std::memory_order_release);
+}
+
+} // namespace Backend
+} // namespace Afina
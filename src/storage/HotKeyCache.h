@@ -0,0 +1,123 @@
+#ifndef AFINA_STORAGE_HOT_KEY_CACHE_H
+#define AFINA_STORAGE_HOT_KEY_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/CoreLocal.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Per-core read replica for hot keys
+ * Decorates another storage. Each CPU has a small sampled frequency sketch (count-min) and a tiny
+ * direct mapped table of values for the keys the sketch considers hot. Get of such key is served
+ * from the core-local table without touching backend or any shared cache line.
+ *
+ * Replicas are invalidated by versions: every key maps to a version stripe that gets incremented
+ * after each write through this decorator, each replica remembers stripe version it was filled
+ * with. Writes that bypass decorator are not tracked, so all access must go through it.
+ *
+ * Backend itself must be thread safe if decorator used from many threads
+ */
+class HotKeyCache : public Afina::Storage {
+public:
+    /**
+     * @param backend storage to delegate to
+     * @param replica_size number of values each CPU could replicate
+     * @param hot_threshold sketch estimation key must reach to be replicated
+     * @param sample_rate only each sample_rate'th Get is counted in the sketch
+     */
+    HotKeyCache(std::shared_ptr<Afina::Storage> backend, std::size_t replica_size = 64, uint32_t hot_threshold = 4,
+                uint32_t sample_rate = 16);
+    ~HotKeyCache() {}
+
+    // Implements Afina::Storage interface
+    void Start() override { _backend->Start(); }
+
+    // Implements Afina::Storage interface
+    void Stop() override { _backend->Stop(); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Scan(const std::function<void(const std::string &key, const std::string &value)> &visit) override {
+        return _backend->Scan(visit);
+    }
+
+private:
+    // Number of version stripes, must be power of 2
+    static constexpr std::size_t kStripes = 4096;
+
+    // Sketch geometry, width must be power of 2
+    static constexpr std::size_t kSketchDepth = 4;
+    static constexpr std::size_t kSketchWidth = 1024;
+
+    // Each replica hit number kRefreshPeriod goes to the backend anyway, so that backend keeps
+    // recency of the hot key and we notice once backend evicted it
+    static constexpr uint32_t kRefreshPeriod = 256;
+
+    // Replicated value
+    struct Entry {
+        bool used = false;
+        std::size_t hash = 0;
+        uint64_t version = 0;
+        uint32_t hits = 0;
+        std::string key;
+        std::string value;
+    };
+
+    // Everything that belongs to a single CPU
+    struct Shard {
+        explicit Shard(std::size_t replica_size) : entries(replica_size), counters(kSketchDepth * kSketchWidth, 0) {}
+
+        // Number of Get calls, used for sampling
+        uint32_t ticks = 0;
+
+        // Number of sampled Get calls since last sketch aging
+        uint32_t samples = 0;
+
+        std::vector<Entry> entries;
+        std::vector<uint8_t> counters;
+    };
+
+    // Counts given hash in the sketch, returns new estimation
+    uint32_t touch(Shard &shard, std::size_t hash);
+
+    // Called after each write
+    void invalidate(const std::string &key);
+
+    inline std::atomic<uint64_t> &version(std::size_t hash) { return _versions[hash & (kStripes - 1)]; }
+
+    std::shared_ptr<Afina::Storage> _backend;
+
+    const uint32_t _hot_threshold;
+    const uint32_t _sample_rate;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> _versions;
+
+    Concurrency::CoreLocal<Shard> _shards;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_HOT_KEY_CACHE_H
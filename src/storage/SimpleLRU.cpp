@@ -2,6 +2,8 @@
 
 #include "SimpleLRU.h"
 
+#include <afina/metrics/Counters.h>
+
 namespace Afina {
 namespace Backend {
 
@@ -68,6 +70,14 @@ bool SimpleLRU::Get(const std::string &key, std::string &value) {
     return true;
 }
 
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Scan(const std::function<void(const std::string &key, const std::string &value)> &visit) {
+    for (lru_node *node = _lru_head->next.get(); node != _lru_tail; node = node->next.get()) {
+        visit(node->key, node->value);
+    }
+    return true;
+}
+
 bool SimpleLRU::delete_oldest_node() {
     lru_node *old_node = _lru_head->next.get();
     if (old_node == nullptr)
@@ -77,6 +87,8 @@ bool SimpleLRU::delete_oldest_node() {
     old_node->next->prev = _lru_head.get();
     swap(_lru_head->next, old_node->next);
     old_node->next = nullptr;
+
+    Metrics::Counters::Instance().Add(Metrics::kEvictions);
     return true;
 }
 
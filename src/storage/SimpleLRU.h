@@ -59,6 +59,9 @@ public:
     // Implements Afina::Storage interface
     bool Get(const std::string &key, std::string &value) override;
 
+    // Implements Afina::Storage interface
+    bool Scan(const std::function<void(const std::string &key, const std::string &value)> &visit) override;
+
 private:
 
     // LRU cache node
@@ -51,6 +51,12 @@ public:
         return SimpleLRU::Get(key, value);
     }
 
+    // see SimpleLRU.h
+    bool Scan(const std::function<void(const std::string &key, const std::string &value)> &visit) override {
+        std::lock_guard<std::mutex> lg(exist_user);
+        return SimpleLRU::Scan(visit);
+    }
+
 private:
     std::mutex exist_user;
 };
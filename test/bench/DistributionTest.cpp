@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <bench/Distribution.h>
+
+using namespace Afina::Bench;
+
+namespace {
+
+// How many times each key is chosen out of draws
+std::vector<uint64_t> frequencies(const KeyDistribution &keys, uint64_t draws) {
+    Random random(42);
+    std::vector<uint64_t> counts(keys.keys());
+    for (uint64_t i = 0; i < draws; i++) {
+        uint64_t key = keys.Next(random);
+        EXPECT_LT(key, keys.keys());
+        counts[key]++;
+    }
+    return counts;
+}
+
+} // namespace
+
+TEST(DistributionTest, Uniform) {
+    auto counts = frequencies(UniformKeys(10), 100000);
+    for (auto count : counts) {
+        EXPECT_NEAR(10000, count, 500);
+    }
+}
+
+TEST(DistributionTest, Zipfian) {
+    auto counts = frequencies(ZipfianKeys(1000, 0.99), 200000);
+
+    // Frequency of rank i is ~ 1/i^0.99: first key is chosen about twice as often as the second one and about
+    // a hundred times as often as the hundredth
+    EXPECT_NEAR(2.0, double(counts[0]) / counts[1], 0.2);
+    EXPECT_NEAR(95.0, double(counts[0]) / counts[99], 25.0);
+    EXPECT_GT(counts[0], 200000 / 10);
+
+    EXPECT_THROW(ZipfianKeys(1000, 1.0), std::runtime_error);
+}
+
+TEST(DistributionTest, Hotspot) {
+    auto counts = frequencies(HotspotKeys(100, 0.1, 0.9), 100000);
+    uint64_t hot = 0;
+    for (int i = 0; i < 10; i++) {
+        hot += counts[i];
+    }
+    EXPECT_NEAR(90000, hot, 1000);
+}
+
+TEST(DistributionTest, ValueSizes) {
+    Random random(42);
+    EXPECT_EQ(100, ValueSize::Parse("100", "normal").Next(random));
+    EXPECT_THROW(ValueSize::Parse("10-x", "uniform"), std::runtime_error);
+    EXPECT_THROW(ValueSize::Parse("10-20", "pareto"), std::runtime_error);
+    EXPECT_THROW(ValueSize::Parse("20-10", "uniform"), std::runtime_error);
+
+    for (auto type : {"uniform", "normal", "exponential"}) {
+        ValueSize sizes = ValueSize::Parse("100-1100", type);
+        double sum = 0;
+        for (int i = 0; i < 10000; i++) {
+            std::size_t size = sizes.Next(random);
+            ASSERT_GE(size, 100);
+            ASSERT_LE(size, 1100);
+            sum += size;
+        }
+
+        // Exponential prefers small values, the others are centered
+        EXPECT_NEAR(std::string(type) == "exponential" ? 200 : 600, sum / 10000, 20) << type;
+    }
+}
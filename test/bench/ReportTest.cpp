@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+
+#include <afina/metrics/Histogram.h>
+#include <bench/Report.h>
+
+using namespace Afina;
+
+TEST(ReportTest, HdrHistogramLayout) {
+    Metrics::Histogram histogram;
+    for (uint64_t i = 1; i <= 1000; i++) {
+        histogram.Record(i);
+    }
+
+    std::ostringstream out;
+    Bench::WritePercentiles(out, histogram, 1000.0);
+    std::string text = out.str();
+
+    EXPECT_EQ(0, text.find("       Value     Percentile TotalCount 1/(1-Percentile)\n\n"));
+    EXPECT_NE(std::string::npos, text.find("       0.001 0.000000000000          1           1.00\n"));
+    EXPECT_NE(std::string::npos, text.find("       1.000 1.000000000000       1000\n"));
+    EXPECT_NE(std::string::npos, text.find("#[Max     =        1.000, Total count    =         1000]\n"));
+
+    // Mean is within histogram precision
+    std::size_t mean = text.find("#[Mean    = ");
+    ASSERT_NE(std::string::npos, mean);
+    EXPECT_NEAR(0.5, std::stod(text.substr(mean + 12)), 0.5 / 32);
+
+    // Percentiles go up to 100% in ever finer steps
+    std::istringstream lines(text);
+    std::string line;
+    std::getline(lines, line);
+    std::getline(lines, line);
+    double previous = -1;
+    int rows = 0;
+    while (std::getline(lines, line) && line[0] != '#') {
+        double value, percentile;
+        std::istringstream(line) >> value >> percentile;
+        EXPECT_GE(value, previous);
+        previous = value;
+        rows++;
+    }
+    EXPECT_GT(rows, 30);
+}
@@ -0,0 +1,180 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/client/AsyncClient.h>
+
+using namespace Afina::Client;
+
+namespace {
+
+/**
+ * Server that knows every key: value of a key is the key itself. Counts keys asked from it
+ */
+class FakeServer {
+public:
+    FakeServer() : keys(0), _stop(false) {
+        _socket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_socket, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+        listen(_socket, 16);
+
+        socklen_t len = sizeof(addr);
+        getsockname(_socket, reinterpret_cast<struct sockaddr *>(&addr), &len);
+        address = "127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+        _thread = std::thread(&FakeServer::Accept, this);
+    }
+
+    ~FakeServer() {
+        _stop = true;
+        shutdown(_socket, SHUT_RDWR);
+        _thread.join();
+        for (auto &t : _connections) {
+            t.join();
+        }
+        close(_socket);
+    }
+
+    std::string address;
+    std::atomic<int> keys;
+
+private:
+    void Accept() {
+        int client;
+        while ((client = accept(_socket, nullptr, nullptr)) != -1) {
+            _connections.emplace_back(&FakeServer::Serve, this, client);
+        }
+    }
+
+    void Serve(int client) {
+        std::string input;
+        char buf[4096];
+        ssize_t n;
+        while (!_stop && (n = recv(client, buf, sizeof(buf), 0)) > 0) {
+            input.append(buf, n);
+
+            std::string output;
+            std::size_t eol;
+            while ((eol = input.find("\r\n")) != std::string::npos) {
+                std::istringstream line(input.substr(0, eol));
+                std::string name, key;
+                line >> name;
+                if (name == "get") {
+                    while (line >> key) {
+                        output += "VALUE " + key + " 0 " + std::to_string(key.size()) + "\r\n" + key + "\r\n";
+                        keys++;
+                    }
+                    output += "END\r\n";
+                    input.erase(0, eol + 2);
+                } else {
+                    std::size_t flags, exptime, bytes;
+                    line >> key >> flags >> exptime >> bytes;
+                    if (input.size() < eol + 2 + bytes + 2) {
+                        break;
+                    }
+                    output += "STORED\r\n";
+                    input.erase(0, eol + 2 + bytes + 2);
+                }
+            }
+            send(client, output.data(), output.size(), MSG_NOSIGNAL);
+        }
+        close(client);
+    }
+
+    int _socket;
+    std::atomic<bool> _stop;
+    std::thread _thread;
+    std::vector<std::thread> _connections;
+};
+
+} // namespace
+
+TEST(AsyncClientTest, Pipelines) {
+    FakeServer server;
+    AsyncClient::Options options;
+    options.connections = 2;
+    options.pipeline = 4;
+    AsyncClient client({server.address}, options);
+
+    // More requests than pipelines take, the rest wait in backlog
+    int stored = 0, found = 0;
+    for (int i = 0; i < 100; i++) {
+        client.Set("key" + std::to_string(i), std::string(i, 'x'), [&stored](Response &r) { stored += r.ok; });
+        client.Get({"key" + std::to_string(i)}, [&found, i](Response &r) {
+            ASSERT_TRUE(r.ok);
+            ASSERT_EQ(1, r.values.size());
+            EXPECT_EQ("key" + std::to_string(i), r.values[0].data);
+            found++;
+        });
+    }
+    EXPECT_EQ(200, client.InFlight());
+    client.Wait();
+    EXPECT_EQ(100, stored);
+    EXPECT_EQ(100, found);
+    EXPECT_EQ(0, client.InFlight());
+}
+
+TEST(AsyncClientTest, SplitsMultiGet) {
+    FakeServer first, second;
+    AsyncClient client({first.address, second.address});
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < 50; i++) {
+        keys.push_back("multi" + std::to_string(i));
+    }
+
+    Response response;
+    client.Get(keys, [&response](Response &r) { response = std::move(r); });
+    client.Wait();
+
+    EXPECT_TRUE(response.ok);
+    EXPECT_EQ(50, response.values.size());
+    EXPECT_EQ(50, first.keys + second.keys);
+    EXPECT_GT(first.keys, 0);
+    EXPECT_GT(second.keys, 0);
+
+    // Key is asked from its owner only
+    EXPECT_EQ(client.ServerOf(keys[0]), client.ServerOf(keys[0]));
+}
+
+TEST(AsyncClientTest, FailsWithoutServer) {
+    std::string address;
+    {
+        FakeServer gone;
+        address = gone.address;
+    }
+
+    AsyncClient client({address});
+    Response first, second;
+    client.Set("a", "b", [&first](Response &r) { first = std::move(r); });
+    client.Wait();
+    EXPECT_FALSE(first.ok);
+    EXPECT_EQ(0, first.status.find("CONNECTION_ERROR"));
+
+    // Server failed just now, request fails without trying
+    client.Get({"a"}, [&second](Response &r) { second = std::move(r); });
+    client.Wait();
+    EXPECT_EQ("CONNECTION_ERROR server failed recently", second.status);
+}
+
+TEST(AsyncClientTest, RejectsBadKeys) {
+    AsyncClient client({"127.0.0.1:1"});
+    EXPECT_THROW(client.Get({"with space"}, [](Response &) {}), std::runtime_error);
+    EXPECT_THROW(client.Set(std::string(251, 'k'), "v", [](Response &) {}), std::runtime_error);
+    EXPECT_EQ(0, client.InFlight());
+}
@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <client/HashRing.h>
+
+using namespace Afina::Client;
+
+namespace {
+
+std::string md5(const std::string &data) {
+    unsigned char digest[16];
+    HashRing::Md5(data.data(), data.size(), digest);
+    char hex[33];
+    for (int i = 0; i < 16; i++) {
+        std::snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    }
+    return hex;
+}
+
+} // namespace
+
+TEST(HashRingTest, Md5) {
+    EXPECT_EQ("d41d8cd98f00b204e9800998ecf8427e", md5(""));
+    EXPECT_EQ("900150983cd24fb0d6963f7d28e17f72", md5("abc"));
+    EXPECT_EQ("9e107d9d372bb6826bd81d3542a419d6", md5("The quick brown fox jumps over the lazy dog"));
+
+    // Padding takes an extra block
+    EXPECT_EQ("57edf4a22be3c955ac49da2e2107b67a",
+              md5("12345678901234567890123456789012345678901234567890123456789012345678901234567890"));
+}
+
+TEST(HashRingTest, SpreadsKeys) {
+    HashRing ring({"10.0.0.1:11211", "10.0.0.2:11211", "10.0.0.3:11211"});
+    std::vector<int> counts(3);
+    for (int i = 0; i < 30000; i++) {
+        counts[ring.Server("key" + std::to_string(i))]++;
+    }
+    for (int count : counts) {
+        EXPECT_GT(count, 7000);
+        EXPECT_LT(count, 13000);
+    }
+}
+
+TEST(HashRingTest, MovesFewKeys) {
+    HashRing before({"10.0.0.1:11211", "10.0.0.2:11211", "10.0.0.3:11211"});
+    HashRing after({"10.0.0.1:11211", "10.0.0.2:11211", "10.0.0.3:11211", "10.0.0.4:11211"});
+
+    // Keys either stay or go to the new server
+    int moved = 0;
+    for (int i = 0; i < 10000; i++) {
+        std::string key = "key" + std::to_string(i);
+        std::size_t server = after.Server(key);
+        if (server != before.Server(key)) {
+            EXPECT_EQ(3, server) << key;
+            moved++;
+        }
+    }
+    EXPECT_GT(moved, 1500);
+    EXPECT_LT(moved, 3500);
+}
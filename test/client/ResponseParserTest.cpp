@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+
+#include <client/ResponseParser.h>
+
+using namespace Afina::Client;
+
+namespace {
+
+// Feeds response split into pieces of given size, returns bytes left after it
+std::size_t feed(const std::string &data, std::size_t piece, ResponseParser::Kind kind, Response &out) {
+    ResponseParser parser;
+    std::size_t pos = 0;
+    bool done = false;
+    while (!done && pos < data.size()) {
+        std::size_t size = std::min(piece, data.size() - pos);
+        pos += parser.Parse(data.data() + pos, size, kind, out, done);
+    }
+    EXPECT_TRUE(done);
+    return data.size() - pos;
+}
+
+} // namespace
+
+TEST(ResponseParserTest, Storage) {
+    Response out;
+    EXPECT_EQ(12, feed("STORED\r\nNOT_STORED\r\n", 100, ResponseParser::Kind::kStorage, out));
+    EXPECT_TRUE(out.ok);
+    EXPECT_EQ("STORED", out.status);
+
+    Response failed;
+    feed("NOT_STORED\r\n", 3, ResponseParser::Kind::kStorage, failed);
+    EXPECT_FALSE(failed.ok);
+    EXPECT_EQ("NOT_STORED", failed.status);
+}
+
+TEST(ResponseParserTest, Values) {
+    const std::string response = "VALUE a 5 3\r\nabc\r\nVALUE bb 0 4\r\n\r\n\r\n\r\nEND\r\nSTORED\r\n";
+    for (std::size_t piece : {1, 2, 7, 1000}) {
+        Response out;
+        EXPECT_EQ(8, feed(response, piece, ResponseParser::Kind::kRetrieval, out)) << piece;
+        EXPECT_TRUE(out.ok);
+        ASSERT_EQ(2, out.values.size());
+        EXPECT_EQ("a", out.values[0].key);
+        EXPECT_EQ(5, out.values[0].flags);
+        EXPECT_EQ("abc", out.values[0].data);
+        EXPECT_EQ("bb", out.values[1].key);
+        EXPECT_EQ("\r\n\r\n", out.values[1].data);
+    }
+}
+
+TEST(ResponseParserTest, Stats) {
+    Response out;
+    feed("STAT pid 42\r\nSTAT get:p50_ns 100\r\nEND\r\n", 5, ResponseParser::Kind::kRetrieval, out);
+    ASSERT_EQ(2, out.values.size());
+    EXPECT_EQ("pid", out.values[0].key);
+    EXPECT_EQ("42", out.values[0].data);
+    EXPECT_EQ("get:p50_ns", out.values[1].key);
+}
+
+TEST(ResponseParserTest, Errors) {
+    Response out;
+    feed("CLIENT_ERROR bad data chunk\r\n", 4, ResponseParser::Kind::kRetrieval, out);
+    EXPECT_FALSE(out.ok);
+    EXPECT_EQ("CLIENT_ERROR bad data chunk", out.status);
+
+    ResponseParser parser;
+    bool done;
+    Response garbage;
+    EXPECT_THROW(parser.Parse("HELLO\r\n", 7, ResponseParser::Kind::kRetrieval, garbage, done), std::runtime_error);
+    parser.Reset();
+    EXPECT_THROW(parser.Parse("VALUE a b c\r\n", 13, ResponseParser::Kind::kRetrieval, garbage, done),
+                 std::runtime_error);
+}
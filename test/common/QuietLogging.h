@@ -0,0 +1,37 @@
+#ifndef AFINA_TEST_COMMON_QUIET_LOGGING_H
+#define AFINA_TEST_COMMON_QUIET_LOGGING_H
+
+#include <memory>
+
+#include <afina/logging/Config.h>
+
+#include "logging/ServiceImpl.h"
+
+namespace Afina {
+namespace Test {
+
+/**
+ * Logging service for tests that start real services: errors only, to stderr. Loggers are registered globally,
+ * so all tests of the binary share a single service
+ */
+inline std::shared_ptr<Logging::Service> QuietLogging() {
+    static std::shared_ptr<Logging::Service> service;
+    if (service) {
+        return service;
+    }
+
+    std::shared_ptr<Logging::Config> config(new Logging::Config);
+    config->appenders["console"].type = Logging::Appender::Type::STDERR;
+    Logging::Logger &logger = config->loggers["root"];
+    logger.level = Logging::Logger::Level::ERROR;
+    logger.appenders.push_back("console");
+
+    service.reset(new Logging::ServiceImpl(config));
+    service->Start();
+    return service;
+}
+
+} // namespace Test
+} // namespace Afina
+
+#endif // AFINA_TEST_COMMON_QUIET_LOGGING_H
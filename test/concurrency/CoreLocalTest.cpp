@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/CoreLocal.h>
+
+using namespace Afina::Concurrency;
+
+TEST(CoreLocalTest, SlotsArePadded) {
+    CoreLocal<uint64_t> counters(0);
+    ASSERT_GE(counters.size(), 1);
+
+    for (std::size_t i = 1; i < counters.size(); i++) {
+        auto distance = reinterpret_cast<const char *>(&counters[i]) - reinterpret_cast<const char *>(&counters[i - 1]);
+        EXPECT_EQ(0, distance % CoreLocal<uint64_t>::kCacheLine);
+    }
+}
+
+TEST(CoreLocalTest, LocalIsStableSlot) {
+    CoreLocal<int> values(0);
+    int &slot = values.local();
+
+    bool found = false;
+    for (std::size_t i = 0; i < values.size(); i++) {
+        found |= (&values[i] == &slot);
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST(CoreLocalTest, ReduceAtomicCounters) {
+    CoreLocal<std::atomic<uint64_t>> counters(0);
+
+    const int threads = 4, iterations = 10000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&counters]() {
+            for (int i = 0; i < iterations; i++) {
+                counters.local().fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    uint64_t total = counters.reduce(uint64_t(0), [](uint64_t acc, const std::atomic<uint64_t> &c) {
+        return acc + c.load(std::memory_order_relaxed);
+    });
+    EXPECT_EQ(threads * iterations, total);
+}
+
+TEST(CoreLocalTest, WithLocalIsExclusive) {
+    // Plain integers are safe to use only under exclusive access
+    CoreLocal<uint64_t> counters(0);
+
+    const int threads = 8, iterations = 10000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&counters]() {
+            for (int i = 0; i < iterations; i++) {
+                counters.with_local([](uint64_t &c) { c++; });
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    uint64_t total = 0;
+    counters.for_each([&total](const uint64_t &c) { total += c; });
+    EXPECT_EQ(threads * iterations, total);
+}
+
+TEST(CoreLocalTest, TryLockFailsOnBusySlot) {
+    CoreLocal<int> values(0);
+
+    auto first = values.try_lock_local();
+    ASSERT_TRUE(bool(first));
+
+    // Same thread, same CPU most of the time: second attempt must not get the same slot
+    auto second = values.try_lock_local();
+    if (second) {
+        EXPECT_NE(&*first, &*second);
+    }
+}
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <afina/concurrency/Executor.h>
+
+using namespace Afina::Concurrency;
+
+TEST(ExecutorTest, StopCompletesQueuedTasks) {
+    Executor executor(2, 4, 100, 1000);
+    executor.Start(nullptr);
+
+    std::atomic<int> done(0);
+    for (int i = 0; i < 50; i++) {
+        ASSERT_TRUE(executor.Execute([&done]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            done++;
+        }));
+    }
+
+    executor.Stop(true);
+    EXPECT_EQ(50, done.load());
+    EXPECT_FALSE(executor.Execute([]() {}));
+}
+
+TEST(ExecutorTest, RejectsOverQueueLimit) {
+    Executor executor(1, 1, 2, 1000);
+    executor.Start(nullptr);
+
+    // Single thread is blocked, so the rest stays in the queue
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool release = false, started = false;
+    ASSERT_TRUE(executor.Execute([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        started = true;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return release; });
+    }));
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return started; });
+    }
+
+    std::atomic<int> done(0);
+    EXPECT_TRUE(executor.Execute([&done]() { done++; }));
+    EXPECT_TRUE(executor.Execute([&done]() { done++; }));
+    EXPECT_FALSE(executor.Execute([&done]() { done++; }));
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        release = true;
+        cv.notify_all();
+    }
+    executor.Stop(true);
+    EXPECT_EQ(2, done.load());
+}
+
+TEST(ExecutorTest, GrowsAndShrinks) {
+    Executor executor(0, 4, 100, 10);
+    executor.Start(nullptr);
+
+    std::atomic<int> done(0);
+    for (int i = 0; i < 8; i++) {
+        ASSERT_TRUE(executor.Execute([&done]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            done++;
+        }));
+    }
+
+    // Idle threads above low watermark leave, pool still takes new tasks afterwards
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(8, done.load());
+    ASSERT_TRUE(executor.Execute([&done]() { done++; }));
+    executor.Stop(true);
+    EXPECT_EQ(9, done.load());
+}
@@ -0,0 +1,110 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/ThreadLocal.h>
+
+using namespace Afina::Concurrency;
+
+TEST(ThreadLocalTest, InstancesHaveOwnSlots) {
+    ThreadLocal<int> a, b;
+    a.get() = 1;
+    b.get() = 2;
+
+    EXPECT_EQ(1, a.get());
+    EXPECT_EQ(2, b.get());
+    EXPECT_NE(&a.get(), &b.get());
+}
+
+TEST(ThreadLocalTest, ThreadsHaveOwnSlots) {
+    ThreadLocal<int> value;
+    value.get() = 1;
+
+    std::thread t([&value]() {
+        EXPECT_EQ(0, value.get());
+        value.get() = 2;
+    });
+    t.join();
+
+    EXPECT_EQ(1, value.get());
+}
+
+TEST(ThreadLocalTest, ForEachSeesAllThreads) {
+    ThreadLocal<std::atomic<uint64_t>> counter;
+
+    const int threads = 4, iterations = 1000;
+    std::atomic<int> ready(0);
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < iterations; i++) {
+                counter->fetch_add(1, std::memory_order_relaxed);
+            }
+            ready++;
+            while (!done) {
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    while (ready != threads) {
+        std::this_thread::yield();
+    }
+
+    int slots = 0;
+    uint64_t total = 0;
+    counter.for_each([&](const std::atomic<uint64_t> &c) {
+        slots++;
+        total += c.load();
+    });
+    EXPECT_EQ(threads, slots);
+    EXPECT_EQ(threads * iterations, total);
+
+    done = true;
+    for (auto &w : workers) {
+        w.join();
+    }
+}
+
+TEST(ThreadLocalTest, SlotReleasedOnThreadExit) {
+    uint64_t retired = 0;
+    ThreadLocal<uint64_t> counter([&retired](uint64_t &c) { retired += c; });
+
+    std::thread t([&counter]() { counter.get() += 42; });
+    t.join();
+
+    int slots = 0;
+    counter.for_each([&slots](const uint64_t &) { slots++; });
+    EXPECT_EQ(0, slots);
+    EXPECT_EQ(42, retired);
+}
+
+TEST(ThreadLocalTest, InstanceDestroyedBeforeThread) {
+    std::unique_ptr<ThreadLocal<int>> value(new ThreadLocal<int>());
+    std::atomic<bool> created(false), destroyed(false);
+
+    std::thread t([&]() {
+        value->get() = 1;
+        created = true;
+        while (!destroyed) {
+            std::this_thread::yield();
+        }
+    });
+
+    while (!created) {
+        std::this_thread::yield();
+    }
+    value.reset();
+    destroyed = true;
+    t.join();
+
+    // Id reused by the new instance must start from the fresh slot
+    ThreadLocal<int> other;
+    EXPECT_EQ(0, other.get());
+}
@@ -62,3 +62,65 @@ TEST(CoroutineTest, Printer) {
     engine.start(_printer, engine, result);
     ASSERT_STREQ("A1 B1 A2 B2 A3 B3 END", result.c_str());
 }
+
+void _waiter(Afina::Coroutine::Engine &pe, std::stringstream &out) {
+    out << "W1 ";
+    pe.block();
+    out << "W2 ";
+}
+
+void _waker(Afina::Coroutine::Engine &pe, std::stringstream &out, void *&waiter) {
+    out << "K1 ";
+    pe.unblock(waiter);
+    out << "K2 ";
+}
+
+// Each coroutine has own copy of the stack, so shared state must live outside of it
+std::stringstream block_out;
+void _block_main(Afina::Coroutine::Engine &pe, std::string &result) {
+    std::stringstream &out = block_out;
+    void *waiter = pe.run(_waiter, pe, out);
+    pe.sched(waiter);
+
+    // Waiter is blocked, so control is back here
+    out << "M ";
+    // Once waker is done, engine runs unblocked waiter before getting back here
+    void *waker = pe.run(_waker, pe, out, waiter);
+    pe.sched(waker);
+
+    result = out.str();
+}
+
+TEST(CoroutineTest, BlockUnblock) {
+    Afina::Coroutine::Engine engine;
+
+    std::string result;
+    engine.start(_block_main, engine, result);
+    ASSERT_STREQ("W1 M K1 K2 W2 ", result.c_str());
+}
+
+void _blocked_forever(Afina::Coroutine::Engine &pe, int &counter) {
+    for (int i = 0; i < 3; i++) {
+        pe.block();
+        counter++;
+    }
+}
+
+void _unblocker_main(Afina::Coroutine::Engine &pe, int &counter, void *&routine) {
+    routine = pe.run(_blocked_forever, pe, counter);
+}
+
+TEST(CoroutineTest, Unblocker) {
+    void *routine = nullptr;
+    int wakeups = 0;
+    Afina::Coroutine::Engine engine([&routine, &wakeups](Afina::Coroutine::Engine &pe) {
+        wakeups++;
+        pe.unblock(routine);
+    });
+
+    int counter = 0;
+    engine.start(_unblocker_main, engine, counter, routine);
+
+    ASSERT_EQ(3, counter);
+    ASSERT_EQ(3, wakeups);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <afina/execute/Get.h>
+#include <afina/execute/Set.h>
+#include <afina/execute/Stats.h>
+#include <afina/metrics/Counters.h>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+
+namespace {
+
+// Parses "STAT name value" lines of the stats response
+std::map<std::string, long> stats() {
+    Backend::SimpleLRU storage;
+    std::string out;
+    Execute::Stats().Execute(storage, "", out);
+
+    std::map<std::string, long> result;
+    std::stringstream in(out);
+    std::string stat, name;
+    long value;
+    while (in >> stat && stat == "STAT" && in >> name >> value) {
+        result[name] = value;
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(StatsTest, ResponseFormat) {
+    Backend::SimpleLRU storage;
+    std::string out;
+    Execute::Stats().Execute(storage, "", out);
+
+    ASSERT_EQ(0, out.find("STAT pid "));
+    ASSERT_EQ(out.size() - 3, out.rfind("END"));
+}
+
+TEST(StatsTest, CountsCommands) {
+    auto before = stats();
+
+    Backend::SimpleLRU storage;
+    std::string out;
+    Execute::Set("foo", 0, 0).Execute(storage, "bar", out);
+    Execute::Get({"foo", "missing"}).Execute(storage, "", out);
+
+    // Counters of exited threads must not be lost
+    std::thread([&storage]() {
+        std::string out;
+        Execute::Get({"foo"}).Execute(storage, "", out);
+    }).join();
+
+    auto after = stats();
+    EXPECT_EQ(1, after["cmd_set"] - before["cmd_set"]);
+    EXPECT_EQ(3, after["cmd_get"] - before["cmd_get"]);
+    EXPECT_EQ(2, after["get_hits"] - before["get_hits"]);
+    EXPECT_EQ(1, after["get_misses"] - before["get_misses"]);
+}
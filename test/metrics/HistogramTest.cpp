@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <thread>
+
+#include <afina/metrics/Histogram.h>
+#include <afina/metrics/Latency.h>
+
+using namespace Afina::Metrics;
+
+TEST(HistogramTest, BucketsCoverValues) {
+    for (uint64_t value : {0ull, 1ull, 31ull, 32ull, 33ull, 1000ull, 123456ull, (1ull << 31) + 5}) {
+        std::size_t bucket = Histogram::BucketOf(value);
+        ASSERT_LT(bucket, Histogram::kBuckets);
+        EXPECT_LE(Histogram::LowestOf(bucket), value);
+        EXPECT_GT(Histogram::LowestOf(bucket) + Histogram::WidthOf(bucket), value);
+    }
+
+    // Too large values are clamped into the last bucket
+    EXPECT_EQ(Histogram::kBuckets - 1, Histogram::BucketOf(uint64_t(1) << 40));
+}
+
+TEST(HistogramTest, Percentiles) {
+    Histogram histogram;
+    for (uint64_t i = 1; i <= 10000; i++) {
+        histogram.Record(i);
+    }
+
+    EXPECT_EQ(10000, histogram.Count());
+    EXPECT_EQ(10000, histogram.Max());
+
+    // Precision is 1/32 of the value
+    EXPECT_NEAR(5000, histogram.Percentile(50), 5000 / 32);
+    EXPECT_NEAR(9900, histogram.Percentile(99), 9900 / 32);
+    EXPECT_NEAR(9990, histogram.Percentile(99.9), 9990 / 32);
+}
+
+TEST(HistogramTest, Merge) {
+    Histogram a, b;
+    a.Record(10);
+    b.Record(20);
+    b.Record(1000);
+
+    a.Merge(b);
+    EXPECT_EQ(3, a.Count());
+    EXPECT_EQ(1000, a.Max());
+    EXPECT_EQ(10, a.Percentile(0));
+}
+
+TEST(LatencyTest, SampledAndMergedAcrossThreads) {
+    Latency &latency = Latency::Instance();
+    latency.SetSampleRate(1);
+
+    Histogram before;
+    latency.Collect(kCommandSet, before);
+
+    std::thread([&latency]() {
+        for (int i = 0; i < 10; i++) {
+            latency.Finish("set", latency.Start());
+        }
+    }).join();
+
+    // Every 4-th command only
+    latency.SetSampleRate(4);
+    for (int i = 0; i < 8; i++) {
+        latency.Finish("set", latency.Start());
+    }
+
+    Histogram after;
+    latency.Collect(kCommandSet, after);
+    EXPECT_EQ(12, after.Count() - before.Count());
+}
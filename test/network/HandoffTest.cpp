@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <network/common/Handoff.h>
+
+using namespace Afina::Network;
+
+TEST(HandoffTest, PassesDescriptors) {
+    int channel[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, channel));
+
+    int first[2], second[2];
+    ASSERT_EQ(0, pipe(first));
+    ASSERT_EQ(0, pipe(second));
+
+    Handoff::Send(channel[0], {first[1], second[1]});
+    std::vector<int> received = Handoff::Receive(channel[1]);
+    ASSERT_EQ(2, received.size());
+
+    // Received descriptors refer to the same pipes, while the sent ones are still open
+    EXPECT_NE(first[1], received[0]);
+    ASSERT_EQ(2, write(received[0], "ok", 2));
+    ASSERT_EQ(3, write(second[1], "yes", 3));
+
+    char buf[8];
+    ASSERT_EQ(2, read(first[0], buf, sizeof(buf)));
+    EXPECT_EQ("ok", std::string(buf, 2));
+    close(received[1]);
+    close(second[1]);
+    ASSERT_EQ(3, read(second[0], buf, sizeof(buf)));
+    EXPECT_EQ("yes", std::string(buf, 3));
+
+    Handoff::Confirm(channel[1]);
+    EXPECT_TRUE(Handoff::WaitConfirm(channel[0], 1000));
+
+    for (int fd : {channel[0], channel[1], first[0], first[1], second[0], received[0]}) {
+        close(fd);
+    }
+}
+
+TEST(HandoffTest, NoConfirmation) {
+    int channel[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, channel));
+
+    Handoff::Send(channel[0], {});
+    EXPECT_TRUE(Handoff::Receive(channel[1]).empty());
+    EXPECT_FALSE(Handoff::WaitConfirm(channel[0], 10));
+
+    // Successor died without confirmation
+    close(channel[1]);
+    EXPECT_FALSE(Handoff::WaitConfirm(channel[0], 1000));
+    close(channel[0]);
+}
+
+TEST(HandoffTest, NobodyListens) {
+    std::string path = "/tmp/afina-handoff-test-" + std::to_string(getpid());
+    EXPECT_EQ(-1, Handoff::Connect(path));
+
+    int server = Handoff::Listen(path);
+    int client = Handoff::Connect(path);
+    EXPECT_NE(-1, client);
+
+    close(client);
+    close(server);
+    unlink(path.c_str());
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <string>
+
+#include <network/common/InputBuffer.h>
+
+using namespace Afina::Network;
+
+namespace {
+
+// Simulates read() from socket
+void Receive(InputBuffer &buffer, const std::string &data) {
+    std::size_t available = 0;
+    char *tail = buffer.Reserve(available);
+    ASSERT_NE(nullptr, tail);
+    ASSERT_GE(available, data.size());
+    std::memcpy(tail, data.data(), data.size());
+    buffer.Commit(data.size());
+}
+
+} // namespace
+
+TEST(InputBufferTest, ConsumeAdvancesCursor) {
+    InputBuffer buffer;
+    Receive(buffer, "get a\r\nget b\r\n");
+    const char *start = buffer.data();
+
+    buffer.Consume(7);
+    EXPECT_EQ(start + 7, buffer.data());
+    EXPECT_EQ("get b\r\n", std::string(buffer.data(), buffer.size()));
+
+    buffer.Consume(7);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(InputBufferTest, CompactsOnlyWhenTailIsExhausted) {
+    InputBuffer buffer;
+    std::string block(InputBuffer::kInitialSize - 3, 'x');
+    Receive(buffer, block);
+    buffer.Consume(block.size() - 2);
+
+    // Still space at the tail, remainder stays where it is
+    std::size_t available = 0;
+    char *tail = buffer.Reserve(available);
+    EXPECT_EQ(3, available);
+    std::memcpy(tail, "abc", 3);
+    buffer.Commit(3);
+
+    // Now it moves to the start
+    tail = buffer.Reserve(available);
+    EXPECT_EQ(InputBuffer::kInitialSize, buffer.capacity());
+    EXPECT_EQ(InputBuffer::kInitialSize - 5, available);
+    EXPECT_EQ("xxabc", std::string(buffer.data(), buffer.size()));
+}
+
+TEST(InputBufferTest, GrowsForLongCommand) {
+    InputBuffer buffer;
+    std::string line(3 * InputBuffer::kInitialSize, 'k');
+    EXPECT_TRUE(buffer.Append(line.data(), line.size()));
+    EXPECT_EQ(line, std::string(buffer.data(), buffer.size()));
+    EXPECT_GE(buffer.capacity(), line.size());
+
+    // Memory goes away with the command
+    buffer.Consume(line.size());
+    EXPECT_EQ(0, buffer.capacity());
+}
+
+TEST(InputBufferTest, RespectsLimit) {
+    InputBuffer buffer(2 * InputBuffer::kInitialSize);
+    std::string line(2 * InputBuffer::kInitialSize, 'k');
+    EXPECT_TRUE(buffer.Append(line.data(), line.size()));
+
+    std::size_t available = 0;
+    EXPECT_EQ(nullptr, buffer.Reserve(available));
+    EXPECT_FALSE(buffer.Append("x", 1));
+}
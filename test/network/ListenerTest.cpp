@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <network/common/Listener.h>
+
+using namespace Afina::Network;
+
+TEST(ListenerTest, ParsesAddresses) {
+    EXPECT_EQ("0.0.0.0:8080", Listener::Parse("8080").ToString());
+    EXPECT_EQ("0.0.0.0:8080", Listener::Parse(":8080").ToString());
+    EXPECT_EQ("127.0.0.1:11211", Listener::Parse("127.0.0.1:11211").ToString());
+    EXPECT_EQ("[::1]:8080", Listener::Parse("[::1]:8080").ToString());
+    EXPECT_EQ("[::]:8080", Listener::Parse("[::]:8080").ToString());
+    EXPECT_EQ("unix:/tmp/afina.sock", Listener::Parse("unix:/tmp/afina.sock").ToString());
+    EXPECT_EQ("unix:@afina", Listener::Parse("unix:@afina").ToString());
+
+    EXPECT_EQ(AF_INET6, Listener::Parse("[::1]:8080").addr.ss_family);
+    EXPECT_TRUE(Listener::Parse("8080").CanReusePort());
+    EXPECT_FALSE(Listener::Parse("unix:@afina").CanReusePort());
+
+    // Abstract name isn't terminated, so it takes exactly its bytes
+    EXPECT_EQ(offsetof(struct sockaddr_un, sun_path) + 6, Listener::Parse("unix:@afina").len);
+}
+
+TEST(ListenerTest, RejectsMalformed) {
+    for (const char *spec : {"", "0", "65536", "8080x", "host:8080", "1.2.3:8080", "::1:8080", "[::1]8080",
+                             "[::1]:", "[1.2.3.4]:8080", "127.0.0.1:", "unix:", "unix:@"}) {
+        EXPECT_THROW(Listener::Parse(spec), std::runtime_error) << spec;
+    }
+    EXPECT_THROW(Listener::Parse("unix:/" + std::string(200, 'a')), std::runtime_error);
+}
+
+TEST(ListenerTest, DefaultsToPort) {
+    std::vector<Listener::Address> addresses = Listener::Parse(std::vector<std::string>(), 8080);
+    ASSERT_EQ(1, addresses.size());
+    EXPECT_EQ("0.0.0.0:8080", addresses[0].ToString());
+
+    addresses = Listener::Parse({"127.0.0.1:1", "unix:@a"}, 8080);
+    ASSERT_EQ(2, addresses.size());
+    EXPECT_EQ("unix:@a", addresses[1].ToString());
+}
+
+TEST(ListenerTest, AcceptsOnAbstractSocket) {
+    Listener::Address address = Listener::Parse("unix:@afina-listener-test-" + std::to_string(getpid()));
+    int server = Listener::Open(address, true, false);
+    EXPECT_TRUE(Listener::Local(server) == address);
+
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_NE(-1, client);
+    ASSERT_EQ(0, connect(client, reinterpret_cast<const struct sockaddr *>(&address.addr), address.len));
+
+    struct sockaddr_storage peer;
+    socklen_t peer_len = sizeof(peer);
+    int accepted = Listener::Accept({server}, &peer, &peer_len);
+    ASSERT_NE(-1, accepted);
+    ASSERT_EQ(2, write(client, "ok", 2));
+
+    char buf[8];
+    ASSERT_EQ(2, read(accepted, buf, sizeof(buf)));
+    EXPECT_EQ("ok", std::string(buf, 2));
+
+    // Name is taken while socket is open
+    EXPECT_THROW(Listener::Open(address, true, false), std::runtime_error);
+
+    for (int fd : {accepted, client, server}) {
+        close(fd);
+    }
+}
+
+TEST(ListenerTest, OwnsSocketFile) {
+    std::string path = "/tmp/afina-listener-test-" + std::to_string(getpid()) + ".sock";
+    Listener::Address address = Listener::Parse("unix:" + path);
+
+    // File of a crashed process is replaced
+    int crashed = Listener::Open(address, true, false);
+    close(crashed);
+    int server = Listener::Open(address, true, false);
+
+    // Running server keeps its address
+    EXPECT_THROW(Listener::Open(address, true, false), std::runtime_error);
+
+    // File is gone with the server, but not while somebody else accepts on the socket
+    int successor = dup(server);
+    Listener::Close(server);
+    EXPECT_EQ(0, access(path.c_str(), F_OK));
+    Listener::Close(successor);
+    EXPECT_NE(0, access(path.c_str(), F_OK));
+}
+
+TEST(ListenerTest, DistributesSockets) {
+    // Port is chosen by the kernel, the rest of reuseport sockets join the first one
+    Listener::Address any = Listener::Parse("127.0.0.1:1");
+    reinterpret_cast<struct sockaddr_in *>(&any.addr)->sin_port = 0;
+
+    std::vector<int> sockets;
+    sockets.push_back(Listener::Open(any, true, true));
+    Listener::Address tcp = Listener::Local(sockets[0]);
+    sockets.push_back(Listener::Open(tcp, true, true));
+    sockets.push_back(Listener::Open(tcp, true, true));
+    sockets.push_back(Listener::Open(Listener::Parse("unix:@afina-distribute-" + std::to_string(getpid())), true,
+                                     false));
+
+    // Every worker has a socket for each address, unix socket is shared
+    std::vector<std::vector<int>> workers = Listener::Distribute(sockets, 2);
+    ASSERT_EQ(3, workers.size());
+    for (std::size_t i = 0; i < workers.size(); i++) {
+        ASSERT_EQ(2, workers[i].size());
+        EXPECT_EQ(sockets[i], workers[i][0]);
+        EXPECT_EQ(sockets[3], workers[i][1]);
+    }
+
+    workers = Listener::Distribute(sockets, 4);
+    ASSERT_EQ(4, workers.size());
+    EXPECT_EQ(sockets[0], workers[3][0]);
+
+    for (int fd : sockets) {
+        close(fd);
+    }
+}
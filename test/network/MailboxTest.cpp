@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+#include <network/common/Mailbox.h>
+
+using namespace Afina::Network;
+
+namespace {
+
+struct Item {
+    int producer = 0;
+    int seq = 0;
+    Item *mailbox_next = nullptr;
+};
+
+} // namespace
+
+TEST(MailboxTest, KeepsOrder) {
+    Mailbox<Item> mailbox;
+    EXPECT_TRUE(mailbox.empty());
+    EXPECT_EQ(nullptr, mailbox.TakeAll());
+
+    Item items[3];
+    EXPECT_TRUE(mailbox.Push(&items[0]));
+    EXPECT_FALSE(mailbox.Push(&items[1]));
+    EXPECT_FALSE(mailbox.Push(&items[2]));
+    EXPECT_FALSE(mailbox.empty());
+
+    Item *it = mailbox.TakeAll();
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(&items[i], it);
+        it = it->mailbox_next;
+    }
+    EXPECT_EQ(nullptr, it);
+
+    // Emptied mailbox asks for wakeup again
+    EXPECT_TRUE(mailbox.empty());
+    EXPECT_TRUE(mailbox.Push(&items[1]));
+}
+
+TEST(MailboxTest, ConcurrentProducers) {
+    const int producers = 4, per_producer = 10000;
+    std::vector<Item> items(producers * per_producer);
+    Mailbox<Item> mailbox;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < per_producer; i++) {
+                Item &item = items[p * per_producer + i];
+                item.producer = p;
+                item.seq = i;
+                mailbox.Push(&item);
+            }
+        });
+    }
+
+    // Consumer runs concurrently, each producer's items must come in order and none is lost
+    std::vector<int> next(producers, 0);
+    int taken = 0;
+    while (taken < producers * per_producer) {
+        for (Item *it = mailbox.TakeAll(); it != nullptr; it = it->mailbox_next) {
+            ASSERT_EQ(next[it->producer], it->seq);
+            next[it->producer]++;
+            taken++;
+        }
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_TRUE(mailbox.empty());
+}
@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <network/common/MemoryBudget.h>
+#include <network/common/OutputQueue.h>
+
+using namespace Afina::Network;
+
+namespace {
+
+// Glues together everything queue would send
+std::string Collect(const OutputQueue &queue) {
+    struct iovec iov[64];
+    int count = queue.Fill(iov, 64);
+
+    std::string result;
+    for (int i = 0; i < count; i++) {
+        result.append(static_cast<char *>(iov[i].iov_base), iov[i].iov_len);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(OutputQueueTest, SmallResponsesShareBlock) {
+    OutputQueue queue;
+    queue.Append("STORED\r\n");
+    queue.Append("VALUE a 0 1\r\nx\r\nEND\r\n");
+
+    struct iovec iov[4];
+    EXPECT_EQ(1, queue.Fill(iov, 4));
+    EXPECT_EQ("STORED\r\nVALUE a 0 1\r\nx\r\nEND\r\n", Collect(queue));
+    EXPECT_EQ(29, queue.size());
+}
+
+TEST(OutputQueueTest, LargeResponseSpansBlocks) {
+    OutputQueue queue;
+    std::string data(OutputQueue::kBlockSize * 2 + 10, 'x');
+    data[OutputQueue::kBlockSize] = 'y';
+    queue.Append(data);
+
+    struct iovec iov[4];
+    EXPECT_EQ(3, queue.Fill(iov, 4));
+    EXPECT_EQ(2, queue.Fill(iov, 2));
+    EXPECT_EQ(data, Collect(queue));
+}
+
+TEST(OutputQueueTest, PartialAdvanceResumes) {
+    OutputQueue queue;
+    std::string data(OutputQueue::kBlockSize + 100, 'a');
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = 'a' + i % 26;
+    }
+    queue.Append(data);
+
+    queue.Advance(5);
+    EXPECT_EQ(data.substr(5), Collect(queue));
+
+    queue.Advance(OutputQueue::kBlockSize);
+    EXPECT_EQ(data.substr(OutputQueue::kBlockSize + 5), Collect(queue));
+
+    queue.Append("END\r\n");
+    EXPECT_EQ(data.substr(OutputQueue::kBlockSize + 5) + "END\r\n", Collect(queue));
+
+    queue.Advance(queue.size());
+    EXPECT_TRUE(queue.empty());
+
+    struct iovec iov[4];
+    EXPECT_EQ(0, queue.Fill(iov, 4));
+}
+
+TEST(OutputQueueTest, FlushWritesToSocket) {
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+    OutputQueue queue;
+    queue.Append("DELETED\r\n");
+    queue.Append("NOT_FOUND\r\n");
+    EXPECT_EQ(20, queue.Flush(fds[0]));
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(0, queue.Flush(fds[0]));
+
+    char buf[32];
+    ASSERT_EQ(20, read(fds[1], buf, sizeof(buf)));
+    EXPECT_EQ("DELETED\r\nNOT_FOUND\r\n", std::string(buf, 20));
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(OutputQueueTest, BlocksAreAccounted) {
+    MemoryBudget &budget = MemoryBudget::Instance();
+    std::size_t before = budget.Used();
+    {
+        OutputQueue queue;
+        queue.Append(std::string(OutputQueue::kBlockSize + 1, 'x'));
+        EXPECT_LE(before + 2 * OutputQueue::kBlockSize, budget.Used());
+
+        queue.Advance(OutputQueue::kBlockSize);
+        EXPECT_LE(before + OutputQueue::kBlockSize, budget.Used());
+        EXPECT_GT(before + 2 * OutputQueue::kBlockSize, budget.Used());
+    }
+    EXPECT_EQ(before, budget.Used());
+
+    EXPECT_FALSE(budget.OverBudget(0));
+    EXPECT_TRUE(budget.OverBudget(MemoryBudget::kOutputLimit + 1));
+}
@@ -0,0 +1,164 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <network/common/Listener.h>
+#include <network/proxy/ServerImpl.h>
+#include <network/st_nonblocking/ServerImpl.h>
+
+#include "common/QuietLogging.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+
+namespace {
+
+/**
+ * Sends request and reads until response ends with the given tail
+ */
+std::string exchange(const std::string &address, const std::string &request, const std::string &tail) {
+    Network::Listener::Address to = Network::Listener::Parse(address);
+    int s = socket(AF_UNIX, SOCK_STREAM, 0);
+    EXPECT_EQ(0, connect(s, reinterpret_cast<const struct sockaddr *>(&to.addr), to.len));
+    EXPECT_EQ(request.size(), send(s, request.data(), request.size(), 0));
+
+    std::string response;
+    char buf[4096];
+    ssize_t n;
+    while ((response.size() < tail.size() || response.compare(response.size() - tail.size(), tail.size(), tail)) &&
+           (n = recv(s, buf, sizeof(buf), 0)) > 0) {
+        response.append(buf, n);
+    }
+    close(s);
+    return response;
+}
+
+class ProxyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        logging = Afina::Test::QuietLogging();
+        std::string prefix = "unix:@afina-proxy-test-" + std::to_string(getpid());
+        for (int i = 0; i < 2; i++) {
+            backends.push_back(prefix + "-" + std::to_string(i));
+            servers.push_back(std::make_shared<Network::STnonblock::ServerImpl>(
+                std::make_shared<Backend::SimpleLRU>(), logging));
+            servers.back()->SetAddresses({backends.back()});
+        }
+
+        proxy = prefix;
+        servers.push_back(std::make_shared<Network::Proxy::ServerImpl>(std::make_shared<Backend::SimpleLRU>(),
+                                                                        logging, backends,
+                                                                        Client::AsyncClient::Options()));
+        servers.back()->SetAddresses({proxy});
+
+        for (auto &server : servers) {
+            server->Start(0, 1, 2);
+        }
+    }
+
+    void TearDown() override {
+        for (auto it = servers.rbegin(); it != servers.rend(); it++) {
+            (*it)->Stop();
+            (*it)->Join();
+        }
+    }
+
+    std::shared_ptr<Logging::Service> logging;
+    std::vector<std::shared_ptr<Network::Server>> servers;
+    std::vector<std::string> backends;
+    std::string proxy;
+};
+
+} // namespace
+
+TEST_F(ProxyTest, SplitsAndMergesKeys) {
+    std::string request, keys;
+    for (int i = 0; i < 10; i++) {
+        request += "set proxy-test-key-" + std::to_string(i) + " 0 0 1\r\n" + std::to_string(i) + "\r\n";
+        keys += " proxy-test-key-" + std::to_string(i);
+    }
+    std::string response = exchange(proxy, request + "get missing" + keys + "\r\n", "END\r\n");
+
+    // Every key is on exactly one backend, and both backends got their share
+    std::vector<std::string> blocks(10);
+    for (auto &backend : backends) {
+        int own = 0;
+        for (int i = 0; i < 10; i++) {
+            std::string block = exchange(backend, "get proxy-test-key-" + std::to_string(i) + "\r\n", "END\r\n");
+            block.resize(block.size() - 5);
+            if (!block.empty()) {
+                EXPECT_TRUE(blocks[i].empty()) << i;
+                blocks[i] = block;
+                own++;
+            }
+        }
+        EXPECT_GT(own, 0);
+    }
+
+    // Responses come in order of commands, values are passed as backends have them in order of keys
+    std::string expected;
+    for (int i = 0; i < 10; i++) {
+        expected += "STORED\r\n";
+    }
+    for (auto &block : blocks) {
+        EXPECT_FALSE(block.empty());
+        expected += block;
+    }
+    expected += "END\r\n";
+    EXPECT_EQ(expected, response);
+}
+
+TEST_F(ProxyTest, AnswersErrorsInOrder) {
+    std::string response = exchange(proxy,
+                                     "set proxy-test-a 0 0 1\r\na\r\n"
+                                     "get bad\x01key\r\n"
+                                     "add proxy-test-a 0 0 1\r\nb\r\n"
+                                     "gets proxy-test-a\r\n"
+                                     "stats\r\n",
+                                     "END\r\n");
+    EXPECT_EQ(0, response.find("STORED\r\nCLIENT_ERROR "));
+    EXPECT_NE(std::string::npos,
+              response.find("\r\nNOT_STORED\r\nCLIENT_ERROR gets is not supported by proxy\r\nSTAT pid "));
+
+    // Backend gone: its keys fail, the rest are still served
+    servers[0]->Stop();
+    servers[0]->Join();
+    servers.erase(servers.begin());
+
+    std::string request;
+    for (int i = 0; i < 10; i++) {
+        request += "set proxy-test-key-" + std::to_string(i) + " 0 0 1\r\nx\r\n";
+    }
+    response = exchange(proxy, request + "stats\r\n", "END\r\n");
+    EXPECT_NE(std::string::npos, response.find("SERVER_ERROR backend"));
+    EXPECT_NE(std::string::npos, response.find("STORED\r\n"));
+}
+
+TEST_F(ProxyTest, MultiGetSurvivesBackendDown) {
+    std::string request, keys;
+    for (int i = 0; i < 10; i++) {
+        request += "set proxy-test-key-" + std::to_string(i) + " 0 0 1\r\n" + std::to_string(i) + "\r\n";
+        keys += " proxy-test-key-" + std::to_string(i);
+    }
+    exchange(proxy, request + "get" + keys + "\r\n", "END\r\n");
+
+    // Values of the backend left alive, keys of the gone one are misses
+    std::string expected;
+    for (int i = 0; i < 10; i++) {
+        std::string block = exchange(backends[1], "get proxy-test-key-" + std::to_string(i) + "\r\n", "END\r\n");
+        expected += block.substr(0, block.size() - 5);
+    }
+    expected += "END\r\n";
+    ASSERT_NE("END\r\n", expected);
+
+    servers[0]->Stop();
+    servers[0]->Join();
+    servers.erase(servers.begin());
+
+    EXPECT_EQ(expected, exchange(proxy, "get" + keys + "\r\n", "END\r\n"));
+}
@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <network/common/RateLimiter.h>
+
+using namespace Afina::Network;
+using std::chrono::milliseconds;
+
+namespace {
+
+RateLimiter::Limit limit(uint64_t ops, uint64_t bytes) {
+    RateLimiter::Limit limit;
+    limit.ops = ops;
+    limit.bytes = bytes;
+    return limit;
+}
+
+} // namespace
+
+TEST(RateLimiterTest, DisabledHasNoBuckets) {
+    RateLimiter limiter;
+    EXPECT_EQ(nullptr, limiter.Acquire("client", RateLimiter::Clock::now()));
+    limiter.Release(nullptr);
+}
+
+TEST(RateLimiterTest, CommandsAreLimited) {
+    RateLimiter limiter(limit(100, 0));
+    auto now = RateLimiter::Clock::now();
+    RateLimiter::Bucket *bucket = limiter.Acquire("client", now);
+    ASSERT_NE(nullptr, bucket);
+
+    // Burst is 100ms worth of rate
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(limiter.TakeCommand(*bucket, now));
+    }
+    EXPECT_FALSE(limiter.TakeCommand(*bucket, now));
+    EXPECT_NEAR(10000, std::chrono::duration_cast<std::chrono::microseconds>(limiter.Delay(*bucket, now)).count(), 1);
+
+    // Single token comes every 10ms
+    EXPECT_TRUE(limiter.TakeCommand(*bucket, now + milliseconds(10)));
+    EXPECT_FALSE(limiter.TakeCommand(*bucket, now + milliseconds(10)));
+
+    // Idle client doesn't save more than a burst
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(limiter.TakeCommand(*bucket, now + milliseconds(10000)));
+    }
+    EXPECT_FALSE(limiter.TakeCommand(*bucket, now + milliseconds(10000)));
+}
+
+TEST(RateLimiterTest, IdleClientGetsSingleBurst) {
+    RateLimiter limiter(limit(100, 0));
+    auto now = RateLimiter::Clock::now();
+    RateLimiter::Bucket *bucket = limiter.Acquire("client", now);
+
+    // Idle time is credited once, spent bucket isn't refilled with it again
+    auto later = now + milliseconds(10000);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(limiter.TakeCommand(*bucket, later));
+    }
+    EXPECT_FALSE(limiter.TakeCommand(*bucket, later));
+}
+
+TEST(RateLimiterTest, BytesGoIntoDebt) {
+    RateLimiter limiter(limit(0, 100000));
+    auto now = RateLimiter::Clock::now();
+    RateLimiter::Bucket *bucket = limiter.Acquire("client", now);
+
+    EXPECT_EQ(10000, limiter.Allowance(*bucket, now));
+    EXPECT_TRUE(limiter.TakeCommand(*bucket, now));
+
+    // Read could take more than allowed, the rest is paid by waiting
+    limiter.TakeBytes(*bucket, 20000);
+    EXPECT_EQ(0, limiter.Allowance(*bucket, now));
+    auto delay = std::chrono::duration_cast<std::chrono::microseconds>(limiter.Delay(*bucket, now));
+    EXPECT_NEAR(100010, delay.count(), 1);
+    EXPECT_EQ(0, limiter.Allowance(*bucket, now + milliseconds(50)));
+    EXPECT_LT(0, limiter.Allowance(*bucket, now + milliseconds(101)));
+}
+
+TEST(RateLimiterTest, ConnectionsShareBucket) {
+    RateLimiter limiter(limit(10, 0));
+    auto now = RateLimiter::Clock::now();
+    RateLimiter::Bucket *first = limiter.Acquire("client", now);
+    RateLimiter::Bucket *second = limiter.Acquire("client", now);
+    RateLimiter::Bucket *other = limiter.Acquire("other", now);
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+    EXPECT_EQ(2, limiter.size());
+
+    EXPECT_TRUE(limiter.TakeCommand(*first, now));
+    EXPECT_FALSE(limiter.TakeCommand(*second, now));
+    EXPECT_TRUE(limiter.TakeCommand(*other, now));
+
+    limiter.Release(first);
+    EXPECT_EQ(2, limiter.size());
+    limiter.Release(second);
+    EXPECT_EQ(1, limiter.size());
+
+    // Bucket of a client without connections is forgotten, the new one is full
+    RateLimiter::Bucket *again = limiter.Acquire("client", now);
+    EXPECT_TRUE(limiter.TakeCommand(*again, now));
+}
+
+TEST(RateLimiterTest, Keys) {
+    struct sockaddr_storage storage;
+    std::memset(&storage, 0, sizeof(storage));
+    struct sockaddr_in *in = reinterpret_cast<struct sockaddr_in *>(&storage);
+    in->sin_family = AF_INET;
+    in->sin_port = htons(12345);
+    inet_pton(AF_INET, "10.1.2.3", &in->sin_addr);
+
+    RateLimiter::Limit by_address = limit(10, 0);
+    EXPECT_EQ("10.1.2.3", RateLimiter(by_address).Key(storage, sizeof(*in), "127.0.0.1:8080"));
+
+    RateLimiter::Limit by_listener = limit(10, 0);
+    by_listener.key = RateLimiter::Limit::Key::kListener;
+    EXPECT_EQ("127.0.0.1:8080", RateLimiter(by_listener).Key(storage, sizeof(*in), "127.0.0.1:8080"));
+
+    storage.ss_family = AF_UNIX;
+    EXPECT_EQ("unix", RateLimiter(by_address).Key(storage, sizeof(storage.ss_family), "unix:@afina"));
+}
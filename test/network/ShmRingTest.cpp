@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <network/shm/Ring.h>
+
+using namespace Afina::Network::Shm;
+
+namespace {
+
+constexpr uint32_t kCapacity = 4096;
+
+struct TestSegment {
+    TestSegment() : memory(Segment::Size(kCapacity) + 64) {
+        // Segment must be aligned as in mapping
+        base = memory.data() + (64 - reinterpret_cast<uintptr_t>(memory.data()) % 64);
+        Segment::Init(base, kCapacity);
+        segment = reinterpret_cast<Segment *>(base);
+        producer = Ring(&segment->requests, segment->Data(), kCapacity);
+        consumer = Ring(&segment->requests, segment->Data(), kCapacity);
+    }
+
+    std::vector<char> memory;
+    char *base;
+    Segment *segment;
+    Ring producer;
+    Ring consumer;
+};
+
+std::string pop(Ring &ring) {
+    const char *data;
+    std::size_t size;
+    if (!ring.Peek(data, size)) {
+        return "<empty>";
+    }
+    std::string result(data, size);
+    ring.Pop();
+    return result;
+}
+
+} // namespace
+
+TEST(ShmRingTest, SegmentHeader) {
+    TestSegment t;
+    EXPECT_TRUE(Segment::Valid(t.base, Segment::Size(kCapacity)));
+    EXPECT_FALSE(Segment::Valid(t.base, Segment::Size(kCapacity) - 1));
+
+    t.segment->capacity = kCapacity + 8;
+    EXPECT_FALSE(Segment::Valid(t.base, Segment::Size(kCapacity) + 64));
+    t.segment->capacity = kCapacity;
+    t.segment->magic = 0;
+    EXPECT_FALSE(Segment::Valid(t.base, Segment::Size(kCapacity)));
+}
+
+TEST(ShmRingTest, KeepsOrder) {
+    TestSegment t;
+    EXPECT_TRUE(t.consumer.Empty());
+    EXPECT_EQ("<empty>", pop(t.consumer));
+
+    ASSERT_TRUE(t.producer.Push("get a\r\n", 7));
+    ASSERT_TRUE(t.producer.Push("", 0));
+    ASSERT_TRUE(t.producer.Push("get b\r\n", 7));
+    EXPECT_FALSE(t.consumer.Empty());
+    EXPECT_EQ("get a\r\n", pop(t.consumer));
+    EXPECT_EQ("", pop(t.consumer));
+    EXPECT_EQ("get b\r\n", pop(t.consumer));
+    EXPECT_TRUE(t.consumer.Empty());
+    EXPECT_FALSE(t.consumer.Broken());
+}
+
+TEST(ShmRingTest, WrapsAround) {
+    TestSegment t;
+    std::string record(1000, 'x');
+    for (int i = 0; i < 100; i++) {
+        record[0] = 'a' + i % 26;
+        ASSERT_TRUE(t.producer.Push(record.data(), record.size())) << i;
+        ASSERT_TRUE(t.producer.Push(record.data(), 17)) << i;
+        ASSERT_EQ(record, pop(t.consumer)) << i;
+        ASSERT_EQ(record.substr(0, 17), pop(t.consumer)) << i;
+    }
+    EXPECT_FALSE(t.consumer.Broken());
+}
+
+TEST(ShmRingTest, Full) {
+    TestSegment t;
+    std::string record(Ring::MaxRecord(kCapacity), 'x');
+    EXPECT_FALSE(t.producer.Push(record.data(), record.size() + 1));
+
+    ASSERT_TRUE(t.producer.Push(record.data(), record.size()));
+    ASSERT_TRUE(t.producer.Push(record.data(), record.size()));
+    EXPECT_FALSE(t.producer.Push("a", 1));
+
+    EXPECT_EQ(record, pop(t.consumer));
+    EXPECT_TRUE(t.producer.Push("a", 1));
+}
+
+TEST(ShmRingTest, DetectsBrokenPeer) {
+    TestSegment t;
+    ASSERT_TRUE(t.producer.Push("get a\r\n", 7));
+
+    // Length points past the data written
+    uint32_t len = 1000;
+    std::memcpy(t.segment->Data(), &len, sizeof(len));
+    const char *data;
+    std::size_t size;
+    EXPECT_FALSE(t.consumer.Peek(data, size));
+    EXPECT_TRUE(t.consumer.Broken());
+
+    // Tail is too far ahead
+    TestSegment u;
+    u.segment->requests.tail = kCapacity + 8;
+    EXPECT_FALSE(u.consumer.Peek(data, size));
+    EXPECT_TRUE(u.consumer.Broken());
+}
+
+TEST(ShmRingTest, WaitAnnounce) {
+    TestSegment t;
+    ASSERT_TRUE(t.consumer.PrepareWait());
+    ASSERT_TRUE(t.producer.Push("a", 1));
+    EXPECT_TRUE(t.producer.NeedsSignal());
+
+    // Signal is sent once per announce
+    ASSERT_TRUE(t.producer.Push("b", 1));
+    EXPECT_FALSE(t.producer.NeedsSignal());
+
+    // Consumer doesn't sleep on a ring with records
+    EXPECT_FALSE(t.consumer.PrepareWait());
+    EXPECT_FALSE(t.producer.NeedsSignal());
+    t.consumer.CancelWait();
+}
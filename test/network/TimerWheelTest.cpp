@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include <network/common/TimerWheel.h>
+
+using namespace Afina::Network;
+using std::chrono::milliseconds;
+
+namespace {
+
+std::vector<void *> AdvanceTo(TimerWheel &wheel, TimerWheel::Clock::time_point now) {
+    std::vector<void *> expired;
+    wheel.Advance(now, [&expired](void *data) { expired.push_back(data); });
+    return expired;
+}
+
+} // namespace
+
+TEST(TimerWheelTest, ExpiresNotEarlier) {
+    auto start = TimerWheel::Clock::now();
+    TimerWheel wheel(milliseconds(10), 8, start);
+    EXPECT_EQ(-1, wheel.Timeout(start));
+
+    TimerWheel::Timer timer;
+    timer.data = &timer;
+    wheel.Schedule(timer, milliseconds(25), start);
+    EXPECT_TRUE(timer.scheduled());
+    EXPECT_EQ(30, wheel.Timeout(start));
+
+    EXPECT_TRUE(AdvanceTo(wheel, start + milliseconds(25)).empty());
+
+    std::vector<void *> expired = AdvanceTo(wheel, start + milliseconds(30));
+    ASSERT_EQ(1, expired.size());
+    EXPECT_EQ(&timer, expired[0]);
+    EXPECT_FALSE(timer.scheduled());
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, LongerThanRotation) {
+    auto start = TimerWheel::Clock::now();
+    TimerWheel wheel(milliseconds(10), 4, start);
+
+    TimerWheel::Timer timer;
+    wheel.Schedule(timer, milliseconds(100), start);
+
+    // Slot of the timer is visited twice before its tick comes
+    EXPECT_TRUE(AdvanceTo(wheel, start + milliseconds(50)).empty());
+    EXPECT_TRUE(AdvanceTo(wheel, start + milliseconds(90)).empty());
+    EXPECT_EQ(1, AdvanceTo(wheel, start + milliseconds(110)).size());
+}
+
+TEST(TimerWheelTest, RescheduleAndCancel) {
+    auto start = TimerWheel::Clock::now();
+    TimerWheel wheel(milliseconds(10), 16, start);
+
+    TimerWheel::Timer a, b;
+    wheel.Schedule(a, milliseconds(20), start);
+    wheel.Schedule(b, milliseconds(20), start);
+
+    // Activity moves deadline forward
+    wheel.Schedule(a, milliseconds(100), start);
+    wheel.Cancel(b);
+
+    EXPECT_TRUE(AdvanceTo(wheel, start + milliseconds(50)).empty());
+    EXPECT_FALSE(wheel.empty());
+    EXPECT_EQ(1, AdvanceTo(wheel, start + milliseconds(1000)).size());
+}
+
+TEST(TimerWheelTest, DestroyedTimerIsUnlinked) {
+    auto start = TimerWheel::Clock::now();
+    TimerWheel wheel(milliseconds(10), 16, start);
+    {
+        TimerWheel::Timer timer;
+        wheel.Schedule(timer, milliseconds(20), start);
+        EXPECT_FALSE(wheel.empty());
+    }
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_TRUE(AdvanceTo(wheel, start + milliseconds(100)).empty());
+}
+
+TEST(TimerWheelTest, ScheduleAfterSleep) {
+    auto start = TimerWheel::Clock::now();
+    TimerWheel wheel(milliseconds(10), 16, start);
+
+    // Wheel wasn't advanced for a while, deadline still counts from the actual time
+    TimerWheel::Timer timer;
+    wheel.Schedule(timer, milliseconds(50), start + milliseconds(500));
+    EXPECT_TRUE(AdvanceTo(wheel, start + milliseconds(540)).empty());
+    EXPECT_EQ(1, AdvanceTo(wheel, start + milliseconds(560)).size());
+}
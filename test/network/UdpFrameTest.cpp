@@ -0,0 +1,43 @@
+#include "gtest/gtest.h"
+
+#include <network/udp/Frame.h>
+
+using namespace Afina::Network::Udp;
+
+TEST(UdpFrameTest, HeaderRoundTrip) {
+    FrameHeader header;
+    header.request_id = 0xBEEF;
+    header.sequence = 3;
+    header.total = 0x102;
+
+    char data[kHeaderSize];
+    WriteHeader(header, data);
+
+    // Fields are big endian on the wire
+    EXPECT_EQ('\xBE', data[0]);
+    EXPECT_EQ('\xEF', data[1]);
+    EXPECT_EQ('\x01', data[4]);
+    EXPECT_EQ('\x02', data[5]);
+
+    FrameHeader parsed;
+    ASSERT_TRUE(ReadHeader(data, sizeof(data), parsed));
+    EXPECT_EQ(0xBEEF, parsed.request_id);
+    EXPECT_EQ(3, parsed.sequence);
+    EXPECT_EQ(0x102, parsed.total);
+    EXPECT_EQ(0, parsed.reserved);
+}
+
+TEST(UdpFrameTest, ShortDatagram) {
+    char data[kHeaderSize] = {0};
+    FrameHeader header;
+    EXPECT_FALSE(ReadHeader(data, kHeaderSize - 1, header));
+}
+
+TEST(UdpFrameTest, FrameCount) {
+    EXPECT_EQ(1, FrameCount(0));
+    EXPECT_EQ(1, FrameCount(1));
+    EXPECT_EQ(1, FrameCount(kMaxPayload));
+    EXPECT_EQ(2, FrameCount(kMaxPayload + 1));
+    EXPECT_EQ(65535, FrameCount(kMaxPayload * 65535));
+    EXPECT_EQ(0, FrameCount(kMaxPayload * 65535 + 1));
+}
@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <replication/Backlog.h>
+
+using namespace Afina::Replication;
+
+namespace {
+
+std::vector<std::string> keys(const std::string &raw) {
+    std::vector<std::string> result;
+    RecordReader records(raw);
+    Op op;
+    std::string key, value;
+    while (records.Next(op, key, value)) {
+        result.push_back(std::string(op == Op::kPut ? "put " : "delete ") + key);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(BacklogTest, ReadsInOrder) {
+    Backlog backlog(1024);
+    backlog.Append(Op::kPut, "a", "1");
+    backlog.Append(Op::kDelete, "b", "");
+    backlog.Append(Op::kPut, "c", "3");
+    EXPECT_EQ(3, backlog.Next());
+
+    std::string raw;
+    uint32_t count = 0;
+    EXPECT_EQ(Backlog::Status::kOk, backlog.Read(1, 1024, std::chrono::milliseconds(0), raw, count));
+    EXPECT_EQ(2, count);
+    EXPECT_EQ((std::vector<std::string>{"delete b", "put c"}), keys(raw));
+}
+
+TEST(BacklogTest, BatchIsLimited) {
+    Backlog backlog(1024);
+    for (int i = 0; i < 10; i++) {
+        backlog.Append(Op::kPut, "key" + std::to_string(i), "value");
+    }
+
+    std::string raw;
+    uint32_t count = 0;
+    EXPECT_EQ(Backlog::Status::kOk,
+              backlog.Read(0, 3 * RecordSize("key0", "value"), std::chrono::milliseconds(0), raw, count));
+    EXPECT_EQ(3, count);
+}
+
+TEST(BacklogTest, OverflowLosesPosition) {
+    Backlog backlog(10 * RecordSize("key0", "value"));
+    for (int i = 0; i < 15; i++) {
+        backlog.Append(Op::kPut, "key" + std::to_string(i % 10), "value");
+    }
+    EXPECT_FALSE(backlog.Contains(4));
+    EXPECT_TRUE(backlog.Contains(5));
+    EXPECT_TRUE(backlog.Contains(15));
+    EXPECT_FALSE(backlog.Contains(16));
+
+    std::string raw;
+    uint32_t count = 0;
+    EXPECT_EQ(Backlog::Status::kLost, backlog.Read(0, 1024, std::chrono::milliseconds(0), raw, count));
+    EXPECT_EQ(Backlog::Status::kOk, backlog.Read(5, 1024, std::chrono::milliseconds(0), raw, count));
+    EXPECT_EQ(10, count);
+}
+
+TEST(BacklogTest, ReaderWaitsForAppend) {
+    Backlog backlog(1024);
+
+    std::string raw;
+    uint32_t count = 0;
+    EXPECT_EQ(Backlog::Status::kEmpty, backlog.Read(0, 1024, std::chrono::milliseconds(10), raw, count));
+
+    std::thread writer([&backlog] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        backlog.Append(Op::kPut, "a", "1");
+    });
+    EXPECT_EQ(Backlog::Status::kOk, backlog.Read(0, 1024, std::chrono::seconds(5), raw, count));
+    EXPECT_EQ(1, count);
+    writer.join();
+}
+
+TEST(BacklogTest, WakeReleasesReader) {
+    Backlog backlog(1024);
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread waker([&backlog] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        backlog.Wake();
+    });
+
+    std::string raw;
+    uint32_t count = 0;
+    EXPECT_EQ(Backlog::Status::kEmpty, backlog.Read(0, 1024, std::chrono::seconds(5), raw, count));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(4));
+    waker.join();
+}
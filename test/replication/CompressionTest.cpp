@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <replication/Compression.h>
+
+using namespace Afina::Replication;
+
+namespace {
+
+std::string round_trip(const std::string &data) {
+    std::string compressed;
+    Compress(data.data(), data.size(), compressed);
+
+    std::string out;
+    Decompress(compressed.data(), compressed.size(), data.size(), out);
+    return out;
+}
+
+} // namespace
+
+TEST(CompressionTest, Empty) { EXPECT_EQ("", round_trip("")); }
+
+TEST(CompressionTest, ShortLiterals) {
+    EXPECT_EQ("a", round_trip("a"));
+    EXPECT_EQ("abcdefghijklmnopqrstuvwxyz", round_trip("abcdefghijklmnopqrstuvwxyz"));
+}
+
+TEST(CompressionTest, RepeatsShrink) {
+    std::string data;
+    for (int i = 0; i < 1000; i++) {
+        data += "key:" + std::to_string(i % 10) + " value value value\r\n";
+    }
+
+    std::string compressed;
+    Compress(data.data(), data.size(), compressed);
+    EXPECT_LT(compressed.size() * 10, data.size());
+    EXPECT_EQ(data, round_trip(data));
+}
+
+TEST(CompressionTest, OverlappingMatch) {
+    std::string data = "x" + std::string(10000, 'a') + "yz";
+    EXPECT_EQ(data, round_trip(data));
+}
+
+TEST(CompressionTest, RandomData) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> small(0, 3);
+    for (int round = 0; round < 20; round++) {
+        // Mix of noise and runs of few symbols, so both literals and matches have all lengths
+        std::string data;
+        while (data.size() < 100000) {
+            int length = byte(random) * (round + 1);
+            for (int i = 0; i < length; i++) {
+                data.push_back(static_cast<char>(round % 2 ? byte(random) : small(random)));
+            }
+        }
+        EXPECT_EQ(data, round_trip(data));
+    }
+}
+
+TEST(CompressionTest, MalformedThrows) {
+    std::string data(1000, 'a');
+    std::string compressed;
+    Compress(data.data(), data.size(), compressed);
+
+    std::string out;
+    EXPECT_THROW(Decompress(compressed.data(), compressed.size(), data.size() - 1, out), std::runtime_error);
+    out.clear();
+    EXPECT_THROW(Decompress(compressed.data(), 3, data.size(), out), std::runtime_error);
+
+    // Match pointing before the start of output
+    std::string bad("\x10" "a" "\x05\x00", 4);
+    out.clear();
+    EXPECT_THROW(Decompress(bad.data(), bad.size(), 10, out), std::runtime_error);
+}
@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include <replication/Primary.h>
+#include <replication/Replica.h>
+
+#include "common/QuietLogging.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina;
+
+namespace {
+
+std::string address(int i) {
+    return "unix:@afina-replication-test-" + std::to_string(getpid()) + "-" + std::to_string(i);
+}
+
+/**
+ * Waits until storage has the key with the value, empty value waits for the key to be gone
+ */
+bool eventually(Storage &storage, const std::string &key, const std::string &expected) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::string value;
+        bool found = storage.Get(key, value);
+        if (expected.empty() ? !found : (found && value == expected)) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+class ReplicationTest : public ::testing::Test {
+protected:
+    void Run(int i, std::size_t backlog) {
+        primary.reset(new Replication::Primary(std::make_shared<Backend::ThreadSafeSimplLRU>(1 << 20),
+                                               Afina::Test::QuietLogging(), address(i), backlog));
+        primary->Start();
+        replica_backend = std::make_shared<Backend::ThreadSafeSimplLRU>(1 << 20);
+        replica.reset(new Replication::Replica(replica_backend, Afina::Test::QuietLogging(), address(i),
+                                               std::chrono::milliseconds(10)));
+    }
+
+    void TearDown() override {
+        replica->Stop();
+        primary->Stop();
+    }
+
+    std::shared_ptr<Replication::Primary> primary;
+    std::shared_ptr<Storage> replica_backend;
+    std::shared_ptr<Replication::Replica> replica;
+};
+
+} // namespace
+
+TEST_F(ReplicationTest, SnapshotThenStream) {
+    Run(0, 1 << 20);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(primary->Put("key" + std::to_string(i), "value" + std::to_string(i)));
+    }
+
+    replica->Start();
+    EXPECT_TRUE(eventually(*replica, "key999", "value999"));
+    EXPECT_TRUE(eventually(*replica, "key0", "value0"));
+
+    EXPECT_TRUE(primary->Set("key1", "changed"));
+    EXPECT_TRUE(primary->PutIfAbsent("new", "added"));
+    EXPECT_FALSE(primary->PutIfAbsent("key2", "ignored"));
+    EXPECT_TRUE(primary->Delete("key3"));
+    EXPECT_TRUE(primary->Put("last", "one"));
+
+    EXPECT_TRUE(eventually(*replica, "last", "one"));
+    EXPECT_TRUE(eventually(*replica, "key1", "changed"));
+    EXPECT_TRUE(eventually(*replica, "new", "added"));
+    EXPECT_TRUE(eventually(*replica, "key2", "value2"));
+    EXPECT_TRUE(eventually(*replica, "key3", ""));
+}
+
+TEST_F(ReplicationTest, ReplicaIsReadOnly) {
+    Run(1, 1 << 20);
+    replica->Start();
+
+    EXPECT_FALSE(replica->Put("key", "value"));
+    EXPECT_FALSE(replica->Set("key", "value"));
+    EXPECT_FALSE(replica->PutIfAbsent("key", "value"));
+    EXPECT_FALSE(replica->Delete("key"));
+
+    std::string value;
+    EXPECT_FALSE(replica->Get("key", value));
+}
+
+TEST_F(ReplicationTest, ContinuesAfterReconnect) {
+    Run(2, 1 << 20);
+    replica->Start();
+    ASSERT_TRUE(primary->Put("before", "1"));
+    ASSERT_TRUE(eventually(*replica, "before", "1"));
+
+    replica->Stop();
+    ASSERT_TRUE(primary->Put("during", "2"));
+    ASSERT_TRUE(primary->Delete("before"));
+
+    replica->Start();
+    EXPECT_TRUE(eventually(*replica, "during", "2"));
+    EXPECT_TRUE(eventually(*replica, "before", ""));
+}
+
+TEST_F(ReplicationTest, ResyncsAfterBacklogOverflow) {
+    Run(3, 1024);
+    replica->Start();
+    ASSERT_TRUE(primary->Put("stale", "1"));
+    ASSERT_TRUE(eventually(*replica, "stale", "1"));
+
+    // Replica misses more than backlog keeps, delete of stale key is among dropped records
+    replica->Stop();
+    ASSERT_TRUE(primary->Delete("stale"));
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(primary->Put("key" + std::to_string(i), std::string(100, 'x')));
+    }
+
+    replica->Start();
+    EXPECT_TRUE(eventually(*replica, "key0", std::string(100, 'x')));
+    EXPECT_TRUE(eventually(*replica, "key99", std::string(100, 'x')));
+    EXPECT_TRUE(eventually(*replica, "stale", ""));
+}
+
+TEST_F(ReplicationTest, SnapshotConvergesUnderWrites) {
+    Run(4, 1 << 20);
+    for (int i = 0; i < 5000; i++) {
+        ASSERT_TRUE(primary->Put("key" + std::to_string(i), "value" + std::to_string(i)));
+    }
+
+    // Writes go on while snapshot is scanned and sent
+    std::atomic<bool> writing(true);
+    std::thread writer([this, &writing] {
+        for (int i = 0; writing; i++) {
+            std::string key = "key" + std::to_string(i % 5000);
+            if (i % 3 == 0) {
+                primary->Delete(key);
+            } else {
+                primary->Put(key, "round" + std::to_string(i));
+            }
+        }
+    });
+    replica->Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    writing = false;
+    writer.join();
+
+    ASSERT_TRUE(primary->Put("last", "one"));
+    ASSERT_TRUE(eventually(*replica, "last", "one"));
+
+    std::map<std::string, std::string> expected, actual;
+    primary->Scan([&expected](const std::string &key, const std::string &value) { expected[key] = value; });
+    replica->Scan([&actual](const std::string &key, const std::string &value) { actual[key] = value; });
+    EXPECT_EQ(expected, actual);
+}
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+
+#include "storage/HotKeyCache.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina::Backend;
+
+namespace {
+
+// Counts number of reads that hit the backend
+class CountingLRU : public SimpleLRU {
+public:
+    bool Get(const std::string &key, std::string &value) override {
+        gets++;
+        return SimpleLRU::Get(key, value);
+    }
+
+    int gets = 0;
+};
+
+} // namespace
+
+TEST(HotKeyCacheTest, PutGet) {
+    HotKeyCache storage(std::make_shared<SimpleLRU>());
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY2", "val2"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val1", value);
+
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val2", value);
+
+    EXPECT_FALSE(storage.Get("KEY3", value));
+}
+
+TEST(HotKeyCacheTest, HotKeyServedFromReplica) {
+    auto backend = std::make_shared<CountingLRU>();
+    HotKeyCache storage(backend, 16, 2, 1);
+    EXPECT_TRUE(storage.Put("hot", "value"));
+
+    std::string value;
+    for (int i = 0; i < 100; i++) {
+        EXPECT_TRUE(storage.Get("hot", value));
+        EXPECT_EQ("value", value);
+    }
+
+    // Even if thread jumps between CPUs, most of reads must be served by the replica
+    EXPECT_LT(backend->gets, 50);
+}
+
+TEST(HotKeyCacheTest, WriteInvalidatesReplica) {
+    HotKeyCache storage(std::make_shared<SimpleLRU>(), 16, 1, 1);
+    EXPECT_TRUE(storage.Put("hot", "v1"));
+
+    std::string value;
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(storage.Get("hot", value));
+        EXPECT_EQ("v1", value);
+    }
+
+    EXPECT_TRUE(storage.Set("hot", "v2"));
+    EXPECT_TRUE(storage.Get("hot", value));
+    EXPECT_EQ("v2", value);
+
+    EXPECT_TRUE(storage.Delete("hot"));
+    EXPECT_FALSE(storage.Get("hot", value));
+}
@@ -44,6 +44,23 @@ TEST(StorageTest, PutOverwrite) {
     EXPECT_TRUE(value == "val2");
 }
 
+TEST(StorageTest, ScanFromOldest) {
+    SimpleLRU storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+
+    std::vector<std::string> scanned;
+    EXPECT_TRUE(storage.Scan([&scanned](const std::string &key, const std::string &value) {
+        scanned.push_back(key + "=" + value);
+    }));
+    EXPECT_EQ(scanned, (std::vector<std::string>{"KEY2=val2", "KEY3=val3", "KEY1=val1"}));
+}
+
 TEST(StorageTest, PutIfAbsent) {
     SimpleLRU storage;
 